@@ -10,6 +10,7 @@
 #include "../common/config.hh"
 #include "../common/io.hh"
 #include "../common/coding/coding_util.hh"
+#include "../common/coding/decoding_table_cache.hh"
 #include "../common/util.hh"
 
 Agent::Agent() {
@@ -18,6 +19,8 @@ Agent::Agent() {
     _numWorkers = Config::getInstance().getAgentNumWorkers();
     _containerManager = new ContainerManager();
     _coordinator = new AgentCoordinator(_containerManager);
+    // cache the tables of coefficient matrices for partial encoding and repair
+    DecodingTableCache::getInstance().setCapacity(Config::getInstance().getAgentCodingTableCacheSize());
     pthread_mutex_init(&_stats.lock, NULL);
 
     // init statistics
@@ -119,7 +122,7 @@ void *Agent::handleChunkEvent(void *arg) {
 
             // Now event.chunks[i].p2a (startTv, endTv) are marked with valid time
 
-            if (self->_containerManager->putChunks(event.containerIds, event.chunks, event.numChunks) == true) {            
+            if (self->_containerManager->putChunks(event.containerIds, event.chunks, event.numChunks, Config::getInstance().getAgentTrustProxyChecksum()) == true) {            
                 event.opcode = Opcode::PUT_CHUNK_REP_SUCCESS;
                 self->incrementOp();
 
@@ -175,6 +178,76 @@ void *Agent::handleChunkEvent(void *arg) {
             }
             break;
 
+        case Opcode::GET_CHUNK_RANGE_REQ:
+            tagPt_agentProcess.markStart();
+
+            // the (offset, length) of ranges are carried in the coding state
+            if (event.codingMeta.codingStateSize == (int) (sizeof(int) * 2 * event.numChunks) && self->_containerManager->getChunkRanges(event.containerIds, event.chunks, event.numChunks, (int *) event.codingMeta.codingState) == true) {
+                tagPt_agentProcess.markEnd();
+
+                event.opcode = Opcode::GET_CHUNK_RANGE_REP_SUCCESS;
+                LOG(INFO) << "Get ranges of " << event.numChunks << " chunks from containers in " << mytimer.elapsed().wall * 1.0 / 1e9 << " seconds";
+
+                for (int i = 0; i < event.numChunks; i++) {
+                    traffic += event.chunks[i].size;
+                }
+
+                self->addEgressChunkTraffic(traffic);
+                self->incrementOp();
+            } else {
+                event.opcode = Opcode::GET_CHUNK_RANGE_REP_FAIL;
+                LOG(ERROR) << "Failed to get ranges of " << event.numChunks << " chunks from containers";
+                self->incrementOp(false);
+            }
+            break;
+
+        case Opcode::PUT_CHUNK_BATCH_REQ:
+        case Opcode::GET_CHUNK_BATCH_REQ:
+            {
+                // chunks of different requests succeed or fail independently
+                bool isPut = event.opcode == Opcode::PUT_CHUNK_BATCH_REQ;
+                int numSuccess = 0;
+
+                tagPt_agentProcess.markStart();
+
+                event.chunkStatus = new bool[event.numChunks];
+                for (int i = 0; i < event.numChunks; i++) {
+                    Chunk &chunk = event.chunks[i];
+                    if (isPut) {
+                        traffic += chunk.size;
+                        event.chunkStatus[i] = self->_containerManager->putChunks(&event.containerIds[i], &chunk, 1, Config::getInstance().getAgentTrustProxyChecksum());
+                    } else {
+                        event.chunkStatus[i] = self->_containerManager->getChunks(&event.containerIds[i], &chunk, 1);
+                        // no data is returned for a failed chunk
+                        if (!event.chunkStatus[i]) {
+                            chunk.releaseData();
+                            chunk.data = 0;
+                            chunk.size = 0;
+                        }
+                        traffic += chunk.size;
+                    }
+                    if (event.chunkStatus[i]) {
+                        numSuccess++;
+                    } else {
+                        LOG(ERROR) << "Failed to " << (isPut? "put" : "get") << " chunk " << chunk.getChunkName() << " in container " << event.containerIds[i] << " of a batched request";
+                    }
+                    self->incrementOp(event.chunkStatus[i]);
+                }
+
+                tagPt_agentProcess.markEnd();
+
+                LOG(INFO) << (isPut? "Put " : "Get ") << numSuccess << " of " << event.numChunks << " batched chunks " << (isPut? "into" : "from") << " containers in " << mytimer.elapsed().wall * 1.0 / 1e9 << " seconds";
+
+                if (isPut) {
+                    event.opcode = Opcode::PUT_CHUNK_BATCH_REP;
+                    self->addIngressChunkTraffic(traffic);
+                } else {
+                    event.opcode = Opcode::GET_CHUNK_BATCH_REP;
+                    self->addEgressChunkTraffic(traffic);
+                }
+            }
+            break;
+
         case Opcode::DEL_CHUNK_REQ:
             // TAGPT(start): agent del chunk
             tagPt_agentProcess.markStart();
@@ -351,10 +424,13 @@ void *Agent::handleChunkEvent(void *arg) {
                     output[chunkIdx] = curChunk.data;
                 }
                 // do decoding
-                CodingUtils::encode(input, numInputChunkReq, output, event.numChunks, chunkSize, isCAR? matrix : event.codingMeta.codingState);
+                if (allsuccess && !CodingUtils::encode(input, numInputChunkReq, output, event.numChunks, chunkSize, isCAR? matrix : event.codingMeta.codingState)) {
+                    LOG(ERROR) << "Failed to decode the chunks for repair";
+                    allsuccess = false;
+                }
                 // compute checksum
                 for (int chunkIdx = 0; chunkIdx < event.numChunks; chunkIdx++) {
-                    event.chunks[chunkIdx].computeMD5();
+                    event.chunks[chunkIdx].computeChecksum();
                 }
                 // send chunks to other agents for storage (keep first numChunksPerNode for local storage, and send out the remaining)
                 int numChunksToSend = isCAR? 0 : event.numChunks - numChunksPerNode;
@@ -482,6 +558,22 @@ void *Agent::handleChunkEvent(void *arg) {
             }
             break;
 
+        case UPD_CHUNK_REQ:
+            if (self->_containerManager->updateChunks(event.containerIds, event.chunks, &(event.chunks[event.numChunks]), event.numChunks) == true) {
+                event.opcode = Opcode::UPD_CHUNK_REP_SUCCESS;
+                LOG(INFO) << "Update " << event.numChunks << " chunks in containers in " << mytimer.elapsed().wall * 1.0 / 1e9 << " seconds";
+                self->incrementOp();
+            } else {
+                event.opcode = Opcode::UPD_CHUNK_REP_FAIL;
+                LOG(ERROR) << "Failed to update " << event.numChunks << " chunks in containers";
+                self->incrementOp(false);
+            }
+            for (int i = 0; i < event.numChunks; i++) {
+                traffic += event.chunks[i].size;
+            }
+            self->addIngressChunkTraffic(traffic);
+            break;
+
         case VRF_CHUNK_REQ:
             { 
                 int numCorruptedChunks = 0;
@@ -499,7 +591,8 @@ void *Agent::handleChunkEvent(void *arg) {
             }
         }
 
-        // send a reply
+        // send a reply, the chunk data is sent without copying and must remain valid until released
+        IO::ZeroCopyTracker tracker;
         try {
             
             // TAGPT(start): agent send reply to proxy
@@ -512,7 +605,7 @@ void *Agent::handleChunkEvent(void *arg) {
 
             // mytimer.start();
 
-            traffic = IO::sendChunkEventMessage(socket, event);
+            traffic = IO::sendChunkEventMessage(socket, event, &tracker);
 
             self->addEgressTraffic(traffic);
 
@@ -523,8 +616,11 @@ void *Agent::handleChunkEvent(void *arg) {
 
         } catch (zmq::error_t &e) {
             LOG(ERROR) << "Failed to send chunk event message: " << e.what();
+            tracker.wait();
             break;
         }
+
+        tracker.wait();
     }
 
     return NULL;
@@ -100,7 +100,7 @@ bool AliContainer::copyChecksum(const char *hash, unsigned char *md5) {
     return apr_base64_decode_binary(md5, hash) == MD5_DIGEST_LENGTH;
 }
 
-bool AliContainer::putChunk(Chunk &chunk) {
+bool AliContainer::putChunk(Chunk &chunk, bool trustChecksum) {
     char opath[OBJ_PATH_MAX];
     if (genObjectPath(opath, chunk.getChunkName()) == false) {
         LOG(ERROR) << "Failed to get object path name";
@@ -136,12 +136,18 @@ bool AliContainer::putChunk(Chunk &chunk) {
     if (success) {
         md5base64 = apr_table_get(repHeaders, OSS_CONTENT_MD5);
         // verify the chunk checksum
+        // (the content md5 is the md5 of the data, so chunks with other checksum types are verified against the data sent instead)
         if (Config::getInstance().verifyChunkChecksum()) {
-            success = compareChecksum(md5base64, chunk.md5, chunk.getChunkName());
+            if (chunk.checksumType == ChecksumType::CHECKSUM_MD5) {
+                success = compareChecksum(md5base64, chunk.checksum, chunk.getChunkName());
+            } else {
+                success = trustChecksum || chunk.verifyChecksum();
+            }
         }
 
         // copy the checksum from reponse
-        copyChecksum(md5base64, chunk.md5);
+        if (chunk.checksumType == ChecksumType::CHECKSUM_MD5)
+            copyChecksum(md5base64, chunk.checksum);
 
         LOG(INFO) << "Put chunk " << chunk.getChunkName() << " as object " << opath;
     } else {
@@ -192,7 +198,7 @@ bool AliContainer::getChunk(Chunk &chunk, bool skipVerification) {
         }
         // verify checksum
         if (!skipVerification && Config::getInstance().verifyChunkChecksum()) {
-            success = chunk.verifyMD5();
+            success = chunk.verifyChecksum();
         }
     }
 
@@ -284,12 +290,16 @@ bool AliContainer::copyChunk(const Chunk &src, Chunk &dst) {
         const char *md5base64 = okay? apr_table_get(repHeaders, OSS_CONTENT_MD5) : 0;
 
         // verify checksum
-        okay = okay && (!Config::getInstance().verifyChunkChecksum() || compareChecksum(md5base64, src.md5, dst.getChunkName()));
+        bool isMD5 = src.checksumType == ChecksumType::CHECKSUM_MD5;
+        if (!isMD5)
+            dst.copyChecksum(src);
+        okay = okay && (!Config::getInstance().verifyChunkChecksum() || (isMD5? compareChecksum(md5base64, src.checksum, dst.getChunkName()) : verifyChunkData(dst)));
 
         if (okay) {
             dst.size = atol(apr_table_get(repHeaders, OSS_CONTENT_LENGTH));
             // copy the checksum from reponse
-            copyChecksum(md5base64, dst.md5);
+            if (isMD5)
+                copyChecksum(md5base64, dst.checksum);
         } else {
             deleteChunk(dst);
             LOG(ERROR) << "Failed to get the size of copied chunk " << dst.getChunkName() << ", code = " << status->error_code << " msg = " << status->error_msg;
@@ -341,7 +351,9 @@ bool AliContainer::checkChunk(const Chunk &chunk, bool forceChecksumCheck, bool
             (checksumOnly || (size && atoi(size) == chunk.size)) && // object size
             (
                 (!Config::getInstance().verifyChunkChecksum() && !forceChecksumCheck) ||
-                compareChecksum(apr_table_get(repHeaders, OSS_CONTENT_MD5), chunk.md5, chunk.getChunkName())
+                (chunk.checksumType == ChecksumType::CHECKSUM_MD5?
+                    compareChecksum(apr_table_get(repHeaders, OSS_CONTENT_MD5), chunk.checksum, chunk.getChunkName()) :
+                    verifyChunkData(chunk))
             ) // object checksum
     ;
 
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "fs.hh"
+#include "segment.hh"
 #include "alicloud.hh"
 #include "aws_s3.hh"
 #include "azure_blob.hh"
@@ -150,7 +150,7 @@ bool AwsContainer::copyChecksum(const Aws::String &etag, unsigned char *md5) {
     return true;
 }
 
-bool AwsContainer::putChunk(Chunk &chunk) {
+bool AwsContainer::putChunk(Chunk &chunk, bool trustChecksum) {
     std::string chunkName = chunk.getChunkName();
 
     char opath[OBJ_PATH_MAX];
@@ -181,7 +181,12 @@ bool AwsContainer::putChunk(Chunk &chunk) {
     bool success = outcome.IsSuccess();
     // verify checksum
     if (success && Config::getInstance().verifyChunkChecksum()) {
-        success = compareChecksum(outcome.GetResult().GetETag(), chunk.md5, chunkName);
+        // the etag is the md5 of the data, so chunks with other checksum types are verified against the data sent instead
+        if (chunk.checksumType == ChecksumType::CHECKSUM_MD5) {
+            success = compareChecksum(outcome.GetResult().GetETag(), chunk.checksum, chunkName);
+        } else {
+            success = trustChecksum || chunk.verifyChecksum();
+        }
     }
 
     // check the response
@@ -192,7 +197,8 @@ bool AwsContainer::putChunk(Chunk &chunk) {
         // mark the current chunk version for chunk reverting (by deleting the current version)
         snprintf(chunk.chunkVersion, CHUNK_VERSION_MAX_LEN - 1, "%s", outcome.GetResult().GetVersionId().c_str()); 
         // copy checksum from response
-        copyChecksum(outcome.GetResult().GetETag(), chunk.md5);
+        if (chunk.checksumType == ChecksumType::CHECKSUM_MD5)
+            copyChecksum(outcome.GetResult().GetETag(), chunk.checksum);
     } else {
         LOG(ERROR) << "Failed to put chunk " << chunkName << " as object " << opath;
     }
@@ -232,7 +238,7 @@ bool AwsContainer::getChunk(Chunk &chunk, bool skipVerification) {
         chunk.data = (unsigned char *) malloc (chunk.size);
         outcome.GetResult().GetBody().read((char *) chunk.data, chunk.size);
         // verify chunk checksum
-        success = skipVerification || !Config::getInstance().verifyChunkChecksum() || chunk.verifyMD5();
+        success = skipVerification || !Config::getInstance().verifyChunkChecksum() || chunk.verifyChecksum();
     }
     if (!success) {
         LOG(ERROR) << "Failed to get chunk " << chunkName << " as object " << opath;
@@ -300,11 +306,17 @@ bool AwsContainer::copyChunk(const Chunk &src, Chunk &dst) {
     if (success) {
         // copy resulted chunk size
         dst.size = outcome2.GetResult().GetContentLength();
-        // copy checksum from response
-        copyChecksum(outcome2.GetResult().GetETag(), dst.md5);
+        // copy checksum from response, or from the source chunk if the etag does not carry the checksum
+        if (src.checksumType == ChecksumType::CHECKSUM_MD5) {
+            copyChecksum(outcome2.GetResult().GetETag(), dst.checksum);
+        } else {
+            dst.copyChecksum(src);
+        }
         // verify chunk checksum
         if (Config::getInstance().verifyChunkChecksum()) {
-            success = compareChecksum(outcome2.GetResult().GetETag(), src.md5, dst.getChunkName());
+            success = src.checksumType == ChecksumType::CHECKSUM_MD5?
+                    compareChecksum(outcome2.GetResult().GetETag(), src.checksum, dst.getChunkName()) :
+                    verifyChunkData(dst);
         }
     }
     if (!success) {
@@ -317,7 +329,7 @@ bool AwsContainer::copyChunk(const Chunk &src, Chunk &dst) {
 }
 
 bool AwsContainer::moveChunk(const Chunk &src, Chunk &dst) {
-    // the size and md5 will be copied in copyChunk()
+    // the size and checksum will be copied in copyChunk()
     return copyChunk(src, dst) && deleteChunk(src);
 }
 
@@ -340,7 +352,9 @@ bool AwsContainer::hasChunk(const Chunk &chunk) {
             outcome.GetResult().GetContentLength() == chunk.size && // chunk size
             (
                 !Config::getInstance().verifyChunkChecksum() || // chunk checksum
-                compareChecksum(outcome.GetResult().GetETag(), chunk.md5, chunkName)
+                (chunk.checksumType == ChecksumType::CHECKSUM_MD5?
+                    compareChecksum(outcome.GetResult().GetETag(), chunk.checksum, chunkName) :
+                    verifyChunkData(chunk))
             )
     ;
 }
@@ -382,7 +396,9 @@ bool AwsContainer::verifyChunk(const Chunk &chunk) {
 
     auto outcome = _client.HeadObject(req);
 
-    matched = outcome.IsSuccess() && compareChecksum(outcome.GetResult().GetETag(), chunk.md5, chunkName);
+    matched = outcome.IsSuccess() && (chunk.checksumType == ChecksumType::CHECKSUM_MD5?
+            compareChecksum(outcome.GetResult().GetETag(), chunk.checksum, chunkName) :
+            verifyChunkData(chunk));
     DLOG(INFO) << "Check chunk " << opath << " using HeadObj request, result = " << matched;
 
     return matched;
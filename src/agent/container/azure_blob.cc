@@ -62,7 +62,7 @@ bool AzureContainer::copyChecksum(const std::string &hash, unsigned char *md5) {
     return true;
 }
 
-bool AzureContainer::putChunk(Chunk &chunk) {
+bool AzureContainer::putChunk(Chunk &chunk, bool trustChecksum) {
     std::string chunkName = chunk.getChunkName();
 
     char bpath[BPATH_MAX];
@@ -95,13 +95,18 @@ bool AzureContainer::putChunk(Chunk &chunk) {
 
     bool success = true;
     std::string hash = chunkBlob.properties().content_md5();
-    // verify checksum
+    // verify checksum (the content md5 is the md5 of the data, so chunks with other checksum types are verified against the data sent instead)
     if (success && Config::getInstance().verifyChunkChecksum()) {
-        success = compareChecksum(hash, chunk.md5, chunkName);
+        if (chunk.checksumType == ChecksumType::CHECKSUM_MD5) {
+            success = compareChecksum(hash, chunk.checksum, chunkName);
+        } else {
+            success = trustChecksum || chunk.verifyChecksum();
+        }
     }
     if (success) {
         // copy checksum from response
-        copyChecksum(hash, chunk.md5);
+        if (chunk.checksumType == ChecksumType::CHECKSUM_MD5)
+            copyChecksum(hash, chunk.checksum);
         LOG(INFO) << "Put chunk " << chunkName << " as blob " << bpath << " snapshot version = " << chunk.chunkVersion;
     }
     return success;
@@ -126,7 +131,7 @@ bool AzureContainer::getChunk(Chunk &chunk, bool skipVerification) {
     chunkBlob.download_to_stream(outStream, _accessCond, _reqOpts, _opCxt);
 
     // verify checksum
-    if (!skipVerification && Config::getInstance().verifyChunkChecksum() && !chunk.verifyMD5())
+    if (!skipVerification && Config::getInstance().verifyChunkChecksum() && !chunk.verifyChecksum())
         return false;
 
     LOG(INFO) << "Get chunk " << chunk.getChunkName() << " as blob " << bpath;
@@ -174,11 +179,16 @@ bool AzureContainer::copyChunk(const Chunk &src, Chunk &dst) {
 
     std::string hash = copyChunkBlob.properties().content_md5();
 
-    // copy checksum from response
-    copyChecksum(hash, dst.md5);
+    // copy checksum from response, or from the source chunk if the content md5 does not carry the checksum
+    bool isMD5 = src.checksumType == ChecksumType::CHECKSUM_MD5;
+    if (isMD5) {
+        copyChecksum(hash, dst.checksum);
+    } else {
+        dst.copyChecksum(src);
+    }
 
     // verify checksum, delete and report fail if mismatched
-    if (Config::getInstance().verifyChunkChecksum() && !compareChecksum(hash, src.md5, dst.getChunkName())) {
+    if (Config::getInstance().verifyChunkChecksum() && !(isMD5? compareChecksum(hash, src.checksum, dst.getChunkName()) : verifyChunkData(dst))) {
         deleteChunk(dst);
         return false;
     } 
@@ -211,7 +221,9 @@ bool AzureContainer::checkChunkAttributes(const Chunk &chunk, bool forceChecksum
     return (checksumOnly || chunkBlob.properties().size() == (unsigned int) chunk.size) && // object size
             (
                 (!Config::getInstance().verifyChunkChecksum() && !forceChecksumCheck) ||
-                compareChecksum(chunkBlob.properties().content_md5(), chunk.md5, chunk.getChunkName())
+                (chunk.checksumType == ChecksumType::CHECKSUM_MD5?
+                    compareChecksum(chunkBlob.properties().content_md5(), chunk.checksum, chunk.getChunkName()) :
+                    verifyChunkData(chunk))
             ) // object checksum
     ;
 }
@@ -24,8 +24,10 @@ public:
 
     /**
      * See Container::putChunk()
+     *
+     * @remark the chunk checksum is always taken from the response of the storage service, so trustChecksum is ignored
      **/
-    bool putChunk(Chunk &chunk);
+    bool putChunk(Chunk &chunk, bool trustChecksum = false);
 
     /**
      * See Container::getChunk()
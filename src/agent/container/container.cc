@@ -57,3 +57,9 @@ void* Container::backgroundUsageUpdate(void *arg) {
     }
     return 0;
 }
+
+bool Container::verifyChunkData(const Chunk &chunk) {
+    Chunk readChunk;
+    readChunk.copyMeta(chunk, /* copy size */ false);
+    return getChunk(readChunk, /* skip verification */ true) && readChunk.verifyChecksum();
+}
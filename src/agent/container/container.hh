@@ -18,10 +18,11 @@ public:
      *
      * @param[in,out] chunk            chunk to store/overwrite;
      *                                 should have all fields filled
+     * @param[in] trustChecksum        whether the chunk checksum (Chunk::checksum) is trusted, such that it needs not be computed from the stored data
      *
      * @return whether the chunk is successful stored
      **/
-    virtual bool putChunk(Chunk &chunk) = 0;
+    virtual bool putChunk(Chunk &chunk, bool trustChecksum = false) = 0;
 
     /**
      * Get a chunk from the container
@@ -160,6 +161,16 @@ protected:
      **/
     static void* backgroundUsageUpdate(void *arg);
 
+    /**
+     * Verify a stored chunk by reading back its data, for chunks with checksums of a type not kept by the storage backend
+     *
+     * @param[in] chunk                chunk to verify
+     *                                 should have all fields filled, except Chunk::size, Chunk::data and Chunk::freeData;
+     *
+     * @return whether the chunk data matches the checksum
+     **/
+    bool verifyChunkData(const Chunk &chunk);
+
 };
 
 #endif // define __CONTAINER_HH__
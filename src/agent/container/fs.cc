@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <dirent.h> // opendir(), readdir()
+#include <errno.h>
 #include <stdio.h> // ftell(), rewind(), sprintf()
 #include <string.h> // strlen()
 #include <string>
@@ -12,6 +14,10 @@
 #include <sys/file.h> // flock()
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include <boost/timer/timer.hpp>
 
 #include <glog/logging.h>
@@ -19,12 +25,66 @@
 #include "../../common/config.hh"
 #include "fs.hh"
 
+/// magic string at the beginning of the usage state file
+#define FS_USAGE_STATE_MAGIC   "ncloud-fs-usage"
+/// version of the usage state file format
+#define FS_USAGE_STATE_VERSION (1)
+/// min. number of entries in the container folder for each thread scanning the folder
+#define FS_USAGE_SCAN_BATCH    (4096)
+
+/**
+ * Get the size of a chunk file
+ *
+ * @return size of the file, or 0 if the file does not exist
+ **/
+static unsigned long int getChunkFileSize(const char *fpath) {
+    struct stat sbuf;
+    return stat(fpath, &sbuf) == 0? sbuf.st_size : 0;
+}
+
+static bool syncDirectory(const char *dir) {
+    int dirFd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (dirFd < 0)
+        return false;
+    bool okay = fsync(dirFd) == 0;
+    close(dirFd);
+    return okay;
+}
+
 FsContainer::FsContainer(int id, const char *dir, unsigned long int capacity) :
         Container(id, capacity) {
+    Config &config = Config::getInstance();
+    FsIOOptions options;
+    options.engine = config.getAgentFsIOEngine();
+    options.queueDepth = config.getAgentFsIOQueueDepth();
+    options.directIO = config.getAgentFsDirectIO();
+    options.groupCommit = config.getAgentFsGroupCommit();
+    options.groupCommitWindow = config.getAgentFsGroupCommitWindow();
+    options.groupCommitBatchSize = config.getAgentFsGroupCommitBatchSize();
+    init(dir, options);
+}
+
+FsContainer::FsContainer(int id, const char *dir, unsigned long int capacity, const FsIOOptions &options) :
+        Container(id, capacity) {
+    init(dir, options);
+}
+
+void FsContainer::init(const char *dir, const FsIOOptions &options) {
     strcpy(_dir, dir);
     // create the directory for chunk files
     mkdir(dir, 0755);
-    updateUsage();
+
+    // load the usage saved, or scan the directory if the usage is not saved
+    boost::timer::cpu_timer mytimer;
+    unsigned long int usage = 0;
+    _usageSaved = loadUsage(usage);
+    if (!_usageSaved && !getTotalSize(usage))
+        LOG(WARNING) << "Failed to get usage for container id = " << _id;
+    _usage = usage;
+    LOG(INFO) << (_usageSaved? "Load" : "Scan") << " usage of FS container id = " << _id << " (" << _usage << "B) in " << mytimer.elapsed().wall * 1.0 / 1e9 << "s";
+    // save the usage scanned, so the next start does not scan again
+    if (!_usageSaved)
+        saveUsage();
 
     _running = true;
 
@@ -32,6 +92,33 @@ FsContainer::FsContainer(int id, const char *dir, unsigned long int capacity) :
     pthread_cond_init(&_chunkCleanUp.cond, NULL);
     pthread_mutex_init(&_chunkCleanUp.lock, NULL);
     pthread_create(&_chunkCleanUp.th, NULL, FsContainer::cleanUpOldChunks, (FsContainer *) this);
+
+    // I/O engine
+    _uring = NULL;
+    _directIO = false;
+    if (options.engine == FsIOEngine::FS_IO_URING) {
+        _uring = new UringIO(options.queueDepth);
+        if (!_uring->isAvailable()) {
+            LOG(WARNING) << "io_uring is not available, fall back to POSIX I/O for container id = " << _id;
+            delete _uring;
+            _uring = NULL;
+        } else {
+            _directIO = options.directIO;
+        }
+    }
+
+    // group commit of synced writes
+    _groupCommit = NULL;
+    if (options.groupCommit && Config::getInstance().getAgentFlushOnClose()) {
+        _groupCommit = new GroupCommit(dir, options.groupCommitWindow, options.groupCommitBatchSize);
+        if (!_groupCommit->isReady()) {
+            LOG(WARNING) << "Failed to start group commit, sync each write on its own for container id = " << _id;
+            delete _groupCommit;
+            _groupCommit = NULL;
+        }
+    }
+
+    LOG(INFO) << "FS container id = " << _id << " uses " << FsIOEngineName[getIOEngine()] << " I/O" << (_directIO? " (direct I/O)" : "") << (_groupCommit? " with group commit" : "");
 }
 
 FsContainer::~FsContainer() {
@@ -41,12 +128,19 @@ FsContainer::~FsContainer() {
     pthread_join(_chunkCleanUp.th, NULL);
     pthread_cond_destroy(&_chunkCleanUp.cond);
     pthread_mutex_destroy(&_chunkCleanUp.lock);
+    saveUsage();
+    delete _groupCommit;
+    delete _uring;
 }
 
 bool FsContainer::getChunkPath(char *fpath, std::string chunkName) {
     return snprintf(fpath, PATH_MAX, "%s/%s", _dir, chunkName.c_str()) < PATH_MAX;
 }
 
+std::mutex &FsContainer::getChunkLock(const std::string &chunkName) {
+    return _chunkLocks[std::hash<std::string>()(chunkName) % FS_NUM_CHUNK_LOCKS];
+}
+
 void FsContainer::getOldChunkPath(std::string &ofpath, char *fpath, const char *ctime) {
     ofpath.clear();
     ofpath = fpath;
@@ -54,11 +148,16 @@ void FsContainer::getOldChunkPath(std::string &ofpath, char *fpath, const char *
     ofpath += ctime;
 }
 
-bool FsContainer::putChunk(Chunk &chunk) {
+bool FsContainer::putChunk(Chunk &chunk, bool trustChecksum) {
     char fpath[PATH_MAX];
     if (getChunkPath(fpath, chunk.getChunkName()) == false)
         return false;
 
+    std::lock_guard<std::mutex> clk(getChunkLock(chunk.getChunkName()));
+    std::shared_lock<std::shared_mutex> change = beginChange();
+    // the previous version, if any, is moved away and no longer counted in the usage
+    unsigned long int before = getChunkFileSize(fpath);
+
     std::string ofpath(fpath);
     // backup the chunk first if exists
     if (boost::filesystem::is_regular_file(ofpath)) {
@@ -78,6 +177,59 @@ bool FsContainer::putChunk(Chunk &chunk) {
 
     boost::timer::cpu_timer mytimer;
 
+    // check if all chunk data is successfully written
+    bool success = writeChunkFile(fpath, chunk);
+    // read chunk data back to get checksum, and verify the checksum if needed, unless the checksum is trusted
+    if (success && !trustChecksum) {
+        Chunk readChunk;
+        readChunk.copyMeta(chunk);
+        success = getChunkInternal(readChunk) || !Config::getInstance().verifyChunkChecksum();
+        if (success) {
+            readChunk.computeChecksum();
+            chunk.copyChecksum(readChunk);
+        }
+    }
+
+    addUsage(before, getChunkFileSize(fpath));
+
+    if (success) {
+        double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        LOG(INFO) << "Put chunk " << chunk.getChunkName() << " to path " << fpath << " size " << (chunk.size * 1.0 / (1 << 20)) << " MB in " << elapsed << "s, " << (chunk.size * 1.0 / (1 << 20)) / elapsed << " MB/s";
+    }
+
+    return success;
+}
+
+bool FsContainer::writeChunkFile(const char fpath[], const Chunk &chunk) {
+    boost::timer::cpu_timer mytimer;
+    bool sync = Config::getInstance().getAgentFlushOnClose();
+
+    if (_uring) {
+        // open (and truncate) the file for write
+        bool direct = false;
+        int fd = openChunkFile(fpath, O_WRONLY | O_CREAT | O_TRUNC, direct);
+        if (fd < 0)
+            return false;
+
+        // lock file for write
+        flock(fd, LOCK_EX);
+
+        // write the data (and sync, unless synced in a group) in one batch of requests
+        bool okay = _uring->write(fd, chunk.data, chunk.size, sync && !_groupCommit, direct);
+        LOG_IF(ERROR, !okay) << "Failed to write chunk data " << chunk.getChunkName() << " with io_uring";
+        if (okay && sync && _groupCommit)
+            okay = syncChunkFile(fd);
+
+        // unlock and close the chunk file
+        flock(fd, LOCK_UN);
+        close(fd);
+
+        double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        DLOG(INFO) << "<WRITE> Write chunk (io_uring), size: " << (chunk.size * 1.0 / (1 << 20)) << " MB, time: " << elapsed << " s, speed: " << (chunk.size * 1.0 / (1 << 20)) / elapsed << " MB/s";
+
+        return okay;
+    }
+
     // open (and truncate) the file for write
     FILE *chunkFile = fopen(fpath, "w");
     if (chunkFile == NULL) {
@@ -100,9 +252,14 @@ bool FsContainer::putChunk(Chunk &chunk) {
         written += ret;
     }
 
-    if (Config::getInstance().getAgentFlushOnClose()) {
+    if (sync) {
         fflush(chunkFile);
-        fsync(fileno(chunkFile));
+        if (!syncChunkFile(fileno(chunkFile))) {
+            LOG(ERROR) << "Failed to sync chunk data " << chunk.getChunkName() << " error = " << strerror(errno);
+            flock(fileno(chunkFile), LOCK_UN);
+            fclose(chunkFile);
+            return false;
+        }
     }
 
     // benchmark
@@ -116,21 +273,25 @@ bool FsContainer::putChunk(Chunk &chunk) {
     // close the chunk file
     fclose(chunkFile);
 
-    // check if all chunk data is successfully written
-    bool success = written == chunk.size;
-    // read chunk data back to get checksum, and verify the checksum if needed
-    Chunk readChunk;
-    readChunk.copyMeta(chunk);
-    success = success && (getChunkInternal(readChunk) || !Config::getInstance().verifyChunkChecksum());
+    return written == chunk.size;
+}
 
-    if (success) {
-        readChunk.computeMD5();
-        chunk.copyMD5(readChunk);
-        elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
-        LOG(INFO) << "Put chunk " << chunk.getChunkName() << " to path " << fpath << " size " << (chunk.size * 1.0 / (1 << 20)) << " MB in " << elapsed << "s, " << (chunk.size * 1.0 / (1 << 20)) / elapsed << " MB/s";
-    }
+bool FsContainer::syncChunkFile(int fd) {
+    if (_groupCommit)
+        return _groupCommit->commit(fd);
+    return fsync(fd) == 0;
+}
 
-    return success;
+int FsContainer::openChunkFile(const char fpath[], int flags, bool &direct) {
+    direct = _directIO;
+    int fd = open(fpath, flags | (direct? O_DIRECT : 0), 0666);
+    if (fd < 0 && direct && errno == EINVAL) {
+        // the file system does not support direct I/O, e.g., tmpfs
+        direct = false;
+        fd = open(fpath, flags, 0666);
+    }
+    LOG_IF(ERROR, fd < 0) << "Failed to open chunk file " << fpath << ", " << strerror(errno);
+    return fd;
 }
 
 bool FsContainer::getChunk(Chunk &chunk, bool skipVerification) {
@@ -154,10 +315,60 @@ bool FsContainer::getChunkInternal(Chunk &chunk, bool skipVerification) {
     }
 
     // verify checksum if needed
-    return skipVerification || !Config::getInstance().verifyChunkChecksum() || chunk.verifyMD5();
+    return skipVerification || !Config::getInstance().verifyChunkChecksum() || chunk.verifyChecksum();
 }
 
 bool FsContainer::readChunkFile(const char fpath[], Chunk &chunk) {
+    if (_uring) {
+        bool direct = false;
+        int fd = openChunkFile(fpath, O_RDONLY, direct);
+        if (fd < 0)
+            return false;
+
+        boost::timer::cpu_timer mytimer;
+
+        // lock file for read
+        flock(fd, LOCK_SH);
+
+        // get chunk (file) size
+        struct stat sbuf;
+        if (fstat(fd, &sbuf) != 0) {
+            LOG(ERROR) << "Failed to get the size of chunk file " << fpath << ", " << strerror(errno);
+            flock(fd, LOCK_UN);
+            close(fd);
+            return false;
+        }
+        chunk.size = sbuf.st_size;
+
+        // get chunk (file) data, into an aligned buffer for direct I/O
+        length_t bufSize = UringIO::getBufferSize(chunk.size, direct);
+        chunk.data = NULL;
+        if (direct) {
+            if (posix_memalign((void **) &chunk.data, URING_IO_ALIGNMENT, bufSize > 0? bufSize : URING_IO_ALIGNMENT) != 0)
+                chunk.data = NULL;
+        } else {
+            chunk.data = (unsigned char*) malloc (bufSize);
+        }
+        bool okay = (chunk.data != NULL || bufSize == 0) && _uring->read(fd, chunk.data, chunk.size, direct);
+
+        // unlock and close the chunk file
+        flock(fd, LOCK_UN);
+        close(fd);
+
+        if (!okay) {
+            LOG(ERROR) << "Failed to read chunk file " << fpath << " with io_uring";
+            free(chunk.data);
+            chunk.data = NULL;
+            chunk.size = 0;
+            return false;
+        }
+
+        double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        LOG(INFO) << "Get chunk " << chunk.getChunkName() << " to path " << fpath << " size " << (chunk.size * 1.0 / (1 << 20)) << " MB in " << elapsed << "s, " << (chunk.size * 1.0 / (1 << 20)) / elapsed << " MB/s";
+
+        return true;
+    }
+
     FILE *chunkFile = fopen(fpath, "r");
     if (chunkFile == NULL) {
         LOG(ERROR) << "Failed to open chunk file " << fpath;
@@ -205,7 +416,12 @@ bool FsContainer::deleteChunk(const Chunk &chunk) {
     if (getChunkPath(fpath, chunk.getChunkName()) == false)
         return false;
 
+    std::lock_guard<std::mutex> clk(getChunkLock(chunk.getChunkName()));
+    std::shared_lock<std::shared_mutex> change = beginChange();
+    unsigned long int before = getChunkFileSize(fpath);
+
     unlink(fpath);
+    addUsage(before, getChunkFileSize(fpath));
     LOG(INFO) << "Delete chunk " << chunk.getChunkName() << " at path " << fpath;
 
     return true;
@@ -217,14 +433,30 @@ bool FsContainer::copyChunk(const Chunk &src, Chunk &dst) {
         return false;
     if (getChunkPath(dfpath, dst.getChunkName()) == false)
         return false;
+
+    // lock both chunks in a fixed order
+    std::mutex *slock = &getChunkLock(src.getChunkName()), *dlock = &getChunkLock(dst.getChunkName());
+    std::unique_lock<std::mutex> clk1(*std::min(slock, dlock));
+    std::unique_lock<std::mutex> clk2;
+    if (slock != dlock)
+        clk2 = std::unique_lock<std::mutex>(*std::max(slock, dlock));
+    std::shared_lock<std::shared_mutex> change = beginChange();
+    unsigned long int before = getChunkFileSize(dfpath);
     
     unsigned long int copyBlockSize = Config::getInstance().getCopyBlockSize();
     char buffer[copyBlockSize];
     FILE *srcFile = fopen(sfpath, "r");
-    FILE *dstFile = fopen(dfpath, "w");
-
-    if (srcFile == NULL || dstFile == NULL)
+    // leave the destination untouched if the source is missing
+    FILE *dstFile = srcFile == NULL? NULL : fopen(dfpath, "w");
+
+    if (srcFile == NULL || dstFile == NULL) {
+        if (srcFile != NULL)
+            fclose(srcFile);
+        if (dstFile != NULL)
+            fclose(dstFile);
+        addUsage(before, getChunkFileSize(dfpath));
         return false;
+    }
 
     // lock files for read/write
     flock(fileno(srcFile), LOCK_SH);
@@ -253,20 +485,22 @@ bool FsContainer::copyChunk(const Chunk &src, Chunk &dst) {
     // check if the whole chuck is copied
     bool success = size == src.size;
 
-    // always compute and copy the MD5 of the copied chunk, and verify the checksum if needed
+    // always compute and copy the checksum of the copied chunk, and verify the checksum if needed
     Chunk readChunk;
     readChunk.copyMeta(dst);
     success = success && (getChunkInternal(readChunk) || !Config::getInstance().verifyChunkChecksum());
 
     // remove newly copied chunk if (checksum verification) failed
-    if (!success) {
-        deleteChunk(dst);
-    } else {
+    if (!success)
+        unlink(dfpath);
+    addUsage(before, getChunkFileSize(dfpath));
+
+    if (success) {
         // mark the size copied
         dst.size = size;
-        // mark the md5 of the copied chunk
-        readChunk.computeMD5();
-        dst.copyMD5(readChunk);
+        // mark the checksum of the copied chunk
+        readChunk.computeChecksum();
+        dst.copyChecksum(readChunk);
         LOG(INFO) << "Copy chunk " << src.getChunkName() << " to " << dst.getChunkName() << " from path " << sfpath << " to path " << dfpath;
     }
 
@@ -280,9 +514,20 @@ bool FsContainer::moveChunk(const Chunk &src, Chunk &dst) {
     if (getChunkPath(dfpath, dst.getChunkName()) == false)
         return false;
 
+    // lock both chunks in a fixed order
+    std::mutex *slock = &getChunkLock(src.getChunkName()), *dlock = &getChunkLock(dst.getChunkName());
+    std::unique_lock<std::mutex> clk1(*std::min(slock, dlock));
+    std::unique_lock<std::mutex> clk2;
+    if (slock != dlock)
+        clk2 = std::unique_lock<std::mutex>(*std::max(slock, dlock));
+
     struct stat sbuf;
     if (stat(sfpath, &sbuf) != 0) 
         return false;
+
+    // a chunk at the destination is replaced
+    std::shared_lock<std::shared_mutex> change = beginChange();
+    unsigned long int before = getChunkFileSize(sfpath) + getChunkFileSize(dfpath);
     
     bool success = rename(sfpath, dfpath) == 0;
 
@@ -294,13 +539,14 @@ bool FsContainer::moveChunk(const Chunk &src, Chunk &dst) {
     if (success) {
         // mark the size moved
         dst.size = sbuf.st_size;
-        // mark the md5 of the moved chunk
-        readChunk.computeMD5();
-        dst.copyMD5(readChunk);
+        // mark the checksum of the moved chunk
+        readChunk.computeChecksum();
+        dst.copyChecksum(readChunk);
         LOG(INFO) << "Move chunk " << src.getChunkName() << " to " << dst.getChunkName() << " from path " << sfpath << " to path " << dfpath;
     } else { // revert the change if (checksum verification) failed
         rename(dfpath, sfpath);
     }
+    addUsage(before, getChunkFileSize(sfpath) + getChunkFileSize(dfpath));
 
     return success;
 }
@@ -325,6 +571,10 @@ bool FsContainer::revertChunk(const Chunk &chunk) {
     if (getChunkPath(fpath, chunk.getChunkName()) == false)
         return false;
 
+    std::lock_guard<std::mutex> clk(getChunkLock(chunk.getChunkName()));
+    std::shared_lock<std::shared_mutex> change = beginChange();
+    unsigned long int before = getChunkFileSize(fpath);
+
     getOldChunkPath(ofpath, fpath, chunk.chunkVersion);
     getOldChunkPath(tfpath, fpath, "0");
 
@@ -336,6 +586,7 @@ bool FsContainer::revertChunk(const Chunk &chunk) {
     } else {
         unlink(tfpath.c_str());
     }
+    addUsage(before, getChunkFileSize(fpath));
 
     return okay;
 }
@@ -351,7 +602,7 @@ bool FsContainer::verifyChunk(const Chunk &chunk) {
     Chunk readChunk;
     readChunk.copyMeta(chunk);
     // either verified when reading chunk data back (if checksum verification is enabled), or manual verification
-    matched = getChunkInternal(readChunk) && (Config::getInstance().verifyChunkChecksum() || readChunk.verifyMD5());
+    matched = getChunkInternal(readChunk) && (Config::getInstance().verifyChunkChecksum() || readChunk.verifyChecksum());
     LOG_IF(WARNING, !matched) << "Check chunk " << fpath << " by reading data and computing checksum, result = " << matched;
 
     return matched;
@@ -360,17 +611,63 @@ bool FsContainer::verifyChunk(const Chunk &chunk) {
 
 bool FsContainer::getTotalSize(unsigned long int &total, bool needsLock) {
     total = 0;
-    // sum up the size of all files
-    try {
-        for (boost::filesystem::directory_entry &f : boost::filesystem::recursive_directory_iterator(boost::filesystem::path(_dir))) {
-            if (boost::filesystem::is_regular_file(f.path()) && !isOldChunks(f.path().c_str()))
-                total += boost::filesystem::file_size(f.path());
-        }
-    } catch (std::exception &e) {
-        LOG(ERROR) << "Failed to list directory " << _dir << ", " << e.what();
+
+    // list the directory
+    std::vector<std::string> names;
+    DIR *dir = opendir(_dir);
+    if (dir == NULL) {
+        LOG(ERROR) << "Failed to list directory " << _dir << ", " << strerror(errno);
         return false;
     }
-    return true;
+    for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        // skip the directory itself, its parent, and old chunks
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0 || (entry->d_type != DT_DIR && isOldChunks(entry->d_name)))
+            continue;
+        names.push_back(entry->d_name);
+    }
+    closedir(dir);
+
+    // sum up the size of all files, with the entries taken in turn by multiple threads to overlap the metadata reads
+    std::atomic<size_t> next(0);
+    std::atomic<unsigned long int> sum(0);
+    std::atomic<bool> okay(true);
+    auto scan = [&]() {
+        unsigned long int subtotal = 0;
+        for (size_t i = next++; i < names.size() && okay; i = next++) {
+            std::string fpath = std::string(_dir) + "/" + names.at(i);
+            struct stat sbuf;
+            // skip files removed after listing
+            if (stat(fpath.c_str(), &sbuf) != 0)
+                continue;
+            if (S_ISREG(sbuf.st_mode)) {
+                subtotal += isOldChunks(fpath.c_str())? 0 : sbuf.st_size;
+                continue;
+            }
+            if (!S_ISDIR(sbuf.st_mode))
+                continue;
+            try {
+                for (boost::filesystem::directory_entry &f : boost::filesystem::recursive_directory_iterator(boost::filesystem::path(fpath))) {
+                    if (boost::filesystem::is_regular_file(f.path()) && !isOldChunks(f.path().c_str()))
+                        subtotal += boost::filesystem::file_size(f.path());
+                }
+            } catch (std::exception &e) {
+                LOG(ERROR) << "Failed to list directory " << fpath << ", " << e.what();
+                okay = false;
+            }
+        }
+        sum += subtotal;
+    };
+
+    size_t numThreads = std::min(names.size() / FS_USAGE_SCAN_BATCH + 1, (size_t) FS_USAGE_SCAN_MAX_THREADS);
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; t++)
+        threads.emplace_back(scan);
+    scan();
+    for (auto &th : threads)
+        th.join();
+
+    total = sum;
+    return okay;
 }
 
 bool FsContainer::isOldChunks(const char *fpath) {
@@ -380,13 +677,113 @@ bool FsContainer::isOldChunks(const char *fpath) {
     return strchr(idx == NULL? fpath : idx, '.') != NULL;
 }
 
+bool FsContainer::isUsageStateFile(const char *fpath) {
+    const char *idx = strrchr(fpath, '/');
+    // the state file, or its temporary file
+    return strncmp(idx == NULL? fpath : idx + 1, FS_USAGE_STATE_FILE, strlen(FS_USAGE_STATE_FILE)) == 0;
+}
+
+int FsContainer::getIOEngine() const {
+    return _uring? FsIOEngine::FS_IO_URING : FsIOEngine::FS_IO_POSIX;
+}
+
+bool FsContainer::getGroupCommitStats(unsigned long int &numCommits, unsigned long int &numWrites) const {
+    if (_groupCommit == NULL)
+        return false;
+    numCommits = _groupCommit->getNumCommits();
+    numWrites = _groupCommit->getNumWrites();
+    return true;
+}
+
 void FsContainer::updateUsage() {
-    unsigned long int total = 0;
-    if (getTotalSize(total)) {
-        _usage = total;
-    } else {
-        LOG(WARNING) << "Failed to update usage for container id = " << _id;
+    // the usage is updated on every change to the chunk files
+}
+
+std::string FsContainer::getUsageStatePath() const {
+    return std::string(_dir) + "/" + FS_USAGE_STATE_FILE;
+}
+
+std::shared_lock<std::shared_mutex> FsContainer::beginChange() {
+    std::shared_lock<std::shared_mutex> lk(_changeLock);
+    if (_usageSaved) {
+        std::lock_guard<std::mutex> slk(_stateLock);
+        // the usage saved becomes outdated after the change, so remove it before the change is made
+        if (_usageSaved) {
+            std::string fpath = getUsageStatePath();
+            if (unlink(fpath.c_str()) != 0 && errno != ENOENT) {
+                LOG(ERROR) << "Failed to remove usage state file " << fpath << ", " << strerror(errno);
+            } else if (!syncDirectory(_dir)) {
+                LOG(ERROR) << "Failed to sync directory " << _dir << " after removing usage state file, " << strerror(errno);
+            }
+            _usageSaved = false;
+        }
+    }
+    return lk;
+}
+
+void FsContainer::addUsage(unsigned long int before, unsigned long int after) {
+    std::lock_guard<std::mutex> lk(_usageLock);
+    _usage = _usage + after >= before? _usage + after - before : 0;
+}
+
+bool FsContainer::loadUsage(unsigned long int &usage) {
+    std::string fpath = getUsageStatePath();
+    FILE *f = fopen(fpath.c_str(), "r");
+    if (f == NULL) {
+        LOG_IF(WARNING, errno != ENOENT) << "Failed to open usage state file " << fpath << ", " << strerror(errno);
+        return false;
     }
+
+    char magic[32];
+    int version = 0;
+    char end = 0;
+    bool okay = fscanf(f, "%31s %d %lu%c", magic, &version, &usage, &end) == 4
+            && strcmp(magic, FS_USAGE_STATE_MAGIC) == 0
+            && version == FS_USAGE_STATE_VERSION
+            && end == '\n'
+            && fgetc(f) == EOF;
+    fclose(f);
+
+    LOG_IF(WARNING, !okay) << "Invalid usage state file " << fpath;
+    return okay;
+}
+
+bool FsContainer::saveUsage(bool wait) {
+    // wait for the changes in progress, and hold back new ones, so the usage saved is not outdated by them
+    std::unique_lock<std::shared_mutex> lk(_changeLock, std::defer_lock);
+    if (wait)
+        lk.lock();
+    else if (!lk.try_lock())
+        return false;
+
+    std::lock_guard<std::mutex> slk(_stateLock);
+    if (_usageSaved)
+        return true;
+
+    // write to a temporary file, and make it durable before replacing the previous one
+    std::string fpath = getUsageStatePath();
+    std::string tfpath = fpath + ".tmp";
+    FILE *f = fopen(tfpath.c_str(), "w");
+    if (f == NULL) {
+        LOG(ERROR) << "Failed to open usage state file " << tfpath << ", " << strerror(errno);
+        return false;
+    }
+    bool okay = fprintf(f, "%s %d %lu\n", FS_USAGE_STATE_MAGIC, FS_USAGE_STATE_VERSION, _usage) > 0;
+    okay = okay && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    okay = fclose(f) == 0 && okay;
+    okay = okay && rename(tfpath.c_str(), fpath.c_str()) == 0;
+    if (!okay) {
+        LOG(ERROR) << "Failed to write usage state file " << fpath << ", " << strerror(errno);
+        unlink(tfpath.c_str());
+        return false;
+    }
+
+    // the file is in place, and is removed before the next change anyway
+    _usageSaved = true;
+    LOG_IF(ERROR, !syncDirectory(_dir)) << "Failed to sync directory " << _dir << " after saving usage state file, " << strerror(errno);
+    DLOG(INFO) << "Save usage of FS container id = " << _id << " (" << _usage << "B)";
+
+    return true;
 }
 
 void *FsContainer::cleanUpOldChunks(void *arg) {
@@ -410,9 +807,10 @@ void *FsContainer::cleanUpOldChunks(void *arg) {
                 // go over the directory
                 for (boost::filesystem::directory_entry &f : boost::filesystem::recursive_directory_iterator(boost::filesystem::path(container->_dir))) {
                     //LOG(INFO) << "Clean up check path " << f.path();
-                    // skip (1) non-regular files, (2) files that are not old ones, and (3) old chunks that is yet expired (10mins)
+                    // skip (1) non-regular files, (2) files that are not old ones, (3) the usage state file, and (4) old chunks that is yet expired (10mins)
                     if (!boost::filesystem::is_regular_file(f.path()) ||
                         !isOldChunks(f.path().c_str()) ||
+                        isUsageStateFile(f.path().c_str()) ||
                         boost::filesystem::last_write_time(f.path()) + timeout * 10 > time(NULL))
                         continue;
                     // clean the chunk
@@ -424,6 +822,8 @@ void *FsContainer::cleanUpOldChunks(void *arg) {
                 //LOG(ERROR) << "Failed to list directory " << container->_dir << " for cleaning up old chunks, " << e.what();
             }
         } while (removed);
+        // save the usage, unless the container is busy with changes
+        container->saveUsage(/* wait */ false);
     } while (container->_running);
     pthread_mutex_unlock(&container->_chunkCleanUp.lock);
 
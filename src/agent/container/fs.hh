@@ -7,18 +7,66 @@
 #include <pthread.h>
 #include <linux/limits.h>
 
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
 #include "container.hh"
+#include "group_commit.hh"
+#include "uring_io.hh"
 #include "../../ds/chunk.hh"
 
+/// name of the file holding the usage of an FS container, in the container folder
+#define FS_USAGE_STATE_FILE       ".usage"
+/// number of locks for serializing the operations on the same chunk
+#define FS_NUM_CHUNK_LOCKS        (64)
+/// max. number of threads to scan the container folder for usage
+#define FS_USAGE_SCAN_MAX_THREADS (16)
+
+/**
+ * I/O options of FS containers
+ **/
+struct FsIOOptions {
+    int engine;                        /**< I/O engine, see FsIOEngine */
+    int queueDepth;                    /**< number of requests submitted at a time (for io_uring only) */
+    bool directIO;                     /**< whether to bypass the page cache (for io_uring only) */
+    bool groupCommit;                  /**< whether to sync the writes in groups */
+    unsigned int groupCommitWindow;    /**< max. time (in microseconds) to wait for more writes to join a group */
+    unsigned int groupCommitBatchSize; /**< max. number of writes in a group */
+
+    FsIOOptions() {
+        engine = FsIOEngine::FS_IO_POSIX;
+        queueDepth = URING_IO_DEFAULT_DEPTH;
+        directIO = false;
+        groupCommit = false;
+        groupCommitWindow = GROUP_COMMIT_DEFAULT_WINDOW;
+        groupCommitBatchSize = GROUP_COMMIT_DEFAULT_BATCH_SIZE;
+    }
+};
+
+/**
+ * Container on local file system that stores each chunk as a file
+ *
+ * The usage is updated on every put, delete, copy, move and revert. Once a minute, if no change is in progress, and
+ * when the container is closed, the usage is saved to a state file, which is removed before the next change. On
+ * start, the usage is loaded from the state file, or, if the file is missing or invalid, e.g., after a crash, the
+ * container folder is scanned with multiple threads.
+ **/
 class FsContainer : public Container {
 public:
     FsContainer(int id, const char* dir, unsigned long int capacity);
+    /**
+     * Constructor with the I/O options specified instead of taken from the agent config
+     *
+     * @param[in] options          I/O options
+     **/
+    FsContainer(int id, const char* dir, unsigned long int capacity, const FsIOOptions &options);
     ~FsContainer();
 
     /**
      * See Container::putChunk()
      **/
-    bool putChunk(Chunk &chunk);
+    bool putChunk(Chunk &chunk, bool trustChecksum = false);
 
     /**
      * See Container::getChunk()
@@ -60,6 +108,32 @@ public:
      **/
     void updateUsage();
 
+    /**
+     * Save the usage to the state file, if the usage has changed since the file is last saved
+     *
+     * @param[in] wait            whether to wait for the changes in progress, instead of giving up
+     *
+     * @return whether the state file holds the current usage
+     **/
+    bool saveUsage(bool wait = true);
+
+    /**
+     * Get the I/O engine in use, which is POSIX I/O if io_uring is not available
+     *
+     * @return the I/O engine, see FsIOEngine
+     **/
+    int getIOEngine() const;
+
+    /**
+     * Get the number of group commits and the number of writes committed in groups
+     *
+     * @param[out] numCommits     number of commits
+     * @param[out] numWrites      number of writes committed
+     *
+     * @return whether group commit is enabled
+     **/
+    bool getGroupCommitStats(unsigned long int &numCommits, unsigned long int &numWrites) const;
+
 private:
     char _dir[PATH_MAX]; /**< container folder path */
     struct {
@@ -70,6 +144,30 @@ private:
 
     bool _running; /**< whether the container is "running" */
 
+    UringIO *_uring; /**< io_uring engine, NULL for POSIX I/O */
+    bool _directIO;  /**< whether to bypass the page cache on io_uring */
+    GroupCommit *_groupCommit; /**< group commit of synced writes, NULL to sync each write on its own */
+
+    std::mutex _chunkLocks[FS_NUM_CHUNK_LOCKS]; /**< locks serializing the operations on the same chunk */
+    std::mutex _usageLock;                      /**< lock on usage changes */
+    std::shared_mutex _changeLock;              /**< held shared by changes in progress, and exclusively by saving the usage */
+    std::mutex _stateLock;                      /**< lock on the state file */
+    std::atomic<bool> _usageSaved;              /**< whether the state file holds the current usage */
+
+    /**
+     * Set up the container
+     **/
+    void init(const char *dir, const FsIOOptions &options);
+
+    /**
+     * Make a written chunk file durable, either on its own or in a group
+     *
+     * @param[in] fd              file descriptor of the chunk file
+     *
+     * @return whether the chunk file is durable
+     **/
+    bool syncChunkFile(int fd);
+
     /**
      * Get the path of chunk file
      *
@@ -84,12 +182,62 @@ private:
 
     bool getTotalSize(unsigned long int &total, bool needsLock = true);
 
+    /**
+     * Get the lock of a chunk
+     *
+     * @param[in] chunkName      name of the chunk
+     *
+     * @return the lock of the chunk
+     **/
+    std::mutex &getChunkLock(const std::string &chunkName);
+
+    /**
+     * Start a change to the usage, which removes the state file if it holds the usage before the change
+     *
+     * @return lock held until the change completes
+     **/
+    std::shared_lock<std::shared_mutex> beginChange();
+
+    /**
+     * Add the change in size of chunk files to the usage
+     *
+     * @param[in] before         total size of the chunk files before a change
+     * @param[in] after          total size of the chunk files after the change
+     **/
+    void addUsage(unsigned long int before, unsigned long int after);
+
+    /**
+     * Load the usage from the state file
+     *
+     * @param[out] usage         usage saved
+     *
+     * @return whether the usage is loaded
+     **/
+    bool loadUsage(unsigned long int &usage);
+
+    std::string getUsageStatePath() const;
+
     bool getChunkInternal(Chunk &chunk, bool skipVerification = false);
 
     bool readChunkFile(const char fpath[], Chunk &chunk);
 
+    bool writeChunkFile(const char fpath[], const Chunk &chunk);
+
+    /**
+     * Open a chunk file for io_uring, with O_DIRECT if enabled and supported by the file system
+     *
+     * @param[in] fpath           path of the chunk file
+     * @param[in] flags           flags for open()
+     * @param[out] direct         whether the file is opened with O_DIRECT
+     *
+     * @return the file descriptor, or -1 if failed
+     **/
+    int openChunkFile(const char fpath[], int flags, bool &direct);
+
     static bool isOldChunks(const char *fpath);
 
+    static bool isUsageStateFile(const char *fpath);
+
     static void *cleanUpOldChunks(void *arg);
 };
 
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h> // strerror()
+#include <stdio.h>  // sscanf()
+#include <unistd.h> // fsync(), fdatasync(), syncfs(), close()
+#include <sys/utsname.h> // uname()
+
+#include <algorithm>
+#include <chrono>
+
+#include <glog/logging.h>
+
+#include "group_commit.hh"
+
+GroupCommit::GroupCommit(const char *dir, unsigned int window, unsigned int batchSize) {
+    _window = window;
+    _batchSize = std::max(batchSize, 1U);
+    _useSyncfs = syncfsReportsErrors();
+    _stop = false;
+    _numCommits = 0;
+    _numWrites = 0;
+
+    _dirFd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (_dirFd < 0) {
+        LOG(ERROR) << "Failed to open directory " << dir << " for group commit, " << strerror(errno);
+        return;
+    }
+    LOG_IF(WARNING, !_useSyncfs) << "Kernel syncfs() does not report writeback errors, commit multiple writes on " << dir << " with a fdatasync() on each";
+    _committer = std::thread(&GroupCommit::run, this);
+}
+
+GroupCommit::~GroupCommit() {
+    {
+        std::lock_guard<std::mutex> lk(_lock);
+        _stop = true;
+    }
+    _hasRequest.notify_all();
+    // the commit thread completes the pending requests before it ends
+    if (_committer.joinable())
+        _committer.join();
+    if (_dirFd >= 0)
+        close(_dirFd);
+}
+
+bool GroupCommit::isReady() const {
+    return _dirFd >= 0;
+}
+
+bool GroupCommit::commit(int fd) {
+    if (!isReady())
+        return fsync(fd) == 0;
+
+    Request request = { fd, false, false };
+    std::unique_lock<std::mutex> lk(_lock);
+    if (_stop) {
+        lk.unlock();
+        return fsync(fd) == 0;
+    }
+    _pending.push_back(&request);
+    // wake the commit thread on the first request, or when the batch is full
+    if (_pending.size() == 1 || _pending.size() >= _batchSize)
+        _hasRequest.notify_one();
+    _committed.wait(lk, [&request] { return request.done; });
+    return request.okay;
+}
+
+unsigned long int GroupCommit::getNumCommits() const {
+    return _numCommits;
+}
+
+unsigned long int GroupCommit::getNumWrites() const {
+    return _numWrites;
+}
+
+void GroupCommit::run() {
+    std::unique_lock<std::mutex> lk(_lock);
+    while (true) {
+        _hasRequest.wait(lk, [this] { return _stop || !_pending.empty(); });
+        if (_pending.empty())
+            break;
+
+        // wait for more writes to join, unless the batch is full
+        if (_window > 0 && !_stop) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(_window);
+            _hasRequest.wait_until(lk, deadline, [this] { return _stop || _pending.size() >= _batchSize; });
+        }
+
+        // take a batch, leaving the rest for the next commit
+        size_t numRequests = std::min(_pending.size(), (size_t) _batchSize);
+        std::vector<Request *> batch(_pending.begin(), _pending.begin() + numRequests);
+        _pending.erase(_pending.begin(), _pending.begin() + numRequests);
+        lk.unlock();
+
+        // flush once for all files in the batch, or each file if the flush may miss writeback errors
+        bool okay = false;
+        if (batch.size() == 1) {
+            okay = batch.front()->okay = fsync(batch.front()->fd) == 0;
+        } else if (_useSyncfs) {
+            okay = syncfs(_dirFd) == 0;
+            for (Request *request : batch)
+                request->okay = okay;
+        } else {
+            okay = true;
+            for (Request *request : batch) {
+                request->okay = fdatasync(request->fd) == 0;
+                okay = okay && request->okay;
+            }
+        }
+        LOG_IF(ERROR, !okay) << "Failed to commit " << batch.size() << " writes, " << strerror(errno);
+        _numCommits++;
+        _numWrites += batch.size();
+
+        lk.lock();
+        for (Request *request : batch)
+            request->done = true;
+        _committed.notify_all();
+    }
+}
+
+bool GroupCommit::syncfsReportsErrors() {
+    struct utsname name;
+    int major = 0, minor = 0;
+    if (uname(&name) != 0 || sscanf(name.release, "%d.%d", &major, &minor) != 2)
+        return false;
+    return major > 5 || (major == 5 && minor >= 8);
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __GROUP_COMMIT_HH__
+#define __GROUP_COMMIT_HH__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// default max. time (in microseconds) to wait for more writes to join a commit
+#define GROUP_COMMIT_DEFAULT_WINDOW      (200)
+/// default max. number of writes per commit
+#define GROUP_COMMIT_DEFAULT_BATCH_SIZE  (64)
+
+/**
+ * Group commit of file writes on a file system
+ *
+ * Writers hand over their written files and wait. A commit thread takes the pending files, after waiting for up to
+ * a window for more to join or until the batch is full, and makes them durable together: a single file is synced
+ * with fsync(), and multiple files are synced with one syncfs() on the file system, which flushes the device once
+ * for all of them. Writers are released once their commit completes, so a write returns only after its data is
+ * durable, as with a fsync() per write. Since syncfs() reports writeback errors only since Linux 5.8, multiple
+ * files are synced with a fdatasync() on each of them on older kernels.
+ **/
+class GroupCommit {
+public:
+    /**
+     * Constructor
+     *
+     * @param[in] dir               a directory on the file system to commit
+     * @param[in] window            max. time (in microseconds) to wait for more writes to join a commit, 0 to commit the pending writes right away
+     * @param[in] batchSize         max. number of writes per commit
+     **/
+    GroupCommit(const char *dir, unsigned int window = GROUP_COMMIT_DEFAULT_WINDOW, unsigned int batchSize = GROUP_COMMIT_DEFAULT_BATCH_SIZE);
+    ~GroupCommit();
+
+    /**
+     * Tell whether the commit thread is running
+     *
+     * @return whether the group commit is ready
+     **/
+    bool isReady() const;
+
+    /**
+     * Make a written file durable, and wait until its commit completes
+     *
+     * @param[in] fd                file descriptor of the written file, which must stay open until this returns
+     *
+     * @return whether the file is durable
+     **/
+    bool commit(int fd);
+
+    unsigned long int getNumCommits() const;
+    unsigned long int getNumWrites() const;
+
+private:
+    /**
+     * A file waiting for commit
+     **/
+    struct Request {
+        int fd;                        /**< file descriptor */
+        bool done;                     /**< whether the commit completes */
+        bool okay;                     /**< whether the commit succeeds */
+    };
+
+    /**
+     * Commit the pending writes in batches until stopped
+     **/
+    void run();
+
+    /**
+     * Tell whether syncfs() reports writeback errors on the running kernel, i.e., Linux 5.8 or later
+     *
+     * @return whether syncfs() reports writeback errors
+     **/
+    static bool syncfsReportsErrors();
+
+    int _dirFd;                        /**< file descriptor of the directory, for syncfs() */
+    unsigned int _window;              /**< max. time (in microseconds) to wait for more writes */
+    unsigned int _batchSize;           /**< max. number of writes per commit */
+    bool _useSyncfs;                   /**< whether to sync multiple files with syncfs(), instead of a fdatasync() on each */
+
+    std::mutex _lock;                  /**< lock on the pending requests */
+    std::condition_variable _hasRequest;  /**< signal for new requests */
+    std::condition_variable _committed;   /**< signal for completed commits */
+    std::vector<Request *> _pending;   /**< requests pending for commit */
+    bool _stop;                        /**< whether to stop the commit thread */
+    std::thread _committer;            /**< commit thread */
+
+    std::atomic<unsigned long int> _numCommits;  /**< number of commits */
+    std::atomic<unsigned long int> _numWrites;   /**< number of writes committed */
+};
+
+#endif // define __GROUP_COMMIT_HH__
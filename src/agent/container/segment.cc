@@ -0,0 +1,1295 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h> // snprintf(), sscanf()
+#include <stdlib.h> // malloc(), free(), atol()
+#include <string.h> // memset(), memcpy(), strerror()
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h> // pwritev()
+
+#include <algorithm>
+#include <functional>
+
+#include <boost/filesystem.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <glog/logging.h>
+
+extern "C" {
+#include <isa-l/crc.h>
+}
+
+#include "../../common/config.hh"
+#include "segment.hh"
+
+/// magic number at the beginning of each record
+#define SEGMENT_RECORD_MAGIC      (0x4e534752) // "RGSN"
+/// magic number at the beginning of the checkpoint file
+#define SEGMENT_CHECKPOINT_MAGIC  (0x4e534b43) // "CKSN"
+/// version of the checkpoint file format
+#define SEGMENT_CHECKPOINT_VERSION (2)
+/// size of reads when scanning segments
+#define SEGMENT_SCAN_BUFFER_SIZE  (1 << 20)
+/// time (in seconds) to keep old versions of chunks for revert, as in FsContainer
+#define SEGMENT_OLD_VERSION_TTL   (600)
+
+static bool preadFully(int fd, unsigned char *buf, size_t length, off_t offset, size_t *done = NULL) {
+    size_t read = 0;
+    while (read < length) {
+        ssize_t ret = pread(fd, buf + read, length - read, offset + read);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            break;
+        read += ret;
+    }
+    if (done)
+        *done = read;
+    return read == length;
+}
+
+static bool pwritevFully(int fd, struct iovec *iov, int iovcnt, off_t offset) {
+    while (iovcnt > 0) {
+        ssize_t ret = pwritev(fd, iov, iovcnt, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+        offset += ret;
+        // skip the vectors written, and advance the one partially written
+        while (iovcnt > 0 && (size_t) ret >= iov->iov_len) {
+            ret -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *) iov->iov_base + ret;
+            iov->iov_len -= ret;
+        }
+    }
+    return true;
+}
+
+/**
+ * Scoped hold of a read-write lock, shared or exclusive
+ **/
+class RwLockGuard {
+public:
+    RwLockGuard(pthread_rwlock_t *lock, bool exclusive = false) {
+        _lock = lock;
+        if (exclusive)
+            pthread_rwlock_wrlock(_lock);
+        else
+            pthread_rwlock_rdlock(_lock);
+    }
+
+    ~RwLockGuard() {
+        pthread_rwlock_unlock(_lock);
+    }
+
+private:
+    pthread_rwlock_t *_lock;
+};
+
+SegmentContainer::Segment::~Segment() {
+    if (fd >= 0)
+        close(fd);
+}
+
+SegmentContainer::SegmentContainer(int id, const char *dir, unsigned long int capacity) :
+        Container(id, capacity) {
+    Config &config = Config::getInstance();
+    SegmentOptions options;
+    options.segmentSize = config.getAgentSegmentSize();
+    options.compactionThreshold = config.getAgentSegmentCompactionThreshold();
+    options.groupCommit = config.getAgentFsGroupCommit();
+    options.groupCommitWindow = config.getAgentFsGroupCommitWindow();
+    options.groupCommitBatchSize = config.getAgentFsGroupCommitBatchSize();
+    init(dir, options);
+}
+
+SegmentContainer::SegmentContainer(int id, const char *dir, unsigned long int capacity, const SegmentOptions &options) :
+        Container(id, capacity) {
+    init(dir, options);
+}
+
+void SegmentContainer::init(const char *dir, const SegmentOptions &options) {
+    strcpy(_dir, dir);
+    _options = options;
+
+    // let checkpoints wait for the updates in progress only, instead of all updates coming after them
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&_updateLock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    _checkpointSeq = 0;
+    _indexChanged = false;
+    _seq = 0;
+    _usage = 0;
+
+    // create the directory for segment files
+    mkdir(dir, 0755);
+
+    boost::timer::cpu_timer mytimer;
+    recover();
+    double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+
+    // group commit of synced writes
+    _groupCommit = NULL;
+    if (options.groupCommit && Config::getInstance().getAgentFlushOnClose()) {
+        _groupCommit = new GroupCommit(dir, options.groupCommitWindow, options.groupCommitBatchSize);
+        if (!_groupCommit->isReady()) {
+            LOG(WARNING) << "Failed to start group commit, sync each write on its own for container id = " << _id;
+            delete _groupCommit;
+            _groupCommit = NULL;
+        }
+    }
+
+    _running = true;
+
+    // background thread for cleaning old versions, compaction and checkpoints
+    pthread_cond_init(&_maintenance.cond, NULL);
+    pthread_mutex_init(&_maintenance.lock, NULL);
+    pthread_create(&_maintenance.th, NULL, SegmentContainer::runMaintenance, (SegmentContainer *) this);
+
+    LOG(INFO) << "Segment container id = " << _id << " loaded " << _index.size() << " chunks in " << _segments.size() << " segments in " << elapsed << "s" << (_groupCommit? " with group commit" : "");
+}
+
+SegmentContainer::~SegmentContainer() {
+    // signal the background thread to terminate now
+    pthread_mutex_lock(&_maintenance.lock);
+    _running = false;
+    pthread_cond_signal(&_maintenance.cond);
+    pthread_mutex_unlock(&_maintenance.lock);
+    pthread_join(_maintenance.th, NULL);
+    pthread_cond_destroy(&_maintenance.cond);
+    pthread_mutex_destroy(&_maintenance.lock);
+
+    // persist the index for a fast restart
+    checkpoint();
+
+    delete _groupCommit;
+    _activeSegment.reset();
+    _segments.clear();
+    pthread_rwlock_destroy(&_updateLock);
+}
+
+std::mutex &SegmentContainer::getChunkLock(const std::string &name) {
+    return _chunkLocks[std::hash<std::string>()(name) % SEGMENT_NUM_CHUNK_LOCKS];
+}
+
+std::string SegmentContainer::getSegmentPath(long int id) const {
+    char fpath[PATH_MAX];
+    int length = 0;
+    if (id < 0)
+        length = snprintf(fpath, PATH_MAX, "%s/index", _dir);
+    else
+        length = snprintf(fpath, PATH_MAX, "%s/seg-%08ld", _dir, id);
+    LOG_IF(ERROR, length >= PATH_MAX) << "Path of segment " << id << " in " << _dir << " is too long";
+    return std::string(fpath);
+}
+
+std::shared_ptr<SegmentContainer::Segment> SegmentContainer::openSegment(uint32_t id, bool create) {
+    std::string fpath = getSegmentPath(id);
+    int fd = open(fpath.c_str(), O_RDWR | (create? O_CREAT | O_EXCL : 0), 0666);
+    if (fd < 0) {
+        LOG(ERROR) << "Failed to open segment " << fpath << ", " << strerror(errno);
+        return NULL;
+    }
+    struct stat sbuf;
+    if (fstat(fd, &sbuf) != 0) {
+        LOG(ERROR) << "Failed to get the size of segment " << fpath << ", " << strerror(errno);
+        close(fd);
+        return NULL;
+    }
+
+    std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+    segment->id = id;
+    segment->fd = fd;
+    segment->size = sbuf.st_size;
+    segment->liveBytes = 0;
+
+    std::unique_lock<std::shared_mutex> lk(_lock);
+    _segments[id] = segment;
+    return segment;
+}
+
+uint32_t SegmentContainer::getRecordCrc(const RecordHeader &header, const char *name, const char *aux) {
+    RecordHeader h = header;
+    h.crc = 0;
+    uint32_t crc = crc32_iscsi((unsigned char *) &h, sizeof(RecordHeader), 0);
+    crc = crc32_iscsi((unsigned char *) name, header.nameLength, crc);
+    return crc32_iscsi((unsigned char *) aux, header.auxLength, crc);
+}
+
+bool SegmentContainer::prepareActiveSegment(uint32_t length) {
+    if (_activeSegment && (_activeSegment->size == 0 || _activeSegment->size + length <= _options.segmentSize))
+        return true;
+
+    // seal the full segment, so records copied there by compaction are durable before the next checkpoint
+    if (_activeSegment && fdatasync(_activeSegment->fd) != 0)
+        LOG(ERROR) << "Failed to sync segment " << _activeSegment->id << ", " << strerror(errno);
+
+    uint32_t id = 0;
+    {
+        std::shared_lock<std::shared_mutex> lk(_lock);
+        if (!_segments.empty())
+            id = _segments.rbegin()->first + 1;
+    }
+    _activeSegment = openSegment(id, /* create */ true);
+    return _activeSegment != NULL;
+}
+
+bool SegmentContainer::appendRecord(uint8_t type, const std::string &name, const std::string &aux, const unsigned char *data, uint32_t dataLength, uint8_t checksumType, const unsigned char *checksum, Location &location) {
+    RecordHeader header;
+    memset(&header, 0, sizeof(RecordHeader));
+    header.magic = SEGMENT_RECORD_MAGIC;
+    header.type = type;
+    header.checksumType = checksumType;
+    header.nameLength = name.size();
+    header.auxLength = aux.size();
+    header.dataLength = dataLength;
+    if (checksum)
+        memcpy(header.checksum, checksum, CHUNK_CHECKSUM_MAX_LEN);
+    uint32_t recordLength = sizeof(RecordHeader) + header.nameLength + header.auxLength + dataLength;
+
+    struct iovec iov[4];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(RecordHeader);
+    iov[1].iov_base = (void *) name.data();
+    iov[1].iov_len = name.size();
+    iov[2].iov_base = (void *) aux.data();
+    iov[2].iov_len = aux.size();
+    iov[3].iov_base = (void *) data;
+    iov[3].iov_len = dataLength;
+
+    std::shared_ptr<Segment> segment;
+    {
+        // write records one after another, so a record synced implies all records before it are written
+        std::lock_guard<std::mutex> wlk(_writeLock);
+        if (!prepareActiveSegment(recordLength))
+            return false;
+        segment = _activeSegment;
+
+        header.seq = ++_seq;
+        header.crc = getRecordCrc(header, name.data(), aux.data());
+
+        if (!pwritevFully(segment->fd, iov, 4, segment->size)) {
+            LOG(ERROR) << "Failed to append record of chunk " << name << " to segment " << segment->id << ", " << strerror(errno);
+            return false;
+        }
+
+        location.segment = segment->id;
+        location.offset = segment->size;
+        location.recordLength = recordLength;
+        location.dataLength = dataLength;
+        location.checksumType = checksumType;
+        memcpy(location.checksum, header.checksum, CHUNK_CHECKSUM_MAX_LEN);
+
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        segment->size += recordLength;
+    }
+
+    // make the record durable, either on its own or in a group
+    if (Config::getInstance().getAgentFlushOnClose()) {
+        bool okay = _groupCommit? _groupCommit->commit(segment->fd) : fdatasync(segment->fd) == 0;
+        if (!okay) {
+            LOG(ERROR) << "Failed to sync record of chunk " << name << " in segment " << segment->id << ", " << strerror(errno);
+            // the operation fails, so the record must not come back on recovery
+            discardRecord(segment, header, name, aux, location);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SegmentContainer::discardRecord(const std::shared_ptr<Segment> &segment, RecordHeader header, const std::string &name, const std::string &aux, const Location &location) {
+    bool okay = false;
+    {
+        std::lock_guard<std::mutex> wlk(_writeLock);
+        if (segment->size == location.offset + location.recordLength) {
+            // drop the last record of the segment
+            okay = ftruncate(segment->fd, location.offset) == 0;
+            if (okay) {
+                std::unique_lock<std::shared_mutex> lk(_lock);
+                segment->size = location.offset;
+            }
+        } else {
+            // keep the records appended after it, and mark the record as aborted in place
+            header.type = RECORD_ABORTED;
+            header.crc = getRecordCrc(header, name.data(), aux.data());
+            struct iovec iov;
+            iov.iov_base = &header;
+            iov.iov_len = sizeof(RecordHeader);
+            okay = pwritevFully(segment->fd, &iov, 1, location.offset);
+        }
+    }
+
+    okay = okay && fdatasync(segment->fd) == 0;
+    LOG_IF(ERROR, !okay) << "Failed to discard the record of chunk " << name << " at offset " << location.offset << " of segment " << segment->id << ", " << strerror(errno);
+}
+
+bool SegmentContainer::copyRecord(const unsigned char *record, uint32_t length, Location &location) {
+    std::lock_guard<std::mutex> wlk(_writeLock);
+    if (!prepareActiveSegment(length))
+        return false;
+
+    struct iovec iov;
+    iov.iov_base = (void *) record;
+    iov.iov_len = length;
+    if (!pwritevFully(_activeSegment->fd, &iov, 1, _activeSegment->size)) {
+        LOG(ERROR) << "Failed to copy record to segment " << _activeSegment->id << ", " << strerror(errno);
+        return false;
+    }
+
+    location.segment = _activeSegment->id;
+    location.offset = _activeSegment->size;
+
+    std::unique_lock<std::shared_mutex> lk(_lock);
+    _activeSegment->size += length;
+    return true;
+}
+
+void SegmentContainer::addReference(const Location &location) {
+    auto it = _segments.find(location.segment);
+    if (it != _segments.end())
+        it->second->liveBytes += location.recordLength;
+}
+
+void SegmentContainer::removeReference(const Location &location) {
+    auto it = _segments.find(location.segment);
+    if (it != _segments.end())
+        it->second->liveBytes -= std::min((unsigned long int) location.recordLength, it->second->liveBytes);
+}
+
+void SegmentContainer::addTombstone(const std::string &name, const Location &location) {
+    removeTombstone(name);
+    // older records of the chunk are in the segments so far, or copied later by compaction
+    Tombstone &tombstone = _tombstones[name];
+    tombstone.location = location;
+    tombstone.lastSegment = _segments.empty()? location.segment : std::max(location.segment, _segments.rbegin()->first);
+    addReference(location);
+}
+
+void SegmentContainer::removeTombstone(const std::string &name) {
+    auto it = _tombstones.find(name);
+    if (it == _tombstones.end())
+        return;
+    removeReference(it->second.location);
+    _tombstones.erase(it);
+}
+
+void SegmentContainer::applyRecord(uint8_t type, const std::string &name, const std::string &aux, const Location &location) {
+    if (type == RECORD_ABORTED)
+        return;
+
+    // a new version replays after the older records of the chunk, so its deletion is no longer needed
+    if (type != RECORD_DELETE)
+        removeTombstone(name);
+
+    auto current = _index.find(name);
+
+    // drop the current version, or keep it as an old version for revert
+    if (current != _index.end() && type != RECORD_DELETE) {
+        _usage -= current->second.dataLength;
+        if (type == RECORD_PUT && !aux.empty()) {
+            std::map<std::string, Location> &versions = _oldVersions[name];
+            auto old = versions.find(aux);
+            if (old != versions.end())
+                removeReference(old->second);
+            versions[aux] = current->second;
+        } else {
+            removeReference(current->second);
+        }
+    }
+
+    switch (type) {
+    case RECORD_PUT:
+        break;
+
+    case RECORD_DELETE:
+        if (current != _index.end()) {
+            _usage -= current->second.dataLength;
+            removeReference(current->second);
+            _index.erase(current);
+        }
+        addTombstone(name, location);
+        _indexChanged = true;
+        return;
+
+    case RECORD_MOVE: {
+        // remove the source chunk, leaving its old versions
+        auto src = _index.find(aux);
+        if (src != _index.end()) {
+            _usage -= src->second.dataLength;
+            removeReference(src->second);
+            _index.erase(src);
+            addTombstone(aux, location);
+        }
+        break;
+    }
+
+    case RECORD_REVERT: {
+        // remove the old version reverted to
+        auto versions = _oldVersions.find(name);
+        if (versions == _oldVersions.end())
+            break;
+        auto old = versions->second.find(aux);
+        if (old != versions->second.end()) {
+            removeReference(old->second);
+            versions->second.erase(old);
+        }
+        if (versions->second.empty())
+            _oldVersions.erase(versions);
+        break;
+    }
+
+    default:
+        LOG(WARNING) << "Unknown record type " << (int) type << " for chunk " << name;
+        return;
+    }
+
+    // the record holds the new current version
+    _index[name] = location;
+    addReference(location);
+    _usage += location.dataLength;
+    _indexChanged = true;
+}
+
+bool SegmentContainer::findChunk(const std::string &name, Location &location, std::shared_ptr<Segment> &segment) {
+    std::shared_lock<std::shared_mutex> lk(_lock);
+    auto it = _index.find(name);
+    if (it == _index.end())
+        return false;
+    location = it->second;
+    auto sit = _segments.find(location.segment);
+    if (sit == _segments.end())
+        return false;
+    segment = sit->second;
+    return true;
+}
+
+bool SegmentContainer::readChunkData(const std::shared_ptr<Segment> &segment, const Location &location, Chunk &chunk) {
+    chunk.data = (unsigned char *) malloc(std::max(location.dataLength, 1U));
+    if (chunk.data == NULL)
+        return false;
+    off_t offset = location.offset + location.recordLength - location.dataLength;
+    if (!preadFully(segment->fd, chunk.data, location.dataLength, offset)) {
+        LOG(ERROR) << "Failed to read chunk " << chunk.getChunkName() << " from segment " << segment->id << " at offset " << offset << ", " << strerror(errno);
+        free(chunk.data);
+        chunk.data = NULL;
+        chunk.size = 0;
+        return false;
+    }
+    chunk.size = location.dataLength;
+    return true;
+}
+
+bool SegmentContainer::putChunk(Chunk &chunk, bool trustChecksum) {
+    std::string name = chunk.getChunkName();
+    if (name.size() > UINT16_MAX)
+        return false;
+
+    boost::timer::cpu_timer mytimer;
+
+    // compute the checksum of the data written, and verify the checksum if needed, unless the checksum is trusted
+    if (!trustChecksum) {
+        Chunk computed;
+        computed.copyMeta(chunk);
+        computed.data = chunk.data;
+        computed.freeData = false;
+        if (Config::getInstance().verifyChunkChecksum() && !computed.verifyChecksum()) {
+            LOG(ERROR) << "Failed to verify the checksum of chunk " << name << " before write";
+            return false;
+        }
+        computed.computeChecksum();
+        chunk.copyChecksum(computed);
+    }
+
+    std::lock_guard<std::mutex> clk(getChunkLock(name));
+    RwLockGuard ulk(&_updateLock);
+
+    // keep the current version for revert if exists
+    Location location;
+    std::shared_ptr<Segment> segment;
+    if (findChunk(name, location, segment)) {
+        // use the current time as the version of the previous chunk
+        snprintf(chunk.chunkVersion, CHUNK_VERSION_MAX_LEN, "%ld", time(NULL));
+    } else {
+        // no previous version found
+        chunk.chunkVersion[0] = 0;
+    }
+    segment.reset();
+
+    if (!appendRecord(RECORD_PUT, name, chunk.chunkVersion, chunk.data, chunk.size, chunk.checksumType, chunk.checksum, location))
+        return false;
+
+    {
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        applyRecord(RECORD_PUT, name, chunk.chunkVersion, location);
+    }
+
+    double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+    LOG(INFO) << "Put chunk " << name << " to segment " << location.segment << " at offset " << location.offset << " size " << (chunk.size * 1.0 / (1 << 20)) << " MB in " << elapsed << "s, " << (chunk.size * 1.0 / (1 << 20)) / elapsed << " MB/s";
+
+    return true;
+}
+
+bool SegmentContainer::getChunk(Chunk &chunk, bool skipVerification) {
+    bool success = getChunkInternal(chunk, skipVerification);
+    LOG_IF(INFO, success) << "Get chunk " << chunk.getChunkName() << " from segment container id = " << _id;
+    return success;
+}
+
+bool SegmentContainer::getChunkInternal(Chunk &chunk, bool skipVerification) {
+    Location location;
+    std::shared_ptr<Segment> segment;
+    if (!findChunk(chunk.getChunkName(), location, segment) || !readChunkData(segment, location, chunk)) {
+        DLOG(WARNING) << "Failed to read chunk " << chunk.getChunkName();
+        return false;
+    }
+
+    // verify checksum if needed
+    return skipVerification || !Config::getInstance().verifyChunkChecksum() || chunk.verifyChecksum();
+}
+
+bool SegmentContainer::deleteChunk(const Chunk &chunk) {
+    std::string name = chunk.getChunkName();
+
+    std::lock_guard<std::mutex> clk(getChunkLock(name));
+    RwLockGuard ulk(&_updateLock);
+
+    Location location;
+    std::shared_ptr<Segment> segment;
+    if (!findChunk(name, location, segment))
+        return true;
+    segment.reset();
+
+    if (!appendRecord(RECORD_DELETE, name, "", NULL, 0, 0, NULL, location))
+        return false;
+
+    {
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        applyRecord(RECORD_DELETE, name, "", location);
+    }
+    LOG(INFO) << "Delete chunk " << name << " in segment container id = " << _id;
+
+    return true;
+}
+
+bool SegmentContainer::copyChunk(const Chunk &src, Chunk &dst) {
+    std::string dname = dst.getChunkName();
+
+    // read the source chunk for the data and checksum of the copy, and verify the checksum if needed
+    Chunk readChunk;
+    readChunk.copyMeta(dst);
+    readChunk.setId(src.namespaceId, src.fuuid, src.chunkId);
+    readChunk.fileVersion = src.fileVersion;
+    if (!getChunkInternal(readChunk) && Config::getInstance().verifyChunkChecksum())
+        return false;
+    if (readChunk.data == NULL || readChunk.size != src.size)
+        return false;
+    readChunk.computeChecksum();
+
+    std::lock_guard<std::mutex> clk(getChunkLock(dname));
+    RwLockGuard ulk(&_updateLock);
+
+    // the copy replaces any chunk at the destination, as in FsContainer
+    Location location;
+    if (!appendRecord(RECORD_PUT, dname, "", readChunk.data, readChunk.size, readChunk.checksumType, readChunk.checksum, location))
+        return false;
+
+    {
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        applyRecord(RECORD_PUT, dname, "", location);
+    }
+
+    // mark the size and checksum of the copied chunk
+    dst.size = readChunk.size;
+    dst.copyChecksum(readChunk);
+    LOG(INFO) << "Copy chunk " << src.getChunkName() << " to " << dname << " in segment container id = " << _id;
+
+    return true;
+}
+
+bool SegmentContainer::moveChunk(const Chunk &src, Chunk &dst) {
+    std::string sname = src.getChunkName(), dname = dst.getChunkName();
+    if (dname.size() > UINT16_MAX)
+        return false;
+
+    // lock both chunks in a fixed order
+    std::mutex *slock = &getChunkLock(sname), *dlock = &getChunkLock(dname);
+    std::unique_lock<std::mutex> clk1(*std::min(slock, dlock));
+    std::unique_lock<std::mutex> clk2;
+    if (slock != dlock)
+        clk2 = std::unique_lock<std::mutex>(*std::max(slock, dlock));
+
+    // read the chunk for checksum computation, and verify the checksum if needed
+    Chunk readChunk;
+    readChunk.copyMeta(dst);
+    readChunk.setId(src.namespaceId, src.fuuid, src.chunkId);
+    readChunk.fileVersion = src.fileVersion;
+    if (!getChunkInternal(readChunk) && (readChunk.data == NULL || Config::getInstance().verifyChunkChecksum()))
+        return false;
+    readChunk.computeChecksum();
+
+    // the chunk data goes with the move record, so the move is replayed from the record alone after the segment
+    // holding the source chunk is compacted
+    RwLockGuard ulk(&_updateLock);
+    Location location;
+    if (!appendRecord(RECORD_MOVE, dname, sname, readChunk.data, readChunk.size, readChunk.checksumType, readChunk.checksum, location))
+        return false;
+
+    {
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        applyRecord(RECORD_MOVE, dname, sname, location);
+    }
+
+    // mark the size and checksum of the moved chunk
+    dst.size = readChunk.size;
+    dst.copyChecksum(readChunk);
+    LOG(INFO) << "Move chunk " << sname << " to " << dname << " in segment container id = " << _id;
+
+    return true;
+}
+
+bool SegmentContainer::hasChunk(const Chunk &chunk) {
+    Chunk readChunk;
+    readChunk.copyMeta(chunk);
+    bool checksumPassed = !Config::getInstance().verifyChunkChecksum() || getChunk(readChunk);
+
+    Location location;
+    std::shared_ptr<Segment> segment;
+    return findChunk(chunk.getChunkName(), location, segment) && chunk.size == (int) location.dataLength && checksumPassed;
+}
+
+bool SegmentContainer::revertChunk(const Chunk &chunk) {
+    std::string name = chunk.getChunkName();
+    std::string version = chunk.chunkVersion;
+
+    std::lock_guard<std::mutex> clk(getChunkLock(name));
+
+    // find the old version
+    Location old;
+    std::shared_ptr<Segment> segment;
+    {
+        std::shared_lock<std::shared_mutex> lk(_lock);
+        auto versions = _oldVersions.find(name);
+        if (versions != _oldVersions.end() && versions->second.count(version) > 0) {
+            old = versions->second.at(version);
+            auto it = _segments.find(old.segment);
+            if (it != _segments.end())
+                segment = it->second;
+        }
+    }
+    Chunk readChunk;
+    readChunk.copyMeta(chunk);
+    if (!segment || !readChunkData(segment, old, readChunk)) {
+        LOG(ERROR) << "Failed to revert chunk " << name << " back to version " << version << ", version not found";
+        return false;
+    }
+    segment.reset();
+
+    // write the old version as the current one, so the revert is replayed from the record alone
+    RwLockGuard ulk(&_updateLock);
+    Location location;
+    if (!appendRecord(RECORD_REVERT, name, version, readChunk.data, readChunk.size, old.checksumType, old.checksum, location))
+        return false;
+
+    {
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        applyRecord(RECORD_REVERT, name, version, location);
+    }
+
+    return true;
+}
+
+bool SegmentContainer::verifyChunk(const Chunk &chunk) {
+    Chunk readChunk;
+    readChunk.copyMeta(chunk);
+    // either verified when reading chunk data back (if checksum verification is enabled), or manual verification
+    bool matched = getChunkInternal(readChunk) && (Config::getInstance().verifyChunkChecksum() || readChunk.verifyChecksum());
+    LOG_IF(WARNING, !matched) << "Check chunk " << chunk.getChunkName() << " by reading data and computing checksum, result = " << matched;
+
+    return matched;
+}
+
+void SegmentContainer::updateUsage() {
+    // the usage is updated on every change to the index
+}
+
+void SegmentContainer::getSegmentStats(unsigned long int &numSegments, unsigned long int &totalSize, unsigned long int &liveSize) {
+    std::shared_lock<std::shared_mutex> lk(_lock);
+    numSegments = _segments.size();
+    totalSize = 0;
+    liveSize = 0;
+    for (auto &s : _segments) {
+        totalSize += s.second->size;
+        liveSize += s.second->liveBytes;
+    }
+}
+
+bool SegmentContainer::checkpoint() {
+    std::lock_guard<std::mutex> clk(_checkpointLock);
+
+    std::string fpath = getSegmentPath(-1);
+    std::string tfpath = fpath + ".tmp";
+
+    FILE *f = fopen(tfpath.c_str(), "w");
+    if (f == NULL) {
+        LOG(ERROR) << "Failed to open checkpoint file " << tfpath << ", " << strerror(errno);
+        return false;
+    }
+
+    bool okay = true;
+    uint32_t crc = 0;
+    auto put = [&](const void *buf, size_t length) {
+        if (!okay || length == 0)
+            return;
+        okay = fwrite(buf, 1, length, f) == length;
+        crc = crc32_iscsi((unsigned char *) buf, length, crc);
+    };
+
+    boost::timer::cpu_timer mytimer;
+    size_t numChunks = 0;
+    {
+        // wait for the updates in progress, and hold back new ones, so the index covers all records up to the sequence number
+        RwLockGuard ulk(&_updateLock, /* exclusive */ true);
+        std::shared_lock<std::shared_mutex> lk(_lock);
+
+        if (!_indexChanged) {
+            fclose(f);
+            unlink(tfpath.c_str());
+            return true;
+        }
+
+        uint32_t magic = SEGMENT_CHECKPOINT_MAGIC, version = SEGMENT_CHECKPOINT_VERSION;
+        uint64_t seq = _seq;
+        put(&magic, sizeof(magic));
+        put(&version, sizeof(version));
+        put(&seq, sizeof(seq));
+
+        // size of segments covered
+        uint32_t numSegments = _segments.size();
+        put(&numSegments, sizeof(numSegments));
+        for (auto &s : _segments) {
+            uint64_t size = s.second->size;
+            put(&s.first, sizeof(s.first));
+            put(&size, sizeof(size));
+        }
+
+        // current versions
+        uint64_t count = _index.size();
+        put(&count, sizeof(count));
+        for (auto &c : _index) {
+            uint16_t length = c.first.size();
+            put(&length, sizeof(length));
+            put(c.first.data(), length);
+            put(&c.second, sizeof(Location));
+        }
+
+        // old versions
+        count = 0;
+        for (auto &c : _oldVersions)
+            count += c.second.size();
+        put(&count, sizeof(count));
+        for (auto &c : _oldVersions) {
+            for (auto &v : c.second) {
+                uint16_t length = c.first.size();
+                put(&length, sizeof(length));
+                put(c.first.data(), length);
+                length = v.first.size();
+                put(&length, sizeof(length));
+                put(v.first.data(), length);
+                put(&v.second, sizeof(Location));
+            }
+        }
+
+        // deletions
+        count = _tombstones.size();
+        put(&count, sizeof(count));
+        for (auto &c : _tombstones) {
+            uint16_t length = c.first.size();
+            put(&length, sizeof(length));
+            put(c.first.data(), length);
+            put(&c.second.location, sizeof(Location));
+        }
+        put(&crc, sizeof(crc));
+
+        if (okay) {
+            _checkpointSeq = seq;
+            _indexChanged = false;
+        }
+        numChunks = _index.size();
+    }
+
+    // make the checkpoint durable before replacing the previous one
+    okay = okay && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    okay = fclose(f) == 0 && okay;
+    okay = okay && rename(tfpath.c_str(), fpath.c_str()) == 0;
+    if (okay) {
+        int dirFd = open(_dir, O_RDONLY | O_DIRECTORY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    } else {
+        LOG(ERROR) << "Failed to write checkpoint file " << fpath << ", " << strerror(errno);
+        unlink(tfpath.c_str());
+        _indexChanged = true;
+        return false;
+    }
+
+    double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+    LOG(INFO) << "Checkpoint " << numChunks << " chunks of segment container id = " << _id << " in " << elapsed << "s";
+
+    return true;
+}
+
+bool SegmentContainer::loadCheckpoint(std::map<uint32_t, unsigned long int> &sizes) {
+    std::string fpath = getSegmentPath(-1);
+    FILE *f = fopen(fpath.c_str(), "r");
+    if (f == NULL) {
+        LOG_IF(WARNING, errno != ENOENT) << "Failed to open checkpoint file " << fpath << ", " << strerror(errno);
+        return false;
+    }
+
+    bool okay = true;
+    uint32_t crc = 0;
+    auto get = [&](void *buf, size_t length) {
+        if (!okay || length == 0)
+            return;
+        okay = fread(buf, 1, length, f) == length;
+        if (okay)
+            crc = crc32_iscsi((unsigned char *) buf, length, crc);
+    };
+    auto getString = [&](std::string &str) {
+        uint16_t length = 0;
+        get(&length, sizeof(length));
+        str.resize(length);
+        get(&str[0], length);
+    };
+
+    uint32_t magic = 0, version = 0;
+    uint64_t seq = 0;
+    get(&magic, sizeof(magic));
+    get(&version, sizeof(version));
+    get(&seq, sizeof(seq));
+    okay = okay && magic == SEGMENT_CHECKPOINT_MAGIC && version == SEGMENT_CHECKPOINT_VERSION;
+
+    uint32_t numSegments = 0;
+    get(&numSegments, sizeof(numSegments));
+    for (uint32_t i = 0; i < numSegments && okay; i++) {
+        uint32_t id = 0;
+        uint64_t size = 0;
+        get(&id, sizeof(id));
+        get(&size, sizeof(size));
+        sizes[id] = size;
+    }
+
+    std::string name, aux;
+    Location location;
+    uint64_t count = 0;
+    get(&count, sizeof(count));
+    if (okay)
+        _index.reserve(count);
+    for (uint64_t i = 0; i < count && okay; i++) {
+        getString(name);
+        get(&location, sizeof(Location));
+        _index[name] = location;
+    }
+    get(&count, sizeof(count));
+    for (uint64_t i = 0; i < count && okay; i++) {
+        getString(name);
+        getString(aux);
+        get(&location, sizeof(Location));
+        _oldVersions[name][aux] = location;
+    }
+    get(&count, sizeof(count));
+    for (uint64_t i = 0; i < count && okay; i++) {
+        getString(name);
+        get(&location, sizeof(Location));
+        _tombstones[name].location = location;
+    }
+
+    uint32_t expectedCrc = crc, storedCrc = 0;
+    okay = okay && fread(&storedCrc, 1, sizeof(storedCrc), f) == sizeof(storedCrc) && storedCrc == expectedCrc;
+    fclose(f);
+
+    if (!okay) {
+        LOG(WARNING) << "Checkpoint file " << fpath << " is corrupted";
+        _index.clear();
+        _oldVersions.clear();
+        _tombstones.clear();
+        sizes.clear();
+        return false;
+    }
+
+    _checkpointSeq = seq;
+    return true;
+}
+
+bool SegmentContainer::scanSegment(Segment &segment, unsigned long int offset, std::vector<ScannedRecord> &records) {
+    std::vector<unsigned char> buf;
+    unsigned long int bufStart = 0;
+    size_t bufLength = 0;
+
+    // get a range of the segment from the read buffer, refilling it if needed
+    auto getRange = [&](unsigned long int start, size_t length) -> const unsigned char * {
+        if (start >= bufStart && start + length <= bufStart + bufLength)
+            return buf.data() + (start - bufStart);
+        buf.resize(std::max(length, (size_t) SEGMENT_SCAN_BUFFER_SIZE));
+        bufStart = start;
+        preadFully(segment.fd, buf.data(), std::min((unsigned long int) buf.size(), segment.size - start), start, &bufLength);
+        return length <= bufLength? buf.data() : NULL;
+    };
+
+    while (offset + sizeof(RecordHeader) <= segment.size) {
+        const unsigned char *ptr = getRange(offset, sizeof(RecordHeader));
+        if (ptr == NULL)
+            break;
+        RecordHeader header;
+        memcpy(&header, ptr, sizeof(RecordHeader));
+        unsigned long int recordLength = sizeof(RecordHeader) + header.nameLength + header.auxLength + (unsigned long int) header.dataLength;
+        if (header.magic != SEGMENT_RECORD_MAGIC || offset + recordLength > segment.size)
+            break;
+        ptr = getRange(offset + sizeof(RecordHeader), header.nameLength + header.auxLength);
+        if (ptr == NULL || getRecordCrc(header, (const char *) ptr, (const char *) ptr + header.nameLength) != header.crc)
+            break;
+
+        ScannedRecord record;
+        record.seq = header.seq;
+        record.type = header.type;
+        record.name.assign((const char *) ptr, header.nameLength);
+        record.aux.assign((const char *) ptr + header.nameLength, header.auxLength);
+        record.location.segment = segment.id;
+        record.location.offset = offset;
+        record.location.recordLength = recordLength;
+        record.location.dataLength = header.dataLength;
+        record.location.checksumType = header.checksumType;
+        memcpy(record.location.checksum, header.checksum, CHUNK_CHECKSUM_MAX_LEN);
+        records.push_back(record);
+
+        offset += recordLength;
+    }
+
+    // drop the incomplete record at the end, e.g., written partially before a crash
+    if (offset < segment.size) {
+        LOG(WARNING) << "Truncate segment " << segment.id << " of container id = " << _id << " from " << segment.size << " to " << offset << " bytes after the last complete record";
+        if (ftruncate(segment.fd, offset) != 0) {
+            LOG(ERROR) << "Failed to truncate segment " << segment.id << ", " << strerror(errno);
+            return false;
+        }
+        segment.size = offset;
+    }
+
+    return true;
+}
+
+void SegmentContainer::recover() {
+    // open all segments
+    std::vector<uint32_t> ids;
+    try {
+        for (boost::filesystem::directory_entry &f : boost::filesystem::directory_iterator(boost::filesystem::path(_dir))) {
+            unsigned int id = 0;
+            char c = 0;
+            if (boost::filesystem::is_regular_file(f.path()) && sscanf(f.path().filename().c_str(), "seg-%8u%c", &id, &c) == 1)
+                ids.push_back(id);
+        }
+    } catch (std::exception &e) {
+        LOG(ERROR) << "Failed to list directory " << _dir << ", " << e.what();
+    }
+    std::sort(ids.begin(), ids.end());
+    for (uint32_t id : ids)
+        openSegment(id, /* create */ false);
+
+    // load the index from checkpoint, if the checkpoint refers to existing records only
+    std::map<uint32_t, unsigned long int> sizes;
+    bool loaded = loadCheckpoint(sizes);
+    auto isValid = [this](const Location &location) {
+        auto it = _segments.find(location.segment);
+        return it != _segments.end() && location.offset + location.recordLength <= it->second->size;
+    };
+    for (auto it = _index.begin(); loaded && it != _index.end(); it++)
+        loaded = isValid(it->second);
+    for (auto it = _oldVersions.begin(); loaded && it != _oldVersions.end(); it++)
+        for (auto vit = it->second.begin(); loaded && vit != it->second.end(); vit++)
+            loaded = isValid(vit->second);
+    for (auto it = _tombstones.begin(); loaded && it != _tombstones.end(); it++)
+        loaded = isValid(it->second.location);
+    if (!loaded) {
+        LOG_IF(WARNING, !_segments.empty()) << "Rebuild the index of segment container id = " << _id << " from " << _segments.size() << " segments";
+        _index.clear();
+        _oldVersions.clear();
+        _tombstones.clear();
+        _checkpointSeq = 0;
+        sizes.clear();
+    }
+
+    // replay the records appended after the checkpoint in order
+    std::vector<ScannedRecord> records;
+    for (auto &s : _segments) {
+        auto size = sizes.find(s.first);
+        unsigned long int offset = size != sizes.end()? std::min(size->second, s.second->size) : 0;
+        scanSegment(*s.second, offset, records);
+    }
+    std::sort(records.begin(), records.end(), [](const ScannedRecord &a, const ScannedRecord &b) { return a.seq < b.seq; });
+    _seq = _checkpointSeq;
+    size_t numReplayed = 0;
+    for (const ScannedRecord &record : records) {
+        // skip records covered by the checkpoint, and the copies of a record by compaction
+        if (record.seq <= _seq)
+            continue;
+        applyRecord(record.type, record.name, record.aux, record.location);
+        _seq = record.seq;
+        numReplayed++;
+    }
+    _indexChanged = !loaded || numReplayed > 0;
+
+    // count the live records and usage from the index
+    _usage = 0;
+    for (auto &s : _segments)
+        s.second->liveBytes = 0;
+    for (auto &c : _index) {
+        addReference(c.second);
+        _usage += c.second.dataLength;
+    }
+    for (auto &c : _oldVersions)
+        for (auto &v : c.second)
+            addReference(v.second);
+    // any segment may hold older records of the deleted chunks copied by compaction before the restart
+    uint32_t lastSegment = _segments.empty()? 0 : _segments.rbegin()->first;
+    for (auto &c : _tombstones) {
+        c.second.lastSegment = lastSegment;
+        addReference(c.second.location);
+    }
+
+    // continue appending to the last segment
+    if (!_segments.empty())
+        _activeSegment = _segments.rbegin()->second;
+
+    LOG_IF(INFO, numReplayed > 0) << "Replayed " << numReplayed << " records for segment container id = " << _id;
+}
+
+void SegmentContainer::cleanUpOldVersions() {
+    RwLockGuard ulk(&_updateLock);
+    std::unique_lock<std::shared_mutex> lk(_lock);
+    time_t now = time(NULL);
+    for (auto it = _oldVersions.begin(); it != _oldVersions.end(); ) {
+        for (auto vit = it->second.begin(); vit != it->second.end(); ) {
+            // skip old versions that are yet expired (10mins)
+            if (atol(vit->first.c_str()) + SEGMENT_OLD_VERSION_TTL > now) {
+                vit++;
+                continue;
+            }
+            LOG(INFO) << "Clean chunk " << it->first << " of version " << vit->first << " of size " << vit->second.dataLength;
+            removeReference(vit->second);
+            vit = it->second.erase(vit);
+            _indexChanged = true;
+        }
+        if (it->second.empty())
+            it = _oldVersions.erase(it);
+        else
+            it++;
+    }
+}
+
+int SegmentContainer::compact() {
+    if (_options.compactionThreshold <= 0)
+        return 0;
+
+    std::lock_guard<std::mutex> clk(_compactionLock);
+
+    // pick the full segments with little live data
+    std::vector<std::shared_ptr<Segment> > victims;
+    {
+        std::lock_guard<std::mutex> wlk(_writeLock);
+        std::shared_lock<std::shared_mutex> lk(_lock);
+        for (auto &s : _segments) {
+            if (s.second == _activeSegment)
+                continue;
+            if (s.second->liveBytes * 100 < s.second->size * _options.compactionThreshold || s.second->size == 0)
+                victims.push_back(s.second);
+        }
+    }
+    if (victims.empty())
+        return 0;
+
+    boost::timer::cpu_timer mytimer;
+
+    // copy the live records out
+    std::vector<std::shared_ptr<Segment> > removable;
+    for (auto &victim : victims) {
+        if (compactSegment(victim))
+            removable.push_back(victim);
+    }
+
+    // make the copies durable, and persist their new locations before removing the segments
+    {
+        std::lock_guard<std::mutex> wlk(_writeLock);
+        if (_activeSegment && fdatasync(_activeSegment->fd) != 0)
+            LOG(ERROR) << "Failed to sync segment " << _activeSegment->id << ", " << strerror(errno);
+    }
+    if (!checkpoint())
+        return 0;
+
+    int numRemoved = 0;
+    unsigned long int reclaimed = 0;
+    for (auto &victim : removable) {
+        {
+            std::unique_lock<std::shared_mutex> lk(_lock);
+            // a concurrent revert may bring back an old version in the segment
+            if (victim->liveBytes > 0)
+                continue;
+            _segments.erase(victim->id);
+        }
+        // readers holding the segment can still read from the unlinked file until they release it
+        unlink(getSegmentPath(victim->id).c_str());
+        reclaimed += victim->size;
+        numRemoved++;
+    }
+
+    double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+    LOG(INFO) << "Compacted " << numRemoved << " segments of container id = " << _id << ", reclaimed " << (reclaimed * 1.0 / (1 << 20)) << " MB in " << elapsed << "s";
+
+    return numRemoved;
+}
+
+bool SegmentContainer::compactSegment(const std::shared_ptr<Segment> &segment) {
+    // a chunk version, or a chunk deletion, held by a record
+    struct Reference {
+        std::string name;
+        std::string version;           // version of an old version, empty for the current version
+        bool deletion;
+    };
+    // get the location referred to, with the index lock held
+    auto getLocation = [this](const Reference &ref) -> Location * {
+        if (ref.deletion) {
+            auto it = _tombstones.find(ref.name);
+            return it != _tombstones.end()? &it->second.location : NULL;
+        }
+        if (ref.version.empty()) {
+            auto it = _index.find(ref.name);
+            return it != _index.end()? &it->second : NULL;
+        }
+        auto it = _oldVersions.find(ref.name);
+        if (it == _oldVersions.end())
+            return NULL;
+        auto vit = it->second.find(ref.version);
+        return vit != it->second.end()? &vit->second : NULL;
+    };
+
+    // find the live chunk versions and deletions in the segment, by record offset
+    std::unordered_map<uint64_t, std::vector<Reference> > references;
+    {
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        for (auto &c : _index)
+            if (c.second.segment == segment->id)
+                references[c.second.offset].push_back({c.first, std::string(), false});
+        for (auto &c : _oldVersions)
+            for (auto &v : c.second)
+                if (v.second.segment == segment->id)
+                    references[v.second.offset].push_back({c.first, v.first, false});
+        for (auto it = _tombstones.begin(); it != _tombstones.end(); ) {
+            if (it->second.location.segment != segment->id) {
+                it++;
+                continue;
+            }
+            // keep the deletion while an old version may still be copied, or another segment may hold an older record
+            bool needed = _oldVersions.count(it->first) > 0;
+            for (auto sit = _segments.begin(); !needed && sit != _segments.end() && sit->first <= it->second.lastSegment; sit++)
+                needed = sit->first != segment->id;
+            if (needed) {
+                references[it->second.location.offset].push_back({it->first, std::string(), true});
+                it++;
+            } else {
+                removeReference(it->second.location);
+                it = _tombstones.erase(it);
+                _indexChanged = true;
+            }
+        }
+    }
+
+    // copy each live record as is, with its sequence number, so the copy is skipped on replay
+    std::vector<unsigned char> record;
+    for (auto &r : references) {
+        Location live;
+        bool found = false;
+        {
+            std::shared_lock<std::shared_mutex> lk(_lock);
+            for (auto &ref : r.second) {
+                Location *location = getLocation(ref);
+                if (location != NULL && location->segment == segment->id && location->offset == r.first) {
+                    live = *location;
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found)
+            continue;
+
+        record.resize(live.recordLength);
+        if (!preadFully(segment->fd, record.data(), live.recordLength, live.offset)) {
+            LOG(ERROR) << "Failed to read record at offset " << live.offset << " of segment " << segment->id << " for compaction, " << strerror(errno);
+            return false;
+        }
+
+        RwLockGuard ulk(&_updateLock);
+        Location copied = live;
+        if (!copyRecord(record.data(), live.recordLength, copied))
+            return false;
+
+        // point the chunk versions and deletions still referring to the record to the copy
+        std::unique_lock<std::shared_mutex> lk(_lock);
+        for (auto &ref : r.second) {
+            // the copy of a version of a deleted chunk may go after the deletion
+            auto tombstone = ref.deletion? _tombstones.end() : _tombstones.find(ref.name);
+            if (tombstone != _tombstones.end())
+                tombstone->second.lastSegment = std::max(tombstone->second.lastSegment, copied.segment);
+
+            Location *location = getLocation(ref);
+            if (location == NULL || location->segment != segment->id || location->offset != r.first)
+                continue;
+            removeReference(*location);
+            location->segment = copied.segment;
+            location->offset = copied.offset;
+            addReference(*location);
+        }
+        _indexChanged = true;
+    }
+
+    std::shared_lock<std::shared_mutex> lk(_lock);
+    return segment->liveBytes == 0;
+}
+
+void *SegmentContainer::runMaintenance(void *arg) {
+    SegmentContainer *container = (SegmentContainer *) arg;
+    struct timespec nextSchTime;
+
+    const time_t timeout = 60; // timeout for checking and cleaning (1min)
+
+    pthread_mutex_lock(&container->_maintenance.lock);
+    while (container->_running) {
+        clock_gettime(CLOCK_REALTIME, &nextSchTime);
+        nextSchTime.tv_sec += timeout;
+        // wait for signal or timeout before next round
+        pthread_cond_timedwait(&container->_maintenance.cond, &container->_maintenance.lock, &nextSchTime);
+        if (!container->_running)
+            break;
+        container->cleanUpOldVersions();
+        container->compact();
+        container->checkpoint();
+    }
+    pthread_mutex_unlock(&container->_maintenance.lock);
+
+    LOG(WARNING) << "Segment container maintenance thread exits now";
+
+    return 0;
+}
@@ -0,0 +1,416 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __SEGMENT_CONTAINER_HH__
+#define __SEGMENT_CONTAINER_HH__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <linux/limits.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "container.hh"
+#include "group_commit.hh"
+#include "../../ds/chunk.hh"
+
+/// default max. size of a segment file
+#define SEGMENT_DEFAULT_SIZE                 (256UL << 20)
+/// default percentage of live data in a full segment below which the segment is compacted
+#define SEGMENT_DEFAULT_COMPACTION_THRESHOLD (50)
+/// number of locks for serializing the operations on the same chunk
+#define SEGMENT_NUM_CHUNK_LOCKS              (64)
+
+/**
+ * Options of segment containers
+ **/
+struct SegmentOptions {
+    unsigned long int segmentSize;     /**< max. size of a segment file */
+    int compactionThreshold;           /**< percentage of live data in a full segment below which the segment is compacted, 0 to disable compaction */
+    bool groupCommit;                  /**< whether to sync the writes in groups */
+    unsigned int groupCommitWindow;    /**< max. time (in microseconds) to wait for more writes to join a group */
+    unsigned int groupCommitBatchSize; /**< max. number of writes in a group */
+
+    SegmentOptions() {
+        segmentSize = SEGMENT_DEFAULT_SIZE;
+        compactionThreshold = SEGMENT_DEFAULT_COMPACTION_THRESHOLD;
+        groupCommit = false;
+        groupCommitWindow = GROUP_COMMIT_DEFAULT_WINDOW;
+        groupCommitBatchSize = GROUP_COMMIT_DEFAULT_BATCH_SIZE;
+    }
+};
+
+/**
+ * Container on local file system that packs chunks into large append-only segment files
+ *
+ * Each put, delete, move and revert appends a record to the active segment, so there is no file per chunk. Records
+ * of moves and reverts carry the chunk data, so each chunk version is held by the record that created it. An
+ * in-memory index maps each chunk name to the location (segment, offset, length) and checksum of its current
+ * version, and of its old versions kept for revert, which expire after 10 minutes as in FsContainer.
+ *
+ * The index is persisted as a checkpoint file in the background and when the container is closed. On start, the
+ * checkpoint is loaded and the records appended after it are replayed in order of their sequence numbers. If the
+ * checkpoint is missing or corrupted, the index is rebuilt from all records in the segments. A record that fails to
+ * be made durable is truncated, or marked as aborted if other records follow, so a failed operation is not replayed.
+ *
+ * Full segments with little live data left are compacted in the background, by copying their live records as they
+ * are, with their sequence numbers, to the active segment, and removing the segments after the next checkpoint. The
+ * record deleting a chunk stays live until no other segment may hold an older record of the chunk, so the deletion
+ * is replayed after any such record when the index is rebuilt.
+ **/
+class SegmentContainer : public Container {
+public:
+    SegmentContainer(int id, const char *dir, unsigned long int capacity);
+    /**
+     * Constructor with the options specified instead of taken from the agent config
+     *
+     * @param[in] options          segment options
+     **/
+    SegmentContainer(int id, const char *dir, unsigned long int capacity, const SegmentOptions &options);
+    ~SegmentContainer();
+
+    /**
+     * See Container::putChunk()
+     **/
+    bool putChunk(Chunk &chunk, bool trustChecksum = false);
+
+    /**
+     * See Container::getChunk()
+     **/
+    bool getChunk(Chunk &chunk, bool skipVerification = false);
+
+    /**
+     * See Container::deleteChunk()
+     **/
+    bool deleteChunk(const Chunk &chunk);
+
+    /**
+     * See Container::copyChunk()
+     **/
+    bool copyChunk(const Chunk &src, Chunk &dst);
+
+    /**
+     * See Container::moveChunk()
+     **/
+    bool moveChunk(const Chunk &src, Chunk &dst);
+
+    /**
+     * See Container::hasChunk()
+     **/
+    bool hasChunk(const Chunk &chunk);
+
+    /**
+     * See Container::revertChunk()
+     **/
+    bool revertChunk(const Chunk &chunk);
+
+    /**
+     * See Container::verifyChunk()
+     **/
+    bool verifyChunk(const Chunk &chunk);
+
+    /**
+     * See Container::updateUsage()
+     *
+     * The usage is kept up to date by the index, so this only reports the size of current chunk versions
+     **/
+    void updateUsage();
+
+    /**
+     * Compact the full segments with live data below the threshold
+     *
+     * @return number of segments removed
+     **/
+    int compact();
+
+    /**
+     * Persist the index to the checkpoint file
+     *
+     * @return whether the checkpoint is written
+     **/
+    bool checkpoint();
+
+    /**
+     * Get the number of segments and their total size
+     *
+     * @param[out] numSegments     number of segments
+     * @param[out] totalSize       total size of segments in bytes
+     * @param[out] liveSize        total size of live records in bytes
+     **/
+    void getSegmentStats(unsigned long int &numSegments, unsigned long int &totalSize, unsigned long int &liveSize);
+
+private:
+    /**
+     * Type of records in segments
+     **/
+    enum RecordType {
+        RECORD_PUT = 1,                /**< chunk data; aux is the version of the replaced chunk kept for revert, or empty if discarded */
+        RECORD_DELETE,                 /**< chunk deletion */
+        RECORD_MOVE,                   /**< chunk data moved from another chunk; aux is the name of the source chunk */
+        RECORD_REVERT,                 /**< chunk data of an old version; aux is the version reverted to */
+        RECORD_ABORTED                 /**< record of an operation that failed to be made durable, skipped on replay */
+    };
+
+    /**
+     * Header of records in segments, followed by the chunk name, the aux string and the chunk data
+     **/
+    struct RecordHeader {
+        uint32_t magic;                /**< SEGMENT_RECORD_MAGIC */
+        uint8_t type;                  /**< record type, see RecordType */
+        uint8_t checksumType;          /**< chunk checksum type */
+        uint16_t nameLength;           /**< length of chunk name */
+        uint16_t auxLength;            /**< length of aux string */
+        uint16_t reserved;
+        uint32_t dataLength;           /**< length of chunk data */
+        uint64_t seq;                  /**< sequence number of the operation */
+        unsigned char checksum[CHUNK_CHECKSUM_MAX_LEN]; /**< chunk checksum */
+        uint32_t crc;                  /**< CRC32C of the header (with this field zeroed), chunk name and aux string */
+        uint32_t padding;
+    };
+
+    /**
+     * Location and checksum of a chunk version
+     **/
+    struct Location {
+        uint64_t offset;               /**< offset of the record in the segment */
+        uint32_t segment;              /**< segment id */
+        uint32_t recordLength;         /**< length of the whole record */
+        uint32_t dataLength;           /**< length of chunk data, at the end of the record */
+        uint8_t checksumType;          /**< chunk checksum type */
+        unsigned char checksum[CHUNK_CHECKSUM_MAX_LEN]; /**< chunk checksum */
+    };
+
+    /**
+     * Deletion of a chunk
+     **/
+    struct Tombstone {
+        Location location;             /**< location of the record deleting the chunk */
+        uint32_t lastSegment;          /**< last segment that may hold an older record of the chunk */
+    };
+
+    /**
+     * A segment file
+     **/
+    struct Segment {
+        uint32_t id;                   /**< segment id */
+        int fd;                        /**< file descriptor */
+        unsigned long int size;        /**< size of records written */
+        unsigned long int liveBytes;   /**< size of records referenced by the index */
+
+        ~Segment();
+    };
+
+    /**
+     * A record found when scanning segments
+     **/
+    struct ScannedRecord {
+        uint64_t seq;                  /**< sequence number */
+        uint8_t type;                  /**< record type */
+        std::string name;              /**< chunk name */
+        std::string aux;               /**< aux string */
+        Location location;             /**< location of the record */
+    };
+
+    char _dir[PATH_MAX];               /**< container folder path */
+    SegmentOptions _options;           /**< segment options */
+    GroupCommit *_groupCommit;         /**< group commit of synced writes, NULL to sync each write on its own */
+
+    std::shared_mutex _lock;           /**< lock on the index and segments */
+    std::unordered_map<std::string, Location> _index;                          /**< current version of chunks */
+    std::map<std::string, std::map<std::string, Location> > _oldVersions;       /**< old versions of chunks, by chunk name and version */
+    std::unordered_map<std::string, Tombstone> _tombstones;                    /**< deletions of chunks kept live, by chunk name */
+    std::map<uint32_t, std::shared_ptr<Segment> > _segments;                   /**< segments by id */
+    uint64_t _checkpointSeq;           /**< sequence number covered by the last checkpoint */
+    std::atomic<bool> _indexChanged;   /**< whether the index changed since the last checkpoint */
+
+    std::mutex _writeLock;             /**< lock on appending records, in the order of offsets */
+    std::shared_ptr<Segment> _activeSegment; /**< segment to append records to */
+    uint64_t _seq;                     /**< sequence number of the last record */
+
+    pthread_rwlock_t _updateLock;      /**< held shared by updates from append to index update, and exclusively by checkpoints (preferred) */
+    std::mutex _checkpointLock;        /**< lock on writing checkpoints */
+    std::mutex _compactionLock;        /**< lock on compaction */
+    std::mutex _chunkLocks[SEGMENT_NUM_CHUNK_LOCKS]; /**< locks serializing the operations on the same chunk */
+
+    struct {
+        pthread_t th;                  /**< background compaction thread */
+        pthread_cond_t cond;
+        pthread_mutex_t lock;
+    } _maintenance;
+    bool _running;                     /**< whether the container is "running" */
+
+    /**
+     * Set up the container
+     **/
+    void init(const char *dir, const SegmentOptions &options);
+
+    /**
+     * Get the lock of a chunk
+     *
+     * @param[in] name             chunk name
+     *
+     * @return the lock
+     **/
+    std::mutex &getChunkLock(const std::string &name);
+
+    /**
+     * Get the path of a segment file, or of the checkpoint file if id is -1
+     **/
+    std::string getSegmentPath(long int id) const;
+
+    /**
+     * Open a segment file, and add it to the segments
+     *
+     * @param[in] id               segment id
+     * @param[in] create           whether to create the file
+     *
+     * @return the segment, or NULL if failed
+     **/
+    std::shared_ptr<Segment> openSegment(uint32_t id, bool create);
+
+    /**
+     * Make sure the active segment has room for a record, or start a new one, with the write lock held
+     *
+     * @param[in] length           length of the record
+     *
+     * @return whether the active segment is ready
+     **/
+    bool prepareActiveSegment(uint32_t length);
+
+    /**
+     * Append a record to the active segment, and make it durable if flush_on_close is set
+     *
+     * @param[in] type             record type
+     * @param[in] name             chunk name
+     * @param[in] aux              aux string
+     * @param[in] data             chunk data, for RECORD_PUT only
+     * @param[in] dataLength       length of chunk data
+     * @param[in] checksumType     chunk checksum type
+     * @param[in] checksum         chunk checksum, for RECORD_PUT only
+     * @param[out] location        location of the record
+     *
+     * @return whether the record is written
+     **/
+    bool appendRecord(uint8_t type, const std::string &name, const std::string &aux, const unsigned char *data, uint32_t dataLength, uint8_t checksumType, const unsigned char *checksum, Location &location);
+
+    /**
+     * Discard a record that failed to be made durable, by truncating it if it is the last one in its segment, or
+     * marking it as aborted otherwise
+     *
+     * @param[in] segment          segment of the record
+     * @param[in] header           header of the record
+     * @param[in] name             chunk name
+     * @param[in] aux              aux string
+     * @param[in] location         location of the record
+     **/
+    void discardRecord(const std::shared_ptr<Segment> &segment, RecordHeader header, const std::string &name, const std::string &aux, const Location &location);
+
+    /**
+     * Copy a record as is to the active segment, for compaction
+     *
+     * @param[in] record           record data
+     * @param[in] length           length of the record
+     * @param[out] location        new location of the record
+     *
+     * @return whether the record is copied
+     **/
+    bool copyRecord(const unsigned char *record, uint32_t length, Location &location);
+
+    /**
+     * Apply the operation of a record to the index, with the index lock held
+     *
+     * @param[in] type             record type
+     * @param[in] name             chunk name
+     * @param[in] aux              aux string
+     * @param[in] location         location of the record
+     **/
+    void applyRecord(uint8_t type, const std::string &name, const std::string &aux, const Location &location);
+
+    /**
+     * Add or remove a reference to a record in the live size of its segment, with the index lock held
+     **/
+    void addReference(const Location &location);
+    void removeReference(const Location &location);
+
+    /**
+     * Keep the record deleting a chunk live, or drop it once the chunk is written again, with the index lock held
+     **/
+    void addTombstone(const std::string &name, const Location &location);
+    void removeTombstone(const std::string &name);
+
+    /**
+     * Find the current version of a chunk and its segment
+     *
+     * @param[in] name             chunk name
+     * @param[out] location        location of the chunk
+     * @param[out] segment         segment of the chunk, which stays readable until released even if compacted
+     *
+     * @return whether the chunk is found
+     **/
+    bool findChunk(const std::string &name, Location &location, std::shared_ptr<Segment> &segment);
+
+    /**
+     * Read the data of a chunk version
+     *
+     * @param[in] segment          segment of the chunk
+     * @param[in] location         location of the chunk
+     * @param[out] chunk           chunk with Chunk::data and Chunk::size filled
+     *
+     * @return whether the data is read
+     **/
+    bool readChunkData(const std::shared_ptr<Segment> &segment, const Location &location, Chunk &chunk);
+
+    bool getChunkInternal(Chunk &chunk, bool skipVerification = false);
+
+    /**
+     * Scan the records in a segment from an offset, and truncate any incomplete record at the end
+     *
+     * @param[in] segment          segment to scan
+     * @param[in] offset           offset to start from
+     * @param[out] records         records found
+     *
+     * @return whether the segment is scanned
+     **/
+    bool scanSegment(Segment &segment, unsigned long int offset, std::vector<ScannedRecord> &records);
+
+    /**
+     * Load the checkpoint file
+     *
+     * @param[out] sizes           size of each segment covered by the checkpoint
+     *
+     * @return whether a valid checkpoint is loaded
+     **/
+    bool loadCheckpoint(std::map<uint32_t, unsigned long int> &sizes);
+
+    /**
+     * Load the checkpoint and the segments, and replay the records not covered by the checkpoint
+     **/
+    void recover();
+
+    /**
+     * Remove old versions that expired
+     **/
+    void cleanUpOldVersions();
+
+    /**
+     * Compact a segment
+     *
+     * @param[in] segment          segment to compact
+     *
+     * @return whether all live records are copied out of the segment
+     **/
+    bool compactSegment(const std::shared_ptr<Segment> &segment);
+
+    static uint32_t getRecordCrc(const RecordHeader &header, const char *name, const char *aux);
+
+    static void *runMaintenance(void *arg);
+};
+
+#endif // define __SEGMENT_CONTAINER_HH__
@@ -0,0 +1,343 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h> // posix_memalign(), free()
+#include <string.h> // memset(), memcpy()
+#include <unistd.h> // syscall(), close(), ftruncate()
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h> // struct iovec
+
+#include <linux/io_uring.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "uring_io.hh"
+
+static inline length_t alignUp(length_t size) {
+    return (size + URING_IO_ALIGNMENT - 1) / URING_IO_ALIGNMENT * URING_IO_ALIGNMENT;
+}
+
+UringIO::UringIO(unsigned int queueDepth) {
+    // at least one read/write and a sync per batch
+    _queueDepth = std::max(queueDepth, 2U);
+
+    // probe by setting up the first ring
+    Ring *ring = setupRing();
+    _available = ring != NULL;
+    if (_available) {
+        _rings.push_back(ring);
+        _freeRings.push_back(ring);
+    }
+}
+
+UringIO::~UringIO() {
+    std::lock_guard<std::mutex> lk(_lock);
+    for (Ring *ring : _rings)
+        destroyRing(ring);
+    _rings.clear();
+    _freeRings.clear();
+}
+
+bool UringIO::isAvailable() const {
+    return _available;
+}
+
+unsigned int UringIO::getQueueDepth() const {
+    return _queueDepth;
+}
+
+length_t UringIO::getBufferSize(length_t size, bool direct) {
+    return direct? alignUp(size) : size;
+}
+
+UringIO::Ring *UringIO::setupRing() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = syscall(__NR_io_uring_setup, _queueDepth, &params);
+    if (fd < 0) {
+        LOG(WARNING) << "Failed to set up io_uring, " << strerror(errno);
+        return NULL;
+    }
+    // plain reads and writes (IORING_OP_READ and IORING_OP_WRITE) are supported since the kernel with fast poll
+    if (!(params.features & IORING_FEAT_FAST_POLL)) {
+        LOG(WARNING) << "Kernel io_uring does not support plain reads and writes";
+        close(fd);
+        return NULL;
+    }
+
+    Ring *ring = new Ring();
+    memset(ring, 0, sizeof(Ring));
+    ring->fd = fd;
+    ring->entries = params.sq_entries;
+
+    // map the submission and completion queues
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+        ring->sqRingSize = ring->cqRingSize = std::max(ring->sqRingSize, ring->cqRingSize);
+    ring->sqRing = mmap(0, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring->cqRing = singleMap? ring->sqRing : mmap(0, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *) mmap(0, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        LOG(WARNING) << "Failed to map io_uring queues, " << strerror(errno);
+        destroyRing(ring);
+        return NULL;
+    }
+
+    unsigned char *sq = (unsigned char *) ring->sqRing, *cq = (unsigned char *) ring->cqRing;
+    ring->sqHead = (unsigned int *) (sq + params.sq_off.head);
+    ring->sqTail = (unsigned int *) (sq + params.sq_off.tail);
+    ring->sqMask = (unsigned int *) (sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned int *) (sq + params.sq_off.array);
+    ring->cqHead = (unsigned int *) (cq + params.cq_off.head);
+    ring->cqTail = (unsigned int *) (cq + params.cq_off.tail);
+    ring->cqMask = (unsigned int *) (cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+    return ring;
+}
+
+void UringIO::destroyRing(Ring *ring) {
+    if (ring == NULL)
+        return;
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED)
+        munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing != NULL && ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if (ring->sqRing != NULL && ring->sqRing != MAP_FAILED)
+        munmap(ring->sqRing, ring->sqRingSize);
+    // the registered buffer is released together with the ring
+    close(ring->fd);
+    free(ring->staging);
+    delete ring;
+}
+
+UringIO::Ring *UringIO::acquireRing() {
+    {
+        std::lock_guard<std::mutex> lk(_lock);
+        if (!_freeRings.empty()) {
+            Ring *ring = _freeRings.back();
+            _freeRings.pop_back();
+            return ring;
+        }
+    }
+    // set up a new ring outside the lock
+    Ring *ring = setupRing();
+    if (ring != NULL) {
+        std::lock_guard<std::mutex> lk(_lock);
+        _rings.push_back(ring);
+    }
+    return ring;
+}
+
+void UringIO::releaseRing(Ring *ring) {
+    std::lock_guard<std::mutex> lk(_lock);
+    if (ring->broken) {
+        LOG(WARNING) << "Destroy a broken io_uring";
+        _rings.erase(std::remove(_rings.begin(), _rings.end(), ring), _rings.end());
+        destroyRing(ring);
+        return;
+    }
+    _freeRings.push_back(ring);
+}
+
+bool UringIO::write(int fd, const unsigned char *data, length_t size, bool sync, bool direct) {
+    Ring *ring = acquireRing();
+    if (ring == NULL)
+        return false;
+
+    length_t done = 0;
+    bool okay = true;
+    bool aligned = !direct || ((uintptr_t) data % URING_IO_ALIGNMENT == 0 && size % URING_IO_ALIGNMENT == 0);
+
+    if (aligned) {
+        // write from the data buffer directly
+        okay = runSegments(ring, /* is write */ true, fd, (unsigned char *) data, size, 0, /* fixed */ false, sync, done) && done == size;
+    } else {
+        // stage the data in the aligned (registered) buffer, and pad the last block
+        if (ring->staging == NULL) {
+            if (posix_memalign((void **) &ring->staging, URING_IO_ALIGNMENT, URING_IO_STAGING_SIZE) != 0) {
+                ring->staging = NULL;
+                LOG(ERROR) << "Failed to allocate the staging buffer for direct I/O";
+                releaseRing(ring);
+                return false;
+            }
+            struct iovec iov = { ring->staging, URING_IO_STAGING_SIZE };
+            // fall back to unregistered buffer if the buffer cannot be pinned, e.g., under a low RLIMIT_MEMLOCK
+            ring->stagingRegistered = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+            LOG_IF(WARNING, !ring->stagingRegistered) << "Failed to register the staging buffer for direct I/O, " << strerror(errno);
+        }
+        for (length_t offset = 0; okay && offset < size; offset += URING_IO_STAGING_SIZE) {
+            length_t window = std::min((length_t) URING_IO_STAGING_SIZE, size - offset);
+            length_t padded = alignUp(window);
+            memcpy(ring->staging, data + offset, window);
+            memset(ring->staging + window, 0, padded - window);
+            okay = runSegments(ring, /* is write */ true, fd, ring->staging, padded, offset, ring->stagingRegistered, /* sync */ false, done) && done == padded;
+        }
+        // drop the padding before sync
+        if (okay && ftruncate(fd, size) != 0) {
+            LOG(ERROR) << "Failed to truncate file to " << size << " bytes after direct write, " << strerror(errno);
+            okay = false;
+        }
+        okay = okay && (!sync || runSegments(ring, /* is write */ true, fd, NULL, 0, 0, /* fixed */ false, /* sync */ true, done));
+    }
+
+    releaseRing(ring);
+    return okay;
+}
+
+bool UringIO::read(int fd, unsigned char *data, length_t size, bool direct) {
+    if (size == 0)
+        return true;
+
+    Ring *ring = acquireRing();
+    if (ring == NULL)
+        return false;
+
+    length_t done = 0;
+    // read the padded length under direct I/O, where the read ends early at the end of file
+    bool okay = runSegments(ring, /* is write */ false, fd, data, getBufferSize(size, direct), 0, /* fixed */ false, /* sync */ false, done) && done >= size;
+
+    releaseRing(ring);
+    return okay;
+}
+
+bool UringIO::runSegments(Ring *ring, bool isWrite, int fd, unsigned char *buf, length_t len, off_t offset, bool fixed, bool sync, length_t &done) {
+    std::vector<Segment> pending;
+    for (length_t segOffset = 0; segOffset < len; segOffset += URING_IO_SEGMENT_SIZE) {
+        Segment seg = { buf + segOffset, std::min((length_t) URING_IO_SEGMENT_SIZE, len - segOffset), (off_t) (offset + segOffset) };
+        pending.push_back(seg);
+    }
+
+    done = 0;
+    bool okay = true;
+    bool needsSync = isWrite && sync;
+    size_t next = 0;
+
+    while (okay && (next < pending.size() || needsSync)) {
+        // fill a batch, leaving an entry for the sync
+        unsigned int numSegs = std::min(pending.size() - next, (size_t) ring->entries - 1);
+        bool withSync = needsSync && next + numSegs == pending.size();
+        unsigned int tail = *ring->sqTail;
+        unsigned int mask = *ring->sqMask;
+        for (unsigned int i = 0; i < numSegs + (withSync? 1 : 0); i++) {
+            unsigned int index = (tail + i) & mask;
+            struct io_uring_sqe *sqe = &ring->sqes[index];
+            memset(sqe, 0, sizeof(struct io_uring_sqe));
+            sqe->fd = fd;
+            sqe->user_data = i;
+            if (i < numSegs) {
+                const Segment &seg = pending.at(next + i);
+                sqe->opcode = isWrite? (fixed? IORING_OP_WRITE_FIXED : IORING_OP_WRITE) : (fixed? IORING_OP_READ_FIXED : IORING_OP_READ);
+                sqe->addr = (uint64_t) (uintptr_t) seg.buf;
+                sqe->len = seg.len;
+                sqe->off = seg.offset;
+                sqe->buf_index = 0;
+                // link the last write to the sync, so the sync is skipped if the write fails
+                if (withSync && i + 1 == numSegs)
+                    sqe->flags |= IOSQE_IO_LINK;
+            } else {
+                // sync after all the writes before it completes
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->flags |= IOSQE_IO_DRAIN;
+            }
+            ring->sqArray[index] = index;
+        }
+        unsigned int numEntries = numSegs + (withSync? 1 : 0);
+        __atomic_store_n(ring->sqTail, tail + numEntries, __ATOMIC_RELEASE);
+
+        if (!enter(ring, numEntries, numEntries)) {
+            drainRing(ring, tail);
+            return false;
+        }
+
+        // reap the completions
+        bool resubmit = false;
+        unsigned int head = *ring->cqHead;
+        for (unsigned int i = 0; i < numEntries; i++, head++) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+            unsigned int idx = cqe->user_data;
+            int res = cqe->res;
+            if (idx >= numSegs) {
+                // the sync, canceled if the linked write is short
+                if (res == 0) {
+                    needsSync = false;
+                } else if (res != -ECANCELED) {
+                    LOG(ERROR) << "Failed to sync file with io_uring, " << strerror(-res);
+                    okay = false;
+                }
+                continue;
+            }
+            Segment &seg = pending.at(next + idx);
+            if (res < 0) {
+                LOG(ERROR) << "Failed to " << (isWrite? "write" : "read") << " " << seg.len << " bytes at offset " << seg.offset << " with io_uring, " << strerror(-res);
+                okay = false;
+                continue;
+            }
+            done += res;
+            if ((length_t) res == seg.len || (!isWrite && res == 0))
+                continue;
+            if (isWrite && res == 0) {
+                LOG(ERROR) << "Failed to write " << seg.len << " bytes at offset " << seg.offset << " with io_uring, no progress";
+                okay = false;
+                continue;
+            }
+            // short writes are continued; short reads are at the end of file
+            if (isWrite) {
+                Segment rest = { seg.buf + res, seg.len - res, seg.offset + res };
+                pending.push_back(rest);
+                resubmit = true;
+            }
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+        next += numSegs;
+        // sync again after the continued writes
+        if (resubmit && isWrite && sync)
+            needsSync = true;
+    }
+
+    return okay;
+}
+
+bool UringIO::enter(Ring *ring, unsigned int toSubmit, unsigned int toComplete) {
+    while (toSubmit > 0 || toComplete > 0) {
+        int ret = syscall(__NR_io_uring_enter, ring->fd, toSubmit, toComplete, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            LOG(ERROR) << "Failed to submit requests to io_uring, " << strerror(errno);
+            return false;
+        }
+        toSubmit -= std::min((unsigned int) ret, toSubmit);
+        // check the completions that have arrived
+        unsigned int ready = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - *ring->cqHead;
+        toComplete = ready >= toComplete? 0 : toComplete;
+    }
+    return true;
+}
+
+void UringIO::drainRing(Ring *ring, unsigned int sqStart) {
+    // entries not yet taken by the kernel stay queued, and would be submitted by the next user of the ring
+    ring->broken = true;
+
+    unsigned int submitted = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) - sqStart;
+    unsigned int ready = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - *ring->cqHead;
+    while (ready < submitted) {
+        int ret = syscall(__NR_io_uring_enter, ring->fd, 0, submitted - ready, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0 && errno != EINTR) {
+            // closing the ring cancels the remaining requests
+            LOG(ERROR) << "Failed to wait for " << submitted - ready << " submitted requests on io_uring, " << strerror(errno);
+            break;
+        }
+        ready = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE) - *ring->cqHead;
+    }
+    __atomic_store_n(ring->cqHead, *ring->cqHead + ready, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __URING_IO_HH__
+#define __URING_IO_HH__
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include <mutex>
+#include <vector>
+
+#include "../../common/define.hh"
+
+/// alignment of buffers, offsets and lengths for direct I/O
+#define URING_IO_ALIGNMENT         (4096)
+/// max. size of each read/write request submitted, so a large chunk is read/written by multiple requests in flight
+#define URING_IO_SEGMENT_SIZE      (1 << 20)
+/// size of the registered buffer of each ring, for staging unaligned data under direct I/O
+#define URING_IO_STAGING_SIZE      (4 << 20)
+/// default number of entries in each submission queue
+#define URING_IO_DEFAULT_DEPTH     (32)
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * Asynchronous file I/O using io_uring (without liburing)
+ *
+ * A read or write of a file is split into segments of URING_IO_SEGMENT_SIZE, which are submitted in batches of up
+ * to the queue depth with one system call per batch. A sync on write is linked to the last segment and drains the
+ * segments before it, so it goes into the same submission. Each ring has a registered buffer for staging the
+ * unaligned data under direct I/O.
+ *
+ * Rings are taken from a pool, one per concurrent caller, and are created on demand.
+ **/
+class UringIO {
+public:
+    /**
+     * Constructor
+     *
+     * @param[in] queueDepth        number of entries in each submission queue
+     **/
+    UringIO(unsigned int queueDepth = URING_IO_DEFAULT_DEPTH);
+    ~UringIO();
+
+    /**
+     * Tell whether io_uring is available, i.e., whether a ring can be set up
+     *
+     * @return whether io_uring is available
+     **/
+    bool isAvailable() const;
+
+    /**
+     * Write data to the beginning of a file
+     *
+     * @param[in] fd                file descriptor opened for write
+     * @param[in] data              data to write
+     * @param[in] size              size of data
+     * @param[in] sync              whether to sync the file after write
+     * @param[in] direct            whether the file is opened with O_DIRECT; unaligned data is staged and padded, and the file is truncated to size afterwards
+     *
+     * @return whether the data is written (and synced)
+     **/
+    bool write(int fd, const unsigned char *data, length_t size, bool sync, bool direct = false);
+
+    /**
+     * Read data from the beginning of a file
+     *
+     * @param[in] fd                file descriptor opened for read
+     * @param[out] data             buffer for the data, of at least getBufferSize(size, direct) bytes and aligned to URING_IO_ALIGNMENT under direct I/O
+     * @param[in] size              size of data to read
+     * @param[in] direct            whether the file is opened with O_DIRECT
+     *
+     * @return whether all the data is read
+     **/
+    bool read(int fd, unsigned char *data, length_t size, bool direct = false);
+
+    /**
+     * Get the size of buffer needed to read data
+     *
+     * @param[in] size              size of data
+     * @param[in] direct            whether the file is opened with O_DIRECT
+     *
+     * @return the buffer size
+     **/
+    static length_t getBufferSize(length_t size, bool direct);
+
+    unsigned int getQueueDepth() const;
+
+private:
+    /**
+     * A ring with its submission and completion queues mapped
+     **/
+    struct Ring {
+        int fd;                         /**< ring file descriptor */
+        unsigned int entries;           /**< number of submission queue entries */
+        void *sqRing;                   /**< mapped submission queue ring */
+        size_t sqRingSize;              /**< size of the mapped submission queue ring */
+        void *cqRing;                   /**< mapped completion queue ring, same as the submission queue ring for single mmap */
+        size_t cqRingSize;              /**< size of the mapped completion queue ring */
+        struct io_uring_sqe *sqes;      /**< mapped submission queue entries */
+        size_t sqesSize;                /**< size of the mapped submission queue entries */
+        unsigned int *sqHead;
+        unsigned int *sqTail;
+        unsigned int *sqMask;
+        unsigned int *sqArray;
+        unsigned int *cqHead;
+        unsigned int *cqTail;
+        unsigned int *cqMask;
+        struct io_uring_cqe *cqes;
+        unsigned char *staging;         /**< buffer for staging unaligned data under direct I/O */
+        bool stagingRegistered;         /**< whether the staging buffer is registered as fixed buffer 0 */
+        bool broken;                    /**< whether the queues are left inconsistent by a failed submission, so the ring cannot be reused */
+    };
+
+    /**
+     * A read/write request on a range of a file
+     **/
+    struct Segment {
+        unsigned char *buf;             /**< buffer of the range */
+        length_t len;                   /**< length of the range */
+        off_t offset;                   /**< file offset of the range */
+    };
+
+    /**
+     * Set up a new ring
+     *
+     * @return the ring, or NULL if failed
+     **/
+    Ring *setupRing();
+
+    /**
+     * Tear down a ring
+     *
+     * @param[in] ring              the ring
+     **/
+    void destroyRing(Ring *ring);
+
+    /**
+     * Take a ring from the pool, set up a new one if none is free
+     *
+     * @return the ring, or NULL if failed
+     **/
+    Ring *acquireRing();
+
+    /**
+     * Return a ring to the pool, or destroy it if it is broken
+     *
+     * @param[in] ring              the ring
+     **/
+    void releaseRing(Ring *ring);
+
+    /**
+     * Read/write a range of a file in segments, and optionally sync the file after all segments are written
+     *
+     * @param[in] ring              the ring to use
+     * @param[in] isWrite           whether to write the range
+     * @param[in] fd                file descriptor
+     * @param[in] buf               buffer of the range
+     * @param[in] len               length of the range
+     * @param[in] offset            file offset of the range
+     * @param[in] fixed             whether buf lies in the registered buffer
+     * @param[in] sync              whether to sync the file after write
+     * @param[out] done             number of bytes read/written
+     *
+     * @return whether the whole range is read/written (and the file synced), or the end of file is reached on read
+     **/
+    bool runSegments(Ring *ring, bool isWrite, int fd, unsigned char *buf, length_t len, off_t offset, bool fixed, bool sync, length_t &done);
+
+    /**
+     * Submit the queued entries and wait for a number of completions
+     *
+     * @param[in] ring              the ring
+     * @param[in] toSubmit          number of entries queued
+     * @param[in] toComplete        number of completions to wait for
+     *
+     * @return whether the entries are submitted and the completions arrive
+     **/
+    bool enter(Ring *ring, unsigned int toSubmit, unsigned int toComplete);
+
+    /**
+     * Wait for the completions of the entries taken by the kernel after a failed submission, so that none of them accesses the buffers afterwards, and mark the ring broken
+     *
+     * @param[in] ring              the ring
+     * @param[in] sqStart           submission queue tail before the entries are queued
+     **/
+    void drainRing(Ring *ring, unsigned int sqStart);
+
+    unsigned int _queueDepth;           /**< number of entries in each submission queue */
+    bool _available;                    /**< whether io_uring is available */
+
+    std::mutex _lock;                   /**< lock on the pool of rings */
+    std::vector<Ring *> _rings;         /**< all rings set up */
+    std::vector<Ring *> _freeRings;     /**< rings not in use */
+};
+
+#endif // define __URING_IO_HH__
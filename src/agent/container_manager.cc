@@ -4,6 +4,8 @@
 #include <unistd.h>
 #include <linux/limits.h>
 
+#include <atomic>
+
 #include <glog/logging.h>
 
 #include "container_manager.hh"
@@ -33,6 +35,10 @@ ContainerManager::ContainerManager() {
             _containerPtrs[i] = new FsContainer(cid, cstr.c_str(), capacity);
             DLOG(INFO) << "FS container with id = " << cid << " folder name = " << cstr << " capacity = " << capacity;
             break;
+        case ContainerType::SEGMENT_CONTAINER:
+            _containerPtrs[i] = new SegmentContainer(cid, cstr.c_str(), capacity);
+            DLOG(INFO) << "Segment container with id = " << cid << " folder name = " << cstr << " capacity = " << capacity;
+            break;
         case ContainerType::AWS_CONTAINER:
             _containerPtrs[i] = new AwsContainer(cid, cstr, region, keyId, key, capacity, "", proxyIP, proxyPort);
             DLOG(INFO) << "AWS container with id = " << cid << " bucket name = " << cstr << " capacity = " << capacity;
@@ -59,121 +65,177 @@ ContainerManager::ContainerManager() {
             exit(1);
         }
     }
+
+    // workers of each container, for handling the chunks of a request in different containers in parallel
+    int numWorkers = config.getAgentContainerIOWorkers();
+    for (int i = 0; numWorkers > 0 && _numContainers > 1 && i < _numContainers; i++) {
+        ContainerQueue *queue = new ContainerQueue();
+        queue->stop = false;
+        for (int j = 0; j < numWorkers; j++)
+            queue->workers.emplace_back(ContainerManager::runQueue, queue);
+        _queues[_containerPtrs[i]->getId()] = queue;
+    }
 }
 
 ContainerManager::~ContainerManager() {
     LOG(WARNING) << "Terminating Container Manager ...";
+    // stop the workers of containers
+    for (auto &q : _queues) {
+        ContainerQueue *queue = q.second;
+        {
+            std::lock_guard<std::mutex> lk(queue->lock);
+            queue->stop = true;
+        }
+        queue->hasTask.notify_all();
+        for (auto &worker : queue->workers)
+            worker.join();
+        delete queue;
+    }
+    _queues.clear();
     // release the containers
     for (int i = 0; i < _numContainers; i++)
         delete _containerPtrs[i];
     LOG(WARNING) << "Terminated Container Manager ...";
 }
 
-bool ContainerManager::putChunks(int containerId[], Chunk chunks[], int numChunks) {
-    bool ret = true;
-    int i = 0;
-
-    bool verifyChecksum = Config::getInstance().verifyChunkChecksum();
+bool ContainerManager::putChunks(int containerId[], Chunk chunks[], int numChunks, bool trustChecksum) {
+    bool verifyChecksum = Config::getInstance().verifyChunkChecksum() && !trustChecksum;
+    bool succeeded[numChunks];
 
     // store chunks to containers
-    for (i = 0; i < numChunks && ret; i++) {
+    bool ret = runOnContainers(containerId, numChunks, [&](int i) {
         try {
+            Container *container = _containers.at(containerId[i]);
             // verify checksum before write
-            if (verifyChecksum && !chunks[i].verifyMD5()) {
-                ret = false;
-                break;
-            }
+            if (verifyChecksum && !chunks[i].verifyChecksum())
+                return false;
             // write chunk
-            if ((ret = _containers.at(containerId[i])->putChunk(chunks[i])) == false) {
-                ret = false;
-                break;
-            }
-            _containers.at(containerId[i])->bgUpdateUsage();
+            if (!container->putChunk(chunks[i], trustChecksum))
+                return false;
+            container->bgUpdateUsage();
         } catch (std::exception &e) {
             LOG(ERROR) << "Cannot find container " << containerId[i] << " to write chunk";
-            ret = false;
-            break;
+            return false;
         }
-    }
+        return true;
+    }, /* stopOnFailure */ true, succeeded);
+
     // remove stored chunks once failed
-    for (int j = 0; j < i && !ret; j++) { 
-        try {
-            _containers.at(containerId[j])->deleteChunk(chunks[i]);
-            _containers.at(containerId[i])->bgUpdateUsage();
-        } catch (std::exception &e) {
-            LOG(ERROR) << "Cannot find container " << containerId[j] << " to remove chunk after write failure";
-        }
+    if (!ret) {
+        rollBack(containerId, numChunks, succeeded, [&](int i) {
+            try {
+                Container *container = _containers.at(containerId[i]);
+                container->deleteChunk(chunks[i]);
+                container->bgUpdateUsage();
+            } catch (std::exception &e) {
+                LOG(ERROR) << "Cannot find container " << containerId[i] << " to remove chunk after write failure";
+            }
+            return true;
+        });
     }
     return ret;
 }
 
 bool ContainerManager::getChunks(int containerId[], Chunk chunks[], int numChunks) {
-    bool ret = true;
     // get chunks from containers
-    for (int i = 0; i < numChunks; i++ ) {
+    return runOnContainers(containerId, numChunks, [&](int i) {
         try {
-            if ((ret = _containers.at(containerId[i])->getChunk(chunks[i])) == false) {
-                throw std::invalid_argument("");
-            }
+            return _containers.at(containerId[i])->getChunk(chunks[i]);
         } catch (std::exception &e) {
-            ret = false;
-            break;
+            return false;
         }
+    }, /* stopOnFailure */ true);
+}
+
+bool ContainerManager::getChunkRanges(int containerId[], Chunk chunks[], int numChunks, const int ranges[]) {
+    // get the whole chunks (with verification)
+    if (!getChunks(containerId, chunks, numChunks)) {
+        return false;
     }
-    return ret;
+    // keep only the ranges, in place
+    for (int i = 0; i < numChunks; i++) {
+        int offset = ranges[i * 2], length = ranges[i * 2 + 1];
+        if (offset < 0 || length <= 0 || offset + length > chunks[i].size) {
+            LOG(ERROR) << "Invalid range (" << offset << ", " << length << ") of chunk " << chunks[i].getChunkName() << " of size " << chunks[i].size;
+            return false;
+        }
+        memmove(chunks[i].data, chunks[i].data + offset, length);
+        chunks[i].size = length;
+    }
+    return true;
 }
 
 bool ContainerManager::deleteChunks(int containerId[], Chunk chunks[], int numChunks) {
     // delete chunks from containers
-    for (int i = 0; i < numChunks; i++ ) {
+    runOnContainers(containerId, numChunks, [&](int i) {
         try {
-            _containers.at(containerId[i])->deleteChunk(chunks[i]);
-            _containers.at(containerId[i])->bgUpdateUsage();
+            Container *container = _containers.at(containerId[i]);
+            container->deleteChunk(chunks[i]);
+            container->bgUpdateUsage();
         } catch (std::exception &e) {
             LOG(ERROR) << "Cannot find container " << containerId[i] << " to remove chunk";
         }
-    }
+        return true;
+    }, /* stopOnFailure */ false);
     return true;
 }
 
 bool ContainerManager::copyChunks(int containerId[], Chunk srcChunks[], Chunk dstChunks[], int numChunks) {
+    bool succeeded[numChunks];
+
     // copy chunks within containers
-    bool ret = true;
-    for (int i = 0; i < numChunks; i++) {
+    bool ret = runOnContainers(containerId, numChunks, [&](int i) {
         try {
-            ret = _containers.at(containerId[i])->copyChunk(srcChunks[i], dstChunks[i]) && ret;
-            _containers.at(containerId[i])->bgUpdateUsage();
+            Container *container = _containers.at(containerId[i]);
+            bool okay = container->copyChunk(srcChunks[i], dstChunks[i]);
+            container->bgUpdateUsage();
+            return okay;
         } catch (std::exception &e) {
-            ret = false;
-            // remove already copied chunks upon error
-            for (int j = 0; j < i; j++)
-                try {
-                    _containers.at(containerId[j])->deleteChunk(dstChunks[j]);
-                } catch (std::exception &e) {
-                    LOG(ERROR) << "Cannot find container " << containerId[j] << " to remove chunk after copy failure";
-                }
-            break;
-        } 
+            LOG(ERROR) << "Cannot find container " << containerId[i] << " to copy chunk";
+            return false;
+        }
+    }, /* stopOnFailure */ true, succeeded);
+
+    // remove already copied chunks upon error
+    if (!ret) {
+        rollBack(containerId, numChunks, succeeded, [&](int i) {
+            try {
+                Container *container = _containers.at(containerId[i]);
+                container->deleteChunk(dstChunks[i]);
+                container->bgUpdateUsage();
+            } catch (std::exception &e) {
+                LOG(ERROR) << "Cannot find container " << containerId[i] << " to remove chunk after copy failure";
+            }
+            return true;
+        });
     }
     return ret;
 }
 
 bool ContainerManager::moveChunks(int containerId[], Chunk srcChunks[], Chunk dstChunks[], int numChunks) {
-    bool ret = true;
-    for (int i = 0; i < numChunks; i++) {
+    bool succeeded[numChunks];
+
+    // move chunks within containers
+    bool ret = runOnContainers(containerId, numChunks, [&](int i) {
         try {
-            ret = _containers.at(containerId[i])->moveChunk(srcChunks[i], dstChunks[i]) && ret;
+            return _containers.at(containerId[i])->moveChunk(srcChunks[i], dstChunks[i]);
         } catch (std::exception &e) {
-            ret = false;
-            // revert already moved chunks upon error
-            for (int j = 0; j < i; j++)
-                try {
-                    _containers.at(containerId[j])->moveChunk(dstChunks[j], srcChunks[j]);
-                } catch (std::exception &e) {
-                    LOG(ERROR) << "Cannot find container " << containerId[j] << " to reverse chunk moving after move failure";
-                }
-            break;
-        } 
+            LOG(ERROR) << "Cannot find container " << containerId[i] << " to move chunk";
+            return false;
+        }
+    }, /* stopOnFailure */ true, succeeded);
+
+    // revert already moved chunks upon error
+    if (!ret) {
+        rollBack(containerId, numChunks, succeeded, [&](int i) {
+            try {
+                if (!_containers.at(containerId[i])->moveChunk(dstChunks[i], srcChunks[i]))
+                    LOG(ERROR) << "Failed to reverse chunk moving of " << dstChunks[i].getChunkName() << " after move failure";
+            } catch (std::exception &e) {
+                LOG(ERROR) << "Cannot find container " << containerId[i] << " to reverse chunk moving after move failure";
+            }
+            return true;
+        });
     }
     return ret;
 }
@@ -224,6 +286,76 @@ bool ContainerManager::revertChunks(int containerId[], Chunk chunks[], int numCh
     return ret;
 }
 
+bool ContainerManager::updateChunks(int containerId[], Chunk chunks[], const Chunk expected[], int numChunks) {
+    bool ret = true;
+    int i = 0;
+    bool updated[numChunks];
+
+    bool verifyChecksum = Config::getInstance().verifyChunkChecksum();
+
+    for (i = 0; i < numChunks && ret; i++) {
+        updated[i] = false;
+        try {
+            Container *container = _containers.at(containerId[i]);
+            // verify checksum of the changes before update
+            if (verifyChecksum && !chunks[i].verifyChecksum()) {
+                LOG(ERROR) << "Checksum mismatch on changes to chunk " << chunks[i].getChunkName();
+                ret = false;
+                break;
+            }
+            // read the stored chunk, and check it against the expected one
+            Chunk chunk;
+            chunk.copyMeta(chunks[i], /* copySize */ false);
+            if (!container->getChunk(chunk, /* skipVerification */ true) || chunk.size != chunks[i].size) {
+                LOG(ERROR) << "Failed to get chunk " << chunks[i].getChunkName() << " of size " << chunks[i].size << " for update (got size " << chunk.size << ")";
+                ret = false;
+                break;
+            }
+            chunk.copyChecksum(expected[i]);
+            bool isExpected = chunk.verifyChecksum();
+            // apply the changes
+            for (int b = 0; b < chunk.size; b++)
+                chunk.data[b] ^= chunks[i].data[b];
+            if (!isExpected) {
+                // the changes were applied by a previous attempt if the stored chunk matches the expected one without them
+                if (!chunk.verifyChecksum()) {
+                    LOG(ERROR) << "Stored chunk " << chunks[i].getChunkName() << " mismatches the one expected for update";
+                    ret = false;
+                    break;
+                }
+                for (int b = 0; b < chunk.size; b++)
+                    chunk.data[b] ^= chunks[i].data[b];
+                chunk.computeChecksum();
+                chunks[i].copyChecksum(chunk);
+                chunks[i].chunkVersion[0] = 0;
+                LOG(INFO) << "Skip update of chunk " << chunks[i].getChunkName() << ", changes already applied";
+                continue;
+            }
+            // write the updated chunk, with the previous one kept as a version for revert
+            if (!container->putChunk(chunk)) {
+                LOG(ERROR) << "Failed to write chunk " << chunks[i].getChunkName() << " for update";
+                ret = false;
+                break;
+            }
+            updated[i] = true;
+            chunks[i].copyChecksum(chunk);
+            strncpy(chunks[i].chunkVersion, chunk.chunkVersion, CHUNK_VERSION_MAX_LEN);
+            container->bgUpdateUsage();
+        } catch (std::exception &e) {
+            LOG(ERROR) << "Cannot find container " << containerId[i] << " to update chunk";
+            ret = false;
+            break;
+        }
+    }
+    // revert chunks updated by this request once failed
+    for (int j = 0; !ret && j < i; j++) {
+        if (updated[j])
+            revertChunks(&containerId[j], &chunks[j], 1);
+    }
+
+    return ret;
+}
+
 Chunk ContainerManager::getEncodedChunks(int containerId[], Chunk chunks[], int numChunks, unsigned char matrix[]) {
     Chunk codedChunk, rawChunks[numChunks];
     unsigned char *rawData[numChunks];
@@ -252,9 +384,10 @@ Chunk ContainerManager::getEncodedChunks(int containerId[], Chunk chunks[], int
             codedChunk.size = rawChunks[i].size;
         }
     }
+    // encode the chunk
+    if (ret && (ret = CodingUtils::encode(rawData, numChunks, &codedChunk.data, 1, codedChunk.size, matrix)) == false)
+        LOG(ERROR) << "Failed to encode " << numChunks << " chunks";
     if (ret) {
-        // encode the chunk
-        CodingUtils::encode(rawData, numChunks, &codedChunk.data, 1, codedChunk.size, matrix);
         codedChunk.freeData = false;
     } else {
         codedChunk.size = 0;
@@ -278,6 +411,107 @@ void ContainerManager::getContainerType(unsigned char containerType[]) {
         containerType[i] = config.getContainerType(i);
 }
 
+bool ContainerManager::runOnContainers(int containerId[], int numChunks, const std::function<bool(int)> &op, bool stopOnFailure, bool succeeded[]) {
+    std::vector<int> chunkIndices(numChunks);
+    for (int i = 0; i < numChunks; i++)
+        chunkIndices.at(i) = i;
+    return runOnContainers(containerId, chunkIndices, op, stopOnFailure, succeeded);
+}
+
+bool ContainerManager::runOnContainers(int containerId[], const std::vector<int> &chunkIndices, const std::function<bool(int)> &op, bool stopOnFailure, bool succeeded[]) {
+    std::atomic<bool> failed(false);
+
+    if (succeeded) {
+        for (int i : chunkIndices)
+            succeeded[i] = false;
+    }
+
+    // run the operation on chunks one by one in order
+    auto runChunks = [&](const std::vector<int> &indices) {
+        for (int i : indices) {
+            if (stopOnFailure && failed)
+                break;
+            bool okay = op(i);
+            if (succeeded)
+                succeeded[i] = okay;
+            if (!okay)
+                failed = true;
+        }
+    };
+
+    // group the chunks by container, in order
+    std::map<int, std::vector<int> > groups;
+    for (int i : chunkIndices)
+        groups[containerId[i]].push_back(i);
+
+    if (_queues.empty() || groups.size() <= 1) {
+        runChunks(chunkIndices);
+        return !failed;
+    }
+
+    // hand the chunks in other containers to the workers of the containers, and handle those in the container of the
+    // first chunk (and those in unknown containers, which fail anyway) here
+    std::vector<std::pair<ContainerQueue *, const std::vector<int> *> > queued;
+    std::vector<const std::vector<int> *> local;
+    for (auto &group : groups) {
+        auto queue = _queues.find(group.first);
+        if (group.first == containerId[chunkIndices.front()] || queue == _queues.end())
+            local.push_back(&group.second);
+        else
+            queued.push_back(std::make_pair(queue->second, &group.second));
+    }
+
+    std::mutex lock;
+    std::condition_variable allDone;
+    size_t numPending = queued.size();
+    for (auto &q : queued) {
+        ContainerQueue *queue = q.first;
+        const std::vector<int> *indices = q.second;
+        {
+            std::lock_guard<std::mutex> lk(queue->lock);
+            queue->tasks.emplace_back([&, indices]() {
+                runChunks(*indices);
+                // signal while holding the lock, as the waiting caller may return and release the states right after
+                std::lock_guard<std::mutex> lk(lock);
+                if (--numPending == 0)
+                    allDone.notify_one();
+            });
+        }
+        queue->hasTask.notify_one();
+    }
+
+    for (auto indices : local)
+        runChunks(*indices);
+
+    std::unique_lock<std::mutex> lk(lock);
+    allDone.wait(lk, [&numPending] { return numPending == 0; });
+
+    return !failed;
+}
+
+void ContainerManager::rollBack(int containerId[], int numChunks, const bool succeeded[], const std::function<bool(int)> &undo) {
+    std::vector<int> chunkIndices;
+    for (int i = numChunks - 1; i >= 0; i--) {
+        if (succeeded[i])
+            chunkIndices.push_back(i);
+    }
+    runOnContainers(containerId, chunkIndices, undo, /* stopOnFailure */ false);
+}
+
+void ContainerManager::runQueue(ContainerQueue *queue) {
+    std::unique_lock<std::mutex> lk(queue->lock);
+    while (true) {
+        queue->hasTask.wait(lk, [queue] { return queue->stop || !queue->tasks.empty(); });
+        if (queue->tasks.empty())
+            break;
+        std::function<void()> task = std::move(queue->tasks.front());
+        queue->tasks.pop_front();
+        lk.unlock();
+        task();
+        lk.lock();
+    }
+}
+
 void ContainerManager::getContainerUsage(unsigned long int containerUsage[], unsigned long int containerCapacity[]) {
     for (int i = 0; i < _numContainers; i++) {
         containerUsage[i] = _containerPtrs[i]->getUsage();
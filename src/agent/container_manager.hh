@@ -3,11 +3,24 @@
 #ifndef __CONTAINER_MANAGER_HH__
 #define __CONTAINER_MANAGER_HH__
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "../ds/chunk.hh"
 #include "container/container.hh"
 
+/**
+ * Manager of the containers of an agent
+ *
+ * Chunk operations of a request on chunks in different containers, e.g., put, get, delete, copy and move, run in
+ * parallel on the workers of the containers, while the operations in the same container run one by one in order.
+ * If an operation of put, copy, or move fails, the completed ones are rolled back in each container in reverse order.
+ **/
 class ContainerManager {
 public:
     ContainerManager();
@@ -20,10 +33,11 @@ public:
      * @param[in] chunks            chunks to store in containers with the corresponding ids;
      *                              each of them should have all fields filled
      * @param[in] numChunks         number of chunks to store
+     * @param[in] trustChecksum     whether to trust the chunk checksums, e.g., computed by proxies, without verifying or computing them again
      *
      * @return if all chunks are successfully stored
      **/
-    bool putChunks(int containerId[], Chunk chunks[], int numChunks);
+    bool putChunks(int containerId[], Chunk chunks[], int numChunks, bool trustChecksum = false);
 
     /**
      * Get the chunks from the coresponding containers
@@ -38,6 +52,20 @@ public:
      **/
     bool getChunks(int containerId[], Chunk chunks[], int numChunks);
 
+    /**
+     * Get byte ranges of the chunks from the coresponding containers
+     *
+     * @param[in]  containerId      ids of containers storing the corresponding chunks
+     * @param[out] chunks           list of chunks to store data obtained from containers with the corresponding ids, see getChunks();
+     *                              Chunk::data, Chunk::size would be filled with the range only if get is successful
+     * @param[in]  numChunks        number of chunks to get
+     * @param[in]  ranges           (offset, length) of the range to get in each chunk, its size is a double of the number of chunks
+     *
+     * @return if the ranges of all chunks are successfully get
+     * @remark the whole chunk is read and verified before the range is extracted
+     **/
+    bool getChunkRanges(int containerId[], Chunk chunks[], int numChunks, const int ranges[]);
+
     /**
      * Delete the chunks from the coresponding containers
      *
@@ -114,6 +142,25 @@ public:
      **/
     bool revertChunks(int containerId[], Chunk chunks[], int numChunks);
 
+    /**
+     * Update chunks in place by XOR-ing the changes to the stored chunks
+     *
+     * The changes are only applied to a stored chunk matching the expected checksum. A stored chunk which already has
+     * the changes applied, i.e., matches the expected checksum after XOR-ing the changes again, is left intact, such that
+     * retrying an update does not apply the changes twice.
+     *
+     * @param[in] containerId        ids of containers storing the corresponding chunks
+     * @param[in,out] chunks         changes to the chunks in containers with the corresponding ids;
+     *                               each of them should have all fields filled, and be of the same size as the stored chunk;
+     *                               Chunk::checksum and Chunk::chunkVersion would be set to those of the updated chunk if update is successful
+     *                               (Chunk::chunkVersion is empty if the changes were already applied)
+     * @param[in] expected           expected stored chunks with the checksums, before the changes are applied
+     * @param[in] numChunks          number of chunks to update
+     *
+     * @return if all chunks are successfully updated; updated chunks are reverted upon failure
+     **/
+    bool updateChunks(int containerId[], Chunk chunks[], const Chunk expected[], int numChunks);
+
     /**
      * Generate a partial encoded chunk from chunks in the coresponding containers
      *
@@ -161,9 +208,56 @@ public:
     void getContainerUsage(unsigned long int containerUsage[], unsigned long int containerCapacity[]);
 
 private:
+    /**
+     * Queue of chunk operations on a container, run by the workers of the container
+     **/
+    struct ContainerQueue {
+        std::mutex lock;                             /**< lock on the queue */
+        std::condition_variable hasTask;             /**< signal on new tasks or stop */
+        std::deque<std::function<void()> > tasks;    /**< tasks pending */
+        std::vector<std::thread> workers;            /**< worker threads */
+        bool stop;                                   /**< whether the workers should stop */
+    };
+
     int _numContainers;                              /**< number of containers */
     std::map<int, Container*> _containers;           /**< mapping of containers id to container */
     Container *_containerPtrs[MAX_NUM_CONTAINERS];   /**< list of containers */
+    std::map<int, ContainerQueue*> _queues;          /**< mapping of containers id to the queue of the container, empty if chunks are handled one by one */
+
+    /**
+     * Run an operation on chunks, with the chunks in different containers handled in parallel, and those in the same container one by one in order
+     *
+     * @param[in] containerId        ids of containers storing the corresponding chunks
+     * @param[in] chunkIndices       indices of chunks to operate on, in order
+     * @param[in] op                 operation on the chunk of an index, which returns whether the operation succeeds
+     * @param[in] stopOnFailure      whether to skip the chunks yet handled once an operation fails
+     * @param[out] succeeded         whether the operation on each chunk (by index) succeeds, NULL if not needed
+     *
+     * @return whether the operations on all chunks succeed
+     **/
+    bool runOnContainers(int containerId[], const std::vector<int> &chunkIndices, const std::function<bool(int)> &op, bool stopOnFailure, bool succeeded[] = NULL);
+
+    /**
+     * Run an operation on chunks of indices from 0 to numChunks - 1, see runOnContainers() above
+     **/
+    bool runOnContainers(int containerId[], int numChunks, const std::function<bool(int)> &op, bool stopOnFailure, bool succeeded[] = NULL);
+
+    /**
+     * Roll back the operations succeeded on chunks, in each container in reverse order
+     *
+     * @param[in] containerId        ids of containers storing the corresponding chunks
+     * @param[in] numChunks          number of chunks
+     * @param[in] succeeded          whether the operation on each chunk (by index) succeeded
+     * @param[in] undo               operation to undo the one on the chunk of an index
+     **/
+    void rollBack(int containerId[], int numChunks, const bool succeeded[], const std::function<bool(int)> &undo);
+
+    /**
+     * Worker loop, which runs the tasks in the queue of a container
+     *
+     * @param[in] queue              queue of the container
+     **/
+    static void runQueue(ContainerQueue *queue);
 };
 
 #endif // define __CONTAINER_MANAGER_HH__
@@ -28,10 +28,14 @@
 
 #define log_error(...)       fprintf(stderr, __VA_ARGS__)
 
-static int issue_request(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus);
+static int issue_request(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus, unsigned long int *session_id, unsigned int num_stripes, unsigned long int *stripe_size);
+static int send_request_frames(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus, unsigned long int *session_id, unsigned int num_stripes, unsigned long int *stripe_size);
+static int recv_reply_frames(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus, unsigned long int *session_id, unsigned int num_stripes, unsigned long int *stripe_size);
+static unsigned long int get_request_result(request_t *req, int ret);
 static int has_file_data(int opcode);
 
-static int setup_connection(const char *ip, unsigned short port, void **context, void **socket);
+static int setup_connection(const char *ip, unsigned short port, int type, void **context, void **socket);
+static void drain_reply(void *socket);
 static int teardown_connection(void *context, void *socket);
 
 static int set_file_write_request_base(request_t *req, char *filename, unsigned long int filesize, char *storage_class, unsigned char namespace_id);
@@ -41,6 +45,7 @@ static int has_opcode_only(int opcode);
 static int has_namespace_id_only(int opcode);
 static int has_size_or_length(int opcode);
 static int has_offset(int opcode);
+static int has_session_id(int opcode);
 
 
 ////////////////////////
@@ -228,6 +233,9 @@ int request_t_init(request_t *request) {
     file_list_head_t_init(&request->file_list);
     agent_info_head_t_init(&request->agent_list);
     sysinfo_t_init(&request->proxy_status);
+    request->session_id = 0;
+    request->stripe_size = 0;
+    request->num_stripes = 0;
 
     request->opcode = UNKNOWN_CLIENT_OP;
     request->opcode = UNKNOWN_NAMESPACE_ID;
@@ -256,7 +264,7 @@ int ncloud_conn_t_init(const char *ip, unsigned short port, ncloud_conn_t *conn,
     conn->context = 0;
 
     if (connect)
-        setup_connection(ip, port, &conn->context, &conn->socket);
+        setup_connection(ip, port, ZMQ_REQ, &conn->context, &conn->socket);
 
     return 0;
 }
@@ -271,6 +279,66 @@ void ncloud_conn_t_release(ncloud_conn_t *conn) {
     ncloud_conn_t_init("", 0, conn, 0);
 }
 
+int ncloud_async_conn_t_init(const char *ip, unsigned short port, ncloud_async_conn_t *conn, unsigned int max_inflight) {
+    if (conn == NULL || max_inflight == 0 || max_inflight > INT_MAX)
+        return -1;
+
+    conn->socket = 0;
+    conn->context = 0;
+    conn->max_inflight = max_inflight;
+    conn->num_inflight = 0;
+    conn->free_slot = -1;
+
+    // chain up all slots as free
+    conn->slots = (async_request_slot_t *) malloc (sizeof(async_request_slot_t) * max_inflight);
+    if (conn->slots == NULL) {
+        log_error("Failed to allocate memory for %u requests in flight\n", max_inflight);
+        return -1;
+    }
+    for (int i = max_inflight - 1; i >= 0; i--) {
+        conn->slots[i].request = NULL;
+        conn->slots[i].next_free = conn->free_slot;
+        conn->free_slot = i;
+    }
+
+    // requests are matched with replies by the envelope, so a DEALER socket can keep many of them in flight
+    if (setup_connection(ip, port, ZMQ_DEALER, &conn->context, &conn->socket) != 0) {
+        free(conn->slots);
+        conn->slots = NULL;
+        conn->socket = 0;
+        conn->context = 0;
+        return -1;
+    }
+    // do not block the submission before reaching the max. number of requests in flight
+    int hwm = max_inflight;
+    if (hwm > 1000) {
+        zmq_setsockopt(conn->socket, ZMQ_SNDHWM, &hwm, sizeof(hwm));
+        zmq_setsockopt(conn->socket, ZMQ_RCVHWM, &hwm, sizeof(hwm));
+    }
+
+    return 0;
+}
+
+void ncloud_async_conn_t_release(ncloud_async_conn_t *conn) {
+    if (conn == NULL)
+        return;
+
+    if (conn->socket != 0 && conn->context != 0) {
+        // drop the requests in flight
+        int linger = 0;
+        zmq_setsockopt(conn->socket, ZMQ_LINGER, &linger, sizeof(linger));
+        teardown_connection(conn->context, conn->socket);
+    }
+    free(conn->slots);
+
+    conn->socket = 0;
+    conn->context = 0;
+    conn->slots = NULL;
+    conn->max_inflight = 0;
+    conn->num_inflight = 0;
+    conn->free_slot = -1;
+}
+
 
 ////////////////////
 //  Request init  //
@@ -501,6 +569,78 @@ int set_get_read_size_request(request_t *req, char *filename, unsigned char name
     return 0;
 }
 
+int set_open_write_session_request(request_t *req, char *filename, char *storage_class, unsigned char namespace_id) {
+    if (request_t_init(req) != 0 || filename == NULL || storage_class == NULL)
+        return -1;
+
+    // name
+    _set_file_request(req, filename, namespace_id);
+    // storage class
+    req->file.storage_class.name = storage_class;
+    req->file.storage_class.length = strlen(storage_class);
+    req->opcode = OPEN_WRITE_SESSION_REQ;
+
+    return 0;
+}
+
+static int _set_session_request(request_t *req, unsigned long int session_id, int opcode) {
+    if (request_t_init(req) != 0)
+        return -1;
+
+    // the file is identified by the session
+    req->namespace_id = UNKNOWN_NAMESPACE_ID;
+    req->session_id = session_id;
+    req->opcode = opcode;
+
+    return 0;
+}
+
+int set_write_session_data_request(request_t *req, unsigned long int session_id, unsigned char *data, unsigned long int length) {
+    if ((data == NULL && length > 0) || _set_session_request(req, session_id, WRITE_SESSION_DATA_REQ) == -1)
+        return -1;
+
+    // data
+    req->file.data = data;
+    req->file.length = length;
+
+    return 0;
+}
+
+int set_commit_write_session_request(request_t *req, unsigned long int session_id) {
+    return _set_session_request(req, session_id, COMMIT_WRITE_SESSION_REQ);
+}
+
+int set_abort_write_session_request(request_t *req, unsigned long int session_id) {
+    return _set_session_request(req, session_id, ABORT_WRITE_SESSION_REQ);
+}
+
+int set_open_read_session_request(request_t *req, char *filename, unsigned char namespace_id) {
+    if (request_t_init(req) != 0 || filename == NULL)
+        return -1;
+
+    // name
+    _set_file_request(req, filename, namespace_id);
+    req->opcode = OPEN_READ_SESSION_REQ;
+
+    return 0;
+}
+
+int set_read_session_data_request(request_t *req, unsigned long int session_id, unsigned int num_stripes, unsigned char *data, unsigned long int length) {
+    if (num_stripes == 0 || (data != NULL && length == 0) || _set_session_request(req, session_id, READ_SESSION_DATA_REQ) == -1)
+        return -1;
+
+    req->num_stripes = num_stripes;
+    // buffer for data
+    req->file.data = data;
+    req->file.length = length;
+
+    return 0;
+}
+
+int set_close_read_session_request(request_t *req, unsigned long int session_id) {
+    return _set_session_request(req, session_id, CLOSE_READ_SESSION_REQ);
+}
+
 int set_get_agent_status_request(request_t *req) {
     if (request_t_init(req) != 0)
         return -1;
@@ -549,7 +689,11 @@ unsigned long int send_request(ncloud_conn_t *conn, request_t *req) {
     if (conn->socket == NULL || conn->context == NULL)
         return ULONG_MAX;
     // send the file request
-    int ret = issue_request(conn->socket, req->opcode, req->namespace_id, &req->file, &req->stats, &req->file_list, &req->agent_list, &req->proxy_status);
+    int ret = issue_request(conn->socket, req->opcode, req->namespace_id, &req->file, &req->stats, &req->file_list, &req->agent_list, &req->proxy_status, &req->session_id, req->num_stripes, &req->stripe_size);
+    return get_request_result(req, ret);
+}
+
+static unsigned long int get_request_result(request_t *req, int ret) {
     if (ret < 0) {
         log_error("Failed to complete the request on file %.*s\n", req->file.filename.length, req->file.filename.name);
         return ULONG_MAX;
@@ -561,7 +705,14 @@ unsigned long int send_request(ncloud_conn_t *conn, request_t *req) {
         (req->opcode == OVERWRITE_FILE_REQ && ret != OVERWRITE_FILE_REP_SUCCESS) ||
         (req->opcode == READ_FILE_RANGE_REQ && ret != READ_FILE_RANGE_REP_SUCCESS) ||
         (req->opcode == RENAME_FILE_REQ && ret != RENAME_FILE_REP_SUCCESS) ||
-        (req->opcode == COPY_FILE_REQ && ret != COPY_FILE_REP_SUCCESS)
+        (req->opcode == COPY_FILE_REQ && ret != COPY_FILE_REP_SUCCESS) ||
+        (req->opcode == OPEN_WRITE_SESSION_REQ && ret != OPEN_WRITE_SESSION_REP_SUCCESS) ||
+        (req->opcode == WRITE_SESSION_DATA_REQ && ret != WRITE_SESSION_DATA_REP_SUCCESS) ||
+        (req->opcode == COMMIT_WRITE_SESSION_REQ && ret != COMMIT_WRITE_SESSION_REP_SUCCESS) ||
+        (req->opcode == ABORT_WRITE_SESSION_REQ && ret != ABORT_WRITE_SESSION_REP_SUCCESS) ||
+        (req->opcode == OPEN_READ_SESSION_REQ && ret != OPEN_READ_SESSION_REP_SUCCESS) ||
+        (req->opcode == READ_SESSION_DATA_REQ && ret != READ_SESSION_DATA_REP_SUCCESS) ||
+        (req->opcode == CLOSE_READ_SESSION_REQ && ret != CLOSE_READ_SESSION_REP_SUCCESS)
     ) {
         log_error("Failed to operate on file %.*s\n", req->file.filename.length, req->file.filename.name);
         return ULONG_MAX;
@@ -570,7 +721,159 @@ unsigned long int send_request(ncloud_conn_t *conn, request_t *req) {
     return req->file.size;
 }
 
-static int setup_connection(const char *ip, unsigned short port, void **context, void **socket) {
+unsigned long int read_file_stream(ncloud_conn_t *conn, char *filename, unsigned char namespace_id, unsigned int num_stripes, read_stream_callback_t callback, void *arg) {
+    request_t req;
+
+    if (callback == NULL || num_stripes == 0 || set_open_read_session_request(&req, filename, namespace_id) != 0)
+        return ULONG_MAX;
+
+    // open the session
+    unsigned long int file_size = send_request(conn, &req);
+    unsigned long int session_id = req.session_id;
+    unsigned long int stripe_size = req.stripe_size;
+    request_t_release(&req);
+    if (file_size == ULONG_MAX)
+        return ULONG_MAX;
+
+    // reuse one buffer for all replies, such that the memory used is bounded by the credits instead of the file size
+    unsigned long int buf_size = stripe_size * num_stripes;
+    unsigned char *buf = buf_size > 0? (unsigned char *) malloc (buf_size) : NULL;
+    int okay = buf_size == 0 || buf != NULL;
+    if (!okay)
+        log_error("Failed to allocate memory for stream read of file %s\n", filename);
+
+    unsigned long int received = 0;
+    while (okay && received < file_size) {
+        if (set_read_session_data_request(&req, session_id, num_stripes, buf, buf_size) != 0)
+            break;
+        unsigned long int length = send_request(conn, &req);
+        // the data must come in order, and end only at the end of file
+        okay = length != ULONG_MAX && length > 0 && req.file.offset == received;
+        // hand over the data stripe-by-stripe
+        for (unsigned long int pos = 0; okay && pos < length; pos += stripe_size) {
+            unsigned long int slice = length - pos < stripe_size? length - pos : stripe_size;
+            okay = callback(buf + pos, received + pos, slice, arg) == 0;
+        }
+        if (okay)
+            received += length;
+        request_t_release(&req);
+    }
+    free(buf);
+
+    // close the session
+    if (set_close_read_session_request(&req, session_id) == 0)
+        send_request(conn, &req);
+    request_t_release(&req);
+
+    return okay && received == file_size? received : ULONG_MAX;
+}
+
+int submit_request(ncloud_async_conn_t *conn, request_t *req, unsigned long int tag, request_callback_t callback, void *arg) {
+    if (conn == NULL || req == NULL || conn->socket == NULL || conn->context == NULL)
+        return -1;
+    if (conn->free_slot == -1) {
+        log_error("Failed to submit request, %u requests in flight already\n", conn->num_inflight);
+        return -1;
+    }
+
+    // envelope: the slot to match the reply with the request, then the empty delimiter
+    int slot = conn->free_slot;
+    if (zmq_send(conn->socket, &slot, sizeof(slot), ZMQ_SNDMORE) != sizeof(slot) || zmq_send(conn->socket, "", 0, ZMQ_SNDMORE) != 0) {
+        log_error("Failed to send the request envelope, err = %d\n", errno);
+        return -1;
+    }
+    if (send_request_frames(conn->socket, req->opcode, req->namespace_id, &req->file, &req->stats, &req->file_list, &req->agent_list, &req->proxy_status, &req->session_id, req->num_stripes, &req->stripe_size) != 0) {
+        log_error("Failed to submit the request on file %.*s\n", req->file.filename.length, req->file.filename.name);
+        return -1;
+    }
+
+    // occupy the slot
+    async_request_slot_t *s = &conn->slots[slot];
+    conn->free_slot = s->next_free;
+    s->tag = tag;
+    s->request = req;
+    s->callback = callback;
+    s->arg = arg;
+    conn->num_inflight++;
+
+    return 0;
+}
+
+int poll_requests(ncloud_async_conn_t *conn, long timeout, request_completion_t *completions, int max_completions) {
+    if (conn == NULL || conn->socket == NULL || conn->context == NULL || max_completions <= 0)
+        return -1;
+
+    int num_completed = 0;
+    while (num_completed < max_completions && conn->num_inflight > 0) {
+        // wait for the first reply only
+        zmq_pollitem_t item = { conn->socket, 0, ZMQ_POLLIN, 0 };
+        int ret = zmq_poll(&item, 1, num_completed == 0? timeout : 0);
+        if (ret < 0) {
+            log_error("Failed to poll for replies, err = %d\n", errno);
+            return num_completed > 0? num_completed : -1;
+        } else if (ret == 0) {
+            break;
+        }
+
+        // envelope: the slot of the request, then the empty delimiter
+        int slot = -1;
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        if (zmq_msg_recv(&msg, conn->socket, 0) == sizeof(slot))
+            memcpy(&slot, zmq_msg_data(&msg), sizeof(slot));
+        if (zmq_msg_more(&msg)) {
+            zmq_msg_close(&msg);
+            zmq_msg_init(&msg);
+            zmq_msg_recv(&msg, conn->socket, 0);
+        }
+        zmq_msg_close(&msg);
+        if (slot < 0 || slot >= (int) conn->max_inflight || conn->slots[slot].request == NULL) {
+            log_error("Drop a reply of unknown request in slot %d\n", slot);
+            drain_reply(conn->socket);
+            continue;
+        }
+
+        // the reply
+        async_request_slot_t *s = &conn->slots[slot];
+        request_t *req = s->request;
+        ret = recv_reply_frames(conn->socket, req->opcode, req->namespace_id, &req->file, &req->stats, &req->file_list, &req->agent_list, &req->proxy_status, &req->session_id, req->num_stripes, &req->stripe_size);
+        drain_reply(conn->socket);
+        unsigned long int result = get_request_result(req, ret);
+
+        // free the slot before completion, such that the callback can submit another request
+        unsigned long int tag = s->tag;
+        request_callback_t callback = s->callback;
+        void *arg = s->arg;
+        s->request = NULL;
+        s->next_free = conn->free_slot;
+        conn->free_slot = slot;
+        conn->num_inflight--;
+
+        if (callback != NULL)
+            callback(tag, req, result, arg);
+        if (completions != NULL) {
+            completions[num_completed].tag = tag;
+            completions[num_completed].request = req;
+            completions[num_completed].result = result;
+        }
+        num_completed++;
+    }
+
+    return num_completed;
+}
+
+static void drain_reply(void *socket) {
+    int more = 0;
+    size_t more_size = sizeof(more);
+    while (zmq_getsockopt(socket, ZMQ_RCVMORE, &more, &more_size) == 0 && more) {
+        zmq_msg_t msg;
+        zmq_msg_init(&msg);
+        zmq_msg_recv(&msg, socket, 0);
+        zmq_msg_close(&msg);
+    }
+}
+
+static int setup_connection(const char *ip, unsigned short port, int type, void **context, void **socket) {
     // new zmq context
     log_info("Create new context\n");
     *context = zmq_ctx_new();
@@ -580,7 +883,7 @@ static int setup_connection(const char *ip, unsigned short port, void **context,
     }
     log_info("Create new socket\n");
     // new zmq socket
-    *socket = zmq_socket(*context, ZMQ_REQ);
+    *socket = zmq_socket(*context, type);
     if (socket == NULL) {
         log_error("Failed to create a new zero-mq socket, err = %d\n", errno);
         zmq_ctx_destroy(*context);
@@ -608,7 +911,13 @@ static int teardown_connection(void *context, void *socket) {
     zmq_ctx_destroy(context);
 }
 
-static int issue_request(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus) {
+static int issue_request(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus, unsigned long int *session_id, unsigned int num_stripes, unsigned long int *stripe_size) {
+    if (send_request_frames(socket, opcode, namespace_id, file, stats, flist, alist, pstatus, session_id, num_stripes, stripe_size) != 0)
+        return -1;
+    return recv_reply_frames(socket, opcode, namespace_id, file, stats, flist, alist, pstatus, session_id, num_stripes, stripe_size);
+}
+
+static int send_request_frames(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus, unsigned long int *session_id, unsigned int num_stripes, unsigned long int *stripe_size) {
 
 #define send_field(_FIELD_, _FLAG_) (zmq_send(socket, _FIELD_, msg_length, _FLAG_) == msg_length)
 
@@ -618,7 +927,9 @@ static int issue_request(void *socket, int opcode, unsigned char namespace_id, f
         (opcode == GET_CAPACITY_REQ && stats == NULL) ||
         (opcode == GET_FILE_LIST_REQ && flist == NULL && file == NULL) ||
         (opcode == GET_AGENT_STATUS_REQ && alist == NULL) ||
-        (opcode == GET_PROXY_STATUS_REQ && pstatus == NULL)
+        (opcode == GET_PROXY_STATUS_REQ && pstatus == NULL) ||
+        ((opcode == OPEN_WRITE_SESSION_REQ || opcode == OPEN_READ_SESSION_REQ || has_session_id(opcode)) && session_id == NULL) ||
+        (opcode == OPEN_READ_SESSION_REQ && stripe_size == NULL)
     ) {
         return -1;
     }
@@ -650,7 +961,7 @@ static int issue_request(void *socket, int opcode, unsigned char namespace_id, f
                 return -1;
             }
             log_info("Send file storage class = %s\n", file->storage_class.name);
-        } else if (opcode == GET_READ_SIZE_REQ || opcode == GET_FILE_LIST_REQ) {
+        } else if (opcode == GET_READ_SIZE_REQ || opcode == GET_FILE_LIST_REQ || opcode == OPEN_READ_SESSION_REQ) {
             // send file name, or file prefix
             msg_length = file->filename.length;
             if (!send_field(file->filename.name, 0)) {
@@ -658,6 +969,56 @@ static int issue_request(void *socket, int opcode, unsigned char namespace_id, f
                 return -1;
             }
             log_info("Send file name = %s\n", file->filename.name);
+        } else if (opcode == OPEN_WRITE_SESSION_REQ) {
+            // send file name
+            msg_length = file->filename.length;
+            if (!send_field(file->filename.name, ZMQ_SNDMORE)) {
+                log_error("Failed to send the request file name, err = %d\n", errno);
+                return -1;
+            }
+            log_info("Send file name = %s\n", file->filename.name);
+            // send file storage class
+            msg_length = file->storage_class.length;
+            if (!send_field(file->storage_class.name, 0)) {
+                log_error("Failed to send the request file storage class, err = %d\n", errno);
+                return -1;
+            }
+            log_info("Send file storage class = %s\n", file->storage_class.name);
+        } else if (has_session_id(opcode)) {
+            // send session id
+            msg_length = sizeof(*session_id);
+            if (!send_field(session_id, opcode == WRITE_SESSION_DATA_REQ || opcode == READ_SESSION_DATA_REQ? ZMQ_SNDMORE : 0)) {
+                log_error("Failed to send the request session id, err = %d\n", errno);
+                return -1;
+            }
+            log_info("Send session id = %lu\n", *session_id);
+            if (opcode == READ_SESSION_DATA_REQ) {
+                // send the max. number of stripes to read
+                msg_length = sizeof(num_stripes);
+                if (!send_field(&num_stripes, 0)) {
+                    log_error("Failed to send the request number of stripes, err = %d\n", errno);
+                    return -1;
+                }
+                log_info("Send number of stripes = %u\n", num_stripes);
+            }
+            if (opcode == WRITE_SESSION_DATA_REQ) {
+                // send data length
+                msg_length = sizeof(file->length);
+                if (!send_field(&file->length, file->length > 0? ZMQ_SNDMORE : 0)) {
+                    log_error("Failed to send the request data length, err = %d\n", errno);
+                    return -1;
+                }
+                log_info("Send data length = %lu\n", file->length);
+                // send data
+                if (file->length > 0) {
+                    msg_length = file->length;
+                    if (!send_field(file->data, 0)) {
+                        log_error("Failed to send the request data, err = %d\n", errno);
+                        return -1;
+                    }
+                    log_info("Send data of size %lu\n", file->length);
+                }
+            }
         } else {
             // send file name
             msg_length = file->filename.length;
@@ -723,6 +1084,11 @@ static int issue_request(void *socket, int opcode, unsigned char namespace_id, f
 
 #undef send_field
 
+    return 0;
+}
+
+static int recv_reply_frames(void *socket, int opcode, unsigned char namespace_id, file_t *file, sys_stats_t *stats, file_list_head_t *flist, agent_info_head_t *alist, sysinfo_t *pstatus, unsigned long int *session_id, unsigned int num_stripes, unsigned long int *stripe_size) {
+
 #define get_new_msg() \
     do { \
         zmq_msg_close(&msg); \
@@ -875,10 +1241,64 @@ static int issue_request(void *socket, int opcode, unsigned char namespace_id, f
         get_field(&file->length);
     } else if (
             reply_opcode == APPEND_FILE_REP_SUCCESS ||
-            reply_opcode == OVERWRITE_FILE_REP_SUCCESS
+            reply_opcode == OVERWRITE_FILE_REP_SUCCESS ||
+            reply_opcode == WRITE_SESSION_DATA_REP_SUCCESS ||
+            reply_opcode == COMMIT_WRITE_SESSION_REP_SUCCESS
     ) {
         check_more_msg();
         get_field(&file->size);
+    } else if (reply_opcode == OPEN_WRITE_SESSION_REP_SUCCESS) {
+        check_more_msg();
+        get_field(session_id);
+    } else if (reply_opcode == OPEN_READ_SESSION_REP_SUCCESS) {
+        // session id
+        check_more_msg();
+        get_field(session_id);
+        // file size
+        check_more_msg();
+        get_field(&file->size);
+        // stripe size
+        check_more_msg();
+        get_field(stripe_size);
+    } else if (reply_opcode == READ_SESSION_DATA_REP_SUCCESS) {
+        unsigned long int osize = file->size;
+
+        // file offset
+        check_more_msg();
+        get_field(&file->offset);
+        // data size
+        check_more_msg();
+        get_field(&file->size);
+
+        if (file->size > 0) {
+            // use the input buffer if provided and the size is large enough
+            if (file->data && file->size > osize) {
+                log_error("Failed to get data, the buffer provided is too small (%ld vs %ld)\n", osize, file->size);
+                zmq_msg_close(&msg);
+                return -1;
+            } else if (!file->data) {
+                file->data = (unsigned char *) malloc (file->size);
+                if (file->data == 0) {
+                    log_error("Failed to allocate memory for stripe data\n");
+                    zmq_msg_close(&msg);
+                    return -1;
+                }
+                file->free_data = 1;
+            }
+            // get the data, one frame per stripe
+            unsigned long int rb = 0;
+            while (rb < file->size) {
+                check_more_msg();
+                get_new_msg();
+                if (rb + zmq_msg_size(&msg) > file->size) {
+                    log_error("Failed to get data, more data than expected (%ld vs %ld)\n", rb + zmq_msg_size(&msg), file->size);
+                    zmq_msg_close(&msg);
+                    return -1;
+                }
+                memcpy(file->data + rb, zmq_msg_data(&msg), zmq_msg_size(&msg));
+                rb += zmq_msg_size(&msg);
+            }
+        }
     } else if (reply_opcode == GET_AGENT_STATUS_REP_SUCCESS) {
         // get the number of agents
         check_more_msg();
@@ -1048,3 +1468,13 @@ static int has_offset(int opcode) {
         opcode == COPY_FILE_REQ
     );
 }
+
+static int has_session_id(int opcode) {
+    return (
+        opcode == WRITE_SESSION_DATA_REQ ||
+        opcode == COMMIT_WRITE_SESSION_REQ ||
+        opcode == ABORT_WRITE_SESSION_REQ ||
+        opcode == READ_SESSION_DATA_REQ ||
+        opcode == CLOSE_READ_SESSION_REQ
+    );
+}
@@ -94,13 +94,60 @@ typedef struct {
     file_list_head_t file_list;   /**< file list */
     agent_info_head_t agent_list; /**< agent list */
     sysinfo_t proxy_status;       /**< proxy status */
+    unsigned long int session_id; /**< session id (for streaming write and read) */
+    unsigned long int stripe_size;/**< size of data in each stripe (for streaming read) */
+    unsigned int num_stripes;     /**< max. number of stripes to get in one reply (for streaming read) */
 } request_t;
 
+/**
+ * Callback on each stripe of data in a streaming read
+ *
+ * @param[in] data            the stripe data, only valid until the callback returns
+ * @param[in] offset          file offset of the data
+ * @param[in] length          length of the data
+ * @param[in] arg             argument passed to read_file_stream()
+ * @return 0 to continue, non-zero to stop the read
+ **/
+typedef int (*read_stream_callback_t)(const unsigned char *data, unsigned long int offset, unsigned long int length, void *arg);
+
 typedef struct {
     void *socket;
     void *context;
 } ncloud_conn_t;
 
+/**
+ * Callback on the completion of an asynchronous request
+ *
+ * @param[in] tag             tag of the request given on submission
+ * @param[in] request         the request completed, with the fields set by response
+ * @param[in] result          ULONG_MAX if failed, the same value as send_request() returns otherwise
+ * @param[in] arg             argument given on submission
+ **/
+typedef void (*request_callback_t)(unsigned long int tag, request_t *request, unsigned long int result, void *arg);
+
+typedef struct {
+    unsigned long int tag;        /**< tag of the request */
+    request_t *request;           /**< the request completed */
+    unsigned long int result;     /**< ULONG_MAX if failed, the same value as send_request() returns otherwise */
+} request_completion_t;
+
+typedef struct {
+    unsigned long int tag;        /**< tag of the request */
+    request_t *request;           /**< the request in flight, NULL if the slot is free */
+    request_callback_t callback;  /**< callback on completion, NULL to report the completion on poll */
+    void *arg;                    /**< argument to the callback */
+    int next_free;                /**< next free slot, -1 if none */
+} async_request_slot_t;
+
+typedef struct {
+    void *socket;
+    void *context;
+    async_request_slot_t *slots;  /**< slots of requests in flight */
+    unsigned int max_inflight;    /**< max. number of requests in flight */
+    unsigned int num_inflight;    /**< number of requests in flight */
+    int free_slot;                /**< first free slot, -1 if none */
+} ncloud_async_conn_t;
+
 // name init and release helpers
 int name_t_init(name_t *name);
 void name_t_release(name_t *name);
@@ -163,13 +210,86 @@ int set_file_copy_request(request_t *req, char *src_filename, char *dst_filename
 int set_get_append_size_request(request_t *req, char *storage_class);
 int set_get_read_size_request(request_t *req, char *filename, unsigned char namespace_id);
 
+// file (data) operations: streaming write
+// open a session (session_id is set on reply), send the data in segments of at most the proxy's max_segment_size in order, and then commit (or abort) the session
+// the file is written stripe-by-stripe as the data arrives, without buffering the whole file at proxy
+int set_open_write_session_request(request_t *req, char *filename, char *storage_class, unsigned char namespace_id);
+int set_write_session_data_request(request_t *req, unsigned long int session_id, unsigned char *data, unsigned long int length);
+int set_commit_write_session_request(request_t *req, unsigned long int session_id);
+int set_abort_write_session_request(request_t *req, unsigned long int session_id);
+
+// file (data) operations: streaming read
+// open a session (session_id, file size and stripe_size are set on reply), get the data of at most num_stripes stripes in order at a time until no more data is returned, and then close the session
+// data is read into the buffer provided (or allocated if data is NULL), which must hold num_stripes stripes, and one frame is sent for each stripe as soon as it is decoded at proxy
+int set_open_read_session_request(request_t *req, char *filename, unsigned char namespace_id);
+int set_read_session_data_request(request_t *req, unsigned long int session_id, unsigned int num_stripes, unsigned char *data, unsigned long int length);
+int set_close_read_session_request(request_t *req, unsigned long int session_id);
 /**
  * Send a request to Proxy and wait for reply
  *
  * @param[in] conn            the connection properly init by the ncloud_conn_t_init()
  * @param[in] request         the request properly init by the set_*_request()
- * @return ULONG_MAX if failed, size field set by response on success 
+ * @return ULONG_MAX if failed, size field set by response on success (the number of bytes accepted so far for write session data, the file size for write session commit and read session open, and the number of bytes returned for read session data)
  **/
 unsigned long int send_request(ncloud_conn_t *conn, request_t *request);
 
+/**
+ * Read a file from Proxy as a stream of stripes, with at most num_stripes stripes buffered at client (and at proxy for the reply) at a time
+ *
+ * @param[in] conn            the connection properly init by the ncloud_conn_t_init()
+ * @param[in] filename        name of the file to read
+ * @param[in] namespace_id    namespace id of the file
+ * @param[in] num_stripes     max. number of stripes to get in one reply, i.e., the credits of the stream
+ * @param[in] callback        callback on each stripe of data, in the order of file offset
+ * @param[in] arg             argument to pass to the callback
+ * @return ULONG_MAX if failed or stopped by the callback, the number of bytes read otherwise
+ **/
+unsigned long int read_file_stream(ncloud_conn_t *conn, char *filename, unsigned char namespace_id, unsigned int num_stripes, read_stream_callback_t callback, void *arg);
+
+// asynchronous requests: submit many requests over one connection, and complete them on poll in the order the replies arrive
+// the request (and its data buffers) must remain valid until completion, and requests on the same write or read session must not be in flight together
+
+/**
+ * Init an asynchronous connection to Proxy
+ *
+ * @param[in] ip              Proxy IP
+ * @param[in] port            Proxy port of the ZeroMQ interface
+ * @param[out] conn           the connection
+ * @param[in] max_inflight    max. number of requests in flight over the connection
+ * @return 0 on success, -1 otherwise
+ **/
+int ncloud_async_conn_t_init(const char *ip, unsigned short port, ncloud_async_conn_t *conn, unsigned int max_inflight);
+
+/**
+ * Release an asynchronous connection, dropping the requests in flight without completing them
+ *
+ * @param[in] conn            the connection
+ **/
+void ncloud_async_conn_t_release(ncloud_async_conn_t *conn);
+
+/**
+ * Send a request to Proxy without waiting for reply
+ *
+ * @param[in] conn            the connection properly init by the ncloud_async_conn_t_init()
+ * @param[in] request         the request properly init by the set_*_request()
+ * @param[in] tag             tag to identify the request on completion
+ * @param[in] callback        callback on completion, NULL to report the completion on poll_requests() instead
+ * @param[in] arg             argument to pass to the callback
+ * @return 0 on success, -1 if failed or the max. number of requests are in flight
+ **/
+int submit_request(ncloud_async_conn_t *conn, request_t *request, unsigned long int tag, request_callback_t callback, void *arg);
+
+/**
+ * Complete the requests with replies from Proxy
+ *
+ * Callbacks are invoked for requests submitted with a callback, and the completion of other requests are reported in the completion array
+ *
+ * @param[in] conn            the connection properly init by the ncloud_async_conn_t_init()
+ * @param[in] timeout         max. time in milliseconds to wait for the first reply, -1 to wait until a reply arrives
+ * @param[out] completions    completions of requests submitted without a callback
+ * @param[in] max_completions max. number of requests to complete
+ * @return number of requests completed, -1 if failed
+ **/
+int poll_requests(ncloud_async_conn_t *conn, long timeout, request_completion_t *completions, int max_completions);
+
 #endif //define __PROXY_ZMQ_INT_H__
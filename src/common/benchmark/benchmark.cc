@@ -390,6 +390,7 @@ std::map<std::string, double>* BMWrite::calcStats() {
         double networkTime = 0.0;
         double encodeTime = 0.0;
         double replyCheckTime = 0.0;
+        double encodeNetworkOverlap = 0.0;
         double tmp = 0.0;
         std::vector<double> agentProcessVec(_numAgents, 0.0);
         std::vector<double> networkRTVec(_numAgents, 0.0);
@@ -418,6 +419,9 @@ std::map<std::string, double>* BMWrite::calcStats() {
             encodeTime += bmStripe.encode.usedTime();
             replyCheckTime += bmStripe.replyCheck.usedTime();
             tmp += bmStripe.temp.usedTime();
+            // encoding of a stripe overlapped with the chunk transfer of the previous stripe (pipelined write)
+            if (i > 0)
+                encodeNetworkOverlap += Benchmark::findOverlap(bmStripe.encode, this->at(i - 1).networkRT);
 
             for (int j = 0; j < _numAgents; j++) {
                 networkRTAgents.at(j).at(i) = bmStripe.network->at(j);
@@ -517,6 +521,7 @@ std::map<std::string, double>* BMWrite::calcStats() {
         tvMap->insert(std::pair<std::string, double>("Agg. time - encode", encodeTime));
         tvMap->insert(std::pair<std::string, double>("Agg. time - network", networkTime));
         tvMap->insert(std::pair<std::string, double>("Agg. time - replyCheck", replyCheckTime));
+        tvMap->insert(std::pair<std::string, double>("Agg. time - encode-network overlap", encodeNetworkOverlap));
         tvMap->insert(std::pair<std::string, double>("Agg. time - overall", overallTime));
         tvMap->insert(std::pair<std::string, double>("Total time - metadata", updateMeta.usedTime()));
     }
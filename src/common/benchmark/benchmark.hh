@@ -443,6 +443,19 @@ public:
         return gap.getEnd() - gap.getStart();
     }
 
+    /**
+     * get the overlapping time of two events
+     * 
+     * @param a: TagPt of the first event
+     * @param b: TagPt of the second event
+     * @return double: overlapping time in seconds, 0 if the events do not overlap
+     */
+    static inline double findOverlap(const TagPt &a, const TagPt &b) {
+        const TimeVal &start = a.getStart_const() > b.getStart_const() ? a.getStart_const() : b.getStart_const();
+        const TimeVal &end = a.getEnd_const() < b.getEnd_const() ? a.getEnd_const() : b.getEnd_const();
+        return end > start ? (end - start).sec() : 0.0;
+    }
+
     static int vecTime2SpeedWithOverlap(std::vector<double> **dst, std::vector<TagPt> *src1, std::vector<TagPt> *src2, unsigned long int size) {
         if (src1->size() != src2->size()) {
             LOG(ERROR) << "vector size mismatch";
@@ -11,6 +11,12 @@
 #include <boost/algorithm/hex.hpp>
 #include <boost/algorithm/string.hpp>
 
+extern "C" {
+#include <isa-l/crc.h>
+}
+
+#include "define.hh"
+
 // alias new APIs for OpenSSL 1.1.0 below
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
 #define EVP_MD_CTX_new         EVP_MD_CTX_create
@@ -35,11 +41,11 @@ public:
         EVP_DigestInit_ex(_mdctx, _md, NULL);
     }
 
-    ~ChecksumCalculator() {
+    virtual ~ChecksumCalculator() {
         EVP_MD_CTX_free(_mdctx);
     }
 
-    bool appendData(const unsigned char *data, const size_t length) {
+    virtual bool appendData(const unsigned char *data, const size_t length) {
         bool okay = false;
 
         // do not allow data append once finalized
@@ -53,7 +59,7 @@ public:
         return okay;
     }
 
-    bool finalize(unsigned char *digest, unsigned int &length) {
+    virtual bool finalize(unsigned char *digest, unsigned int &length) {
         bool okay = false;
 
         if (length < (unsigned int) getDigestSize())
@@ -83,11 +89,11 @@ public:
         return _finalized;
     }
 
-    std::string getType() {
+    virtual std::string getType() {
         return OBJ_nid2sn(EVP_MD_type(_md));
     }
 
-    int getDigestSize() {
+    virtual int getDigestSize() {
         return EVP_MD_size(_md);
     }
 
@@ -139,4 +145,76 @@ public:
     }
 };
 
+#define CRC32C_DIGEST_LENGTH (4)
+
+/**
+ * CRC32C (Castagnoli) using ISA-L, which picks the SSE4.2 crc32 instruction when available
+ *
+ * The digest is the CRC in big-endian, i.e., the byte order of the hex representation.
+ **/
+class CRC32CCalculator : public ChecksumCalculator {
+public:
+    CRC32CCalculator() {
+        _crc = 0xFFFFFFFF;
+    }
+
+    bool appendData(const unsigned char *data, const size_t length) {
+        if (isFinalized())
+            return false;
+
+        pthread_mutex_lock(&_lock);
+        _crc = crc32_iscsi((unsigned char *) data, (int) length, _crc);
+        pthread_mutex_unlock(&_lock);
+
+        return true;
+    }
+
+    bool finalize(unsigned char *digest, unsigned int &length) {
+        if (length < (unsigned int) getDigestSize())
+            return false;
+
+        pthread_mutex_lock(&_lock);
+        uint32_t crc = ~_crc;
+        for (int i = 0; i < CRC32C_DIGEST_LENGTH; i++)
+            digest[i] = (crc >> (8 * (CRC32C_DIGEST_LENGTH - 1 - i))) & 0xFF;
+        length = CRC32C_DIGEST_LENGTH;
+        _finalized = true;
+        pthread_mutex_unlock(&_lock);
+
+        return true;
+    }
+
+    std::string getType() {
+        return "crc32c";
+    }
+
+    int getDigestSize() {
+        return CRC32C_DIGEST_LENGTH;
+    }
+
+protected:
+    uint32_t _crc;
+};
+
+class ChecksumCalculatorGenerator {
+public:
+
+    /**
+     * Generate a checksum calculator of a checksum type
+     *
+     * @param[in] checksumType  checksum type, see ChecksumType
+     *
+     * @return a new checksum calculator, or NULL if the type is unknown; the caller should delete the calculator after use
+     **/
+    static ChecksumCalculator *genCalculator(int checksumType) {
+        switch (checksumType) {
+        case ChecksumType::CHECKSUM_MD5:
+            return new MD5Calculator();
+        case ChecksumType::CHECKSUM_CRC32C:
+            return new CRC32CCalculator();
+        }
+        return NULL;
+    }
+};
+
 #endif //define __CHECKSUM_CALCULATOR_HH__
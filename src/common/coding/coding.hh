@@ -3,8 +3,12 @@
 #ifndef __CODING_HH__
 #define __CODING_HH__
 
+#include <memory>
 #include <string>
 #include <vector>
+
+#include <glog/logging.h>
+
 #include "../define.hh"
 #include "../../ds/chunk.hh"
 #include "coding_options.hh"
@@ -120,6 +124,24 @@ public:
         return _storeCodeChunksOnly;
     }
 
+    /**
+     * Tell whether the data chunks are stored as is, i.e., the code is systematic
+     *
+     * @return whether the data chunks are stored as is
+     **/
+    bool isSystematic() {
+        return _systematic;
+    }
+
+    /**
+     * Tell whether the code chunks can be updated with the changes to data chunks, without re-encoding the stripe
+     *
+     * @return whether the code chunks can be updated with data changes
+     **/
+    bool supportsDeltaUpdate() {
+        return _deltaUpdate;
+    }
+
 
     // ------------------------ //
     //  Pre-coding preparation  //
@@ -136,7 +158,7 @@ public:
      * Get list of chunks to retrieve for decode/repair
      *
      * @param[in] failedChunkIdx         ids of failed chunks
-     * @param[out] plan                  decoding plan; the coding implementation should set the ids of the set of input chunks, and the minimal number of chunks to retrieve for decoding. Optionally, the implementation can set the repair matrix for CAR repair
+     * @param[out] plan                  decoding plan; the coding implementation should set the ids of the set of input chunks, and the minimal number of chunks to retrieve for decoding. Optionally, the implementation can set the repair matrix for CAR repair (or repair at agents), and the sub-chunks needed from each input chunk
      * @param[in,out] codingState        coding state; caller should pass in the last obtained/updated coding state
      * @param[in] isRepair               whether the decoding is for repair; the coding implementation should give the plan for decoding the data chunks if this is set to 'false', and that for decoding the failed chunks if this is set to 'true'
      *
@@ -156,15 +178,18 @@ public:
      * @param[in] dataSize               size of the buffered data
      * @param[out] stripe                chunks in the stripe; the coding implementation should set the chunk id (using Chunk::setChunkId()) and data for all chunks
      * @param[out] codingState           a pointer to the placeholder of coding state; the coding state, if any, will be allocated by the function
+     * @param[in] shadowDataChunks       whether the data chunks may reference the data buffer instead of holding a copy of data (only for systematic codes); the caller must then keep the data buffer until the chunks are released
+     * @param[in] computeChecksums       whether to compute the checksums (Chunk::checksum) of all chunks along with encoding, while the chunk data is still in the cache
+     * @param[in] checksumType           type of the checksums to compute, see ChecksumType
      *
      * @return if data is successfully encoded 
      **/
-    virtual bool encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState) = 0;
+    virtual bool encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks = false, bool computeChecksums = false, int checksumType = ChecksumType::CHECKSUM_MD5) = 0;
 
     /**
      * Decode data chunks using input chunks
      *
-     * @param[in] inputChunks            input chunk buffers
+     * @param[in] inputChunks            input chunk buffers, holding only the sub-chunks needed if the plan specifies them
      * @param[out] decodedData           pointer placeholder for storing decoded data, buffer will be allocated by the function; if the pointer is null, new buffer is allocated; otherwise, the function reuse the provided buffer (i.e., caller should ensure the buffer is sufficient large to hold the decoded data
      * @param[out] decodedSize           size of the decoded data
      * @param[in] plan                   decoding plan obtained from preDecode()
@@ -176,15 +201,72 @@ public:
      **/
     virtual bool decode(std::vector<Chunk> &inputChunks, data_t **decodedData, length_t &decodedSize, DecodingPlan &plan, data_t *codingState, bool isRepair = false, std::vector<chunk_id_t> repairTargets = std::vector<chunk_id_t>()) = 0;
 
+    /**
+     * Compute the changes to code chunks from the changes to some data chunks (for coding schemes that support delta update)
+     *
+     * @param[in] dataDeltas             changes to data chunks, i.e., XOR of the old and new data; the chunk ids tell which data chunks are changed, and all chunks should be of the same size
+     * @param[out] codeDeltas            changes to code chunks, to be XOR-ed to the stored code chunks; the coding implementation should set the chunk id (using Chunk::setChunkId()) and data for all code chunks
+     *
+     * @return if the changes to code chunks are computed
+     **/
+    virtual bool encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas) {
+        return false;
+    }
+
 
 protected:
     Coding() {
         _extraDataSize = 0;
         _modifyDataBuffer = false;
         _storeCodeChunksOnly = false;
+        _systematic = false;
+        _deltaUpdate = false;
+    }
+
+    /**
+     * Create the checksums for the chunks in a stripe
+     *
+     * @param[in] checksumType           checksum type, see ChecksumType
+     * @param[in] numChunks              number of chunks in the stripe
+     * @param[out] checksums             checksums of the chunks
+     *
+     * @return if the checksums are created
+     **/
+    bool createChecksums(int checksumType, num_t numChunks, std::vector<std::unique_ptr<ChecksumCalculator> > &checksums) {
+        checksums.clear();
+        for (num_t i = 0; i < numChunks; i++) {
+            checksums.emplace_back(ChecksumCalculatorGenerator::genCalculator(checksumType));
+            if (checksums.back() == nullptr) {
+                LOG(ERROR) << "Unknown checksum type " << checksumType;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Finalize the checksums of the chunks in a stripe into the chunks
+     *
+     * @param[in] checksums              checksums of the chunks, in the order of the chunks in the stripe
+     * @param[in] checksumType           checksum type, see ChecksumType
+     * @param[out] stripe                chunks in the stripe
+     *
+     * @return if all checksums are finalized
+     **/
+    bool setChecksums(std::vector<std::unique_ptr<ChecksumCalculator> > &checksums, int checksumType, std::vector<Chunk> &stripe) {
+        bool okay = checksums.size() == stripe.size();
+        for (size_t i = 0; i < stripe.size() && okay; i++) {
+            unsigned int length = CHUNK_CHECKSUM_MAX_LEN;
+            stripe.at(i).resetChecksum();
+            stripe.at(i).checksumType = checksumType;
+            okay = checksums.at(i)->finalize(stripe.at(i).checksum, length);
+        }
+        return okay;
     }
 
     bool _storeCodeChunksOnly;
+    bool _systematic;
+    bool _deltaUpdate;
     bool _modifyDataBuffer;
     length_t _extraDataSize;
 
@@ -15,6 +15,10 @@ public:
             switch (codingScheme) {
             case CodingScheme::RS:
                 return new RSCode(options);
+            case CodingScheme::LRC:
+                return new LRCCode(options);
+            case CodingScheme::HITCHHIKER:
+                return new HitchhikerCode(options);
             }
         } catch (std::exception &e) {
             LOG(ERROR) << "Failed to init coding, " << e.what();
@@ -3,10 +3,15 @@
 #ifndef __CODING_UTIL_HH__
 #define __CODING_UTIL_HH__
 
+#include <memory>
+
 extern "C" {
 #include <isa-l/erasure_code.h>
 }
 
+#include "decoding_table_cache.hh"
+#include "parallel_coding.hh"
+
 class CodingUtils {
 public:
     static bool encode(unsigned char *data, int numDataChunks, unsigned char *code, int numCodeChunks, int chunkSize, unsigned char *matrix) {
@@ -16,19 +21,42 @@ public:
         for (int i = 0; i < numCodeChunks; i++)
             codep[i] = (unsigned char *) code + i * chunkSize;
 
-        uint8_t gftbl[numDataChunks * numCodeChunks * 32];
-        ec_init_tables(numDataChunks, numCodeChunks, matrix, gftbl);
-        ec_encode_data(chunkSize, numDataChunks, numCodeChunks, gftbl, datap, codep);
-
-        return true;
+        return encode(datap, numDataChunks, codep, numCodeChunks, chunkSize, matrix);
     }
     static bool encode(unsigned char **data, int numDataChunks, unsigned char **code, int numCodeChunks, int chunkSize, unsigned char *matrix) {
-        uint8_t gftbl[numDataChunks * numCodeChunks * 32];
-        ec_init_tables(numDataChunks, numCodeChunks, matrix, gftbl);
-        ec_encode_data(chunkSize, numDataChunks, numCodeChunks, gftbl, data, code);
+        if (numDataChunks <= 0 || numCodeChunks <= 0 || matrix == NULL)
+            return false;
+
+        std::shared_ptr<const DecodingTable> table = getTable(numDataChunks, numCodeChunks, matrix);
+        ParallelCoding::getInstance().encode(chunkSize, numDataChunks, numCodeChunks, (unsigned char *) table->gftbl.data(), data, code);
 
         return true;
     }
+
+    /**
+     * Get the expanded tables of a coefficient matrix, from the table cache if the matrix was seen before
+     *
+     * @param[in] numDataChunks     number of input chunks
+     * @param[in] numCodeChunks     number of output chunks
+     * @param[in] matrix            coefficient matrix, one row of numDataChunks coefficients per output chunk
+     *
+     * @return the matrix and its expanded tables
+     **/
+    static std::shared_ptr<const DecodingTable> getTable(int numDataChunks, int numCodeChunks, unsigned char *matrix) {
+        DecodingTableCache &cache = DecodingTableCache::getInstance();
+        std::string key = DecodingTableCache::genKey(numDataChunks, numCodeChunks, matrix);
+        std::shared_ptr<const DecodingTable> cached = cache.get(key);
+        if (cached)
+            return cached;
+
+        std::shared_ptr<DecodingTable> table = std::make_shared<DecodingTable>();
+        table->matrix.assign(matrix, matrix + numDataChunks * numCodeChunks);
+        table->gftbl.resize(numDataChunks * numCodeChunks * 32);
+        ec_init_tables(numDataChunks, numCodeChunks, table->matrix.data(), table->gftbl.data());
+        cache.put(key, table);
+
+        return table;
+    }
 };
 
 #endif // define __CODING_UTIL_HH__
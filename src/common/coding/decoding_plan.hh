@@ -4,6 +4,8 @@
 #define __DECODING_PLAN_HH__
 
 #include <stdint.h>
+#include <utility>
+#include <vector>
 #include "../../common/define.hh"
 #include "../../ds/byte_buffer.hh"
 
@@ -49,6 +51,19 @@ public:
 
     void addInputChunkId(chunk_id_t chunkId) {
         _inputChunkIds.push_back(chunkId);
+        _inputSubChunks.push_back(std::make_pair(0, 0));
+    }
+
+    /**
+     * Add an input chunk of which only some consecutive sub-chunks are needed
+     *
+     * @param[in] chunkId            id of the input chunk
+     * @param[in] firstSubChunk      index of the first sub-chunk needed
+     * @param[in] numSubChunks       number of sub-chunks needed, 0 for the whole chunk
+     **/
+    void addInputChunkId(chunk_id_t chunkId, num_t firstSubChunk, num_t numSubChunks) {
+        _inputChunkIds.push_back(chunkId);
+        _inputSubChunks.push_back(std::make_pair(firstSubChunk, numSubChunks));
     }
 
     std::vector<chunk_id_t> getInputChunkIds() const {
@@ -65,7 +80,9 @@ public:
 
     void releaseInputChunks() {
         _inputChunkIds.clear();
+        _inputSubChunks.clear();
         _minNumChunksToRetrieve = 0;
+        _numSubChunks = 1;
     }
 
     bool setMinNumInputChunks(num_t num) {
@@ -76,6 +93,56 @@ public:
         _minNumChunksToRetrieve = num;
         return true;
     }
+
+    // ------------------ //
+    //  Input sub-chunks  //
+    // ------------------ //
+
+    /**
+     * Set the number of equal-sized sub-chunks that each chunk is divided into
+     *
+     * @param[in] num                number of sub-chunks per chunk
+     **/
+    void setNumSubChunks(num_t num) {
+        _numSubChunks = num > 0? num : 1;
+    }
+
+    num_t getNumSubChunks() const {
+        return _numSubChunks;
+    }
+
+    /**
+     * Get the sub-chunks needed from an input chunk
+     *
+     * @param[in] idx                index of the input chunk in the plan
+     * @param[out] firstSubChunk     index of the first sub-chunk needed
+     * @param[out] numSubChunks      number of sub-chunks needed
+     *
+     * @return whether only part of the input chunk is needed
+     **/
+    bool getInputSubChunks(size_t idx, num_t &firstSubChunk, num_t &numSubChunks) const {
+        firstSubChunk = _inputSubChunks.at(idx).first;
+        numSubChunks = _inputSubChunks.at(idx).second;
+        if (numSubChunks == 0 || numSubChunks > _numSubChunks) {
+            firstSubChunk = 0;
+            numSubChunks = _numSubChunks;
+        }
+        return numSubChunks < _numSubChunks;
+    }
+
+    /**
+     * Tell whether only part of some of the first min. number of input chunks is needed
+     *
+     * @return whether some inputs are partial chunks
+     **/
+    bool hasPartialInputChunks() const {
+        num_t first = 0, num = 0;
+        for (size_t i = 0; i < _minNumChunksToRetrieve && i < _inputChunkIds.size(); i++) {
+            if (getInputSubChunks(i, first, num))
+                return true;
+        }
+        return false;
+    }
     
 private:
 
@@ -90,11 +157,16 @@ private:
 
     void resetInputChunks() {
         _inputChunkIds.clear();
+        _inputSubChunks.clear();
+        _minNumChunksToRetrieve = 0;
+        _numSubChunks = 1;
     }
 
     ByteBuffer _repairMatrix;                  /**< repair matrix */
     std::vector<chunk_id_t> _inputChunkIds;    /**< ids of input chunks */
     num_t _minNumChunksToRetrieve;             /**< minimum number of chunks to retrieve */
+    std::vector<std::pair<num_t, num_t> > _inputSubChunks;  /**< (first sub-chunk, number of sub-chunks, 0 for all) needed from each input chunk */
+    num_t _numSubChunks;                       /**< number of sub-chunks per chunk */
     
 };
 
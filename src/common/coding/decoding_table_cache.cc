@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "decoding_table_cache.hh"
+
+DecodingTableCache::DecodingTableCache() {
+    _capacity = DECODING_TABLE_CACHE_DEFAULT_SIZE;
+    _hits = 0;
+    _misses = 0;
+}
+
+std::string DecodingTableCache::genKey(const std::string &name, coding_param_t n, coding_param_t k, const chunk_id_t *inputIds, num_t numInputs, const chunk_id_t *targetIds, num_t numTargets) {
+    std::string key = name;
+    key.reserve(name.size() + (3 + numInputs + numTargets) * sizeof(chunk_id_t));
+    key.append(1, '\0');
+    key.append((const char *) &n, sizeof(n));
+    key.append((const char *) &k, sizeof(k));
+    key.append((const char *) &numInputs, sizeof(numInputs));
+    key.append((const char *) inputIds, numInputs * sizeof(chunk_id_t));
+    key.append((const char *) targetIds, numTargets * sizeof(chunk_id_t));
+    return key;
+}
+
+std::string DecodingTableCache::genKey(num_t numInputs, num_t numOutputs, const uint8_t *matrix) {
+    // leading null character to avoid collision with the keys beginning with a coding scheme name
+    std::string key(1, '\0');
+    key.reserve(1 + 2 * sizeof(num_t) + numInputs * numOutputs);
+    key.append((const char *) &numInputs, sizeof(numInputs));
+    key.append((const char *) &numOutputs, sizeof(numOutputs));
+    key.append((const char *) matrix, numInputs * numOutputs);
+    return key;
+}
+
+std::shared_ptr<const DecodingTable> DecodingTableCache::get(const std::string &key) {
+    std::lock_guard<std::mutex> lk(_lock);
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        _misses++;
+        return std::shared_ptr<const DecodingTable>();
+    }
+    // move the entry to the front as the most recently used
+    _entries.splice(_entries.begin(), _entries, it->second);
+    _hits++;
+    return it->second->second;
+}
+
+void DecodingTableCache::put(const std::string &key, std::shared_ptr<const DecodingTable> table) {
+    std::lock_guard<std::mutex> lk(_lock);
+    if (_capacity == 0 || !table)
+        return;
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        // keep the existing table, e.g., added by another thread which missed concurrently
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+    _entries.emplace_front(key, table);
+    _index.insert(std::make_pair(key, _entries.begin()));
+    evict();
+}
+
+void DecodingTableCache::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lk(_lock);
+    _capacity = capacity;
+    evict();
+}
+
+void DecodingTableCache::clear() {
+    std::lock_guard<std::mutex> lk(_lock);
+    _index.clear();
+    _entries.clear();
+    _hits = 0;
+    _misses = 0;
+}
+
+size_t DecodingTableCache::getCapacity() {
+    std::lock_guard<std::mutex> lk(_lock);
+    return _capacity;
+}
+
+size_t DecodingTableCache::getNumEntries() {
+    std::lock_guard<std::mutex> lk(_lock);
+    return _entries.size();
+}
+
+unsigned long int DecodingTableCache::getNumHits() const {
+    return _hits;
+}
+
+unsigned long int DecodingTableCache::getNumMisses() const {
+    return _misses;
+}
+
+void DecodingTableCache::evict() {
+    while (_entries.size() > _capacity) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+}
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __DECODING_TABLE_CACHE_HH__
+#define __DECODING_TABLE_CACHE_HH__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../define.hh"
+
+#define DECODING_TABLE_CACHE_DEFAULT_SIZE (1024)
+
+/**
+ * Decoding matrix and its expanded GF tables for one erasure pattern
+ **/
+struct DecodingTable {
+    std::vector<uint8_t> matrix;    /**< decoding matrix, one row of k coefficients per target chunk */
+    std::vector<uint8_t> gftbl;     /**< expanded tables of the decoding matrix for ec_encode_data() */
+};
+
+/**
+ * Bounded LRU cache of decoding tables shared by all coding instances in a process
+ *
+ * Tables are keyed by the coding scheme, coding parameters, the input chunks, and the target chunks, or by the
+ * coefficient matrix itself when the matrix is given by others. A table taken from the cache remains valid after
+ * eviction until the last reference is dropped.
+ **/
+class DecodingTableCache {
+public:
+
+    static DecodingTableCache& getInstance() {
+        static DecodingTableCache instance;
+        return instance;
+    }
+
+    /**
+     * Generate the key of a decoding table
+     *
+     * @param[in] name          name of the coding scheme
+     * @param[in] n             coding parameter n
+     * @param[in] k             coding parameter k
+     * @param[in] inputIds      ids of the input chunks
+     * @param[in] numInputs     number of input chunks
+     * @param[in] targetIds     ids of the target chunks
+     * @param[in] numTargets    number of target chunks
+     *
+     * @return key of the decoding table
+     **/
+    static std::string genKey(const std::string &name, coding_param_t n, coding_param_t k, const chunk_id_t *inputIds, num_t numInputs, const chunk_id_t *targetIds, num_t numTargets);
+
+    /**
+     * Generate the key of the tables of a coefficient matrix, e.g., sent to agents for partial encoding and repair
+     *
+     * @param[in] numInputs     number of input chunks (columns of the matrix)
+     * @param[in] numOutputs    number of output chunks (rows of the matrix)
+     * @param[in] matrix        coefficient matrix, one row of numInputs coefficients per output chunk
+     *
+     * @return key of the tables
+     **/
+    static std::string genKey(num_t numInputs, num_t numOutputs, const uint8_t *matrix);
+
+    /**
+     * Get a cached decoding table
+     *
+     * @param[in] key           key of the decoding table
+     *
+     * @return the decoding table, or an empty pointer if it is not cached
+     **/
+    std::shared_ptr<const DecodingTable> get(const std::string &key);
+
+    /**
+     * Add a decoding table to the cache, evicting the least recently used ones beyond the capacity
+     *
+     * @param[in] key           key of the decoding table
+     * @param[in] table         the decoding table
+     **/
+    void put(const std::string &key, std::shared_ptr<const DecodingTable> table);
+
+    /**
+     * Set the max. number of decoding tables to cache, evicting the least recently used ones beyond the new capacity
+     *
+     * @param[in] capacity      max. number of decoding tables, 0 to disable caching
+     **/
+    void setCapacity(size_t capacity);
+
+    /**
+     * Drop all cached decoding tables and reset the counters
+     **/
+    void clear();
+
+    size_t getCapacity();
+    size_t getNumEntries();
+    unsigned long int getNumHits() const;
+    unsigned long int getNumMisses() const;
+
+private:
+    DecodingTableCache();
+    DecodingTableCache(const DecodingTableCache&) = delete;
+    void operator=(const DecodingTableCache&) = delete;
+
+    /**
+     * Evict the least recently used decoding tables beyond the capacity, the caller must hold the lock
+     **/
+    void evict();
+
+    typedef std::list<std::pair<std::string, std::shared_ptr<const DecodingTable> > > LRUList;
+
+    std::mutex _lock;                                               /**< lock on the entries */
+    LRUList _entries;                                               /**< cached decoding tables, most recently used first */
+    std::unordered_map<std::string, LRUList::iterator> _index;      /**< key to entry mapping */
+    size_t _capacity;                                               /**< max. number of cached decoding tables */
+
+    std::atomic<unsigned long int> _hits;                           /**< number of lookups served by the cache */
+    std::atomic<unsigned long int> _misses;                         /**< number of lookups not served by the cache */
+};
+
+#endif // define __DECODING_TABLE_CACHE_HH__
@@ -0,0 +1,590 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm> // std::sort()
+
+#include "hitchhiker.hh"
+#include "parallel_coding.hh"
+
+extern "C" {
+#include <isa-l/erasure_code.h>
+}
+
+#include <glog/logging.h>
+
+/**
+ * Check the coding parameters, and get the options of the RS codes for the sub-chunks
+ **/
+static CodingOptions checkAndGetRSOptions(CodingOptions options) {
+    coding_param_t n = options.getN();
+    coding_param_t k = options.getK();
+
+    if (k <= 0 || n < k + 2 || n > CODING_MAX_N) {
+        throw std::invalid_argument("Hitchhiker codes only support n-k >= 2, k > 0, and n <= " + std::to_string(CODING_MAX_N));
+    }
+
+    // sub-chunks are always decoded at the proxy, without CAR
+    CodingOptions rsOptions;
+    rsOptions.setN(n);
+    rsOptions.setK(k);
+    return rsOptions;
+}
+
+/**
+ * Wrap a buffer as a chunk without taking its ownership
+ **/
+static void wrapBuffer(Chunk &chunk, chunk_id_t chunkId, data_t *data, length_t size) {
+    chunk.setChunkId(chunkId);
+    chunk.data = data;
+    chunk.size = size;
+    chunk.freeData = false;
+}
+
+HitchhikerCode::HitchhikerCode(CodingOptions options) : _rs(checkAndGetRSOptions(options)) {
+    coding_param_t n = options.getN();
+    coding_param_t k = options.getK();
+    coding_param_t r = n - k;
+
+    // set the coding options
+    _options = options;
+
+    _name = "HITCHHIKER";
+    _systematic = true;
+    _deltaUpdate = true;
+
+    // RS encoding matrix for both sub-chunks
+    _encodeMatrix.resize(n * k);
+    gf_gen_rs_matrix(_encodeMatrix.data(), n, k);
+
+    // parity i >= 1 carries the xor of the a sub-chunks of data chunks in group i-1
+    _piggyback.resize(r * k, 0);
+    for (coding_param_t j = 0; j < k; j++) {
+        _piggyback[(getGroup(j) + 1) * k + j] = 1;
+    }
+
+    // b sub-chunks of parities: [piggyback coefficients of a | RS coefficients of b]
+    std::vector<uint8_t> matrixB (r * 2 * k);
+    for (coding_param_t i = 0; i < r; i++) {
+        memcpy(&matrixB[i * 2 * k], &_piggyback[i * k], k);
+        memcpy(&matrixB[i * 2 * k + k], &_encodeMatrix[(k + i) * k], k);
+    }
+
+    _gftblA.resize(r * k * 32);
+    _gftblB.resize(r * 2 * k * 32);
+    ec_init_tables(k, r, &_encodeMatrix[k * k], _gftblA.data());
+    ec_init_tables(2 * k, r, matrixB.data(), _gftblB.data());
+
+    DLOG(INFO) << "Hitchhiker codes init with n=" << (int) n << ",k=" << (int) k << ",groups=" << r - 1;
+}
+
+num_t HitchhikerCode::getNumDataChunks() {
+    return _options.getK();
+}
+
+num_t HitchhikerCode::getNumCodeChunks() {
+    return _options.getN() - _options.getK();
+}
+
+num_t HitchhikerCode::getNumChunks() {
+    return _options.getN();
+}
+
+num_t HitchhikerCode::getNumChunksPerNode() {
+    return 1;
+}
+
+length_t HitchhikerCode::getCodingStateSize() {
+    return 0;
+}
+
+num_t HitchhikerCode::getGroup(chunk_id_t chunkId) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+    num_t numGroups = n - k - 1;
+    // group j holds data chunks [j*k/g, (j+1)*k/g)
+    return (chunkId * numGroups + numGroups - 1) / k;
+}
+
+length_t HitchhikerCode::getChunkSize(length_t dataSize) {
+    coding_param_t k = _options.getK();
+    length_t chunkSize = (dataSize + k - 1) / k;
+    return (chunkSize + HITCHHIKER_NUM_SUB_CHUNKS - 1) / HITCHHIKER_NUM_SUB_CHUNKS * HITCHHIKER_NUM_SUB_CHUNKS;
+}
+
+bool HitchhikerCode::encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks, bool computeChecksums, int checksumType) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    unsigned char *codeAp[n - k], *codeBp[n - k], *datap[2 * k];
+
+    length_t chunkSize = getChunkSize(dataSize);
+    length_t subChunkSize = chunkSize / HITCHHIKER_NUM_SUB_CHUNKS;
+
+    // init the stripe with n chunks
+    stripe.clear();
+    stripe.resize(n);
+
+    // set the pointers for data and code chunks
+    for (coding_param_t i = 0; i < n; i++) {
+        stripe.at(i).setChunkId(i);
+        // reference the data chunks fully covered by the data buffer
+        if (shadowDataChunks && i < k && (i + 1) * chunkSize <= dataSize) {
+            stripe.at(i).data = data + i * chunkSize;
+            stripe.at(i).size = chunkSize;
+            stripe.at(i).freeData = false;
+            datap[i] = stripe.at(i).data;
+            datap[k + i] = stripe.at(i).data + subChunkSize;
+            continue;
+        }
+        // try allocate space for chunks and revert previous ones if fails
+        if (!stripe.at(i).allocateData(chunkSize, /* aligned */ true)) {
+            LOG(ERROR) << "Failed to allocate memory for chunk " << i << " in stripe with " << n << " chunks of size " << chunkSize;
+            stripe.clear();
+            return false;
+        }
+        if (i < k) {
+            // copy the remaining data to chunk output, and pad the chunk with zeros
+            // (the chunk size is rounded up, so the data may not fill the last chunk)
+            unsigned char *datacp = stripe.at(i).data;
+            length_t remaining = dataSize > i * chunkSize? std::min(dataSize - i * chunkSize, chunkSize) : 0;
+            memcpy(datacp, data + i * chunkSize, remaining);
+            memset(datacp + remaining, 0, chunkSize - remaining);
+            datap[i] = datacp;
+            datap[k + i] = datacp + subChunkSize;
+        } else {
+            // set the buffer pointers for encoding
+            codeAp[i - k] = stripe.at(i).data;
+            codeBp[i - k] = stripe.at(i).data + subChunkSize;
+        }
+    }
+
+    if (computeChecksums) {
+        // checksum the a sub-chunks when encoding the a sub-chunks, and then the b sub-chunks, i.e., the chunks in order
+        std::vector<std::unique_ptr<ChecksumCalculator> > checksums;
+        if (!createChecksums(checksumType, n, checksums))
+            return false;
+        ChecksumCalculator *checksumAp[n], *checksumBp[k + n];
+        for (coding_param_t i = 0; i < n; i++) {
+            checksumAp[i] = checksums.at(i).get();
+            checksumBp[k + i] = checksums.at(i).get();
+        }
+        for (coding_param_t i = 0; i < k; i++)
+            checksumBp[i] = NULL;
+        ParallelCoding::getInstance().encode(subChunkSize, k, n - k, _gftblA.data(), datap, codeAp, checksumAp, checksumAp + k);
+        ParallelCoding::getInstance().encode(subChunkSize, 2 * k, n - k, _gftblB.data(), datap, codeBp, checksumBp, checksumBp + 2 * k);
+        return setChecksums(checksums, checksumType, stripe);
+    }
+
+    // encode the a sub-chunks
+    ParallelCoding::getInstance().encode(subChunkSize, k, n - k, _gftblA.data(), datap, codeAp);
+    // encode the b sub-chunks, with the piggybacks of a sub-chunks
+    ParallelCoding::getInstance().encode(subChunkSize, 2 * k, n - k, _gftblB.data(), datap, codeBp);
+
+    return true;
+}
+
+bool HitchhikerCode::encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    if (dataDeltas.empty()) {
+        LOG(ERROR) << "No data chunk changes to encode";
+        return false;
+    }
+
+    length_t chunkSize = dataDeltas.at(0).size;
+    for (const Chunk &delta : dataDeltas) {
+        if (delta.getChunkId() < 0 || delta.getChunkId() >= k || delta.size != (int) chunkSize || chunkSize % HITCHHIKER_NUM_SUB_CHUNKS != 0) {
+            LOG(ERROR) << "Invalid change to data chunk " << delta.getChunkId() << " of size " << delta.size << " (expected chunk size " << chunkSize << ")";
+            return false;
+        }
+    }
+    length_t subChunkSize = chunkSize / HITCHHIKER_NUM_SUB_CHUNKS;
+
+    // init the code chunk changes to zeros
+    unsigned char *codeAp[n - k], *codeBp[n - k];
+    codeDeltas.clear();
+    codeDeltas.resize(n - k);
+    for (coding_param_t i = 0; i < n - k; i++) {
+        codeDeltas.at(i).setChunkId(k + i);
+        if (!codeDeltas.at(i).allocateData(chunkSize, /* aligned */ true)) {
+            LOG(ERROR) << "Failed to allocate memory for the change to code chunk " << k + i << " of size " << chunkSize;
+            codeDeltas.clear();
+            return false;
+        }
+        memset(codeDeltas.at(i).data, 0, chunkSize);
+        codeAp[i] = codeDeltas.at(i).data;
+        codeBp[i] = codeDeltas.at(i).data + subChunkSize;
+    }
+
+    // accumulate the contribution of each data chunk change, since the code is linear
+    for (const Chunk &delta : dataDeltas) {
+        chunk_id_t j = delta.getChunkId();
+        ec_encode_data_update(subChunkSize, k, n - k, j, _gftblA.data(), delta.data, codeAp);
+        ec_encode_data_update(subChunkSize, 2 * k, n - k, j, _gftblB.data(), delta.data, codeBp);
+        ec_encode_data_update(subChunkSize, 2 * k, n - k, k + j, _gftblB.data(), delta.data + subChunkSize, codeBp);
+    }
+
+    return true;
+}
+
+bool HitchhikerCode::decode(std::vector<Chunk> &inputChunks, data_t **decodedData, length_t &decodedSize, DecodingPlan &plan, data_t *codingState, bool isRepair, std::vector<chunk_id_t> repairTargets) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    num_t numInputChunks = inputChunks.size();
+
+    bool isInput[n];
+    memset(isInput, 0, n);
+    for (num_t i = 0; i < numInputChunks; i++) {
+        chunk_id_t id = inputChunks.at(i).getChunkId();
+        if (id < 0 || id >= n) {
+            LOG(ERROR) << "Invalid input chunk id " << id << " for n=" << (int) n;
+            return false;
+        }
+        isInput[id] = true;
+    }
+
+    // figure out repair targets if not specified by function caller
+    for (chunk_id_t i = 0; isRepair && repairTargets.empty() && i < n; i++) {
+        if (!isInput[i]) {
+            repairTargets.push_back(i);
+        }
+    }
+
+    DLOG_IF(INFO, isRepair) << "Repair " << repairTargets.size() << " chunks";
+
+    // [special case 1] single data chunk repair using the sub-chunks in plan
+    if (isRepair && repairTargets.size() == 1 && repairTargets.at(0) < k && plan.getNumSubChunks() == HITCHHIKER_NUM_SUB_CHUNKS && plan.hasPartialInputChunks()) {
+        return repairDataChunk(inputChunks, plan, repairTargets.at(0), decodedData, decodedSize);
+    }
+
+    // otherwise, always decode all data chunks from k whole chunks
+    if (numInputChunks < k) {
+        LOG(ERROR) << "Insufficient input chunks for decoding, got " << numInputChunks << " but requires " << (int) k << " chunks or more";
+        return false;
+    }
+    length_t chunkSize = inputChunks.at(0).size;
+    num_t numDecodedChunks = isRepair? repairTargets.size() : k;
+
+    data_t *decodedDataTmp = *decodedData;
+    if (decodedDataTmp == NULL) {
+        decodedDataTmp = (data_t*) malloc (sizeof(data_t) * numDecodedChunks * chunkSize);
+        if (decodedDataTmp == NULL) {
+            LOG(ERROR) << "Failed to allocate memory for decoded data of size " << numDecodedChunks * chunkSize;
+            return false;
+        }
+    }
+
+    // decode the data chunks directly to the output buffer for normal decoding
+    data_t *dataChunks = isRepair? (data_t*) malloc (sizeof(data_t) * k * chunkSize) : decodedDataTmp;
+    bool decoded = dataChunks != NULL && decodeDataChunks(inputChunks, dataChunks);
+
+    // copy the data chunks and re-encode the code chunks among the repair targets for repair
+    if (decoded && isRepair) {
+        decoded = repairFromDataChunks(dataChunks, chunkSize, repairTargets, decodedDataTmp);
+    }
+    if (isRepair) {
+        free(dataChunks);
+    }
+
+    if (!decoded) {
+        LOG(ERROR) << "Failed to decode from " << numInputChunks << " input chunks";
+        // if unsuccessful, free locally allocated buffer
+        if (*decodedData != decodedDataTmp) free(decodedDataTmp);
+        return false;
+    }
+
+    // set decode output
+    *decodedData = decodedDataTmp;
+    decodedSize = numDecodedChunks * chunkSize;
+
+    return true;
+}
+
+bool HitchhikerCode::repairFromDataChunks(data_t *dataChunks, length_t chunkSize, const std::vector<chunk_id_t> &targets, data_t *output) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+    length_t subChunkSize = chunkSize / HITCHHIKER_NUM_SUB_CHUNKS;
+    num_t numTargets = targets.size();
+
+    // rows of the code chunks to re-encode, for the a sub-chunks and the b sub-chunks (with piggybacks)
+    uint8_t matrixA[numTargets * k], matrixB[numTargets * 2 * k];
+    unsigned char *datap[2 * k], *codeAp[numTargets], *codeBp[numTargets];
+    num_t numCodeChunks = 0;
+
+    for (num_t i = 0; i < numTargets; i++) {
+        chunk_id_t target = targets.at(i);
+        if (target < 0 || target >= n) {
+            LOG(ERROR) << "Invalid repair target " << target << " for n=" << (int) n;
+            return false;
+        }
+        if (target < k) {
+            memcpy(output + i * chunkSize, dataChunks + target * chunkSize, chunkSize);
+            continue;
+        }
+        memcpy(&matrixA[numCodeChunks * k], &_encodeMatrix[target * k], k);
+        memcpy(&matrixB[numCodeChunks * 2 * k], &_piggyback[(target - k) * k], k);
+        memcpy(&matrixB[numCodeChunks * 2 * k + k], &_encodeMatrix[target * k], k);
+        codeAp[numCodeChunks] = output + i * chunkSize;
+        codeBp[numCodeChunks] = output + i * chunkSize + subChunkSize;
+        numCodeChunks++;
+    }
+
+    if (numCodeChunks == 0) {
+        return true;
+    }
+
+    for (coding_param_t j = 0; j < k; j++) {
+        datap[j] = dataChunks + j * chunkSize;
+        datap[k + j] = dataChunks + j * chunkSize + subChunkSize;
+    }
+    uint8_t gftblA[numCodeChunks * k * 32], gftblB[numCodeChunks * 2 * k * 32];
+    ec_init_tables(k, numCodeChunks, matrixA, gftblA);
+    ec_init_tables(2 * k, numCodeChunks, matrixB, gftblB);
+    ParallelCoding::getInstance().encode(subChunkSize, k, numCodeChunks, gftblA, datap, codeAp);
+    ParallelCoding::getInstance().encode(subChunkSize, 2 * k, numCodeChunks, gftblB, datap, codeBp);
+
+    return true;
+}
+
+bool HitchhikerCode::decodeDataChunks(std::vector<Chunk> &inputChunks, data_t *output) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    length_t chunkSize = inputChunks.at(0).size;
+    if (chunkSize % HITCHHIKER_NUM_SUB_CHUNKS != 0) {
+        LOG(ERROR) << "Invalid chunk size " << chunkSize << " for decoding";
+        return false;
+    }
+    length_t subChunkSize = chunkSize / HITCHHIKER_NUM_SUB_CHUNKS;
+
+    // use the first k input chunks in ascending order of chunk ids
+    Chunk *inputs[n];
+    num_t numInputChunks = 0;
+    for (Chunk &chunk : inputChunks) {
+        if (chunk.size != (int) chunkSize) {
+            LOG(ERROR) << "Inconsistent size of input chunk " << chunk.getChunkId() << ", got " << chunk.size << " but expected " << chunkSize;
+            return false;
+        }
+        inputs[numInputChunks++] = &chunk;
+    }
+    std::sort(inputs, inputs + numInputChunks, [](const Chunk *a, const Chunk *b) { return a->getChunkId() < b->getChunkId(); });
+
+    std::vector<Chunk> subChunks;
+    subChunks.resize(k);
+    data_t *buffer = NULL;
+    length_t bufferSize = 0;
+    DecodingPlan noPlan;
+
+    // (1) decode the a sub-chunks of data chunks
+    unsigned char *dataA[k];
+    for (coding_param_t i = 0; i < k; i++) {
+        wrapBuffer(subChunks.at(i), inputs[i]->getChunkId(), inputs[i]->data, subChunkSize);
+    }
+    if (inputs[k - 1]->getChunkId() == k - 1) {
+        // all data chunks are available
+        for (coding_param_t i = 0; i < k; i++) {
+            dataA[i] = inputs[i]->data;
+        }
+    } else if (_rs.decode(subChunks, &buffer, bufferSize, noPlan, NULL)) {
+        for (coding_param_t i = 0; i < k; i++) {
+            dataA[i] = buffer + i * subChunkSize;
+        }
+    } else {
+        LOG(ERROR) << "Failed to decode the a sub-chunks";
+        return false;
+    }
+
+    // (2) remove the piggybacks from the b sub-chunks of parities
+    data_t *stripped = (data_t*) malloc (sizeof(data_t) * k * subChunkSize);
+    if (stripped == NULL) {
+        LOG(ERROR) << "Failed to allocate memory for the b sub-chunks of size " << k * subChunkSize;
+        free(buffer);
+        return false;
+    }
+    for (coding_param_t i = 0; i < k; i++) {
+        chunk_id_t id = inputs[i]->getChunkId();
+        data_t *subChunk = inputs[i]->data + subChunkSize;
+        if (id > k) {
+            // b' = b + (xor of a sub-chunks in the group) with the group coefficients and 1 for b
+            uint8_t matrix[k + 1], gftbl[(k + 1) * 32];
+            unsigned char *piggyp[k + 1], *outp[1] = { stripped + i * subChunkSize };
+            memcpy(matrix, &_piggyback[(id - k) * k], k);
+            matrix[k] = 1;
+            memcpy(piggyp, dataA, sizeof(unsigned char *) * k);
+            piggyp[k] = subChunk;
+            ec_init_tables(k + 1, 1, matrix, gftbl);
+            ParallelCoding::getInstance().encode(subChunkSize, k + 1, 1, gftbl, piggyp, outp);
+            subChunk = outp[0];
+        }
+        wrapBuffer(subChunks.at(i), id, subChunk, subChunkSize);
+    }
+
+    // (3) decode the b sub-chunks of data chunks
+    data_t *bufferB = NULL;
+    unsigned char *dataB[k];
+    bool decoded = true;
+    if (inputs[k - 1]->getChunkId() == k - 1) {
+        for (coding_param_t i = 0; i < k; i++) {
+            dataB[i] = subChunks.at(i).data;
+        }
+    } else if (_rs.decode(subChunks, &bufferB, bufferSize, noPlan, NULL)) {
+        for (coding_param_t i = 0; i < k; i++) {
+            dataB[i] = bufferB + i * subChunkSize;
+        }
+    } else {
+        LOG(ERROR) << "Failed to decode the b sub-chunks";
+        decoded = false;
+    }
+
+    // (4) assemble the data chunks
+    for (coding_param_t i = 0; decoded && i < k; i++) {
+        memcpy(output + i * chunkSize, dataA[i], subChunkSize);
+        memcpy(output + i * chunkSize + subChunkSize, dataB[i], subChunkSize);
+    }
+
+    subChunks.clear();
+    free(stripped);
+    free(buffer);
+    free(bufferB);
+
+    return decoded;
+}
+
+bool HitchhikerCode::repairDataChunk(std::vector<Chunk> &inputChunks, DecodingPlan &plan, chunk_id_t target, data_t **output, length_t &chunkSize) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    num_t group = getGroup(target);
+    chunk_id_t piggybackParity = k + group + 1;
+
+    // locate the sub-chunks of each input chunk
+    std::vector<chunk_id_t> planInputs = plan.getInputChunkIds();
+    data_t *subChunkp[n][HITCHHIKER_NUM_SUB_CHUNKS];
+    memset(subChunkp, 0, sizeof(subChunkp));
+    length_t subChunkSize = 0;
+    for (Chunk &chunk : inputChunks) {
+        chunk_id_t id = chunk.getChunkId();
+        size_t idx = std::find(planInputs.begin(), planInputs.end(), id) - planInputs.begin();
+        num_t first = 0, num = 0;
+        if (id < 0 || id >= n || idx >= planInputs.size()) {
+            LOG(ERROR) << "Input chunk " << id << " is not in the decoding plan";
+            return false;
+        }
+        plan.getInputSubChunks(idx, first, num);
+        if (chunk.size <= 0 || chunk.size % num != 0 || (subChunkSize > 0 && chunk.size / num != subChunkSize)) {
+            LOG(ERROR) << "Invalid size of input chunk " << id << ", got " << chunk.size << " for " << num << " sub-chunks";
+            return false;
+        }
+        subChunkSize = chunk.size / num;
+        for (num_t s = 0; s < num; s++) {
+            subChunkp[id][first + s] = chunk.data + s * subChunkSize;
+        }
+    }
+
+    // check the sub-chunks needed
+    bool sufficient = subChunkp[k][1] != NULL && subChunkp[piggybackParity][1] != NULL;
+    for (coding_param_t i = 0; sufficient && i < k; i++) {
+        sufficient = i == target || (subChunkp[i][1] != NULL && (getGroup(i) != group || subChunkp[i][0] != NULL));
+    }
+    if (!sufficient) {
+        LOG(ERROR) << "Insufficient sub-chunks for repairing data chunk " << target;
+        return false;
+    }
+
+    chunkSize = subChunkSize * HITCHHIKER_NUM_SUB_CHUNKS;
+    data_t *repaired = *output;
+    if (repaired == NULL) {
+        repaired = (data_t*) malloc (sizeof(data_t) * chunkSize);
+        if (repaired == NULL) {
+            LOG(ERROR) << "Failed to allocate memory for the repaired chunk of size " << chunkSize;
+            return false;
+        }
+    }
+
+    // (1) decode the b sub-chunks of the target and the piggyback parity (without piggyback) from those of the other data chunks and parity 0
+    std::vector<Chunk> subChunks;
+    subChunks.resize(k);
+    for (coding_param_t i = 0, j = 0; i <= k; i++) {
+        if (i == target) continue;
+        wrapBuffer(subChunks.at(j++), i, subChunkp[i][1], subChunkSize);
+    }
+    data_t *decoded = NULL;
+    length_t decodedSize = 0;
+    DecodingPlan noPlan;
+    std::vector<chunk_id_t> targets { target, piggybackParity };
+    if (!_rs.decode(subChunks, &decoded, decodedSize, noPlan, NULL, /* isRepair */ true, targets)) {
+        LOG(ERROR) << "Failed to decode the b sub-chunk of data chunk " << target;
+        if (*output != repaired) free(repaired);
+        return false;
+    }
+    subChunks.clear();
+
+    // (2) the a sub-chunk of target = (b sub-chunk of parity) + (b sub-chunk of parity without piggyback) + (a sub-chunks of the other data chunks in group)
+    unsigned char *inputp[k + 2], *outp[1] = { repaired };
+    num_t numInputs = 0;
+    inputp[numInputs++] = subChunkp[piggybackParity][1];
+    inputp[numInputs++] = decoded + subChunkSize;
+    for (coding_param_t i = 0; i < k; i++) {
+        if (i != target && getGroup(i) == group) {
+            inputp[numInputs++] = subChunkp[i][0];
+        }
+    }
+    uint8_t matrix[numInputs], gftbl[numInputs * 32];
+    memset(matrix, 1, numInputs);
+    ec_init_tables(numInputs, 1, matrix, gftbl);
+    ParallelCoding::getInstance().encode(subChunkSize, numInputs, 1, gftbl, inputp, outp);
+
+    // (3) the b sub-chunk of target
+    memcpy(repaired + subChunkSize, decoded, subChunkSize);
+    free(decoded);
+
+    *output = repaired;
+    return true;
+}
+
+bool HitchhikerCode::preDecode(const std::vector<chunk_id_t> &failedChunkIdx, DecodingPlan &plan, data_t *codingState, bool isRepair) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+    num_t numFailedChunks = failedChunkIdx.size();
+
+    // cannot decode if there is less than k chunks available
+    if (numFailedChunks > (uint32_t) n - k) {
+        LOG(ERROR) << "The number of failure = " << numFailedChunks << " is greater than n-k=" << n - k;
+        return false;
+    }
+
+    plan.release();
+
+    bool isAlive[n];
+    memset(isAlive, 1, n);
+    for (chunk_id_t id : failedChunkIdx) {
+        if (id < 0 || id >= n) {
+            LOG(ERROR) << "Invalid failed chunk id " << id << " for n=" << (int) n;
+            return false;
+        }
+        isAlive[id] = false;
+    }
+
+    // repair a single data chunk using the b sub-chunks of the other data chunks, parity 0 and the piggyback parity,
+    // and the a sub-chunks of the other data chunks in the same group
+    if (isRepair && numFailedChunks == 1 && failedChunkIdx.at(0) < k) {
+        chunk_id_t target = failedChunkIdx.at(0);
+        num_t group = getGroup(target);
+        for (coding_param_t i = 0; i < k; i++) {
+            if (i == target) continue;
+            if (getGroup(i) == group) {
+                plan.addInputChunkId(i);
+            } else {
+                plan.addInputChunkId(i, 1, 1);
+            }
+        }
+        plan.addInputChunkId(k, 1, 1);
+        plan.addInputChunkId(k + group + 1, 1, 1);
+        plan.setNumSubChunks(HITCHHIKER_NUM_SUB_CHUNKS);
+        plan.setMinNumInputChunks(k + 1);
+        return true;
+    }
+
+    // otherwise, decode from the first k chunks available, with the rest as alternatives
+    for (chunk_id_t i = 0; i < n; i++) {
+        if (isAlive[i]) {
+            plan.addInputChunkId(i);
+        }
+    }
+    plan.setMinNumInputChunks(k);
+
+    return true;
+}
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __HITCHHIKER_CODE_HH__
+#define __HITCHHIKER_CODE_HH__
+
+#include <stdint.h> // uint8_t
+#include <vector>
+#include "coding.hh"
+#include "rs.hh"
+#include "../config.hh"
+
+#define HITCHHIKER_NUM_SUB_CHUNKS  (2)
+
+/**
+ * Hitchhiker codes (the XOR variant), i.e., RS codes with piggybacks for reducing the repair traffic of data chunks
+ *
+ * Each chunk is split into two sub-chunks, a (first half) and b (second half). The a and b sub-chunks of the
+ * k data chunks are encoded into those of the n-k parity chunks using RS codes separately, and the b sub-chunk of
+ * parity i (i >= 1) is further XOR-ed with the a sub-chunks of the data chunks in group i-1, where the data chunks
+ * are split evenly into n-k-1 groups. The code remains MDS.
+ *
+ * A failed data chunk in group g is repaired using the b sub-chunks of the other data chunks, parity 0, and
+ * parity g+1, plus the a sub-chunks of the other data chunks in group g, i.e., (k + group size) sub-chunks instead
+ * of 2k sub-chunks.
+ **/
+class HitchhikerCode : public Coding {
+public:
+
+    HitchhikerCode(CodingOptions options);
+    ~HitchhikerCode() {}
+    /**
+     * see Coding::getNumDataChunks()
+     **/
+    num_t getNumDataChunks();
+
+    /**
+     * see Coding::getNumCodeChunks()
+     **/
+    num_t getNumCodeChunks();
+
+    /**
+     * see Coding::getNumChunks()
+     **/
+    num_t getNumChunks();
+
+    /**
+     * see Coding::getNumChunksPerNode()
+     **/
+    num_t getNumChunksPerNode();
+
+    /**
+     * see Coding::getCodingStateSize()
+     **/
+    length_t getCodingStateSize();
+
+    /**
+     * see Coding::encode()
+     *
+     * @remark coding state is ignored for Hitchhiker codes
+     * @remark with shadowDataChunks, only the code chunks and the data chunk with padding at the end of data are allocated
+     **/
+    bool encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks = false, bool computeChecksums = false, int checksumType = ChecksumType::CHECKSUM_MD5);
+
+    /**
+     * see Coding::decode()
+     *
+     * @remark coding state is ignored for Hitchhiker codes
+     * @remark for the repair of a single data chunk, the input chunks hold only the sub-chunks in the decoding plan
+     **/
+    bool decode(std::vector<Chunk> &inputChunks, data_t **decodedData, length_t &decodedSize, DecodingPlan &plan, data_t *codingState, bool isRepair = false, std::vector<chunk_id_t> repairTargets = std::vector<chunk_id_t>());
+
+    /**
+     * see Coding::encodeDelta()
+     **/
+    bool encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas);
+
+    /**
+     * see Coding::preDecode()
+     *
+     * @remark coding state is ignored for Hitchhiker codes
+     * @remark no repair matrix is set, since the repair is not a linear combination of whole chunks
+     **/
+    bool preDecode(const std::vector<chunk_id_t> &failedChunkIdx, DecodingPlan &plan, data_t *codingState, bool isRepair = false);
+
+    /**
+     * see Coding::getChunkSize()
+     *
+     * @remark the chunk size is rounded up to a multiple of the number of sub-chunks
+     **/
+    length_t getChunkSize(length_t dataSize);
+
+    /**
+     * Tell the piggyback group of a data chunk
+     *
+     * @param[in] chunkId                 id of the data chunk
+     *
+     * @return the group, whose piggyback is carried by parity (group + 1)
+     **/
+    num_t getGroup(chunk_id_t chunkId);
+
+private:
+
+    /**
+     * Repair a single data chunk using the sub-chunks in the decoding plan
+     *
+     * @param[in] inputChunks             input sub-chunks
+     * @param[in] plan                    decoding plan from preDecode()
+     * @param[in] target                  id of the failed data chunk
+     * @param[out] output                 buffer for the repaired chunk
+     * @param[out] chunkSize              size of the repaired chunk
+     *
+     * @return whether the chunk is repaired
+     **/
+    bool repairDataChunk(std::vector<Chunk> &inputChunks, DecodingPlan &plan, chunk_id_t target, data_t **output, length_t &chunkSize);
+
+    /**
+     * Decode all data chunks from any k whole chunks
+     *
+     * @param[in] inputChunks             input chunks
+     * @param[out] output                 buffer for the k data chunks
+     *
+     * @return whether the data chunks are decoded
+     **/
+    bool decodeDataChunks(std::vector<Chunk> &inputChunks, data_t *output);
+
+    /**
+     * Repair chunks from all data chunks
+     *
+     * @param[in] dataChunks              buffer of the k data chunks
+     * @param[in] chunkSize               chunk size
+     * @param[in] targets                 ids of the chunks to repair
+     * @param[out] output                 buffer for the repaired chunks, in the order of targets
+     *
+     * @return whether the chunks are repaired
+     **/
+    bool repairFromDataChunks(data_t *dataChunks, length_t chunkSize, const std::vector<chunk_id_t> &targets, data_t *output);
+
+    RSCode _rs;                        /**< RS codes for decoding the sub-chunks */
+    std::vector<uint8_t> _encodeMatrix;  /**< RS encoding matrix, one row of k coefficients per chunk */
+    std::vector<uint8_t> _gftblA;      /**< expanded tables for encoding the a sub-chunks (k inputs) */
+    std::vector<uint8_t> _gftblB;      /**< expanded tables for encoding the b sub-chunks with piggybacks (the a and then the b sub-chunks, 2k inputs) */
+    std::vector<uint8_t> _piggyback;   /**< coefficients of the a sub-chunks in the b sub-chunk of each parity chunk, one row of k per parity chunk */
+
+};
+
+#endif // define __HITCHHIKER_CODE_HH__
@@ -0,0 +1,503 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm> // std::fill(), std::swap_ranges()
+
+#include "lrc.hh"
+#include "parallel_coding.hh"
+
+extern "C" {
+#include <isa-l/erasure_code.h>
+}
+
+#include <glog/logging.h>
+
+LRCCode::LRCCode(CodingOptions options) {
+    coding_param_t n = options.getN();
+    coding_param_t k = options.getK();
+
+    // check the coding parameters
+    if (k <= 0 || n < k + LRC_NUM_GLOBAL_PARITIES + 1 || n - k - LRC_NUM_GLOBAL_PARITIES > k || n > CODING_MAX_N) {
+        throw std::invalid_argument("LRC codes only support 1 <= n-k-" + std::to_string(LRC_NUM_GLOBAL_PARITIES) + " <= k, and n <= " + std::to_string(CODING_MAX_N));
+    }
+
+    // set the coding options
+    _options = options;
+
+    _name = "LRC";
+    _systematic = true;
+    _deltaUpdate = true;
+
+    _numLocalGroups = n - k - LRC_NUM_GLOBAL_PARITIES;
+
+    // data chunks
+    memset(_encodeMatrix, 0, n * k);
+    for (coding_param_t i = 0; i < k; i++) {
+        _encodeMatrix[i * k + i] = 1;
+    }
+    // local parities, xor of the data chunks in the local group
+    for (coding_param_t i = 0; i < k; i++) {
+        _encodeMatrix[(k + getLocalGroup(i)) * k + i] = 1;
+    }
+    // global parities, with coefficient a_j^(i+1) for data chunk j, where a_j = 2^j are distinct for j < 255
+    for (coding_param_t j = 0, a = 1; j < k; j++, a = gf_mul(a, 2)) {
+        for (coding_param_t i = 0, c = a; i < LRC_NUM_GLOBAL_PARITIES; i++, c = gf_mul(c, a)) {
+            _encodeMatrix[(k + _numLocalGroups + i) * k + j] = c;
+        }
+    }
+    ec_init_tables(k, n - k, &_encodeMatrix[k * k], _gftbl);
+
+    DLOG(INFO) << "LRC codes init with n=" << (int) n << ",k=" << (int) k << ",l=" << _numLocalGroups << ",g=" << LRC_NUM_GLOBAL_PARITIES << ",useCAR=" << (bool) _options.repairUsingCAR();
+}
+
+num_t LRCCode::getNumDataChunks() {
+    return _options.getK();
+}
+
+num_t LRCCode::getNumCodeChunks() {
+    return _options.getN() - _options.getK();
+}
+
+num_t LRCCode::getNumChunks() {
+    return _options.getN();
+}
+
+num_t LRCCode::getNumChunksPerNode() {
+    return 1;
+}
+
+length_t LRCCode::getCodingStateSize() {
+    return 0;
+}
+
+num_t LRCCode::getNumLocalGroups() {
+    return _numLocalGroups;
+}
+
+int LRCCode::getLocalGroup(chunk_id_t chunkId) {
+    coding_param_t k = _options.getK();
+    // group j holds data chunks [j*k/l, (j+1)*k/l)
+    if (chunkId < k) {
+        return (chunkId * _numLocalGroups + _numLocalGroups - 1) / k;
+    }
+    if (chunkId < k + _numLocalGroups) {
+        return chunkId - k;
+    }
+    return -1;
+}
+
+length_t LRCCode::getChunkSize(length_t dataSize) {
+    coding_param_t k = _options.getK();
+    return (dataSize + k - 1) / k;
+}
+
+bool LRCCode::encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks, bool computeChecksums, int checksumType) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    unsigned char *codep[n - k], *datap[k];
+
+    length_t chunkSize = getChunkSize(dataSize);
+
+    // init the stripe with n chunks
+    stripe.clear();
+    stripe.resize(n);
+
+    // set the pointers for data and code chunks
+    for (coding_param_t i = 0; i < n; i++) {
+        stripe.at(i).setChunkId(i);
+        // reference the data chunks fully covered by the data buffer
+        if (shadowDataChunks && i < k && (i + 1) * chunkSize <= dataSize) {
+            stripe.at(i).data = data + i * chunkSize;
+            stripe.at(i).size = chunkSize;
+            stripe.at(i).freeData = false;
+            datap[i] = stripe.at(i).data;
+            continue;
+        }
+        // try allocate space for chunks and revert previous ones if fails
+        if (!stripe.at(i).allocateData(chunkSize, /* aligned */ true)) {
+            LOG(ERROR) << "Failed to allocate memory for chunk " << i << " in stripe with " << n << " chunks of size " << chunkSize;
+            stripe.clear();
+            return false;
+        }
+        if (i < k && shadowDataChunks) {
+            // copy the remaining data to chunk output, and pad the chunk with zeros
+            unsigned char *datacp = stripe.at(i).data;
+            length_t remaining = dataSize > i * chunkSize? dataSize - i * chunkSize : 0;
+            memcpy(datacp, data + i * chunkSize, remaining);
+            memset(datacp + remaining, 0, chunkSize - remaining);
+            datap[i] = datacp;
+        } else if (i < k) {
+            // copy data to chunk output and set the buffer pointers for encoding
+            unsigned char *datacp = stripe.at(i).data;
+            memcpy(datacp, data + i * chunkSize, chunkSize);
+            datap[i] = datacp;
+        } else {
+            // set the buffer pointers for encoding
+            codep[i - k] = (unsigned char *) stripe.at(i).data;
+        }
+    }
+
+    // encode data chunks to local and global parities, and compute the checksums of all chunks along if needed
+    if (computeChecksums) {
+        std::vector<std::unique_ptr<ChecksumCalculator> > checksums;
+        if (!createChecksums(checksumType, n, checksums))
+            return false;
+        ChecksumCalculator *checksump[n];
+        for (coding_param_t i = 0; i < n; i++)
+            checksump[i] = checksums.at(i).get();
+        ParallelCoding::getInstance().encode(chunkSize, k, n - k, _gftbl, datap, codep, checksump, checksump + k);
+        return setChecksums(checksums, checksumType, stripe);
+    }
+    ParallelCoding::getInstance().encode(chunkSize, k, n - k, _gftbl, datap, codep);
+
+    return true;
+}
+
+bool LRCCode::encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    if (dataDeltas.empty()) {
+        LOG(ERROR) << "No data chunk changes to encode";
+        return false;
+    }
+
+    length_t chunkSize = dataDeltas.at(0).size;
+    for (const Chunk &delta : dataDeltas) {
+        if (delta.getChunkId() < 0 || delta.getChunkId() >= k || delta.size != (int) chunkSize) {
+            LOG(ERROR) << "Invalid change to data chunk " << delta.getChunkId() << " of size " << delta.size << " (expected chunk size " << chunkSize << ")";
+            return false;
+        }
+    }
+
+    // init the code chunk changes to zeros
+    unsigned char *codep[n - k];
+    codeDeltas.clear();
+    codeDeltas.resize(n - k);
+    for (coding_param_t i = 0; i < n - k; i++) {
+        codeDeltas.at(i).setChunkId(k + i);
+        if (!codeDeltas.at(i).allocateData(chunkSize, /* aligned */ true)) {
+            LOG(ERROR) << "Failed to allocate memory for the change to code chunk " << k + i << " of size " << chunkSize;
+            codeDeltas.clear();
+            return false;
+        }
+        memset(codeDeltas.at(i).data, 0, chunkSize);
+        codep[i] = codeDeltas.at(i).data;
+    }
+
+    // accumulate the contribution of each data chunk change, since the code is linear
+    // (local parities of untouched groups get zero changes)
+    for (const Chunk &delta : dataDeltas) {
+        ec_encode_data_update(chunkSize, k, n - k, delta.getChunkId(), _gftbl, delta.data, codep);
+    }
+
+    return true;
+}
+
+bool LRCCode::carRepairFinalize(data_t *inputp[], num_t numInputChunks, length_t chunkSize, data_t *decodep[]) {
+    DLOG(INFO) << "Decode using partially encoded chunks, input chunks = " << numInputChunks;
+    // if there is only 1 input chunk from 1 rack, no further decoding is required
+    if (numInputChunks == 1) {
+        memcpy(decodep[0], inputp[0], chunkSize);
+        return true;
+    }
+    // construct decode matrix, which xor all partial encoded chunks
+    uint8_t decodeMatrix[numInputChunks], gftbl[numInputChunks * 32];
+    memset(decodeMatrix, 1, numInputChunks);
+    ec_init_tables(numInputChunks, 1, decodeMatrix, gftbl);
+    // decode (i.e., xor all chunks)
+    ParallelCoding::getInstance().encode(chunkSize, numInputChunks, 1, gftbl, inputp, decodep);
+
+    return true;
+}
+
+bool LRCCode::decode(std::vector<Chunk> &inputChunks, data_t **decodedData, length_t &decodedSize, DecodingPlan &plan, data_t *codingState, bool isRepair, std::vector<chunk_id_t> repairTargets) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    num_t numDecodedChunks = k;
+    num_t numInputChunks = inputChunks.size();
+    length_t chunkSize = inputChunks.empty()? 0 : inputChunks.at(0).size;
+
+    unsigned char *decodep[n], *inputp[n];
+    chunk_id_t inputIds[n], decodeIds[n];
+    bool isInput[n];
+    data_t *decodedDataTmp = NULL;
+    std::shared_ptr<const DecodingTable> table;
+
+    bool repairTargetSpecified = !repairTargets.empty();
+
+    DLOG_IF(INFO, isRepair && !repairTargetSpecified) << "Repair all missing chunks by default";
+    DLOG_IF(INFO, isRepair && repairTargetSpecified) << "Repair specific chunks";
+
+    // a local repair may use less than k chunks, while a decode of data chunks always needs k chunks
+    if (numInputChunks == 0 || numInputChunks > n || (numInputChunks < k && !isRepair)) {
+        LOG(ERROR) << "Invalid number of input chunks for decoding, got " << numInputChunks << " but requires " << (isRepair? 1 : (int) k) << " to " << (int) n << " chunks";
+        return false;
+    }
+
+    // set the input buffer pointers and ids
+    memset(isInput, 0, n);
+    for (num_t i = 0; i < numInputChunks; i++) {
+        inputp[i] = inputChunks.at(i).data;
+        inputIds[i] = inputChunks.at(i).getChunkId();
+        if (inputIds[i] < n) {
+            isInput[inputIds[i]] = true;
+        }
+    }
+
+    // figure out repair targets if not specified by function caller
+    for (chunk_id_t i = 0; isRepair && !repairTargetSpecified && i < n; i++) {
+        if (!isInput[i]) {
+            repairTargets.push_back(i);
+        }
+    }
+
+    // update the number of chunks to decode for repair after scanning for failed chunks when target was not specified by caller
+    if (isRepair) {
+        numDecodedChunks = repairTargets.size();
+    }
+
+    // allocate the decode buffer if nill, or reuse existing one
+    if (*decodedData == NULL) {
+        decodedDataTmp = (data_t*) malloc (sizeof(data_t) * numDecodedChunks * chunkSize);
+        if (decodedDataTmp == NULL) {
+            LOG(ERROR) << "Failed to allocate memory for decoded data of size " << numDecodedChunks * chunkSize;
+            return false;
+        }
+    } else {
+        decodedDataTmp = *decodedData;
+    }
+    // set up the decode buffer pointers
+    for (num_t i = 0; i < numDecodedChunks; i++) {
+        decodep[i] = (decodedDataTmp) + i * chunkSize;
+    }
+
+    // set the number of decoded chunks
+    decodedSize = numDecodedChunks * chunkSize;
+
+    // [special case 1] single chunk repair using CAR
+    if (isRepair && numDecodedChunks == 1 && _options.repairUsingCAR()) {
+        bool repaired = carRepairFinalize(inputp, numInputChunks, chunkSize, decodep);
+        if (repaired) {
+            *decodedData = decodedDataTmp;
+        } else if (*decodedData != decodedDataTmp) {
+            free(decodedDataTmp);
+        }
+        return repaired;
+    }
+
+    // decode all data chunks, or the repair targets for repair
+    for (num_t i = 0; i < numDecodedChunks; i++) {
+        decodeIds[i] = isRepair? repairTargets.at(i) : i;
+    }
+    table = getDecodingTable(inputIds, numInputChunks, decodeIds, numDecodedChunks);
+    if (!table) {
+        LOG(ERROR) << "Failed to get the decoding matrix";
+        // if unsuccessful, free locally allocated buffer
+        if (*decodedData != decodedDataTmp) free(decodedDataTmp);
+        return false;
+    }
+
+    // decode
+    ParallelCoding::getInstance().encode(chunkSize, numInputChunks, numDecodedChunks, (unsigned char *) table->gftbl.data(), inputp, decodep);
+
+    // set decode output
+    *decodedData = decodedDataTmp;
+
+    return true;
+}
+
+bool LRCCode::preDecode(const std::vector<chunk_id_t> &failedChunkIdx, DecodingPlan &plan, data_t *codingState, bool isRepair) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+    num_t numFailedChunks = failedChunkIdx.size();
+
+    plan.release();
+
+    bool isAlive[n];
+    num_t numFailedInGroup[_numLocalGroups];
+    std::fill(isAlive, isAlive + n, true);
+    std::fill(numFailedInGroup, numFailedInGroup + _numLocalGroups, 0);
+    for (num_t i = 0; i < numFailedChunks; i++) {
+        chunk_id_t id = failedChunkIdx.at(i);
+        if (id >= n) {
+            LOG(ERROR) << "Invalid failed chunk id " << id << " for n=" << (int) n;
+            return false;
+        }
+        isAlive[id] = false;
+        int group = getLocalGroup(id);
+        if (group >= 0) {
+            numFailedInGroup[group]++;
+        }
+    }
+
+    // repair each failed chunk from the rest of its local group if it is the only failed chunk there
+    std::vector<chunk_id_t> selected;
+    bool isLocalRepair = isRepair && numFailedChunks > 0;
+    for (num_t i = 0; i < numFailedChunks && isLocalRepair; i++) {
+        int group = getLocalGroup(failedChunkIdx.at(i));
+        isLocalRepair = group >= 0 && numFailedInGroup[group] == 1;
+    }
+    if (isLocalRepair) {
+        bool inGroup[_numLocalGroups];
+        std::fill(inGroup, inGroup + _numLocalGroups, false);
+        for (num_t i = 0; i < numFailedChunks; i++) {
+            inGroup[getLocalGroup(failedChunkIdx.at(i))] = true;
+        }
+        for (chunk_id_t i = 0; i < k + _numLocalGroups; i++) {
+            if (isAlive[i] && inGroup[getLocalGroup(i)]) {
+                selected.push_back(i);
+            }
+        }
+    } else if (selectIndependentChunks(isAlive, selected) < k) {
+        // otherwise, decode from k chunks, which are enough to recover any chunk
+        LOG(ERROR) << "Failed to find " << (int) k << " linearly independent chunks for decode (got " << selected.size() << ") with " << numFailedChunks << " failed chunks";
+        return false;
+    }
+
+    // selected chunks come first, followed by the other alive chunks as alternatives
+    bool isSelected[n];
+    std::fill(isSelected, isSelected + n, false);
+    for (chunk_id_t id : selected) {
+        plan.addInputChunkId(id);
+        isSelected[id] = true;
+    }
+    for (chunk_id_t i = 0; i < n; i++) {
+        if (isAlive[i] && !isSelected[i]) {
+            plan.addInputChunkId(i);
+        }
+    }
+    plan.setMinNumInputChunks(selected.size());
+
+    // only proceed to generate the repair matrix in plan when preparing for a repair
+    if (!isRepair || numFailedChunks == 0) {
+        return true;
+    }
+
+    // get the matrix for repairing the failed chunks from the selected chunks
+    std::shared_ptr<const DecodingTable> table = getDecodingTable(selected.data(), selected.size(), failedChunkIdx.data(), numFailedChunks);
+    if (!table) {
+        LOG(ERROR) << "Failed to get the matrix for repair";
+        plan.release();
+        return false;
+    }
+
+    // allocate space for outputting repair matrix
+    if (!plan.allocateRepairMatrix(table->matrix.size())) {
+        LOG(ERROR) << "Failed to allocate space for repair matrix";
+        plan.release();
+        return false;
+    }
+
+    // copy the rows for decoding failed chunks
+    memcpy(plan.getRepairMatrix(), table->matrix.data(), table->matrix.size());
+
+    return true;
+}
+
+num_t LRCCode::selectIndependentChunks(const bool *isAlive, std::vector<chunk_id_t> &selected) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    // rows of selected chunks in echelon form, each normalized to 1 at its pivot, and zero at the pivots of earlier rows
+    uint8_t basis[k * k];
+    num_t pivots[k];
+    num_t rank = 0;
+
+    selected.clear();
+    for (chunk_id_t id = 0; id < n && rank < k; id++) {
+        if (!isAlive[id]) {
+            continue;
+        }
+        uint8_t row[k];
+        memcpy(row, _encodeMatrix + id * k, k);
+        // eliminate the pivots of selected rows
+        for (num_t r = 0; r < rank; r++) {
+            uint8_t c = row[pivots[r]];
+            if (c == 0) continue;
+            for (num_t j = 0; j < k; j++)
+                row[j] ^= gf_mul(c, basis[r * k + j]);
+        }
+        // skip the chunk if its row depends on those selected
+        num_t pivot = 0;
+        while (pivot < k && row[pivot] == 0) pivot++;
+        if (pivot == k) {
+            continue;
+        }
+        uint8_t inv = gf_inv(row[pivot]);
+        for (num_t j = 0; j < k; j++)
+            basis[rank * k + j] = gf_mul(inv, row[j]);
+        pivots[rank++] = pivot;
+        selected.push_back(id);
+    }
+
+    return rank;
+}
+
+std::shared_ptr<const DecodingTable> LRCCode::getDecodingTable(const chunk_id_t *inputIds, num_t numInputs, const chunk_id_t *targetIds, num_t numTargets) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    DecodingTableCache &cache = DecodingTableCache::getInstance();
+    std::string key = DecodingTableCache::genKey(_name, n, k, inputIds, numInputs, targetIds, numTargets);
+
+    std::shared_ptr<const DecodingTable> cached = cache.get(key);
+    if (cached) {
+        return cached;
+    }
+
+    // solve A * X = B by Gauss-Jordan elimination, where column i of A (k x numInputs) is the row of input chunk i,
+    // column t of B (k x numTargets) is the row of target chunk t, and column t of X gives the coefficients of
+    // the input chunks for decoding target chunk t
+    num_t width = numInputs + numTargets;
+    std::vector<uint8_t> a (k * width);
+    for (num_t r = 0; r < k; r++) {
+        for (num_t i = 0; i < numInputs; i++)
+            a[r * width + i] = _encodeMatrix[inputIds[i] * k + r];
+        for (num_t t = 0; t < numTargets; t++)
+            a[r * width + numInputs + t] = _encodeMatrix[targetIds[t] * k + r];
+    }
+
+    num_t pivots[k];
+    num_t rank = 0;
+    for (num_t c = 0; c < numInputs && rank < k; c++) {
+        num_t p = rank;
+        while (p < k && a[p * width + c] == 0) p++;
+        if (p == k) {
+            continue;
+        }
+        if (p != rank) {
+            std::swap_ranges(a.begin() + p * width, a.begin() + (p + 1) * width, a.begin() + rank * width);
+        }
+        uint8_t inv = gf_inv(a[rank * width + c]);
+        for (num_t j = 0; j < width; j++)
+            a[rank * width + j] = gf_mul(inv, a[rank * width + j]);
+        for (num_t r = 0; r < k; r++) {
+            uint8_t f = a[r * width + c];
+            if (r == rank || f == 0) continue;
+            for (num_t j = 0; j < width; j++)
+                a[r * width + j] ^= gf_mul(f, a[rank * width + j]);
+        }
+        pivots[rank++] = c;
+    }
+
+    // the target chunks are not in the span of the input chunks
+    for (num_t r = rank; r < k; r++) {
+        for (num_t t = 0; t < numTargets; t++) {
+            if (a[r * width + numInputs + t] != 0) {
+                LOG(ERROR) << "Failed to decode chunk " << targetIds[t] << " from the " << numInputs << " input chunks";
+                return std::shared_ptr<const DecodingTable>();
+            }
+        }
+    }
+
+    std::shared_ptr<DecodingTable> table = std::make_shared<DecodingTable>();
+    table->matrix.resize(numTargets * numInputs, 0);
+    table->gftbl.resize(numTargets * numInputs * 32);
+
+    uint8_t *matrix = table->matrix.data();
+    for (num_t r = 0; r < rank; r++) {
+        for (num_t t = 0; t < numTargets; t++)
+            matrix[t * numInputs + pivots[r]] = a[r * width + numInputs + t];
+    }
+    ec_init_tables(numInputs, numTargets, matrix, table->gftbl.data());
+
+    cache.put(key, table);
+
+    return table;
+}
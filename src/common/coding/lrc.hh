@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __LRC_CODE_HH__
+#define __LRC_CODE_HH__
+
+#include <stdint.h> // uint8_t
+#include <memory>
+#include "coding.hh"
+#include "decoding_table_cache.hh"
+#include "../config.hh"
+
+/**
+ * Locally repairable codes (Azure-style LRC)
+ *
+ * A stripe of LRC(k,l,g) has k data chunks (ids 0 to k-1), l local parity chunks (ids k to k+l-1), and g global
+ * parity chunks (ids k+l to n-1). The data chunks are split evenly into l local groups, and each local parity is
+ * the XOR of the data chunks in its group. Global parity i is the sum of a_j^(i+1) * (data chunk j) for distinct
+ * non-zero a_j, such that any g+1 chunk failures are recoverable.
+ *
+ * Only n and k are stored in the coding metadata, so the number of global parities is fixed to
+ * LRC_NUM_GLOBAL_PARITIES and the number of local groups is l = n-k-LRC_NUM_GLOBAL_PARITIES.
+ **/
+class LRCCode : public Coding {
+public:
+
+    LRCCode(CodingOptions options);
+    ~LRCCode() {}
+    /**
+     * see Coding::getNumDataChunks()
+     **/
+    num_t getNumDataChunks();
+
+    /**
+     * see Coding::getNumCodeChunks()
+     **/
+    num_t getNumCodeChunks();
+
+    /**
+     * see Coding::getNumChunks()
+     **/
+    num_t getNumChunks();
+
+    /**
+     * see Coding::getNumChunksPerNode()
+     **/
+    num_t getNumChunksPerNode();
+
+    /**
+     * see Coding::getCodingStateSize()
+     **/
+    length_t getCodingStateSize();
+
+    /**
+     * see Coding::encode()
+     *
+     * @remark coding state is ignored for LRC
+     * @remark with shadowDataChunks, only the code chunks and the data chunk with padding at the end of data are allocated
+     **/
+    bool encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks = false, bool computeChecksums = false, int checksumType = ChecksumType::CHECKSUM_MD5);
+
+    /**
+     * see Coding::decode()
+     *
+     * @remark coding state is ignored for LRC
+     * @remark all input chunks are used for decoding, so the inputs should follow the minimal set in the decoding plan
+     **/
+    bool decode(std::vector<Chunk> &inputChunks, data_t **decodedData, length_t &decodedSize, DecodingPlan &plan, data_t *codingState, bool isRepair = false, std::vector<chunk_id_t> repairTargets = std::vector<chunk_id_t>());
+
+    /**
+     * see Coding::encodeDelta()
+     **/
+    bool encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas);
+
+    /**
+     * see Coding::preDecode()
+     *
+     * @remark coding state is ignored for LRC
+     * @remark for repair, a data chunk or local parity which is the only failed chunk in its local group is repaired from the rest of the group; otherwise, k chunks are used
+     **/
+    bool preDecode(const std::vector<chunk_id_t> &failedChunkIdx, DecodingPlan &plan, data_t *codingState, bool isRepair = false);
+
+    /**
+     * see Coding::getChunkSize()
+     **/
+    length_t getChunkSize(length_t dataSize);
+
+    /**
+     * Tell the number of local groups
+     *
+     * @return number of local groups
+     **/
+    num_t getNumLocalGroups();
+
+    /**
+     * Tell the local group of a chunk
+     *
+     * @param[in] chunkId                 id of the chunk
+     *
+     * @return the local group of a data chunk or a local parity, or -1 for a global parity
+     **/
+    int getLocalGroup(chunk_id_t chunkId);
+
+private:
+
+    /**
+     * Final decoding step for repair using CAR (xor all chunks)
+     *
+     * @param[in] inputp                  array of input chunk buffer pointers
+     * @param[in] numInputChunks          number of input chunks
+     * @param[in] chunkSize               chunk size
+     * @param[out] decodep                array of decoded chunk buffer pointers
+     *
+     * @return true if decoding is successful, false otherwise
+     **/
+    bool carRepairFinalize(unsigned char *inputp[], num_t numInputChunks, length_t chunkSize, unsigned char *decodep[]);
+
+    /**
+     * Get the decoding table for decoding the target chunks from the input chunks, from the shared cache if available
+     *
+     * @param[in] inputIds                ids of the input chunks
+     * @param[in] numInputs               number of input chunks
+     * @param[in] targetIds               ids of the target chunks
+     * @param[in] numTargets              number of target chunks
+     *
+     * @return the decoding table with one row of numInputs coefficients per target chunk, or an empty pointer if the target chunks cannot be decoded from the input chunks
+     **/
+    std::shared_ptr<const DecodingTable> getDecodingTable(const chunk_id_t *inputIds, num_t numInputs, const chunk_id_t *targetIds, num_t numTargets);
+
+    /**
+     * Select chunks with linearly independent encoding matrix rows, in ascending order of chunk ids
+     *
+     * @param[in] isAlive                 whether each chunk in the stripe is alive
+     * @param[out] selected               ids of the selected chunks
+     *
+     * @return number of selected chunks, i.e., the rank of the encoding matrix rows of alive chunks
+     **/
+    num_t selectIndependentChunks(const bool *isAlive, std::vector<chunk_id_t> &selected);
+
+    num_t _numLocalGroups;                                  /**< number of local groups (l) */
+    uint8_t _encodeMatrix[CODING_MAX_N * CODING_MAX_N];     /**< encoding matrix, one row of k coefficients per chunk */
+    uint8_t _gftbl[CODING_MAX_N * CODING_MAX_N * 32];       /**< expanded tables of the rows of parity chunks */
+
+};
+
+#endif // define __LRC_CODE_HH__
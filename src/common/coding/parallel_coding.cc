@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "parallel_coding.hh"
+
+extern "C" {
+#include <isa-l/erasure_code.h>
+}
+
+#include <glog/logging.h>
+
+ParallelCoding::ParallelCoding() {
+    _stop = false;
+    _numThreads = PARALLEL_CODING_DEFAULT_NUM_THREADS;
+    _threshold = PARALLEL_CODING_DEFAULT_THRESHOLD;
+    startWorkers(_numThreads - 1);
+}
+
+ParallelCoding::~ParallelCoding() {
+    stopWorkers();
+}
+
+void ParallelCoding::encode(length_t len, int numInputs, int numOutputs, unsigned char *gftbl, unsigned char **inputs, unsigned char **outputs) {
+    encode(len, numInputs, numOutputs, gftbl, inputs, outputs, NULL, NULL);
+}
+
+void ParallelCoding::encode(length_t len, int numInputs, int numOutputs, unsigned char *gftbl, unsigned char **inputs, unsigned char **outputs, ChecksumCalculator **inputChecksums, ChecksumCalculator **outputChecksums) {
+    int numThreads = _numThreads;
+    bool parallel = numThreads > 1 && len >= _threshold && numInputs > 0 && numOutputs > 0;
+    bool checksum = inputChecksums != NULL || outputChecksums != NULL;
+
+    if (parallel) {
+        // code the slices in parallel
+        length_t sliceSize = getSliceSize(len, numInputs, numOutputs, numThreads);
+        num_t numSlices = (len + sliceSize - 1) / sliceSize;
+        run(numSlices, numThreads, [=](num_t slice) {
+            length_t offset = slice * sliceSize;
+            length_t size = std::min(sliceSize, len - offset);
+            unsigned char *inputp[numInputs], *outputp[numOutputs];
+            for (int i = 0; i < numInputs; i++)
+                inputp[i] = inputs[i] + offset;
+            for (int i = 0; i < numOutputs; i++)
+                outputp[i] = outputs[i] + offset;
+            ec_encode_data(size, numInputs, numOutputs, gftbl, inputp, outputp);
+        });
+        if (!checksum)
+            return;
+        // checksum the chunks in parallel, as each checksum goes through its chunk in order
+        run(numInputs + numOutputs, numThreads, [=](num_t i) {
+            ChecksumCalculator *cal = (int) i < numInputs? (inputChecksums? inputChecksums[i] : NULL) : (outputChecksums? outputChecksums[i - numInputs] : NULL);
+            if (cal)
+                cal->appendData((int) i < numInputs? inputs[i] : outputs[i - numInputs], len);
+        });
+        return;
+    }
+
+    if (!checksum) {
+        ec_encode_data(len, numInputs, numOutputs, gftbl, inputs, outputs);
+        return;
+    }
+
+    // code and checksum block by block, while the block of each chunk is in the cache
+    length_t blockSize = getBlockSize(numInputs + numOutputs);
+    unsigned char *inputp[numInputs], *outputp[numOutputs];
+    for (length_t offset = 0; offset < len; offset += blockSize) {
+        length_t size = std::min(blockSize, len - offset);
+        for (int i = 0; i < numInputs; i++)
+            inputp[i] = inputs[i] + offset;
+        for (int i = 0; i < numOutputs; i++)
+            outputp[i] = outputs[i] + offset;
+        if (numInputs > 0 && numOutputs > 0)
+            ec_encode_data(size, numInputs, numOutputs, gftbl, inputp, outputp);
+        for (int i = 0; inputChecksums && i < numInputs; i++)
+            if (inputChecksums[i])
+                inputChecksums[i]->appendData(inputp[i], size);
+        for (int i = 0; outputChecksums && i < numOutputs; i++)
+            if (outputChecksums[i])
+                outputChecksums[i]->appendData(outputp[i], size);
+    }
+}
+
+void ParallelCoding::run(num_t numTasks, int numThreads, std::function<void(num_t)> task) {
+    if (numTasks <= 1 || numThreads <= 1) {
+        for (num_t i = 0; i < numTasks; i++)
+            task(i);
+        return;
+    }
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->numTasks = numTasks;
+    job->task = task;
+    job->next = 0;
+    job->done = 0;
+
+    // ask for help from at most one worker per remaining task
+    int numHelpers = std::min(numThreads - 1, (int) numTasks - 1);
+    {
+        std::lock_guard<std::mutex> lk(_lock);
+        for (int i = 0; i < numHelpers; i++)
+            _jobs.push_back(job);
+    }
+    if (numHelpers > 1) {
+        _hasJob.notify_all();
+    } else {
+        _hasJob.notify_one();
+    }
+
+    // run tasks in the calling thread as well
+    while (job->runTask());
+
+    // wait for the tasks claimed by the workers
+    std::unique_lock<std::mutex> lk(job->lock);
+    job->cv.wait(lk, [&job] { return job->done == job->numTasks; });
+}
+
+bool ParallelCoding::Job::runTask() {
+    num_t i = next++;
+    if (i >= numTasks)
+        return false;
+
+    task(i);
+
+    if (++done == numTasks) {
+        // take the lock to avoid signaling between the check and the wait of the calling thread
+        { std::lock_guard<std::mutex> lk(lock); }
+        cv.notify_all();
+    }
+    return true;
+}
+
+void ParallelCoding::work() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lk(_lock);
+            _hasJob.wait(lk, [this] { return _stop || !_jobs.empty(); });
+            if (_stop)
+                return;
+            job = _jobs.front();
+            _jobs.pop_front();
+        }
+        while (job->runTask());
+    }
+}
+
+void ParallelCoding::setNumThreads(int numThreads) {
+    if (numThreads <= 0)
+        numThreads = std::max((int) std::thread::hardware_concurrency(), 1);
+
+    stopWorkers();
+    startWorkers(numThreads - 1);
+    _numThreads = numThreads;
+
+    DLOG(INFO) << "Parallel coding with " << numThreads << " threads for chunks of " << _threshold << " bytes or more";
+}
+
+void ParallelCoding::setThreshold(length_t threshold) {
+    _threshold = threshold;
+}
+
+int ParallelCoding::getNumThreads() const {
+    return _numThreads;
+}
+
+length_t ParallelCoding::getThreshold() const {
+    return _threshold;
+}
+
+length_t ParallelCoding::getSliceSize(length_t len, int numInputs, int numOutputs, int numThreads) {
+    if (numThreads <= 1 || numInputs + numOutputs <= 0)
+        return len;
+
+    // fit the slices of all input and output chunks into the cache
+    length_t sliceSize = PARALLEL_CODING_SLICE_WORKING_SET / (numInputs + numOutputs);
+    // give every thread at least one slice
+    length_t evenSize = (len + numThreads - 1) / numThreads;
+    sliceSize = std::min(sliceSize, evenSize);
+    sliceSize = std::max(sliceSize / PARALLEL_CODING_SLICE_ALIGNMENT * PARALLEL_CODING_SLICE_ALIGNMENT, (length_t) PARALLEL_CODING_MIN_SLICE_SIZE);
+
+    return sliceSize < len? sliceSize : len;
+}
+
+length_t ParallelCoding::getBlockSize(int numChunks) {
+    length_t blockSize = PARALLEL_CODING_SLICE_WORKING_SET / std::max(numChunks, 1);
+    return std::max(blockSize / PARALLEL_CODING_SLICE_ALIGNMENT * PARALLEL_CODING_SLICE_ALIGNMENT, (length_t) PARALLEL_CODING_MIN_SLICE_SIZE);
+}
+
+void ParallelCoding::startWorkers(int numWorkers) {
+    std::lock_guard<std::mutex> lk(_lock);
+    _stop = false;
+    for (int i = 0; i < numWorkers; i++)
+        _workers.emplace_back(&ParallelCoding::work, this);
+}
+
+void ParallelCoding::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lk(_lock);
+        _stop = true;
+    }
+    _hasJob.notify_all();
+    for (auto &worker : _workers)
+        worker.join();
+    _workers.clear();
+    // drop requests for help left behind, the calling threads code the remaining slices themselves
+    std::lock_guard<std::mutex> lk(_lock);
+    _jobs.clear();
+}
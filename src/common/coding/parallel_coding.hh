@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PARALLEL_CODING_HH__
+#define __PARALLEL_CODING_HH__
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../define.hh"
+#include "../checksum_calculator.hh"
+
+#define PARALLEL_CODING_DEFAULT_NUM_THREADS  (1)
+#define PARALLEL_CODING_DEFAULT_THRESHOLD    (4 << 20)
+#define PARALLEL_CODING_SLICE_ALIGNMENT      (64)
+#define PARALLEL_CODING_SLICE_WORKING_SET    (1 << 20)
+#define PARALLEL_CODING_MIN_SLICE_SIZE       (4 << 10)
+
+/**
+ * Shared worker pool for running ec_encode_data() on slices of the chunks in parallel
+ *
+ * The chunk length is split into slices aligned to the cache line size. Each slice is sized such that the slices of
+ * all input and output chunks fit into the cache together. The calling thread and the workers claim slices one by
+ * one until all slices are coded. Chunks shorter than the threshold are coded directly by the calling thread.
+ *
+ * Checksums of the chunks can be computed along with coding. Without parallel coding, the chunks are coded and
+ * checksummed block by block, while each block is still in the cache. With parallel coding, the chunks are coded in
+ * slices and then checksummed in parallel, one chunk per thread at a time.
+ **/
+class ParallelCoding {
+public:
+
+    static ParallelCoding& getInstance() {
+        static ParallelCoding instance;
+        return instance;
+    }
+
+    /**
+     * Code the input chunks into the output chunks, i.e., a drop-in replacement of ec_encode_data()
+     *
+     * @param[in] len           length of each chunk
+     * @param[in] numInputs     number of input chunks
+     * @param[in] numOutputs    number of output chunks
+     * @param[in] gftbl         expanded GF tables of the coding matrix
+     * @param[in] inputs        pointers to the input chunks
+     * @param[out] outputs      pointers to the output chunks
+     **/
+    void encode(length_t len, int numInputs, int numOutputs, unsigned char *gftbl, unsigned char **inputs, unsigned char **outputs);
+
+    /**
+     * Code the input chunks into the output chunks, and append the chunk data to the checksums
+     *
+     * @param[in] len               length of each chunk
+     * @param[in] numInputs         number of input chunks
+     * @param[in] numOutputs        number of output chunks
+     * @param[in] gftbl             expanded GF tables of the coding matrix
+     * @param[in] inputs            pointers to the input chunks
+     * @param[out] outputs          pointers to the output chunks
+     * @param[in] inputChecksums    checksums of the input chunks, NULL (for the array or an entry) to skip
+     * @param[in] outputChecksums   checksums of the output chunks, NULL (for the array or an entry) to skip
+     *
+     * @remark the checksums are not finalized, so consecutive calls can cover consecutive parts of the chunks
+     **/
+    void encode(length_t len, int numInputs, int numOutputs, unsigned char *gftbl, unsigned char **inputs, unsigned char **outputs, ChecksumCalculator **inputChecksums, ChecksumCalculator **outputChecksums);
+
+    /**
+     * Set the number of threads for coding, including the calling thread, and restart the workers
+     *
+     * @param[in] numThreads    number of threads, 0 for the number of hardware threads, and 1 to disable parallel coding
+     *
+     * @remark this should not be called while chunks are being coded
+     **/
+    void setNumThreads(int numThreads);
+
+    /**
+     * Set the min. chunk length for parallel coding
+     *
+     * @param[in] threshold     min. chunk length in bytes
+     **/
+    void setThreshold(length_t threshold);
+
+    int getNumThreads() const;
+    length_t getThreshold() const;
+
+    /**
+     * Get the slice size for coding chunks in parallel
+     *
+     * @param[in] len           length of each chunk
+     * @param[in] numInputs     number of input chunks
+     * @param[in] numOutputs    number of output chunks
+     * @param[in] numThreads    number of threads
+     *
+     * @return slice size, a multiple of the alignment except when it covers the whole chunk
+     **/
+    static length_t getSliceSize(length_t len, int numInputs, int numOutputs, int numThreads);
+
+    /**
+     * Get the block size for coding and checksumming chunks block by block
+     *
+     * @param[in] numChunks     total number of input and output chunks
+     *
+     * @return block size, a multiple of the alignment
+     **/
+    static length_t getBlockSize(int numChunks);
+
+private:
+    ParallelCoding();
+    ~ParallelCoding();
+    ParallelCoding(const ParallelCoding&) = delete;
+    void operator=(const ParallelCoding&) = delete;
+
+    /**
+     * Independent tasks of one request, e.g., the slices to code
+     **/
+    struct Job {
+        num_t numTasks;                         /**< number of tasks */
+        std::function<void(num_t)> task;        /**< function to run a task by its index */
+
+        std::atomic<num_t> next;                /**< next task to claim */
+        std::atomic<num_t> done;                /**< number of tasks completed */
+        std::mutex lock;                        /**< lock for waiting on completion */
+        std::condition_variable cv;             /**< signal on completion */
+
+        /**
+         * Claim and run one task
+         *
+         * @return whether a task is claimed
+         **/
+        bool runTask();
+    };
+
+    /**
+     * Run the tasks on the workers and the calling thread, and wait until all of them complete
+     *
+     * @param[in] numTasks      number of tasks
+     * @param[in] numThreads    max. number of threads to use, including the calling thread
+     * @param[in] task          function to run a task by its index
+     **/
+    void run(num_t numTasks, int numThreads, std::function<void(num_t)> task);
+
+    /**
+     * Worker loop, which helps run the tasks of queued jobs
+     **/
+    void work();
+
+    void startWorkers(int numWorkers);
+    void stopWorkers();
+
+    std::mutex _lock;                                   /**< lock on the job queue and workers */
+    std::condition_variable _hasJob;                    /**< signal on new jobs or stop */
+    std::deque<std::shared_ptr<Job> > _jobs;            /**< jobs waiting for help, one entry per worker wanted */
+    std::vector<std::thread> _workers;                  /**< worker threads */
+    bool _stop;                                         /**< whether the workers should stop */
+
+    std::atomic<int> _numThreads;                       /**< number of threads for coding, including the calling thread */
+    std::atomic<length_t> _threshold;                   /**< min. chunk length for parallel coding */
+};
+
+#endif // define __PARALLEL_CODING_HH__
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "rs.hh"
+#include "parallel_coding.hh"
 
 extern "C" {
 #include <isa-l/erasure_code.h>
@@ -21,6 +22,8 @@ RSCode::RSCode(CodingOptions options) {
     _options = options;
 
     _name = "RS";
+    _systematic = true;
+    _deltaUpdate = true;
 
     // initialize and generate RS matrix for coding
     gf_gen_rs_matrix(_encodeMatrix, n, k);
@@ -54,7 +57,7 @@ length_t RSCode::getChunkSize(length_t dataSize) {
     return (dataSize + k - 1) / k;
 }
 
-bool RSCode::encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState) {
+bool RSCode::encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks, bool computeChecksums, int checksumType) {
     coding_param_t k = _options.getK(), n = _options.getN();
 
     unsigned char *codep[n - k], *datap[k];
@@ -68,13 +71,28 @@ bool RSCode::encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe,
     // set the pointers for data and code chunks
     for (coding_param_t i = 0; i < n; i++) {
         stripe.at(i).setChunkId(i); 
+        // reference the data chunks fully covered by the data buffer
+        if (shadowDataChunks && i < k && (i + 1) * chunkSize <= dataSize) {
+            stripe.at(i).data = data + i * chunkSize;
+            stripe.at(i).size = chunkSize;
+            stripe.at(i).freeData = false;
+            datap[i] = stripe.at(i).data;
+            continue;
+        }
         // try allocate space for chunks and revert previous ones if fails
         if (!stripe.at(i).allocateData(chunkSize, /* aligned */ true)) {
             LOG(ERROR) << "Failed to allocate memory for chunk " << i << " in stripe with " << n << " chunks of size " << chunkSize;
             stripe.clear();
             return false;
         }
-        if (i < k) {
+        if (i < k && shadowDataChunks) {
+            // copy the remaining data to chunk output, and pad the chunk with zeros
+            unsigned char *datacp = stripe.at(i).data;
+            length_t remaining = dataSize > i * chunkSize? dataSize - i * chunkSize : 0;
+            memcpy(datacp, data + i * chunkSize, remaining);
+            memset(datacp + remaining, 0, chunkSize - remaining);
+            datap[i] = datacp;
+        } else if (i < k) {
             // copy data to chunk output and set the buffer pointers for encoding
             unsigned char *datacp = stripe.at(i).data;
             memcpy(datacp, data + i * chunkSize, chunkSize);
@@ -85,8 +103,57 @@ bool RSCode::encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe,
         }
     }
 
-    // encode data chunks to code chunks
-    ec_encode_data(chunkSize, k, n - k, _gftbl, datap, codep);
+    // encode data chunks to code chunks, and compute the checksums of all chunks along if needed
+    if (computeChecksums) {
+        std::vector<std::unique_ptr<ChecksumCalculator> > checksums;
+        if (!createChecksums(checksumType, n, checksums))
+            return false;
+        ChecksumCalculator *checksump[n];
+        for (coding_param_t i = 0; i < n; i++)
+            checksump[i] = checksums.at(i).get();
+        ParallelCoding::getInstance().encode(chunkSize, k, n - k, _gftbl, datap, codep, checksump, checksump + k);
+        return setChecksums(checksums, checksumType, stripe);
+    }
+    ParallelCoding::getInstance().encode(chunkSize, k, n - k, _gftbl, datap, codep);
+
+    return true;
+}
+
+bool RSCode::encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    if (dataDeltas.empty()) {
+        LOG(ERROR) << "No data chunk changes to encode";
+        return false;
+    }
+
+    length_t chunkSize = dataDeltas.at(0).size;
+    for (const Chunk &delta : dataDeltas) {
+        if (delta.getChunkId() < 0 || delta.getChunkId() >= k || delta.size != (int) chunkSize) {
+            LOG(ERROR) << "Invalid change to data chunk " << delta.getChunkId() << " of size " << delta.size << " (expected chunk size " << chunkSize << ")";
+            return false;
+        }
+    }
+
+    // init the code chunk changes to zeros
+    unsigned char *codep[n - k];
+    codeDeltas.clear();
+    codeDeltas.resize(n - k);
+    for (coding_param_t i = 0; i < n - k; i++) {
+        codeDeltas.at(i).setChunkId(k + i);
+        if (!codeDeltas.at(i).allocateData(chunkSize, /* aligned */ true)) {
+            LOG(ERROR) << "Failed to allocate memory for the change to code chunk " << k + i << " of size " << chunkSize;
+            codeDeltas.clear();
+            return false;
+        }
+        memset(codeDeltas.at(i).data, 0, chunkSize);
+        codep[i] = codeDeltas.at(i).data;
+    }
+
+    // accumulate the contribution of each data chunk change, since the code is linear
+    for (const Chunk &delta : dataDeltas) {
+        ec_encode_data_update(chunkSize, k, n - k, delta.getChunkId(), _gftbl, delta.data, codep);
+    }
 
     return true;
 }
@@ -103,7 +170,7 @@ bool RSCode::carRepairFinalize(data_t *inputp[], num_t numInputChunks, length_t
     memset(decodeMatrix, 1, numInputChunks);
     ec_init_tables(numInputChunks, 1, decodeMatrix, gftbl);
     // decode (i.e., xor all chunks)
-    ec_encode_data(chunkSize, numInputChunks, 1, gftbl, inputp, decodep);
+    ParallelCoding::getInstance().encode(chunkSize, numInputChunks, 1, gftbl, inputp, decodep);
 
     return true;
 }
@@ -115,14 +182,12 @@ bool RSCode::decode(std::vector<Chunk> &inputChunks, data_t **decodedData, lengt
     num_t numInputChunks = inputChunks.size();
     length_t chunkSize = inputChunks.empty()? 0 : inputChunks.at(0).size; 
 
-    int matrixSize = n * n;
-    uint8_t decodeMatrix [matrixSize];
-    uint8_t invertedMatrix [matrixSize];
     unsigned char *decodep[n], *inputp[n];
+    chunk_id_t inputIds[n], decodeIds[n];
+    num_t numInputIds = 0;
     data_t *decodedDataTmp = NULL;
-    uint8_t *finalMatrix = NULL;
+    std::shared_ptr<const DecodingTable> table;
 
-    bool allDataInput = true;
     bool repairTargetSpecified = !repairTargets.empty();
 
     DLOG_IF(INFO, isRepair && !repairTargetSpecified) << "Repair all missing chunks by default";
@@ -135,7 +200,7 @@ bool RSCode::decode(std::vector<Chunk> &inputChunks, data_t **decodedData, lengt
         return false;
     }
 
-    // (1) form a matrix that encodes the input rows
+    // (1) find the ids of input chunks which the decoding matrix is formed with
     // (2) figure out repair targets if not specified by function caller 
     // (3) set the input buffer pointer arrays for decoding
     for (chunk_id_t i = 0, inputIdx = 0, chunkId = 0; i < n; i++) {
@@ -144,10 +209,7 @@ bool RSCode::decode(std::vector<Chunk> &inputChunks, data_t **decodedData, lengt
             inputp[i] = inputChunks.at(i).data;
         }
         if (inputIdx < numInputChunks && ((chunkId = inputChunks.at(inputIdx).chunkId) == i)) { // alive chunks
-            // check if all input are data chunks
-            allDataInput &= inputIdx == i;
-            // prepare matrix for inversion and decoding
-            memcpy(decodeMatrix + inputIdx * k, _encodeMatrix + chunkId * k, k);
+            inputIds[numInputIds++] = chunkId;
             // increment the input index
             inputIdx++;
         } else if (isRepair && !repairTargetSpecified) { // failed chunk that should be the repair targets
@@ -191,43 +253,25 @@ bool RSCode::decode(std::vector<Chunk> &inputChunks, data_t **decodedData, lengt
         return repaired;
     }
 
-    // normal decoding flow (invert the encoding matrix of input chunks and apply it for decoding)
-    // get the inverse of the encoding matrix
-    if (gf_invert_matrix(decodeMatrix, invertedMatrix, k) < 0) {
-        LOG(ERROR) << "Failed to invert the matrix for decoding";
+    // normal decoding flow (apply the inverse of the encoding matrix of input chunks for decoding)
+    // decode all data chunks, or the repair targets for repair
+    for (num_t i = 0; i < numDecodedChunks; i++) {
+        decodeIds[i] = isRepair? repairTargets.at(i) : i;
+    }
+    if (numInputIds >= k) {
+        table = getDecodingTable(inputIds, decodeIds, numDecodedChunks);
+    } else {
+        LOG(ERROR) << "Insufficient input chunks in ascending order of chunk ids for decoding, got " << numInputIds << " but requires " << (int) k << " chunks or more";
+    }
+    if (!table) {
+        LOG(ERROR) << "Failed to get the decoding matrix";
         // if unsuccessful, free locally allocated buffer
         if (*decodedData != decodedDataTmp) free(decodedDataTmp);
         return false;
     }
 
-    // final matrix to apply for decoding, which is the inverted one by default
-    finalMatrix = invertedMatrix;
-
-    // generate a new matrix for repair 
-    if (isRepair) {
-        // copy the rows for decoding
-        num_t i = 0, j = 0, l = 0;
-        uint8_t s;
-        for (i = 0; i < numDecodedChunks && repairTargets.at(i) < k; i++) {
-            memcpy(decodeMatrix + k * i, invertedMatrix + k * repairTargets.at(i), k);
-        }
-        // code chunks
-        for (; i < numDecodedChunks; i++) {
-            for (j = 0; j < k; j++) {
-                s = 0;
-                for (l = 0; l < k; l++)
-                    s ^= gf_mul(invertedMatrix[l * k + j], _encodeMatrix[repairTargets.at(i) * k + l]);
-                decodeMatrix[i * k + j] = s;
-            }
-        }
-        // use the generated matrix for decoding instead
-        finalMatrix = decodeMatrix;
-    }
-
     // decode
-    uint8_t gftbl [matrixSize * 32];
-    ec_init_tables(k, numDecodedChunks, finalMatrix, gftbl);
-    ec_encode_data(chunkSize, k, numDecodedChunks, gftbl, inputp, decodep);
+    ParallelCoding::getInstance().encode(chunkSize, k, numDecodedChunks, (unsigned char *) table->gftbl.data(), inputp, decodep);
 
     // set decode output
     *decodedData = decodedDataTmp;
@@ -276,19 +320,10 @@ bool RSCode::preDecode(const std::vector<chunk_id_t> &failedChunkIdx, DecodingPl
         return true;
     }
 
-    // find the invert matrix for decoding first
-    int matrixSize = n * n;
-    uint8_t decodeMatrix [matrixSize];
-    uint8_t invertedMatrix [matrixSize];
-
-    // get the row where data is alive
-    for (num_t i = 0; i < numInputChunks; i++) {
-        memcpy(decodeMatrix + i * k, _encodeMatrix + inputChunkIds.at(i) * k, k);
-    }
-
-    // get the inverse of the matrix of alive data
-    if (gf_invert_matrix(decodeMatrix, invertedMatrix, k) < 0) {
-        LOG(ERROR) << "Failed to invert the matrix for repair";
+    // get the matrix for repairing the failed chunks from the first k alive chunks
+    std::shared_ptr<const DecodingTable> table = getDecodingTable(inputChunkIds.data(), erasures, e);
+    if (!table) {
+        LOG(ERROR) << "Failed to get the matrix for repair";
         plan.release();
         return false;
     }
@@ -301,22 +336,60 @@ bool RSCode::preDecode(const std::vector<chunk_id_t> &failedChunkIdx, DecodingPl
     }
 
     // copy the rows for decoding failed strips into extraInfo
-    data_t *repairMatrix = plan.getRepairMatrix();
-    int j = 0, l = 0;
-    uint8_t s = 0;
-    // data chunks
-    for (i = 0; i < e && erasures[i] < k; i++) {
-        memcpy(repairMatrix + k * i, invertedMatrix + k * erasures[i], sizeof(uint8_t) * k);
+    memcpy(plan.getRepairMatrix(), table->matrix.data(), e * k);
+
+    return true;
+}
+
+std::shared_ptr<const DecodingTable> RSCode::getDecodingTable(const chunk_id_t *inputIds, const chunk_id_t *targetIds, num_t numTargets) {
+    coding_param_t k = _options.getK(), n = _options.getN();
+
+    DecodingTableCache &cache = DecodingTableCache::getInstance();
+    std::string key = DecodingTableCache::genKey(_name, n, k, inputIds, k, targetIds, numTargets);
+
+    std::shared_ptr<const DecodingTable> cached = cache.get(key);
+    if (cached) {
+        return cached;
     }
-    // code chunks
-    for (; i < e; i++) {
-        for (j = 0; j < k; j++) {
-            s = 0;
-            for (l = 0; l < k; l++)
-                s ^= gf_mul(invertedMatrix[l * k + j], _encodeMatrix[erasures[i] * k + l]);
-            repairMatrix[i * k + j] = s;
+
+    int matrixSize = k * k;
+    uint8_t decodeMatrix [matrixSize];
+    uint8_t invertedMatrix [matrixSize];
+
+    // get the rows of the input chunks
+    for (num_t i = 0; i < k; i++) {
+        memcpy(decodeMatrix + i * k, _encodeMatrix + inputIds[i] * k, k);
+    }
+
+    // get the inverse of the matrix of input chunks
+    if (gf_invert_matrix(decodeMatrix, invertedMatrix, k) < 0) {
+        LOG(ERROR) << "Failed to invert the matrix for decoding";
+        return std::shared_ptr<const DecodingTable>();
+    }
+
+    std::shared_ptr<DecodingTable> table = std::make_shared<DecodingTable>();
+    table->matrix.resize(numTargets * k);
+    table->gftbl.resize(numTargets * k * 32);
+
+    uint8_t *matrix = table->matrix.data();
+    for (num_t i = 0; i < numTargets; i++) {
+        chunk_id_t target = targetIds[i];
+        // data chunks
+        if (target < k) {
+            memcpy(matrix + k * i, invertedMatrix + k * target, k);
+            continue;
+        }
+        // code chunks
+        for (num_t j = 0; j < k; j++) {
+            uint8_t s = 0;
+            for (num_t l = 0; l < k; l++)
+                s ^= gf_mul(invertedMatrix[l * k + j], _encodeMatrix[target * k + l]);
+            matrix[i * k + j] = s;
         }
     }
+    ec_init_tables(k, numTargets, matrix, table->gftbl.data());
 
-    return true;
+    cache.put(key, table);
+
+    return table;
 }
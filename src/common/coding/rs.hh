@@ -4,7 +4,9 @@
 #define __RS_CODE_HH__
 
 #include <stdint.h> // uint8_t
+#include <memory>
 #include "coding.hh"
+#include "decoding_table_cache.hh"
 #include "../config.hh"
 
 class RSCode : public Coding {
@@ -41,8 +43,9 @@ public:
      * see Coding::encode()
      * 
      * @remark coding state is ignored for RS
+     * @remark with shadowDataChunks, only the code chunks and the data chunk with padding at the end of data are allocated
      **/
-    bool encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState);
+    bool encode(data_t *data, length_t dataSize, std::vector<Chunk> &stripe, data_t **codingState, bool shadowDataChunks = false, bool computeChecksums = false, int checksumType = ChecksumType::CHECKSUM_MD5);
 
     /**
      * see Coding::decode()
@@ -51,6 +54,11 @@ public:
      **/
     bool decode(std::vector<Chunk> &inputChunks, data_t **decodedData, length_t &decodedSize, DecodingPlan &plan, data_t *codingState, bool isRepair = false, std::vector<chunk_id_t> repairTargets = std::vector<chunk_id_t>());
 
+    /**
+     * see Coding::encodeDelta()
+     **/
+    bool encodeDelta(const std::vector<Chunk> &dataDeltas, std::vector<Chunk> &codeDeltas);
+
     /**
      * see Coding::preDecode()
      * 
@@ -78,6 +86,17 @@ private:
      **/
     bool carRepairFinalize(unsigned char *inputp[], num_t numInputChunks, length_t chunkSize, unsigned char *decodep[]);
 
+    /**
+     * Get the decoding table for decoding the target chunks from the input chunks, from the shared cache if available
+     *
+     * @param[in] inputIds                ids of the input chunks, only the first k are used
+     * @param[in] targetIds               ids of the target chunks
+     * @param[in] numTargets              number of target chunks
+     *
+     * @return the decoding table, or an empty pointer if the matrix of input chunks is not invertible
+     **/
+    std::shared_ptr<const DecodingTable> getDecodingTable(const chunk_id_t *inputIds, const chunk_id_t *targetIds, num_t numTargets);
+
     uint8_t _encodeMatrix[CODING_MAX_N * CODING_MAX_N];
     uint8_t _gftbl[CODING_MAX_N * CODING_MAX_N * 32];
 
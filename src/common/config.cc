@@ -19,6 +19,7 @@ const char *Config::ContainerTypeName[] = {
     "AWS",
     "Azure",
     "Generic_S3",          // 5
+    "Segment",
 
     "Unknown"
 };
@@ -193,6 +194,19 @@ void Config::setConfigPath (const char *generalPath, const char *proxyPath, cons
         _agent.misc.copyBlockSize = readULL(_agentPt, "misc.copy_block_size");
         _agent.misc.flushOnClose = readBool(_agentPt, "misc.flush_on_close");
         _agent.misc.registerToProxy = readBool(_agentPt, "misc.register_to_proxy");
+        _agent.misc.trustProxyChecksum = readBool(_agentPt, "misc.trust_proxy_checksum");
+        _agent.misc.codingTableCacheSize = std::max(readInt(_agentPt, "misc.coding_table_cache_size"), 0);
+        _agent.misc.fsIOEngine = parseFsIOEngine(readString(_agentPt, "misc.fs_io_engine"));
+        if (_agent.misc.fsIOEngine >= FsIOEngine::UNKNOWN_FS_IO)
+            _agent.misc.fsIOEngine = FsIOEngine::FS_IO_POSIX;
+        _agent.misc.fsIOQueueDepth = std::max(readInt(_agentPt, "misc.fs_io_queue_depth"), 2);
+        _agent.misc.fsDirectIO = readBool(_agentPt, "misc.fs_direct_io");
+        _agent.misc.fsGroupCommit = readBool(_agentPt, "misc.fs_group_commit");
+        _agent.misc.fsGroupCommitWindow = std::max(readInt(_agentPt, "misc.fs_group_commit_window"), 0);
+        _agent.misc.fsGroupCommitBatchSize = std::max(readInt(_agentPt, "misc.fs_group_commit_batch_size"), 1);
+        _agent.misc.segmentSize = std::max(readULL(_agentPt, "misc.segment_size"), 1ULL << 20);
+        _agent.misc.segmentCompactionThreshold = std::min(std::max(readInt(_agentPt, "misc.segment_compaction_threshold"), 0), 100);
+        _agent.misc.containerIOWorkers = std::min(std::max(readInt(_agentPt, "misc.container_io_workers"), 0), MAX_NUM_WORKERS);
         // agent containers
         _agent.numContainers = readInt(_agentPt, "agent.num_containers");
         char pname[32];
@@ -347,6 +361,16 @@ void Config::setConfigPath (const char *generalPath, const char *proxyPath, cons
         _proxy.misc.scanJournalIntv = readInt(_proxyPt, "misc.journal_check_interval");
         if (_proxy.misc.scanJournalIntv > 0 && _proxy.misc.scanJournalIntv < 30)
             _proxy.misc.scanJournalIntv = 30;
+        _proxy.misc.numChunkIOThreads = std::max(readInt(_proxyPt, "misc.chunk_io_threads"), 0);
+        _proxy.misc.numChunkIOConnections = std::max(readInt(_proxyPt, "misc.chunk_io_connections"), 1);
+        _proxy.misc.chunkIODepth = std::max(readInt(_proxyPt, "misc.chunk_io_depth"), 0);
+        _proxy.misc.chunkIOBatchSize = std::max(readInt(_proxyPt, "misc.chunk_io_batch_size"), 1);
+        _proxy.misc.writePipelineDepth = std::max(readInt(_proxyPt, "misc.write_pipeline_depth"), 1);
+        _proxy.misc.readWindow = std::max(readInt(_proxyPt, "misc.read_window"), 1);
+        _proxy.misc.maxReadAhead = std::max(readInt(_proxyPt, "misc.read_ahead_stripes"), 0);
+        _proxy.misc.decodingTableCacheSize = std::max(readInt(_proxyPt, "misc.decoding_table_cache_size"), 0);
+        _proxy.misc.numCodingThreads = std::max(readInt(_proxyPt, "misc.coding_threads"), 0);
+        _proxy.misc.codingParallelThreshold = std::max(readInt(_proxyPt, "misc.coding_parallel_threshold"), 0);
         // agent list
         boost::property_tree::ptree agentListPt;
         try {
@@ -399,6 +423,9 @@ void Config::setConfigPath (const char *generalPath, const char *proxyPath, cons
         // zmq request 
         _proxy.zmqITF.numWorkers = std::min(std::max(1, readInt(_proxyPt, "zmq_interface.num_workers")), MAX_NUM_WORKERS);
         _proxy.zmqITF.port = readInt(_proxyPt, "zmq_interface.port");
+        _proxy.zmqITF.writeSessionTimeout = std::max(readInt(_proxyPt, "zmq_interface.write_session_timeout"), 1);
+        _proxy.zmqITF.readSessionTimeout = std::max(readInt(_proxyPt, "zmq_interface.read_session_timeout"), 1);
+        _proxy.zmqITF.maxSegmentSize = std::max(readULL(_proxyPt, "zmq_interface.max_segment_size"), 1ULL);
 
         // ldap authentication
         _proxy.ldapAuth.uri = readString(_proxyPt, "ldap_auth.uri");
@@ -711,6 +738,61 @@ bool Config::getAgentRegisterToProxy() const {
     return _agent.misc.registerToProxy;
 }
 
+bool Config::getAgentTrustProxyChecksum() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.trustProxyChecksum;
+}
+
+int Config::getAgentCodingTableCacheSize() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.codingTableCacheSize;
+}
+
+int Config::getAgentFsIOEngine() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.fsIOEngine;
+}
+
+int Config::getAgentFsIOQueueDepth() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.fsIOQueueDepth;
+}
+
+bool Config::getAgentFsDirectIO() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.fsDirectIO;
+}
+
+bool Config::getAgentFsGroupCommit() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.fsGroupCommit;
+}
+
+int Config::getAgentFsGroupCommitWindow() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.fsGroupCommitWindow;
+}
+
+int Config::getAgentFsGroupCommitBatchSize() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.fsGroupCommitBatchSize;
+}
+
+unsigned long int Config::getAgentSegmentSize() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.segmentSize;
+}
+
+int Config::getAgentSegmentCompactionThreshold() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.segmentCompactionThreshold;
+}
+
+int Config::getAgentContainerIOWorkers() const {
+    assert(!_agentPt.empty());
+    return _agent.misc.containerIOWorkers;
+}
+
 // Proxy
 
 int Config::getNumProxy() const {
@@ -776,6 +858,12 @@ int Config::getCodingScheme(std::string storageClass) const {
     return coding;
 }
 
+int Config::getChecksumType(std::string storageClass) const {
+    std::string sc = storageClass.empty()? _proxy.storageClass.defaultClass : storageClass;
+    // chunks are checksummed using md5 unless specified
+    return parseChecksumType(_storageClassPt.get<std::string>(sc.append(".checksum").c_str(), ChecksumTypeName[ChecksumType::CHECKSUM_MD5]));
+}
+
 int Config::getN(std::string storageClass) const {
     return getStorageClassConfig(storageClass, "n", -1, 0);
 }
@@ -792,6 +880,18 @@ int Config::getMaxChunkSize(std::string storageClass) const {
     return getStorageClassConfig(storageClass, "max_chunk_size", 0, 0, 1 << 30);
 }
 
+int Config::getHedgedReadChunks(std::string storageClass) const {
+    return getStorageClassConfig(storageClass, "hedged_read_chunks", 0, 0);
+}
+
+int Config::getHedgedReadDelay(std::string storageClass) const {
+    return getStorageClassConfig(storageClass, "hedged_read_delay", 0, 0);
+}
+
+int Config::getHedgedReadPercentile(std::string storageClass) const {
+    return getStorageClassConfig(storageClass, "hedged_read_percentile", 95, 1, 100);
+}
+
 int Config::getStorageClassConfig(std::string storageClass, std::string config, int dv, int min, int max) const {
     std::string sc = storageClass.empty()? _proxy.storageClass.defaultClass : storageClass;
     return readIntWithBoundsAndDefault(_storageClassPt, sc.append(".").append(config).c_str(), dv, min, max);
@@ -901,6 +1001,56 @@ int Config::getJournalCheckInterval() const {
     return _proxy.misc.scanJournalIntv;
 }
 
+int Config::getProxyNumChunkIOThreads() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.numChunkIOThreads;
+}
+
+int Config::getProxyNumChunkIOConnections() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.numChunkIOConnections;
+}
+
+int Config::getProxyChunkIODepth() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.chunkIODepth;
+}
+
+int Config::getProxyChunkIOBatchSize() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.chunkIOBatchSize;
+}
+
+int Config::getProxyWritePipelineDepth() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.writePipelineDepth;
+}
+
+int Config::getProxyReadWindow() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.readWindow;
+}
+
+int Config::getProxyMaxReadAhead() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.maxReadAhead;
+}
+
+int Config::getProxyDecodingTableCacheSize() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.decodingTableCacheSize;
+}
+
+int Config::getProxyNumCodingThreads() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.numCodingThreads;
+}
+
+int Config::getProxyCodingParallelThreshold() const {
+    assert(!_proxyPt.empty());
+    return _proxy.misc.codingParallelThreshold;
+}
+
 int Config::getProxyDistributePolicy() const {
     assert(!_proxyPt.empty());
     return _proxy.dataDistribution.policy;
@@ -962,6 +1112,21 @@ unsigned short Config::getProxyZmqPort() const {
     return _proxy.zmqITF.port;
 }
 
+int Config::getProxyZmqWriteSessionTimeout() const {
+    assert(!_proxyPt.empty());
+    return _proxy.zmqITF.writeSessionTimeout;
+}
+
+int Config::getProxyZmqReadSessionTimeout() const {
+    assert(!_proxyPt.empty());
+    return _proxy.zmqITF.readSessionTimeout;
+}
+
+unsigned long int Config::getProxyZmqMaxSegmentSize() const {
+    assert(!_proxyPt.empty());
+    return _proxy.zmqITF.maxSegmentSize;
+}
+
 bool Config::autoFileRecovery() const {
     assert(!_proxyPt.empty());
     return _proxy.recovery.enabled;
@@ -1275,20 +1440,28 @@ void Config::printConfig() const {
         std::set<std::string>::iterator classIt = classes.begin(), classEd = classes.end();
         std::string defaultClass = getDefaultStorageClass();
         for (; classIt != classEd; classIt++) {
+            std::string hedgedReadDelay = getHedgedReadDelay(*classIt) > 0?
+                    std::to_string(getHedgedReadDelay(*classIt)).append("ms") :
+                    std::string("p").append(std::to_string(getHedgedReadPercentile(*classIt))).append(" latency");
             length += snprintf(buf + length, bufSize - length,
                 "   - [%s]\n"
                 "     - coding                : %s\n"
+                "     - checksum              : %s\n"
                 "     - n                     : %d\n"
                 "     - k                     : %d\n"
                 "     - f                     : %d\n"
                 "     - Max chunk size        : %dB\n"
+                "     - Hedged read           : %d chunks after %s\n"
                 "     - Is default            : %s\n"
                 , classIt->c_str()
                 , CodingSchemeName[getCodingScheme(*classIt)]
+                , ChecksumTypeName[getChecksumType(*classIt)]
                 , getN(*classIt)
                 , getK(*classIt)
                 , getF(*classIt)
                 , getMaxChunkSize(*classIt)
+                , getHedgedReadChunks(*classIt)
+                , hedgedReadDelay.c_str()
                 , *classIt == defaultClass? "true" : "false"
             );
         }
@@ -1324,6 +1497,16 @@ void Config::printConfig() const {
             "   - Reuse data connections  : %s\n"
             "   - Liveness Cache Time     : %ds\n"
             "   - Journal check interval  : %ds\n"
+            "   - Chunk I/O threads       : %d%s\n"
+            "     - Connections per agent : %d\n"
+            "     - Requests in flight    : %d per connection%s\n"
+            "     - Batch size            : %d chunks%s\n"
+            "   - Write pipeline depth    : %d stripes\n"
+            "   - Read window             : %d stripes\n"
+            "   - Max. read-ahead         : %d stripes%s\n"
+            "   - Decoding table cache    : %d entries%s\n"
+            "   - Coding threads          : %d%s\n"
+            "     - Parallel threshold    : %d bytes\n"
             , getProxyNumZmqThread()
             , isRepairAtProxy()? "true" : "false"
             , isRepairUsingCAR()? "true" : "false"
@@ -1331,6 +1514,22 @@ void Config::printConfig() const {
             , reuseDataConn()? "true" : "false"
             , getLivenessCacheTime()
             , getJournalCheckInterval()
+            , getProxyNumChunkIOThreads()
+            , getProxyNumChunkIOThreads() == 0? " (one thread per request)" : ""
+            , getProxyNumChunkIOConnections()
+            , getProxyChunkIODepth()
+            , getProxyChunkIODepth() == 0? " (no limit)" : ""
+            , getProxyChunkIOBatchSize()
+            , getProxyChunkIOBatchSize() == 1? " (no batching)" : ""
+            , getProxyWritePipelineDepth()
+            , getProxyReadWindow()
+            , getProxyMaxReadAhead()
+            , getProxyMaxReadAhead() == 0? " (disabled)" : ""
+            , getProxyDecodingTableCacheSize()
+            , getProxyDecodingTableCacheSize() == 0? " (disabled)" : ""
+            , getProxyNumCodingThreads()
+            , getProxyNumCodingThreads() == 0? " (all hardware threads)" : (getProxyNumCodingThreads() == 1? " (disabled)" : "")
+            , getProxyCodingParallelThreshold()
         );
         length += snprintf(buf + length, bufSize - length,
             " - Background chunk handler\n"
@@ -1364,8 +1563,14 @@ void Config::printConfig() const {
             " - Zero-MQ interface\n"
             "   - Num. of workers         : %d\n"
             "   - Port                    : %d\n"
+            "   - Write session timeout   : %ds\n"
+            "   - Read session timeout    : %ds\n"
+            "   - Max. segment size       : %luB\n"
             , getProxyZmqNumWorkers()
             , getProxyZmqPort()
+            , getProxyZmqWriteSessionTimeout()
+            , getProxyZmqReadSessionTimeout()
+            , getProxyZmqMaxSegmentSize()
         );
         length += snprintf(buf + length, bufSize - length,
             " - Immutable Storage Policy Manager\n"
@@ -1478,6 +1683,12 @@ void Config::printConfig() const {
             " Num of containers           : %d\n"
             " Num zmq threads             : %d\n"
             " Copy block size             : %luB\n"
+            " Trust Proxy checksum        : %s\n"
+            " Coding table cache size     : %d%s\n"
+            " FS container I/O engine     : %s (queue depth = %d, direct I/O = %s)\n"
+            " FS container group commit   : %s (window = %dus, batch size = %d)\n"
+            " Segment size                : %luB (compaction threshold = %d%%)\n"
+            " Container I/O workers       : %d%s\n"
             , getAgentIP().c_str()
             , getAgentPort()
             , getAgentCPort()
@@ -1485,6 +1696,19 @@ void Config::printConfig() const {
             , getNumContainers()
             , getAgentNumZmqThread()
             , getCopyBlockSize()
+            , getAgentTrustProxyChecksum()? "true" : "false"
+            , getAgentCodingTableCacheSize()
+            , getAgentCodingTableCacheSize() == 0? " (disabled)" : ""
+            , FsIOEngineName[getAgentFsIOEngine()]
+            , getAgentFsIOQueueDepth()
+            , getAgentFsDirectIO()? "true" : "false"
+            , getAgentFsGroupCommit()? "true" : "false"
+            , getAgentFsGroupCommitWindow()
+            , getAgentFsGroupCommitBatchSize()
+            , getAgentSegmentSize()
+            , getAgentSegmentCompactionThreshold()
+            , getAgentContainerIOWorkers()
+            , getAgentContainerIOWorkers() == 0? " (disabled)" : " per container"
         );
         for (int i = 0; i < getNumContainers(); i++) {
             int type = getContainerType(i);
@@ -1605,6 +1829,22 @@ int Config::parseCodingScheme(std::string schemeName) const {
     return CodingScheme::UNKNOWN_CODE;
 }
 
+int Config::parseChecksumType(std::string typeName) const {
+    for (int i = 0; i < ChecksumType::UNKNOWN_CHECKSUM; i++) {
+        if (boost::algorithm::to_lower_copy(std::string(ChecksumTypeName[i])) == boost::algorithm::to_lower_copy(typeName))
+            return i;
+    }
+    return ChecksumType::UNKNOWN_CHECKSUM;
+}
+
+int Config::parseFsIOEngine(std::string engineName) const {
+    for (int i = 0; i < FsIOEngine::UNKNOWN_FS_IO; i++) {
+        if (boost::algorithm::to_lower_copy(std::string(FsIOEngineName[i])) == boost::algorithm::to_lower_copy(engineName))
+            return i;
+    }
+    return FsIOEngine::UNKNOWN_FS_IO;
+}
+
 int Config::parseChunkScanSamplingPolicy(std::string policyName) const {
     for (int i = 0; i < ChunkScanSamplingPolicy::UNKNOWN_SAMPLING_POLICY; i++) {
         if (boost::algorithm::to_lower_copy(std::string(ChunkScanSamplingPolicyName[i])) == boost::algorithm::to_lower_copy(policyName)) {
@@ -75,6 +75,17 @@ public:
     unsigned long int getCopyBlockSize() const;
     bool getAgentFlushOnClose() const;
     bool getAgentRegisterToProxy() const;
+    bool getAgentTrustProxyChecksum() const;
+    int getAgentCodingTableCacheSize() const;
+    int getAgentFsIOEngine() const;
+    int getAgentFsIOQueueDepth() const;
+    bool getAgentFsDirectIO() const;
+    bool getAgentFsGroupCommit() const;
+    int getAgentFsGroupCommitWindow() const;
+    int getAgentFsGroupCommitBatchSize() const;
+    unsigned long int getAgentSegmentSize() const;
+    int getAgentSegmentCompactionThreshold() const;
+    int getAgentContainerIOWorkers() const;
 
     // proxy
     int getNumProxy() const;
@@ -90,10 +101,14 @@ public:
     int getNumStorageClasses() const;
     std::set<std::string> getStorageClasses() const;
     int getCodingScheme(std::string storageClass = "") const;
+    int getChecksumType(std::string storageClass = "") const;
     int getN(std::string storageClass = "") const;
     int getK(std::string storageClass = "") const;
     int getF(std::string storageClass = "") const;
     int getMaxChunkSize(std::string storageClass = "") const;
+    int getHedgedReadChunks(std::string storageClass = "") const;
+    int getHedgedReadDelay(std::string storageClass = "") const;
+    int getHedgedReadPercentile(std::string storageClass = "") const;
     // proxy.metastore
     int getProxyMetaStoreType() const;
     std::string getProxyMetaStoreIP() const;
@@ -114,6 +129,16 @@ public:
     int getLivenessCacheTime() const;
     std::vector<std::pair<std::string, unsigned short> > getAgentList();
     int getJournalCheckInterval() const;
+    int getProxyNumChunkIOThreads() const;
+    int getProxyNumChunkIOConnections() const;
+    int getProxyChunkIODepth() const;
+    int getProxyChunkIOBatchSize() const;
+    int getProxyWritePipelineDepth() const;
+    int getProxyReadWindow() const;
+    int getProxyMaxReadAhead() const;
+    int getProxyDecodingTableCacheSize() const;
+    int getProxyNumCodingThreads() const;
+    int getProxyCodingParallelThreshold() const;
     // proxy.data_distribution
     int getProxyDistributePolicy() const;
     bool isAgentNear(const char *ipStr) const;
@@ -126,6 +151,9 @@ public:
     // proxy.zmqITF
     int getProxyZmqNumWorkers() const;
     unsigned short getProxyZmqPort() const;
+    int getProxyZmqWriteSessionTimeout() const;
+    int getProxyZmqReadSessionTimeout() const;
+    unsigned long int getProxyZmqMaxSegmentSize() const;
     // proxy.recovery
     bool autoFileRecovery() const;
     int getFileRecoverInterval() const;
@@ -201,6 +229,8 @@ private:
     int parseLogLevel(std::string levelName) const;
     int parseDistributionPolicy(std::string policyName) const;
     int parseCodingScheme(std::string schemeName) const;
+    int parseChecksumType(std::string typeName) const;
+    int parseFsIOEngine(std::string engineName) const;
     int parseChunkScanSamplingPolicy(std::string policyName) const;
     int parseMetaStoreType(std::string storeName) const;
 
@@ -291,6 +321,17 @@ private:
             unsigned long int copyBlockSize;
             bool flushOnClose;
             bool registerToProxy;
+            bool trustProxyChecksum;
+            int codingTableCacheSize;
+            int fsIOEngine;
+            int fsIOQueueDepth;
+            bool fsDirectIO;
+            bool fsGroupCommit;
+            int fsGroupCommitWindow;
+            int fsGroupCommitBatchSize;
+            unsigned long int segmentSize;
+            int segmentCompactionThreshold;
+            int containerIOWorkers;
         } misc;
     } _agent;
 
@@ -336,6 +377,16 @@ private:
             int livenessCacheTime;
             std::vector<std::pair<std::string, unsigned short> > agentList; // IP, port
             int scanJournalIntv;
+            int numChunkIOThreads;
+            int numChunkIOConnections;
+            int chunkIODepth;
+            int chunkIOBatchSize;
+            int writePipelineDepth;
+            int readWindow;
+            int maxReadAhead;
+            int decodingTableCacheSize;
+            int numCodingThreads;
+            int codingParallelThreshold;
         } misc;
         struct {
             int policy;
@@ -352,6 +403,9 @@ private:
         struct {
             int numWorkers;
             unsigned short port;
+            int writeSessionTimeout;
+            int readSessionTimeout;
+            unsigned long int maxSegmentSize;
         } zmqITF;
         struct {
             bool enabled;
@@ -4,6 +4,22 @@
 
 const char *CodingSchemeName[] = {
     "RS",          // 0
+    "LRC",         // 1
+    "HITCHHIKER",  // 2
+
+    "Unknown"
+};
+
+const char *ChecksumTypeName[] = {
+    "MD5",         // 0
+    "CRC32C",      // 1
+
+    "Unknown"
+};
+
+const char *FsIOEngineName[] = {
+    "POSIX",       // 0
+    "io_uring",    // 1
 
     "Unknown"
 };
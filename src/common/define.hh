@@ -49,9 +49,24 @@ typedef uint32_t                   num_t;
 // see also CodingSchemeName in common/config.cc
 enum CodingScheme {
     RS,
+    LRC,
+    HITCHHIKER,
     UNKNOWN_CODE
 };
 
+// see also ChecksumTypeName in common/define.cc
+enum ChecksumType {
+    CHECKSUM_MD5,
+    CHECKSUM_CRC32C,
+    UNKNOWN_CHECKSUM
+};
+
+/// max. length of chunk checksums (digests shorter than this are zero-padded)
+#define CHUNK_CHECKSUM_MAX_LEN     (16)
+
+/// number of global parities in LRC (the rest of the n-k code chunks are local parities)
+#define LRC_NUM_GLOBAL_PARITIES    (2)
+
 enum Opcode {
     // chunk request
     PUT_CHUNK_REQ,          // 0
@@ -112,6 +127,22 @@ enum Opcode {
     VRF_CHUNK_REP_SUCCESS,
     VRF_CHUNK_REP_FAIL,
 
+    // put and get chunks of different requests in one event, with a status per chunk
+    PUT_CHUNK_BATCH_REQ,
+    PUT_CHUNK_BATCH_REP,  // 40
+    GET_CHUNK_BATCH_REQ,
+    GET_CHUNK_BATCH_REP,
+
+    // apply changes to chunks in place (e.g., delta update of code chunks)
+    UPD_CHUNK_REQ,
+    UPD_CHUNK_REP_SUCCESS,  // 45
+    UPD_CHUNK_REP_FAIL,
+
+    // get byte ranges of chunks (e.g., sub-chunks for repair)
+    GET_CHUNK_RANGE_REQ,
+    GET_CHUNK_RANGE_REP_SUCCESS,
+    GET_CHUNK_RANGE_REP_FAIL,
+
     UNKNOWN_OP,
 };
 
@@ -122,10 +153,19 @@ enum ContainerType {
     AWS_CONTAINER,
     AZURE_CONTAINER,
     GENERIC_S3_CONTAINER,  // 5
+    SEGMENT_CONTAINER,
 
     UNKNOWN_CONTAINER,
 };
 
+// see also FsIOEngineName in common/define.cc
+enum FsIOEngine {
+    FS_IO_POSIX,
+    FS_IO_URING,
+
+    UNKNOWN_FS_IO
+};
+
 // see also DistributionPolicyName in common/config.cc
 enum DistributionPolicy {
     STATIC,
@@ -181,6 +221,8 @@ enum MessageDirection {
 };
 
 extern const char *CodingSchemeName[];
+extern const char *ChecksumTypeName[];
+extern const char *FsIOEngineName[];
 extern const char EmptyStringMD5[];
 
 #endif // define __DEFINE_HH__
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <string.h>
+#include <unistd.h>
 
 #include <boost/timer/timer.hpp>
 #include <glog/logging.h>
@@ -26,6 +27,10 @@ bool IO::isFromProxy(unsigned short opcode) {
         opcode == CHK_CHUNK_REQ ||
         opcode == MOV_CHUNK_REQ ||
         opcode == VRF_CHUNK_REQ ||
+        opcode == PUT_CHUNK_BATCH_REQ ||
+        opcode == GET_CHUNK_BATCH_REQ ||
+        opcode == UPD_CHUNK_REQ ||
+        opcode == GET_CHUNK_RANGE_REQ ||
         false
     );
 }
@@ -48,6 +53,8 @@ bool IO::hasData(unsigned short opcode) {
             opcode == Opcode::ENC_CHUNK_REP_FAIL ||
             opcode == Opcode::CHK_CHUNK_REP_FAIL ||
             opcode == Opcode::VRF_CHUNK_REP_FAIL ||
+            opcode == Opcode::UPD_CHUNK_REP_FAIL ||
+            opcode == Opcode::GET_CHUNK_RANGE_REP_FAIL ||
             false
     );
 }
@@ -64,20 +71,34 @@ bool IO::hasContainerIds(unsigned short opcode) {
 }
 
 bool IO::hasChunkData(unsigned short opcode) {
-    // put chunk requests, get chunk replies, and encode chunk replies contain chunk data
+    // put chunk requests, get chunk (range) replies, encode chunk replies, and update chunk requests contain chunk data
     return (
         opcode == Opcode::PUT_CHUNK_REQ || 
+        opcode == Opcode::UPD_CHUNK_REQ ||
         opcode == Opcode::GET_CHUNK_REP_SUCCESS ||
+        opcode == Opcode::GET_CHUNK_RANGE_REP_SUCCESS ||
         opcode == Opcode::ENC_CHUNK_REP_SUCCESS ||
+        opcode == Opcode::PUT_CHUNK_BATCH_REQ ||
+        opcode == Opcode::GET_CHUNK_BATCH_REP ||
         false
     ) && hasData(opcode) ;
 }
 
+bool IO::hasChunkStatus(unsigned short opcode) {
+    // only batched chunk replies report the status of each chunk
+    return (
+        opcode == Opcode::PUT_CHUNK_BATCH_REP ||
+        opcode == Opcode::GET_CHUNK_BATCH_REP ||
+        false
+    );
+}
+
 bool IO::needsCoding(unsigned short opcode) {
-    // only the encoding chunk request contains coding metadata
+    // only the encoding chunk request contains coding metadata (and the get chunk range request, which carries the ranges in the coding state)
     return (
         opcode == Opcode::ENC_CHUNK_REQ ||
         opcode == Opcode::RPR_CHUNK_REQ ||
+        opcode == Opcode::GET_CHUNK_RANGE_REQ ||
         false
     );
 }
@@ -93,6 +114,7 @@ int IO::getNumChunkFactor(unsigned short opcode) {
     switch (opcode) {
     case Opcode::CPY_CHUNK_REQ:
     case Opcode::MOV_CHUNK_REQ:
+    case Opcode::UPD_CHUNK_REQ:
         return 2;
     default:
         return 1;
@@ -167,6 +189,18 @@ unsigned long int IO::getChunkEventMessage(zmq::socket_t &socket, ChunkEvent &ev
         }
     }
 
+    // data (chunk status)
+    if (hasChunkStatus(event.opcode)) {
+        if (!req.more()) return 0;
+        getNextMsg();
+        if (req.size() != sizeof(bool) * event.numChunks) {
+            LOG(ERROR) << "Chunk status size mismatched, expect " << sizeof(bool) * event.numChunks << " but got " << req.size();
+            return 0;
+        }
+        event.chunkStatus = new bool[event.numChunks];
+        memcpy(event.chunkStatus, req.data(), sizeof(bool) * event.numChunks);
+    }
+
     // data (chunks)
     int actualNumChunks = event.numChunks * getNumChunkFactor(event.opcode);
     if (event.numChunks > 0)
@@ -199,19 +233,31 @@ unsigned long int IO::getChunkEventMessage(zmq::socket_t &socket, ChunkEvent &ev
             memcpy(event.chunks[i].chunkVersion, req.data(), versionLength);
             event.chunks[i].chunkVersion[versionLength] = 0;
         }
-        // chunk checksum (md5)
+        // chunk checksum (and type, absent for md5)
         if (!req.more()) return 0;
         getNextMsg();
-        memcpy(event.chunks[i].md5, req.data(), MD5_DIGEST_LENGTH);
+        if (!event.chunks[i].unpackChecksum((const unsigned char *) req.data(), req.size())) {
+            LOG(ERROR) << "Invalid chunk checksum of size " << req.size();
+            return 0;
+        }
         // chunk size
         if (!req.more()) return 0;
         getField(chunks[i].size, int);
-        // chunk data
-        if (hasChunkData(event.opcode)) {
+        // chunk data (only the first set of chunks carries data, e.g., the expected stored chunks of update requests do not)
+        if (hasChunkData(event.opcode) && i < event.numChunks) {
             if (!req.more()) return 0;
-            getNextMsg();
-            event.chunks[i].data = (unsigned char*) malloc (event.chunks[i].size);
-            memcpy(event.chunks[i].data, req.data(), event.chunks[i].size);
+            // adopt the message buffer as chunk data without copying
+            zmq::message_t *payload = new zmq::message_t();
+            socket.recv(payload);
+            bytes += payload->size();
+            if (payload->size() != (size_t) event.chunks[i].size) {
+                LOG(ERROR) << "Chunk data size mismatched, expect " << event.chunks[i].size << " but got " << payload->size();
+                delete payload;
+                return 0;
+            }
+            // keep the frame properties for checking the remaining frames
+            req.copy(payload);
+            event.chunks[i].adoptData((unsigned char *) payload->data(), payload->size(), payload, releaseReceivedChunkData);
         } else {
             event.chunks[i].data = 0;
         }
@@ -275,13 +321,13 @@ unsigned long int IO::getChunkEventMessage(zmq::socket_t &socket, ChunkEvent &ev
     return bytes;
 }
 
-unsigned long int IO::sendChunkEventMessage(zmq::socket_t &socket, const ChunkEvent &event) {
+unsigned long int IO::sendChunkEventMessage(zmq::socket_t &socket, const ChunkEvent &event, ZeroCopyTracker *tracker, const unsigned int *id) {
 
     // TODO endianness
     unsigned long int bytes = 0;
 
     // header
-    bytes += socket.send(&event.id, sizeof(event.id), ZMQ_SNDMORE);
+    bytes += socket.send(id != NULL? id : &event.id, sizeof(event.id), ZMQ_SNDMORE);
     bytes += socket.send(&event.opcode, sizeof(event.opcode), ZMQ_SNDMORE);
 
     // benchmark: send TAGPT
@@ -307,6 +353,9 @@ unsigned long int IO::sendChunkEventMessage(zmq::socket_t &socket, const ChunkEv
         // no container id for put chunk request
         bytes += socket.send(event.containerIds, sizeof(int) * event.numChunks, ZMQ_SNDMORE);
     }
+    if (hasChunkStatus(event.opcode)) {
+        bytes += socket.send(event.chunkStatus, sizeof(bool) * event.numChunks, ZMQ_SNDMORE);
+    }
 
     int actualNumChunks = event.numChunks * getNumChunkFactor(event.opcode);
 
@@ -327,13 +376,27 @@ unsigned long int IO::sendChunkEventMessage(zmq::socket_t &socket, const ChunkEv
         bytes += socket.send(&versionLength, sizeof(unsigned char), ZMQ_SNDMORE);
         if (versionLength > 0)
             bytes += socket.send(event.chunks[i].chunkVersion, versionLength, ZMQ_SNDMORE);
-        // chunk checksum (md5)
-        bytes += socket.send(event.chunks[i].md5, MD5_DIGEST_LENGTH, ZMQ_SNDMORE);
+        // chunk checksum (and type, absent for md5)
+        unsigned char checksum[CHUNK_CHECKSUM_FIELD_LEN];
+        int checksumLength = event.chunks[i].packChecksum(checksum);
+        bytes += socket.send(checksum, checksumLength, ZMQ_SNDMORE);
         // chunk size
-        bytes += socket.send(&event.chunks[i].size, sizeof(event.chunks[i].size), (!hasChunkData(event.opcode) && !needsCoding(event.opcode) && i + 1 == actualNumChunks)? 0: ZMQ_SNDMORE);
-        // chunk data
-        if (hasChunkData(event.opcode)) {
-            bytes += socket.send(event.chunks[i].data, event.chunks[i].size, (!needsCoding(event.opcode) && i + 1 == actualNumChunks)? 0 : ZMQ_SNDMORE);
+        bool withData = hasChunkData(event.opcode) && i < event.numChunks;
+        bytes += socket.send(&event.chunks[i].size, sizeof(event.chunks[i].size), (!withData && !needsCoding(event.opcode) && i + 1 == actualNumChunks)? 0: ZMQ_SNDMORE);
+        // chunk data (only the first set of chunks carries data)
+        if (withData) {
+            int flags = (!needsCoding(event.opcode) && i + 1 == actualNumChunks)? 0 : ZMQ_SNDMORE;
+            if (tracker != NULL && event.chunks[i].size >= ZERO_COPY_MIN_CHUNK_SIZE) {
+                // send the chunk data without copying, the tracker is notified once ZeroMQ releases the buffer
+                tracker->lock.lock();
+                tracker->numBuffers++;
+                tracker->lock.unlock();
+                zmq::message_t data(event.chunks[i].data, event.chunks[i].size, releaseSentChunkData, tracker);
+                if (socket.send(data, flags))
+                    bytes += event.chunks[i].size;
+            } else {
+                bytes += socket.send(event.chunks[i].data, event.chunks[i].size, flags);
+            }
         }
     }
 
@@ -367,6 +430,23 @@ unsigned long int IO::sendChunkEventMessage(zmq::socket_t &socket, const ChunkEv
     return bytes;
 }
 
+void IO::releaseSentChunkData(void *data, void *hint) {
+    ZeroCopyTracker *tracker = (ZeroCopyTracker *) hint;
+    std::lock_guard<std::mutex> lk (tracker->lock);
+    if (--tracker->numBuffers > 0)
+        return;
+    tracker->released.notify_all();
+    if (tracker->notifyFd != -1) {
+        uint64_t signal = 1;
+        if (write(tracker->notifyFd, &signal, sizeof(signal)) != sizeof(signal))
+            LOG(WARNING) << "Failed to notify the release of chunk data sent, " << strerror(errno);
+    }
+}
+
+void IO::releaseReceivedChunkData(void *message) {
+    delete (zmq::message_t *) message;
+}
+
 std::string IO::genAddr(std::string ip, unsigned port) {
     char portstr[8];
     portstr[0] = ':';
@@ -392,6 +472,18 @@ void *IO::sendChunkRequestToAgent(void *arg) {
     bool reuse = meta.isFromProxy && config.reuseDataConn();
     MessageDirection msgDirection = meta.isFromProxy? PROXY_TO_AGENT : AGENT_TO_AGENT;
     zmq::socket_t *socket = 0;
+    // chunk data is only sent without copying over own sockets, which are closed (and the data released) before return
+    ZeroCopyTracker tracker;
+    ZeroCopyTracker *sendTracker = reuse? NULL : &tracker;
+
+#define closeSocket() do { \
+    if (!reuse && socket != 0) { \
+        socket->close(); \
+        delete socket; \
+        tracker.wait(); \
+    } \
+} while(0)
+
     try {
         if (reuse) {
             socket = meta.socket;
@@ -411,13 +503,10 @@ void *IO::sendChunkRequestToAgent(void *arg) {
         // boost::timer::cpu_timer mytimer;
         
         // send the chunk event request
-        unsigned long sent = IO::sendChunkEventMessage(*socket, *meta.request);
+        unsigned long sent = IO::sendChunkEventMessage(*socket, *meta.request, sendTracker);
         if (sent == 0) {
             LOG(ERROR) << "Failed to send chunk event over socket at " << meta.address;
-            if (!reuse) {
-                socket->close();
-                delete socket;
-            }
+            closeSocket();
             return (void *) -1;
         }
         // boost::timer::cpu_times sentDuration = mytimer.elapsed();
@@ -428,10 +517,7 @@ void *IO::sendChunkRequestToAgent(void *arg) {
         unsigned long received = IO::getChunkEventMessage(*socket, *meta.reply);
         if (received == 0) {
             LOG(ERROR) << "Failed to get a chunk event reply over socket at " << meta.address;
-            if (!reuse) {
-                socket->close();
-                delete socket;
-            }
+            closeSocket();
             return (void *) -2;
         }
 
@@ -441,18 +527,14 @@ void *IO::sendChunkRequestToAgent(void *arg) {
         //           << (hasChunkData(meta.reply->opcode)? "with" : "without")
         //           << " chunks) in " << mytimer.elapsed().wall * 1.0 / 1e9 << " s";
         
-        if (!reuse) {
-            socket->close();
-            delete socket;
-        }
+        closeSocket();
     } catch (zmq::error_t &e) {
         LOG(ERROR) << "Failed to connect agent to send the chunk request opcode = " << meta.request->opcode << ", " << e.what();
-        if (!reuse && socket != 0) {
-            socket->close();
-            delete socket;
-        }
+        closeSocket();
         return (void *) -1;
     }
 
+#undef closeSocket
+
     return NULL;
 }
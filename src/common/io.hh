@@ -3,12 +3,50 @@
 #ifndef __IO_HH__
 #define __IO_HH__
 
+#include <condition_variable>
+#include <mutex>
+
 #include <zmq.hpp>
 
 #include "../ds/chunk_event.hh"
 
+#define ZERO_COPY_MIN_CHUNK_SIZE   (64 << 10)  // 64KiB
+
 class IO {
 public:
+    /**
+     * Tracker of chunk data buffers sent without copying, which must remain valid until ZeroMQ releases them
+     **/
+    struct ZeroCopyTracker {
+        std::mutex lock;                  /**< lock on the counter */
+        std::condition_variable released; /**< all buffers are released */
+        int numBuffers;                   /**< number of buffers not yet released by ZeroMQ */
+        int notifyFd;                     /**< eventfd to notify once all buffers are released, -1 for none */
+
+        ZeroCopyTracker(int fd = -1) {
+            numBuffers = 0;
+            notifyFd = fd;
+        }
+
+        /**
+         * Tell whether all buffers are released
+         *
+         * @return whether all buffers are released
+         **/
+        bool done() {
+            std::lock_guard<std::mutex> lk (lock);
+            return numBuffers == 0;
+        }
+
+        /**
+         * Wait until all buffers are released
+         **/
+        void wait() {
+            std::unique_lock<std::mutex> lk (lock);
+            released.wait(lk, [this]{ return numBuffers == 0; });
+        }
+    };
+
     /**
      * Parse an incoming chunk event from socket
      *
@@ -24,10 +62,12 @@ public:
      *
      * @param[in] socket socket to send the event
      * @param[in] event chunk event to send over the socket
+     * @param[in] tracker tracker of chunk data sent without copying, the caller must keep the chunk data valid until tracker reports all buffers released; NULL to copy the chunk data into messages
+     * @param[in] id      event id to send in place of that of the event, NULL to send the event id
      *
      * @return number of bytes sent
      **/
-    static unsigned long int sendChunkEventMessage(zmq::socket_t &socket, const ChunkEvent &event);
+    static unsigned long int sendChunkEventMessage(zmq::socket_t &socket, const ChunkEvent &event, ZeroCopyTracker *tracker = NULL, const unsigned int *id = NULL);
 
     /**
      * Generate an address string with given IP and port ("tcp://IP:port")
@@ -69,6 +109,21 @@ public:
     } RequestMeta;
 
 private:
+    /**
+     * Release a chunk data buffer sent without copying, called by ZeroMQ
+     *
+     * @param data   the chunk data buffer
+     * @param hint   the IO::ZeroCopyTracker of the buffer
+     **/
+    static void releaseSentChunkData(void *data, void *hint);
+
+    /**
+     * Release a message holding the data of a received chunk
+     *
+     * @param message the zmq::message_t holding the chunk data
+     **/
+    static void releaseReceivedChunkData(void *message);
+
     /** *
      * Tell whether the chunk event message should be from proxy
      * 
@@ -112,6 +167,15 @@ private:
      **/
     static bool hasChunkData(unsigned short opcode);
 
+    /**
+     * Tell whether the chunk event message should contain a status for each chunk
+     *
+     * @param opcode operation code of the chunk event
+     *
+     * @return whether the message should contain a status for each chunk
+     **/
+    static bool hasChunkStatus(unsigned short opcode);
+
     /**
      * Tell whether the chunk event message should contain coding information
      *
@@ -83,6 +83,31 @@ enum ClientOpcode {
     GET_PROXY_STATUS_REP_SUCCESS,
     GET_PROXY_STATUS_REP_FAIL,
 
+    // streaming file write
+    OPEN_WRITE_SESSION_REQ,
+    OPEN_WRITE_SESSION_REP_SUCCESS,
+    OPEN_WRITE_SESSION_REP_FAIL,
+    WRITE_SESSION_DATA_REQ,
+    WRITE_SESSION_DATA_REP_SUCCESS,
+    WRITE_SESSION_DATA_REP_FAIL,
+    COMMIT_WRITE_SESSION_REQ,
+    COMMIT_WRITE_SESSION_REP_SUCCESS,
+    COMMIT_WRITE_SESSION_REP_FAIL,
+    ABORT_WRITE_SESSION_REQ,
+    ABORT_WRITE_SESSION_REP_SUCCESS,
+    ABORT_WRITE_SESSION_REP_FAIL,
+
+    // streaming file read
+    OPEN_READ_SESSION_REQ,
+    OPEN_READ_SESSION_REP_SUCCESS,
+    OPEN_READ_SESSION_REP_FAIL,
+    READ_SESSION_DATA_REQ,
+    READ_SESSION_DATA_REP_SUCCESS,
+    READ_SESSION_DATA_REP_FAIL,
+    CLOSE_READ_SESSION_REQ,
+    CLOSE_READ_SESSION_REP_SUCCESS,
+    CLOSE_READ_SESSION_REP_FAIL,
+
     UNKNOWN_CLIENT_OP,
 };
 
@@ -9,6 +9,8 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <openssl/md5.h>
 
+#define CHUNK_CHECKSUM_FIELD_LEN   (CHUNK_CHECKSUM_MAX_LEN + 1)
+
 #include "../common/define.hh"
 #include "../common/checksum_calculator.hh"
 
@@ -19,11 +21,14 @@ struct Chunk {
     unsigned char *data;         /**< chunk data */
     int size;                    /**< chunk size */
     bool freeData;               /**< whether to free data upon destruction */
+    void *dataOwner;             /**< object holding the adopted data buffer (e.g., a network message), released instead of freeing data */
+    void (*releaseDataOwner)(void *owner); /**< function to release the data owner */
 
     int fileVersion;             /**< file version number */
     char chunkVersion[CHUNK_VERSION_MAX_LEN];  /**< chunk version number for revert */
 
-    unsigned char md5[MD5_DIGEST_LENGTH]; /**< chunk md5 checksum */
+    unsigned char checksum[CHUNK_CHECKSUM_MAX_LEN]; /**< chunk checksum, zero-padded */
+    unsigned char checksumType;  /**< chunk checksum type, see ChecksumType */
 
     Chunk() {
         reset();
@@ -37,7 +42,7 @@ struct Chunk {
         setId(src.namespaceId, src.fuuid, src.chunkId);
         fileVersion = src.fileVersion;
         strncpy(chunkVersion, src.chunkVersion, CHUNK_VERSION_MAX_LEN);
-        copyMD5(src);
+        copyChecksum(src);
         if (copySize)
             size = src.size;
     }
@@ -75,7 +80,7 @@ struct Chunk {
         }
 
         // free any existing data buffer
-        if (freeData) free(data);
+        releaseData();
 
         data = datat;
         size = sizet;
@@ -84,6 +89,23 @@ struct Chunk {
         return true;
     }
 
+    /**
+     * Adopt a data buffer held by another object without copying the data
+     *
+     * @param datat         data buffer
+     * @param sizet         size of the data buffer
+     * @param owner         object holding the data buffer
+     * @param releaseOwner  function to release the owner (and hence the data buffer) upon destruction
+     **/
+    void adoptData(unsigned char *datat, int sizet, void *owner, void (*releaseOwner)(void *owner)) {
+        releaseData();
+        data = datat;
+        size = sizet;
+        freeData = true;
+        dataOwner = owner;
+        releaseDataOwner = releaseOwner;
+    }
+
     bool copy(const Chunk &src, bool aligned = false) {
         release();
         copyMeta(src);
@@ -100,8 +122,12 @@ struct Chunk {
         data = src.data;
         size = src.size;
         freeData = src.freeData;
+        dataOwner = src.dataOwner;
+        releaseDataOwner = src.releaseDataOwner;
         src.data = 0;
         src.freeData = false;
+        src.dataOwner = 0;
+        src.releaseDataOwner = 0;
         return true;
     }
 
@@ -133,38 +159,82 @@ struct Chunk {
         return std::to_string(namespaceId) + "_" + boost::uuids::to_string(fuuid) + "_" + std::to_string(fileVersion) + "_" + std::to_string(chunkId);
     }
 
-    bool computeMD5() {
+    /**
+     * Compute the checksum of the chunk data, of the checksum type of the chunk
+     *
+     * @return whether the checksum is computed
+     **/
+    bool computeChecksum() {
         if (size <= 0)
             return false;
-        unsigned int hashLength = MD5_DIGEST_LENGTH;
-        MD5Calculator cal;
-        cal.appendData(data, size);
-        return cal.finalize(md5, hashLength);
+        return computeChecksum(checksum);
+    }
+
+    /**
+     * Verify the chunk data against the checksum
+     *
+     * @return whether the checksum matches
+     **/
+    bool verifyChecksum() {
+        unsigned char curChecksum[CHUNK_CHECKSUM_MAX_LEN];
+        return computeChecksum(curChecksum) && memcmp(checksum, curChecksum, CHUNK_CHECKSUM_MAX_LEN) == 0;
+    }
+
+    bool matchChecksum(const Chunk &in) const {
+        return checksumType == in.checksumType && memcmp(checksum, in.checksum, CHUNK_CHECKSUM_MAX_LEN) == 0;
     }
 
-    bool verifyMD5() {
-        unsigned char curMD5[MD5_DIGEST_LENGTH];
-        unsigned int hashLength = MD5_DIGEST_LENGTH;
-        MD5Calculator cal;
-        cal.appendData(data, size);
-        cal.finalize(curMD5, hashLength);
-        return memcmp(md5, curMD5, hashLength) == 0;
+    void copyChecksum(const Chunk &src) {
+        memcpy(checksum, src.checksum, CHUNK_CHECKSUM_MAX_LEN);
+        checksumType = src.checksumType;
     }
 
-    void copyMD5(const Chunk &src) {
-        memcpy(md5, src.md5, MD5_DIGEST_LENGTH);
+    /**
+     * Serialize the checksum for messages and metadata, i.e., the checksum followed by the checksum type
+     *
+     * @param[out] field    buffer of at least CHUNK_CHECKSUM_FIELD_LEN bytes
+     *
+     * @return length of the serialized checksum
+     *
+     * @remark MD5 checksums are serialized without the checksum type, as in releases before the checksum type is introduced
+     **/
+    int packChecksum(unsigned char *field) const {
+        memcpy(field, checksum, CHUNK_CHECKSUM_MAX_LEN);
+        if (checksumType == ChecksumType::CHECKSUM_MD5)
+            return CHUNK_CHECKSUM_MAX_LEN;
+        field[CHUNK_CHECKSUM_MAX_LEN] = checksumType;
+        return CHUNK_CHECKSUM_FIELD_LEN;
+    }
+
+    /**
+     * Deserialize the checksum from messages and metadata
+     *
+     * @param[in] field     serialized checksum
+     * @param[in] length    length of the serialized checksum; a checksum without the checksum type is an MD5 checksum
+     *
+     * @return whether the serialized checksum is valid
+     **/
+    bool unpackChecksum(const unsigned char *field, size_t length) {
+        resetChecksum();
+        if (length < CHUNK_CHECKSUM_MAX_LEN)
+            return false;
+        memcpy(checksum, field, CHUNK_CHECKSUM_MAX_LEN);
+        if (length > CHUNK_CHECKSUM_MAX_LEN)
+            checksumType = field[CHUNK_CHECKSUM_MAX_LEN];
+        return checksumType < ChecksumType::UNKNOWN_CHECKSUM;
     }
 
     bool matchMeta(const Chunk &in) {
         return 
             chunkId == in.chunkId /* chunk id */
-            && memcmp(md5, in.md5, MD5_DIGEST_LENGTH) /* checksum */
+            && memcmp(checksum, in.checksum, CHUNK_CHECKSUM_MAX_LEN) /* checksum */
             && size == in.size /* size */
         ;
     }
 
-    void resetMD5() {
-        memset(md5, 0, MD5_DIGEST_LENGTH);
+    void resetChecksum() {
+        memset(checksum, 0, CHUNK_CHECKSUM_MAX_LEN);
+        checksumType = ChecksumType::CHECKSUM_MD5;
     }
     
     void reset() {
@@ -176,13 +246,45 @@ struct Chunk {
         data = 0;
         size = 0;
         freeData = true;
-        resetMD5();
+        dataOwner = 0;
+        releaseDataOwner = 0;
+        resetChecksum();
     }
 
     void release() {
-        if (freeData) free(data);
+        releaseData();
         reset();
     }
+
+    void releaseData() {
+        if (freeData) {
+            if (dataOwner != 0)
+                releaseDataOwner(dataOwner);
+            else
+                free(data);
+        }
+        dataOwner = 0;
+        releaseDataOwner = 0;
+    }
+
+private:
+    /**
+     * Compute the checksum of the chunk data, of the checksum type of the chunk
+     *
+     * @param[out] digest   buffer of CHUNK_CHECKSUM_MAX_LEN bytes for the zero-padded checksum
+     *
+     * @return whether the checksum is computed
+     **/
+    bool computeChecksum(unsigned char *digest) const {
+        ChecksumCalculator *cal = ChecksumCalculatorGenerator::genCalculator(checksumType);
+        if (cal == NULL)
+            return false;
+        unsigned int length = CHUNK_CHECKSUM_MAX_LEN;
+        memset(digest, 0, CHUNK_CHECKSUM_MAX_LEN);
+        bool okay = cal->appendData(data, size) && cal->finalize(digest, length);
+        delete cal;
+        return okay;
+    }
 };
 
 
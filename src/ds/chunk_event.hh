@@ -16,6 +16,7 @@ struct ChunkEvent {
     int numChunks;                     /**< number of chunks */
     int *containerIds;                 /**< container ids */
     Chunk *chunks;                     /**< chunks */
+    bool *chunkStatus;                 /**< whether the operation on each chunk succeeds, for batched chunk replies only */
 
     // coding metadata
     CodingMeta codingMeta;             /**< coding metadata */
@@ -59,6 +60,7 @@ struct ChunkEvent {
     void release() {
         delete [] containerIds;
         delete [] chunks;
+        delete [] chunkStatus;
         free(chunkGroupMap);
         free(containerGroupMap);
         reset();
@@ -70,6 +72,7 @@ struct ChunkEvent {
         numChunks = 0;
         containerIds = 0;
         chunks = 0;
+        chunkStatus = 0;
         numChunkGroups = 0;
         numInputChunks = 0;
         chunkGroupMap = 0;
@@ -157,6 +157,7 @@ void File::copyFileChecksum(const File &in) {
 
 void File::copyVersionControlInfo(const File &in) {
     version = in.version;
+    changeCount = in.changeCount;
 }
 
 void File::copyStoragePolicy(const File &in) {
@@ -279,6 +280,7 @@ void File::reset() {
     nameLength = 0;
     size = 0;
     version = -1;
+    changeCount = 0;
     numStripes = 0;
     offset = INVALID_FILE_OFFSET;
     length = INVALID_FILE_LENGTH;
@@ -78,6 +78,7 @@ public:
     int nameLength;                /**< length of file name */
     unsigned long int size;        /**< file size */
     int version;                   /**< file version number */
+    unsigned long int changeCount; /**< number of modifications to the file version, which may keep the modification time within a second */
     time_t ctime;                  /**< creation time */
     time_t atime;                  /**< last access time */
     time_t mtime;                  /**< modification time */
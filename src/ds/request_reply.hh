@@ -49,6 +49,10 @@ struct Request {
 
     SysInfo proxyStatus;
 
+    unsigned long int sessionId;
+    unsigned long int stripeSize;   // size of each data frame in streaming read replies
+    unsigned int numStripes;        // max. number of stripes to read in a streaming read request
+
     Request() {
         opcode = ClientOpcode::UNKNOWN_CLIENT_OP;
         file.namespaceId = INVALID_NAMESPACE_ID;
@@ -67,6 +71,9 @@ struct Request {
         list.bgTasks.name = 0;
         list.bgTasks.progress = 0;
         list.bgTasks.num = 0;
+        sessionId = 0;
+        stripeSize = 0;
+        numStripes = 0;
     }
 
     ~Request() {
@@ -11,10 +11,11 @@
 
 struct StorageClass {
 public:
-    StorageClass(std::string name, int f, int maxChunkSize, int coding, Coding *codingInstance) : 
+    StorageClass(std::string name, int f, int maxChunkSize, int coding, Coding *codingInstance, int checksumType = ChecksumType::CHECKSUM_MD5) : 
             _name(name),
             _codingMeta(coding, codingInstance->getN(), codingInstance->getK(), maxChunkSize, f),
-            _codingInstance(codingInstance)
+            _codingInstance(codingInstance),
+            _checksumType(checksumType)
     {
     }
 
@@ -32,6 +33,10 @@ public:
         return _codingMeta.coding;
     }
 
+    int getChecksumType() const {
+        return _checksumType;
+    }
+
     CodingMeta getCodingMeta() const {
         return _codingMeta;
     }
@@ -44,6 +49,7 @@ private:
     std::string _name;                          /**< storage class name */
     CodingMeta _codingMeta;                     /**< coding metadata */
     Coding *_codingInstance;                    /**< coding instance */
+    int _checksumType;                          /**< type of chunk checksums */
 };
 
 #endif // ifdef __STORAGE_CLASS_HH__
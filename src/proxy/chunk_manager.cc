@@ -2,7 +2,10 @@
 
 #include <stdlib.h> // malloc(), remalloc()
 
+#include <algorithm>
+#include <chrono>
 #include <map>
+#include <thread>
 
 #include <glog/logging.h>
 #include <boost/timer/timer.hpp>
@@ -10,12 +13,20 @@
 #include "chunk_manager.hh"
 #include "../common/coding/all.hh"
 #include "../common/coding/coding_generator.hh"
+#include "../common/coding/decoding_table_cache.hh"
+#include "../common/coding/parallel_coding.hh"
 
 #include "../common/benchmark/benchmark.hh"
 
 
 ChunkManager::ChunkManager(std::map<int, std::string> *containerToAgentMap, ProxyIO *io, BgChunkHandler *handler, MetaStore *metastore) {
     Config &config = Config::getInstance();
+
+    // decoding tables are shared by all coding instances
+    DecodingTableCache::getInstance().setCapacity(config.getProxyDecodingTableCacheSize());
+    // so are the coding threads
+    ParallelCoding::getInstance().setThreshold(config.getProxyCodingParallelThreshold());
+    ParallelCoding::getInstance().setNumThreads(config.getProxyNumCodingThreads());
     
     // initialize storage classes
     std::set<std::string> classes = config.getStorageClasses();
@@ -28,6 +39,11 @@ ChunkManager::ChunkManager(std::map<int, std::string> *containerToAgentMap, Prox
         int f = config.getF(*it);
         int maxChunkSize = config.getMaxChunkSize(*it);
         int coding = config.getCodingScheme(*it);
+        int checksumType = config.getChecksumType(*it);
+        if (checksumType == ChecksumType::UNKNOWN_CHECKSUM) {
+            LOG(FATAL) << "Unknown chunk checksum type for storage class " << *it;
+            exit(1);
+        }
         try {
             code = CodingGenerator::genCoding(coding, options);
         } catch (std::invalid_argument &e) {
@@ -35,7 +51,8 @@ ChunkManager::ChunkManager(std::map<int, std::string> *containerToAgentMap, Prox
             exit(1);
         }
         _codings.insert(std::make_pair(genCodingInstanceKey(coding, options.getN(), options.getK()), code));
-        _storageClasses.insert(std::make_pair(*it, new StorageClass(*it, f, maxChunkSize, coding, code)));
+        _storageClasses.insert(std::make_pair(*it, new StorageClass(*it, f, maxChunkSize, coding, code, checksumType)));
+        _hedgedReadPolicies.insert(std::make_pair(*it, new HedgedReadPolicy(config.getHedgedReadChunks(*it), config.getHedgedReadDelay(*it), config.getHedgedReadPercentile(*it))));
         DLOG(INFO) << "Init storage class [" << *it << "] with options " << options.str();
     }
     code = 0;
@@ -46,15 +63,30 @@ ChunkManager::ChunkManager(std::map<int, std::string> *containerToAgentMap, Prox
     _containerToAgentMap = containerToAgentMap;
     _bgChunkHandler = handler;
     _metastore = metastore;
+
+    _stopReaper = false;
+    _reaper = std::thread(&ChunkManager::reapChunkRequests, this);
 }
 
 ChunkManager::~ChunkManager() {
     LOG(WARNING) << "Terminating Chunk Manager ...";
+    // release the chunk requests left with late replies
+    {
+        std::lock_guard<std::mutex> lk(_reaperLock);
+        _stopReaper = true;
+        _hasLateRequests.notify_one();
+    }
+    if (_reaper.joinable())
+        _reaper.join();
     // free storage classes and coding instances
     for (auto it = _storageClasses.begin(); it != _storageClasses.end(); it++) {
         delete it->second;
         it->second = 0;
     }
+    for (auto it = _hedgedReadPolicies.begin(); it != _hedgedReadPolicies.end(); it++) {
+        delete it->second;
+        it->second = 0;
+    }
     std::lock_guard<std::mutex> lkg (_codingsLock);
     for (auto it = _codings.begin(); it != _codings.end(); it++) {
         delete it->second;
@@ -64,6 +96,14 @@ ChunkManager::~ChunkManager() {
 }
 
 bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpare, bool alignDataBuf, bool isOverwrite, bool withEncode) {
+    StripeWrite write;
+    if (!submitFileStripe(file, spareContainers, numSpare, write, alignDataBuf, isOverwrite, withEncode)) {
+        return false;
+    }
+    return completeFileStripe(write);
+}
+
+bool ChunkManager::submitFileStripe(File &file, int spareContainers[], int numSpare, StripeWrite &write, bool alignDataBuf, bool isOverwrite, bool withEncode) {
 
     // benchmark
     BMWrite *bmWrite = dynamic_cast<BMWrite *>(Benchmark::getInstance().at(file.reqId));
@@ -95,11 +135,20 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
             return false;
         }
         boost::timer::cpu_timer mytimer;
+        // TAGPT (start): encode
+        if (benchmark) {
+            bmStripe->encode.markStart();
+        }
         // encode
         if (!encodeFile(file, spareContainers, numSpare, alignDataBuf, codebuf)) {
             LOG(ERROR) << "<WRITE> Error encoding file";
+            free(codebuf);
             return false;
         }
+        // TAGPT (end): encode
+        if (benchmark) {
+            bmStripe->encode.markEnd();
+        }
         if (file.reqId == -1) {
             boost::timer::cpu_times duration = mytimer.elapsed();
             LOG_IF(INFO, duration.wall > 0) << "Write file " << file.name << ", finish encoding speed = " << (file.length * 1.0 / (1 << 20)) / (duration.wall * 1.0 / 1e9) << " MB/s "
@@ -119,18 +168,15 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
     int numFgReqs = bgack? numDataChunks / numChunksPerNode : numReqs;
     int numBgReqs = numSpare / numChunksPerNode - numFgReqs;
 
-    pthread_t *wt = 0;
     ProxyIO::RequestMeta *meta = 0;
     ChunkEvent *events = 0;
     try {
-        wt = new pthread_t[numReqs];
         meta = new ProxyIO::RequestMeta[numReqs];
         events = new ChunkEvent[numReqs * 2];
     } catch (std::bad_alloc &e) {
-        delete [] wt;
         delete [] meta;
         delete [] events;
-        LOG(ERROR) << "Failed to allocate memoryy for events metadata and threads";
+        LOG(ERROR) << "Failed to allocate memoryy for events metadata";
         return false;
     }
 
@@ -153,7 +199,6 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
         try {
             events[i].chunks = new Chunk[numChunksPerNode];
         } catch (std::bad_alloc &e) {
-            delete [] wt;
             delete [] meta;
             delete [] events;
             LOG(ERROR) << "Failed to allocate memory for event chunks";
@@ -162,7 +207,6 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
         try {
             events[i].containerIds = new int[numChunksPerNode];
         } catch (std::bad_alloc &e) {
-            delete [] wt;
             delete [] meta;
             delete [] events;
             delete [] events[i].chunks;
@@ -171,8 +215,11 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
         }
         for (int j = 0; j < numChunksPerNode; j++) {
             int chunkIdx = i * numChunksPerNode + j;
-            // compute checksum (and send to agent for verification)
-            file.chunks[chunkIdx].computeMD5();
+            // compute checksum (and send to agent for verification), unless computed along with encoding
+            if (!withEncode) {
+                file.chunks[chunkIdx].checksumType = getChecksumType(file.storageClass);
+                file.chunks[chunkIdx].computeChecksum();
+            }
             events[i].chunks[j] = file.chunks[chunkIdx];
             // never free data reference copied from (and is held by) others
             events[i].chunks[j].freeData = false;
@@ -198,13 +245,68 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
             meta[i].network = &(bmStripe->network->at(i));
         }
 
-        // send the requests in separate threads
+        // send the requests without waiting for the replies
         if (!bgwrite || i < numFgReqs)
-            pthread_create(&wt[i], NULL, ProxyIO::sendChunkRequestToAgent, &meta[i]);
+            ProxyIO::submitChunkRequest(&meta[i]);
     }
 
     DLOG(INFO) << "Write file " << file.name << ", finish issuing chunk requests for block " << file.blockId << ", stripe " << file.stripeId;
-    
+
+    // hand over the requests for completion
+    write.file = &file;
+    write.spareContainers.assign(spareContainers, spareContainers + numSpare);
+    write.isOverwrite = isOverwrite;
+    write.codebuf = codebuf;
+    write.meta = meta;
+    write.events = events;
+    write.numReqs = numReqs;
+    write.numFgReqs = numFgReqs;
+    write.numBgReqs = numBgReqs;
+    write.timer = mytimer;
+
+    return true;
+}
+
+bool ChunkManager::completeFileStripe(StripeWrite &write) {
+    File &file = *write.file;
+    int numSpare = write.spareContainers.size();
+    int *spareContainers = write.spareContainers.data();
+    bool isOverwrite = write.isOverwrite;
+    unsigned char *codebuf = write.codebuf;
+    ProxyIO::RequestMeta *meta = write.meta;
+    ChunkEvent *events = write.events;
+    int numReqs = write.numReqs;
+    int numFgReqs = write.numFgReqs;
+    int numBgReqs = write.numBgReqs;
+    boost::timer::cpu_timer &mytimer = write.timer;
+
+    // the requests are owned by this function from now on
+    write.codebuf = 0;
+    write.meta = 0;
+    write.events = 0;
+
+    // benchmark
+    BMWrite *bmWrite = dynamic_cast<BMWrite *>(Benchmark::getInstance().at(file.reqId));
+    BMWriteStripe *bmStripe = NULL;
+    bool benchmark = bmWrite && bmWrite->isStripeOn();
+    if (benchmark) {
+        bmStripe = &(bmWrite->at(file.stripeId));
+    }
+
+    Coding *coding = getCodingInstance(file.storageClass);
+    if (coding == NULL) {
+        free(codebuf);
+        delete [] meta;
+        delete [] events;
+        return false;
+    }
+
+    bool bgwrite = Config::getInstance().writeRedundancyInBackground();
+    bool bgack = Config::getInstance().ackRedundancyInBackground();
+    int numDataChunks = coding->getNumDataChunks();
+    int numCodeChunks = coding->getNumCodeChunks();
+    int numChunksPerNode = coding->getNumChunksPerNode();
+
     // check replies and gather the container id to file
     // TODO handle partial success, e.g., remove chunk already set?
     bool allsuccess = true;
@@ -213,7 +315,6 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
     try {
         file.containerIds = new int[numDataChunks + numCodeChunks];
     } catch (std::bad_alloc &e) {
-        delete [] wt;
         delete [] meta;
         delete [] events;
         LOG(ERROR) << "Failed to allocate memory for container Ids";
@@ -238,8 +339,8 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
                     numBgReqs--;
                 // issue the request if it was designated to background
                 if (bgwrite && i > numFgReqs)
-                    pthread_create(&wt[i], NULL, ProxyIO::sendChunkRequestToAgent, &meta[i]);
-                pthread_join(wt[i], &ptr);
+                    ProxyIO::submitChunkRequest(&meta[i]);
+                ptr = ProxyIO::waitChunkRequest(&meta[i]);
                 // proxy internal error
                 if (ptr != 0) {
                     long errNum = static_cast<long>(reinterpret_cast<unsigned long>(ptr));
@@ -269,7 +370,7 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
                         !Config::getInstance().verifyChunkChecksum() || 
                         (
                             meta[i].reply->opcode == Opcode::PUT_CHUNK_REP_SUCCESS && 
-                            memcmp(file.chunks[chunkIdx].md5, events[i + numReqs].chunks[j].md5, MD5_DIGEST_LENGTH) == 0
+                            file.chunks[chunkIdx].matchChecksum(events[i + numReqs].chunks[j])
                         );
                 // mark the container id when either 
                 // (1) it is going to complete in the background
@@ -329,11 +430,10 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
             File *bgfile = new File();
             bgfile->status = FileStatus::BG_TASK_PENDING;
             bgfile->copyAllMeta(file);
-            BgChunkHandler::ChunkTask task(PUT_CHUNK_REQ, bgfile, numSpare / numChunksPerNode, numBgReqs, wt, meta, events, codebuf);
+            BgChunkHandler::ChunkTask task(PUT_CHUNK_REQ, bgfile, numSpare / numChunksPerNode, numBgReqs, meta, events, codebuf);
             LOG(INFO) << "Put task with " << numBgReqs << " requests into background";
             _bgChunkHandler->addChunkTask(task);
         } catch (std::bad_alloc &e) {
-            delete [] wt;
             delete [] meta;
             delete [] events;
             LOG(ERROR) << "Failed to allocate memory for background task with " << numBgReqs << " requests";
@@ -341,7 +441,6 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
     } else {
         // if all requests are done in foreground, clean up now
         free(codebuf);
-        delete [] wt;
         delete [] meta;
         delete [] events;
     }
@@ -366,6 +465,205 @@ bool ChunkManager::writeFileStripe(File &file, int spareContainers[], int numSpa
     return true;
 }
 
+bool ChunkManager::canUpdateFileStripe(const File &file) {
+    Coding *coding = getCodingInstance(file.codingMeta.coding, file.codingMeta.n, file.codingMeta.k);
+    // data chunks must hold the stripe data as is, one chunk per container
+    return coding != NULL
+            && coding->isSystematic()
+            && coding->supportsDeltaUpdate()
+            && !coding->storeCodeChunksOnly()
+            && !coding->modifyDataBuffer()
+            && coding->getNumChunksPerNode() == 1;
+}
+
+bool ChunkManager::updateFileStripe(File &file, int stripeId, unsigned long int offset, unsigned long int length, const unsigned char *data, unsigned char *oldData) {
+    if (!canUpdateFileStripe(file)) {
+        return false;
+    }
+    Coding *coding = getCodingInstance(file.codingMeta.coding, file.codingMeta.n, file.codingMeta.k);
+
+    int numDataChunks = coding->getNumDataChunks();
+    int numCodeChunks = coding->getNumCodeChunks();
+    int numChunksPerStripe = numDataChunks + numCodeChunks;
+    int stripeStart = stripeId * numChunksPerStripe;
+
+    if (stripeId < 0 || stripeStart + numChunksPerStripe > file.numChunks || length == 0) {
+        LOG(ERROR) << "Invalid stripe " << stripeId << " to update for file " << file.name << " with " << file.numChunks << " chunks";
+        return false;
+    }
+
+    // all chunks in a stripe are of the same size
+    unsigned long int chunkSize = file.chunks[stripeStart].size;
+    for (int i = 0; i < numChunksPerStripe; i++) {
+        if ((unsigned long int) file.chunks[stripeStart + i].size != chunkSize || file.containerIds[stripeStart + i] == INVALID_CONTAINER_ID) {
+            LOG(WARNING) << "Cannot update stripe " << stripeId << " of file " << file.name << " in place, chunk " << i << " is lost or of a different size";
+            return false;
+        }
+    }
+    if (chunkSize == 0 || offset + length > chunkSize * numDataChunks) {
+        LOG(ERROR) << "Invalid range (" << offset << ", " << length << ") to update in stripe " << stripeId << " of file " << file.name;
+        return false;
+    }
+
+    boost::timer::cpu_timer mytimer;
+
+    // read the affected data chunks
+    int firstChunk = offset / chunkSize;
+    int numUpdated = (offset + length - 1) / chunkSize - firstChunk + 1;
+    int chunkIndices[numUpdated];
+    for (int i = 0; i < numUpdated; i++)
+        chunkIndices[i] = stripeStart + firstChunk + i;
+
+    ChunkEvent getEvents[numUpdated * 2];
+    if (!accessChunks(getEvents, file, numUpdated, Opcode::GET_CHUNK_REQ, Opcode::GET_CHUNK_REP_SUCCESS, 1, chunkIndices)) {
+        LOG(WARNING) << "Failed to get data chunks of stripe " << stripeId << " of file " << file.name << " for in-place update";
+        return false;
+    }
+
+    // patch the data chunks with the new data, and keep the changes for updating the code chunks
+    std::vector<Chunk> dataDeltas(numUpdated), codeDeltas;
+    for (int i = 0; i < numUpdated; i++) {
+        Chunk &chunk = getEvents[numUpdated + i].chunks[0];
+        Chunk &delta = dataDeltas.at(i);
+        unsigned long int chunkOffset = (firstChunk + i) * chunkSize;
+        unsigned long int start = std::max(offset, chunkOffset) - chunkOffset;
+        unsigned long int end = std::min(offset + length, chunkOffset + chunkSize) - chunkOffset;
+        if (!delta.allocateData(chunkSize, /* aligned */ true)) {
+            LOG(ERROR) << "Failed to allocate memory for changes to data chunk " << firstChunk + i << " of stripe " << stripeId << " of file " << file.name;
+            return false;
+        }
+        delta.setChunkId(firstChunk + i);
+        memset(delta.data, 0, chunkSize);
+        const unsigned char *newData = data + chunkOffset + start - offset;
+        for (unsigned long int j = start; j < end; j++) {
+            delta.data[j] = chunk.data[j] ^ newData[j - start];
+            if (oldData)
+                oldData[chunkOffset + j - offset] = chunk.data[j];
+            chunk.data[j] = newData[j - start];
+        }
+    }
+    if (!coding->encodeDelta(dataDeltas, codeDeltas)) {
+        LOG(ERROR) << "Failed to compute changes to code chunks of stripe " << stripeId << " of file " << file.name;
+        return false;
+    }
+
+    // apply the changes to the affected data chunks and the code chunks in place, each only to the stored chunk expected
+    int numReqs = numUpdated + numCodeChunks;
+    int reqIndices[numReqs];
+    unsigned char *deltas[numReqs];
+    Chunk expected[numReqs], updated[numReqs];
+    bool done[numReqs];
+    for (int i = 0; i < numReqs; i++) {
+        bool isData = i < numUpdated;
+        reqIndices[i] = isData? chunkIndices[i] : stripeStart + numDataChunks + (i - numUpdated);
+        deltas[i] = isData? dataDeltas.at(i).data : codeDeltas.at(i - numUpdated).data;
+        expected[i].copyMeta(file.chunks[reqIndices[i]]);
+        done[i] = false;
+    }
+    bool allsuccess = updateChunksInPlace(file, numReqs, reqIndices, deltas, expected, updated, done);
+    // retry the chunks failed once, which is safe as the changes are never applied twice
+    if (!allsuccess) {
+        LOG(WARNING) << "Retry the failed in-place update of stripe " << stripeId << " of file " << file.name;
+        allsuccess = updateChunksInPlace(file, numReqs, reqIndices, deltas, expected, updated, done);
+    }
+
+    // verify the checksum of rewritten data chunks if needed
+    for (int i = 0; allsuccess && i < numUpdated && Config::getInstance().verifyChunkChecksum(); i++) {
+        Chunk &chunk = getEvents[numUpdated + i].chunks[0];
+        chunk.copyChecksum(file.chunks[reqIndices[i]]);
+        chunk.computeChecksum();
+        if (!chunk.matchChecksum(updated[i])) {
+            LOG(ERROR) << "Checksum mismatch on updated chunk " << reqIndices[i] - stripeStart << " of stripe " << stripeId << " of file " << file.name << ", container id = " << file.containerIds[reqIndices[i]];
+            allsuccess = false;
+        }
+    }
+
+    if (!allsuccess) {
+        LOG(WARNING) << "Failed to update stripe " << stripeId << " of file " << file.name << " in place, going to revert the updated chunks now.";
+        // a chunk without a reply may have been updated at the agent, so send its update once more to learn the
+        // checksum after the changes, as the agent applies the changes to an unchanged chunk and reports an updated one as is
+        bool settled[numReqs];
+        for (int i = 0; i < numReqs; i++)
+            settled[i] = done[i];
+        updateChunksInPlace(file, numReqs, reqIndices, deltas, expected, updated, settled);
+        // revert every updated chunk by applying the changes again, with the checksum after the changes as the expected one;
+        // the agent reports a chunk already reverted as is
+        Chunk reverted[numReqs];
+        bool revertDone[numReqs];
+        for (int i = 0; i < numReqs; i++)
+            revertDone[i] = !settled[i];
+        updateChunksInPlace(file, numReqs, reqIndices, deltas, updated, reverted, revertDone);
+        // the chunks in an unknown state no longer match the rest of the stripe, mark them as corrupted for repair
+        for (int i = 0; i < numReqs; i++) {
+            if (settled[i] && revertDone[i])
+                continue;
+            LOG(ERROR) << "Failed to revert the in-place update of chunk " << reqIndices[i] - stripeStart << " of stripe " << stripeId << " of file " << file.name << ", container id = " << file.containerIds[reqIndices[i]] << ", mark it as corrupted";
+            if (file.chunksCorrupted)
+                file.chunksCorrupted[reqIndices[i]] = true;
+        }
+    } else {
+        // refresh the checksums and versions of the updated chunks
+        for (int i = 0; i < numReqs; i++) {
+            file.chunks[reqIndices[i]].copyChecksum(updated[i]);
+            memcpy(file.chunks[reqIndices[i]].chunkVersion, updated[i].chunkVersion, CHUNK_VERSION_MAX_LEN);
+        }
+        boost::timer::cpu_times duration = mytimer.elapsed();
+        LOG(INFO) << "Update stripe " << stripeId << " of file " << file.name << " in place, " << numUpdated << " data chunks and " << numCodeChunks << " code chunks in " << duration.wall * 1.0 / 1e9 << " seconds";
+    }
+
+    return allsuccess;
+}
+
+bool ChunkManager::updateChunksInPlace(const File &file, int numChunks, const int chunkIndices[], unsigned char *const deltas[], const Chunk expected[], Chunk updated[], bool done[]) {
+    ChunkEvent events[numChunks * 2];
+    ProxyIO::RequestMeta meta[numChunks];
+    bool submitted[numChunks];
+
+    for (int i = 0; i < numChunks; i++) {
+        submitted[i] = !done[i];
+        if (done[i])
+            continue;
+        int chunkIdx = chunkIndices[i];
+        events[i].id = _eventCount.fetch_add(1);
+        events[i].opcode = Opcode::UPD_CHUNK_REQ;
+        events[i].numChunks = 1;
+        // the changes, followed by the stored chunk expected
+        events[i].chunks = new Chunk[2];
+        events[i].containerIds = new int[1];
+        events[i].chunks[0].copyMeta(file.chunks[chunkIdx]);
+        // never free data held by others
+        events[i].chunks[0].data = deltas[i];
+        events[i].chunks[0].freeData = false;
+        events[i].chunks[0].computeChecksum();
+        events[i].chunks[1].copyMeta(file.chunks[chunkIdx]);
+        events[i].chunks[1].copyChecksum(expected[i]);
+        events[i].containerIds[0] = file.containerIds[chunkIdx];
+
+        meta[i].containerId = file.containerIds[chunkIdx];
+        meta[i].io = _io;
+        meta[i].request = &events[i];
+        meta[i].reply = &events[numChunks + i];
+
+        ProxyIO::submitChunkRequest(&meta[i]);
+    }
+
+    bool allsuccess = true;
+    for (int i = 0; i < numChunks; i++) {
+        if (!submitted[i])
+            continue;
+        bool sentNoError = ProxyIO::waitChunkRequest(&meta[i]) == 0;
+        if (sentNoError && meta[i].reply->opcode == Opcode::UPD_CHUNK_REP_SUCCESS && meta[i].reply->numChunks == 1) {
+            updated[i].copyMeta(meta[i].reply->chunks[0]);
+            done[i] = true;
+        } else {
+            LOG(ERROR) << "Failed to update chunk " << chunkIndices[i] << " of file " << file.name << " in place, container id = " << meta[i].containerId << ", send error = " << !sentNoError << ", return opcode = " << meta[i].reply->opcode;
+            allsuccess = false;
+        }
+    }
+
+    return allsuccess;
+}
+
 bool ChunkManager::encodeFile(File &file, int spareContainers[], int numSpare, bool alignDataBuf, unsigned char *codebuf) {
     CodingMeta &codingMeta = file.codingMeta;
     int fcoding = codingMeta.coding;
@@ -422,9 +720,14 @@ bool ChunkManager::encodeFile(File &file, int spareContainers[], int numSpare, b
         }
     }
     
-    // encode
+    // reference the data chunks to the data buffer instead of copying data when all chunk requests complete in the foreground,
+    // since the data buffer is kept only until the stripe write completes
+    Config &config = Config::getInstance();
+    bool shadowDataChunks = coding->isSystematic() && !config.writeRedundancyInBackground() && !config.ackRedundancyInBackground();
+
+    // encode, and compute the chunk checksums (of the type set for the storage class) in the same pass over the stripe
     std::vector<Chunk> stripe;
-    if (coding->encode(file.data, encodingSize, stripe, &file.codingMeta.codingState) == false) {
+    if (coding->encode(file.data, encodingSize, stripe, &file.codingMeta.codingState, shadowDataChunks, /* compute checksums */ true, getChecksumType(file.storageClass)) == false) {
         LOG(ERROR) << "Failed to encode data of size " << file.length << " of " << file.size;
         if (isCodeBufLocal) free(codebuf);
         return false;
@@ -512,9 +815,8 @@ bool ChunkManager::fullFileModify(File &srcFile, File &dstFile, bool isCopy, int
     // copy the chunks
     int numReqs = (endIdx - startIdx) * numChunksPerStripe / numChunksPerNode;
     int numReqsPerStripe = numChunksPerStripe / numChunksPerNode;
-    pthread_t wt[numReqs];
-    ProxyIO::RequestMeta meta[numReqs];
     ChunkEvent events[numReqs * 2];
+    ProxyIO::RequestMeta meta[numReqs];
 
     int numSuccess = 0, numTotalSuccess = 0;
     bool okay = true;
@@ -566,8 +868,8 @@ bool ChunkManager::fullFileModify(File &srcFile, File &dstFile, bool isCopy, int
         meta[i].request = &events[i];
         meta[i].reply = &events[i + numReqs];
 
-        // send the requests via threads
-        pthread_create(&wt[i], NULL, ProxyIO::sendChunkRequestToAgent, &meta[i]);
+        // send the requests without waiting for the replies
+        ProxyIO::submitChunkRequest(&meta[i]);
 
         // continue issuing requests until the end of a stripe
         if ((i + 1) % numReqsPerStripe != 0) 
@@ -577,7 +879,7 @@ bool ChunkManager::fullFileModify(File &srcFile, File &dstFile, bool isCopy, int
         for (int j = 0; j < numReqsPerStripe; j++) {
             void *ptr;
             int reqIdx = i - (numReqsPerStripe - 1) + j;
-            pthread_join(wt[reqIdx], &ptr);
+            ptr = ProxyIO::waitChunkRequest(&meta[reqIdx]);
             if (ptr != 0) {
                 LOG(ERROR) << "Failed to store chunk due to internal failure, container id = " << meta[reqIdx].containerId;
             }
@@ -593,12 +895,12 @@ bool ChunkManager::fullFileModify(File &srcFile, File &dstFile, bool isCopy, int
                 // verify the checksum if needed
                 if (
                         Config::getInstance().verifyChunkChecksum() && 
-                        memcmp(meta[reqIdx].reply->chunks[k].md5, srcFile.chunks[k + reqIdx * numChunksPerNode + startIdx * numChunksPerStripe].md5, MD5_DIGEST_LENGTH) != 0
+                        !meta[reqIdx].reply->chunks[k].matchChecksum(srcFile.chunks[k + reqIdx * numChunksPerNode + startIdx * numChunksPerStripe])
                 ) {
                     LOG(ERROR) << "Failed to " << (isCopy? "copy" : "move") << " chunk id = " << i << " due to failure at agent for container id = " << srcFile.containerIds[k + reqIdx * numChunksPerNode + startIdx * numChunksPerNode] << " chunk checksum mismatched";
                     continue;
                 }
-                dstFile.chunks[k + reqIdx * numChunksPerNode + startIdx * numChunksPerStripe].copyMD5(meta[reqIdx].reply->chunks[k]);
+                dstFile.chunks[k + reqIdx * numChunksPerNode + startIdx * numChunksPerStripe].copyChecksum(meta[reqIdx].reply->chunks[k]);
                 numSuccess++;
                 numTotalSuccess++;
             }
@@ -696,7 +998,12 @@ bool ChunkManager::readFile(File &file, bool chunkIndicator[], int **nodeIndices
 
     boost::timer::cpu_timer mytimer;
     bool benchmark = file.reqId != -1;
-    if (!accessChunks(events, file, plan.getMinNumInputChunks(), Opcode::GET_CHUNK_REQ, Opcode::GET_CHUNK_REP_SUCCESS, numChunksPerNode, chunkIndices, selected)) {
+    // hedge against slow chunk replies if there are spare chunks to request
+    HedgedReadPolicy *hedgedRead = numChunksPerNode == 1 && (size_t) selected > plan.getMinNumInputChunks()? getHedgedReadPolicy(file) : NULL;
+    bool chunksRead = hedgedRead?
+            accessChunksHedged(events, file, plan.getMinNumInputChunks(), chunkIndices, selected, hedgedRead) :
+            accessChunks(events, file, plan.getMinNumInputChunks(), Opcode::GET_CHUNK_REQ, Opcode::GET_CHUNK_REP_SUCCESS, numChunksPerNode, chunkIndices, selected);
+    if (!chunksRead) {
         LOG(ERROR) << "Failed to get some of the required chunks, need to handle degraded read or repair first";
         delete [] events;
         delete [] nodeIndices;
@@ -914,8 +1221,12 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
         inputChunkIndices[i] = inputChunkIds.at(i);
     }
 
-    bool isRepairAtProxy = Config::getInstance().isRepairAtProxy();
-    bool isRepairUsingCAR = Config::getInstance().isRepairUsingCAR() && numFailedNodes == 1;
+    // repair at proxy if the plan has no repair matrix for agents to apply on the input chunks
+    bool hasRepairMatrix = plan.getRepairMatrixSize() > 0;
+    bool isRepairAtProxy = Config::getInstance().isRepairAtProxy() || !hasRepairMatrix;
+    bool isRepairUsingCAR = Config::getInstance().isRepairUsingCAR() && numFailedNodes == 1 && hasRepairMatrix;
+    // only sub-chunks are needed from some input chunks
+    bool hasPartialInputChunks = plan.hasPartialInputChunks();
     int numFailedChunks = numFailedNodes * numChunksPerNode;
     // number of failed chunks can be greater than input, e.g., replication
     int maxNumChunkReqs = std::max(numInputChunks, numFailedChunks);
@@ -926,6 +1237,10 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
     int subChunkGroups[numInputChunks * (numInputChunks + 1)];
     int subContainerGroups[numInputChunks];
     switch (file.codingMeta.coding) {
+        // the repair matrix of LRC also has one row of coefficients on the input chunks per failed chunk
+        // (Hitchhiker codes have no repair matrix, and are always repaired at proxy)
+        case CodingScheme::HITCHHIKER:
+        case CodingScheme::LRC:
         case CodingScheme::RS:
             if (isRepairUsingCAR) { // single failure, encode partial chunks for decode
                 std::map<int, int> selectedChunks; // chunk id to index at inputChunkIndices
@@ -1024,7 +1339,25 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
     // start of repairing
     if (isRepairAtProxy) { // repair at Proxy
         switch (file.codingMeta.coding) {
+            case CodingScheme::HITCHHIKER:
+            case CodingScheme::LRC:
             case CodingScheme::RS:
+                if (hasPartialInputChunks) {
+                    // request only the sub-chunks needed from agents
+                    int ranges[numInputChunks * 2];
+                    for (int i = 0; i < numInputChunks; i++) {
+                        num_t first = 0, num = 0;
+                        int subChunkSize = file.chunks[inputChunkIndices[i]].size / plan.getNumSubChunks();
+                        plan.getInputSubChunks(i, first, num);
+                        ranges[i * 2] = first * subChunkSize;
+                        ranges[i * 2 + 1] = num * subChunkSize;
+                    }
+                    if (!accessChunkRanges(events, file, numInputChunks, inputChunkIndices, ranges)) {
+                        LOG(ERROR) << "Failed to read sub-chunks for repair";
+                        return false;
+                    }
+                    break;
+                }
                 if (isRepairUsingCAR) {
                     // request encoded chunks from agents
                     if (!accessGroupedChunks(events, file.containerIds, numInputChunks, subChunkGroups, numSubChunkGroups, file.namespaceId, file.uuid, submatrix, file.chunks[0].getChunkId())) {
@@ -1087,11 +1420,9 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
         meta.request = &events[0];
         meta.reply = &events[1];
 
-        pthread_t rt;
-        void *ptr;
-        // use a thread to send the request, and check if the request succeeded
-        pthread_create(&rt, NULL, ProxyIO::sendChunkRequestToAgent, &meta);
-        pthread_join(rt, &ptr);
+        // send the request, and check if the request succeeded
+        ProxyIO::submitChunkRequest(&meta);
+        void *ptr = ProxyIO::waitChunkRequest(&meta);
 
         //if (ProxyIO::sendChunkRequestToAgent(&meta) != NULL || meta.reply->opcode != RPR_CHUNK_REP_SUCCESS) {
         if (ptr != NULL || meta.reply->opcode != RPR_CHUNK_REP_SUCCESS) {
@@ -1125,7 +1456,8 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
         return true;
     }
 
-    int chunkSize = events[numInputChunks].chunks[0].size;
+    // the repaired chunks are of the same size as the (whole) input chunks
+    int chunkSize = hasPartialInputChunks? file.chunks[inputChunkIndices[0]].size : events[numInputChunks].chunks[0].size;
 
     std::vector<Chunk> inputChunks;
     inputChunks.resize(numInputChunks);
@@ -1145,7 +1477,6 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
         return false;
     }
 
-    pthread_t wt[numRepairedChunks];
     ProxyIO::RequestMeta meta[numRepairedChunks];
     //for (int i = 0; i < file.numChunks; i++) DLOG(INFO) << "Chunk " << i << " size = " << file.chunks[i].size;
     // redistribute the repaired chunks
@@ -1171,7 +1502,7 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
             events[i].chunks[j].copyMeta(file.chunks[failedNodes[i] * numChunksPerNode + j]);
             events[i].chunks[j].size = chunkSize;
             events[i].chunks[j].data = repairedData + (i * numChunksPerNode + j) * chunkSize;
-            events[i].chunks[j].computeMD5();
+            events[i].chunks[j].computeChecksum();
             events[i].chunks[j].freeData = false;
             events[i].containerIds[j] = spareContainers[i];
 
@@ -1186,8 +1517,8 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
         meta[i].io = _io;
         meta[i].request = &events[i];
         meta[i].reply = &events[i + numInputChunks * 2];
-        // send the requests via threads
-        pthread_create(&wt[i], NULL, ProxyIO::sendChunkRequestToAgent, &meta[i]);
+        // send the requests without waiting for the replies
+        ProxyIO::submitChunkRequest(&meta[i]);
     }
 
     // benchmark: set repair size of this stripe
@@ -1199,7 +1530,7 @@ bool ChunkManager::repairFile(File &file, bool *chunkIndicator, int *spareContai
     bool allsuccess = true;
     for (int i = 0; i < numRepairedChunks / numChunksPerNode; i++) {
         void *ptr;
-        pthread_join(wt[i], &ptr);
+        ptr = ProxyIO::waitChunkRequest(&meta[i]);
         // journal the replied change
         //for (int j = 0; j < numChunksPerNode; j++) {
         //    int containerId = meta[i].containerId;
@@ -1257,7 +1588,6 @@ int ChunkManager::checkFile(File &file, bool chunkIndicator[]) {
 int ChunkManager::verifyFileChecksums(File &file, bool chunkIndicator[]) {
     ChunkEvent events[2];
 
-    pthread_t ct;
     ProxyIO::RequestMeta meta;
 
     // construct the request event
@@ -1283,11 +1613,9 @@ int ChunkManager::verifyFileChecksums(File &file, bool chunkIndicator[]) {
     meta.request = &events[0];
     meta.reply = &events[1];
 
-    void *ptr = 0;
-
     // send the request
-    pthread_create(&ct, NULL, ProxyIO::sendChunkRequestToAgent, &meta);
-    pthread_join(ct, &ptr);
+    ProxyIO::submitChunkRequest(&meta);
+    void *ptr = ProxyIO::waitChunkRequest(&meta);
 
     // check if verification request fails over the network / at agent
     if (ptr != 0 || events[1].opcode != Opcode::VRF_CHUNK_REP_SUCCESS) {
@@ -1439,6 +1767,299 @@ unsigned long int ChunkManager::getPerStripeExtraDataSize(std::string storageCla
     return 0;
 }
 
+void ChunkManager::HedgedReadPolicy::addLatency(long latency) {
+    std::lock_guard<std::mutex> lk(lock);
+    if (latencies.size() < HEDGED_READ_LATENCY_HISTORY_SIZE) {
+        latencies.push_back(latency);
+    } else {
+        latencies.at(nextLatency) = latency;
+        nextLatency = (nextLatency + 1) % HEDGED_READ_LATENCY_HISTORY_SIZE;
+    }
+}
+
+long ChunkManager::HedgedReadPolicy::getDelay() {
+    if (delay > 0)
+        return delay * 1000L;
+
+    std::vector<long> sorted;
+    std::unique_lock<std::mutex> lk(lock);
+    if (latencies.size() < HEDGED_READ_MIN_LATENCY_SAMPLES)
+        return -1;
+    sorted = latencies;
+    lk.unlock();
+
+    size_t idx = std::min(sorted.size() * percentile / 100, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    return sorted.at(idx);
+}
+
+ChunkManager::HedgedReadPolicy *ChunkManager::getHedgedReadPolicy(const File &file) {
+    // only codes which decode from any k chunks are supported
+    if (file.codingMeta.coding != CodingScheme::RS && file.codingMeta.coding != CodingScheme::HITCHHIKER)
+        return NULL;
+    auto it = _hedgedReadPolicies.find(file.storageClass.empty()? Config::getInstance().getDefaultStorageClass() : file.storageClass);
+    if (it == _hedgedReadPolicies.end() || it->second->numExtraChunks <= 0)
+        return NULL;
+    return it->second;
+}
+
+/**
+ * Chunk requests of a hedged read, which are released only after all requests complete
+ **/
+struct HedgedChunkRequests {
+    int numRequests;                                    /**< number of requests */
+    int numIssued;                                      /**< number of requests issued */
+    int numInflight;                                    /**< number of requests issued and not yet taken on completion */
+    ChunkEvent *events;                                 /**< request events, followed by the reply events */
+    ProxyIO::RequestMeta *meta;                         /**< request metadata */
+    std::chrono::steady_clock::time_point *issued;      /**< time when each request is issued */
+    ProxyIO::CompletionNotifier notifier;               /**< notification on request completion */
+
+    HedgedChunkRequests(int num) {
+        numRequests = num;
+        numIssued = 0;
+        numInflight = 0;
+        events = new ChunkEvent[num * 2];
+        meta = new ProxyIO::RequestMeta[num];
+        issued = new std::chrono::steady_clock::time_point[num];
+    }
+
+    ~HedgedChunkRequests() {
+        // wait for the requests in flight before releasing the events
+        delete [] meta;
+        delete [] events;
+        delete [] issued;
+    }
+};
+
+bool ChunkManager::accessChunksHedged(ChunkEvent events[], const File &f, int numChunks, int *chunkIndices, int chunkIndicesSize, HedgedReadPolicy *policy) {
+    HedgedChunkRequests *reqs = submitChunksHedged(f, numChunks, chunkIndices, chunkIndicesSize);
+    return completeChunksHedged(reqs, events, f, numChunks, chunkIndices, chunkIndicesSize, policy);
+}
+
+HedgedChunkRequests *ChunkManager::submitChunksHedged(const File &f, int numChunks, const int *chunkIndices, int chunkIndicesSize) {
+    HedgedChunkRequests *reqs = new HedgedChunkRequests(chunkIndicesSize);
+    for (int i = 0; i < numChunks; i++)
+        issueHedgedChunkRequest(reqs, f, chunkIndices);
+    return reqs;
+}
+
+void ChunkManager::issueHedgedChunkRequest(HedgedChunkRequests *reqs, const File &f, const int *chunkIndices) {
+    int i = reqs->numIssued++;
+    ChunkEvent &request = reqs->events[i];
+    request.id = _eventCount.fetch_add(1);
+    request.opcode = Opcode::GET_CHUNK_REQ;
+    request.numChunks = 1;
+    request.chunks = new Chunk[1];
+    request.chunks[0] = f.chunks[chunkIndices[i]];
+    request.chunks[0].freeData = false;
+    request.containerIds = new int[1];
+    request.containerIds[0] = f.containerIds[chunkIndices[i]];
+
+    ProxyIO::RequestMeta &meta = reqs->meta[i];
+    meta.containerId = request.containerIds[0];
+    meta.io = _io;
+    meta.request = &request;
+    meta.reply = &reqs->events[reqs->numRequests + i];
+    meta.notifier = &reqs->notifier;
+
+    reqs->issued[i] = std::chrono::steady_clock::now();
+    ProxyIO::submitChunkRequest(&meta);
+    reqs->numInflight++;
+}
+
+bool ChunkManager::completeChunksHedged(HedgedChunkRequests *reqs, ChunkEvent events[], const File &f, int numChunks, int *chunkIndices, int chunkIndicesSize, HedgedReadPolicy *policy) {
+    std::vector<int> succeeded;
+
+    // request extra chunks if not all chunks arrive before the deadline
+    long delay = policy? policy->getDelay() : -1;
+    bool hedged = delay < 0;
+    std::chrono::steady_clock::time_point deadline = reqs->issued[0] + std::chrono::microseconds(delay);
+
+    while ((int) succeeded.size() < numChunks && (int) succeeded.size() + reqs->numInflight + chunkIndicesSize - reqs->numIssued >= numChunks) {
+        // without a deadline, the chunk requests time out by themselves
+        ProxyIO::RequestMeta *meta = reqs->notifier.wait(hedged? std::chrono::steady_clock::now() + std::chrono::seconds(1) : deadline);
+        if (meta == NULL) {
+            if (!hedged) {
+                int numExtra = std::min(policy->numExtraChunks, chunkIndicesSize - reqs->numIssued);
+                DLOG(INFO) << "Request " << numExtra << " extra chunks for file " << f.name << " after waiting for " << delay << "us";
+                for (int i = 0; i < numExtra; i++)
+                    issueHedgedChunkRequest(reqs, f, chunkIndices);
+                hedged = true;
+            }
+            continue;
+        }
+
+        int i = meta - reqs->meta;
+        reqs->numInflight--;
+
+        // check the reply
+        bool okay = ProxyIO::waitChunkRequest(meta) == 0
+                && meta->reply->opcode == Opcode::GET_CHUNK_REP_SUCCESS
+                && meta->reply->chunks[0].size == f.chunks[chunkIndices[i]].size;
+        if (okay && Config::getInstance().verifyChunkChecksum()) {
+            meta->reply->chunks[0].copyChecksum(f.chunks[chunkIndices[i]]);
+            okay = meta->reply->chunks[0].verifyChecksum();
+        }
+
+        if (okay) {
+            succeeded.push_back(i);
+            if (policy)
+                policy->addLatency(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - reqs->issued[i]).count());
+            continue;
+        }
+
+        LOG(WARNING) << "Failed to get chunk " << chunkIndices[i] << " of file " << f.name << " for " << (policy? "hedged read" : "read") << ", container id = " << meta->containerId << ", return opcode = " << meta->reply->opcode;
+        // replace the failed request
+        if (reqs->numIssued < chunkIndicesSize)
+            issueHedgedChunkRequest(reqs, f, chunkIndices);
+    }
+
+    bool okay = (int) succeeded.size() >= numChunks;
+    if (okay) {
+        // hand over the chunks for decoding, in the order of chunk ids for hedged reads, or in the order requested otherwise
+        succeeded.resize(numChunks);
+        if (policy)
+            std::sort(succeeded.begin(), succeeded.end(), [chunkIndices](int a, int b) { return chunkIndices[a] < chunkIndices[b]; });
+        else
+            std::sort(succeeded.begin(), succeeded.end());
+        int selected[numChunks];
+        for (int i = 0; i < numChunks; i++) {
+            int idx = succeeded.at(i);
+            events[i] = reqs->events[idx];
+            reqs->events[idx].reset();
+            events[numChunks + i] = reqs->events[chunkIndicesSize + idx];
+            reqs->events[chunkIndicesSize + idx].reset();
+            selected[i] = chunkIndices[idx];
+        }
+        memcpy(chunkIndices, selected, sizeof(int) * numChunks);
+    } else {
+        LOG(ERROR) << "Failed to get " << numChunks << " chunks of file " << f.name << " for " << (policy? "hedged read" : "read") << ", only " << succeeded.size() << " obtained";
+    }
+
+    // ignore the late replies
+    releaseChunkRequests(reqs);
+
+    return okay;
+}
+
+void ChunkManager::releaseChunkRequests(HedgedChunkRequests *reqs) {
+    if (reqs == NULL)
+        return;
+    if (reqs->numInflight == 0) {
+        delete reqs;
+        return;
+    }
+    // release the requests once they complete, without blocking the reader
+    std::lock_guard<std::mutex> lk(_reaperLock);
+    _lateRequests.push_back(reqs);
+    _hasLateRequests.notify_one();
+}
+
+void ChunkManager::reapChunkRequests() {
+    std::unique_lock<std::mutex> lk(_reaperLock);
+    while (true) {
+        _hasLateRequests.wait(lk, [this] { return _stopReaper || !_lateRequests.empty(); });
+        if (_lateRequests.empty())
+            break;
+        HedgedChunkRequests *reqs = _lateRequests.front();
+        _lateRequests.pop_front();
+        // wait for the requests in flight outside the lock
+        lk.unlock();
+        delete reqs;
+        lk.lock();
+    }
+}
+
+ChunkManager::StripeRead::StripeRead() {
+    file = 0;
+    chunkIndicator = 0;
+    numChunks = 0;
+    hedged = false;
+    reqs = 0;
+    manager = 0;
+}
+
+ChunkManager::StripeRead::~StripeRead() {
+    // drop the requests if the read is never completed
+    if (manager != NULL)
+        manager->releaseChunkRequests(reqs);
+    else
+        delete reqs;
+}
+
+bool ChunkManager::submitFileStripeRead(File &file, bool chunkIndicator[], StripeRead &read) {
+    Coding *coding = getCodingInstance(file.codingMeta.coding, file.codingMeta.n, file.codingMeta.k);
+    if (coding == NULL) {
+        return false;
+    }
+
+    // plan the chunks to read as ChunkManager::readFile() does
+    std::vector<chunk_id_t> failedChunkIds;
+    for (int i = 0; i < file.numChunks; i++) {
+        if (chunkIndicator[i] == false) failedChunkIds.push_back(i);
+    }
+    bool decodable = coding->preDecode(failedChunkIds, read.plan, file.codingMeta.codingState);
+    int selected = read.plan.getNumInputChunks();
+    int numChunks = coding->getNumDataChunks();
+    if (selected < numChunks || !decodable) {
+        LOG(ERROR) << "Failed to find enough chunks (only " << selected << " alive, and need " << numChunks << ") for read";
+        return false;
+    }
+    std::vector<chunk_id_t> inputChunkIds = read.plan.getInputChunkIds();
+    read.chunkIndices.assign(inputChunkIds.begin(), inputChunkIds.begin() + selected);
+    read.numChunks = read.plan.getMinNumInputChunks();
+
+    // hedge against slow chunk replies if there are spare chunks to request, and otherwise only request the chunks to decode from
+    read.hedged = coding->getNumChunksPerNode() == 1 && selected > read.numChunks && getHedgedReadPolicy(file) != NULL;
+    if (!read.hedged)
+        read.chunkIndices.resize(read.numChunks);
+
+    read.file = &file;
+    read.chunkIndicator = chunkIndicator;
+    read.reqs = submitChunksHedged(file, read.numChunks, read.chunkIndices.data(), read.chunkIndices.size());
+    read.manager = this;
+
+    return true;
+}
+
+bool ChunkManager::completeFileStripeRead(StripeRead &read) {
+    if (read.reqs == NULL)
+        return false;
+
+    File &file = *read.file;
+    HedgedChunkRequests *reqs = read.reqs;
+    // the requests are released on completion
+    read.reqs = 0;
+
+    Coding *coding = getCodingInstance(file.codingMeta.coding, file.codingMeta.n, file.codingMeta.k);
+    if (coding == NULL) {
+        releaseChunkRequests(reqs);
+        return false;
+    }
+    int numChunks = coding->getNumDataChunks();
+    int numChunksPerNode = coding->getNumChunksPerNode();
+
+    ChunkEvent *events = new ChunkEvent[numChunks * 2];
+    if (!completeChunksHedged(reqs, events, file, read.numChunks, read.chunkIndices.data(), read.chunkIndices.size(), read.hedged? getHedgedReadPolicy(file) : NULL)) {
+        delete [] events;
+        // retry with the other alive chunks
+        LOG(WARNING) << "Failed to get the chunks requested for file " << file.name << ", retry the read of stripe";
+        return readFileStripe(file, read.chunkIndicator);
+    }
+
+    int *nodeIndices = new int[file.numChunks / numChunksPerNode];
+    for (int i = 0; i < numChunks / numChunksPerNode; i++)
+        nodeIndices[i] = read.chunkIndices.at(i * numChunksPerNode) / numChunksPerNode;
+
+    bool decodeSuccess = this->decodeFile(file, nodeIndices, events, read.plan);
+
+    delete [] events;
+    delete [] nodeIndices;
+
+    return decodeSuccess;
+}
+
 bool ChunkManager::accessChunks(ChunkEvent events[], const File &f, int numChunks, Opcode reqOp, Opcode expectedOpRep, int numChunksPerNode, int *chunkIndices, int chunkIndicesSize, bool *chunkIndicator) {
     Benchmark &bm = Benchmark::getInstance();
     BMStripe *bmStripe = NULL;
@@ -1476,7 +2097,6 @@ bool ChunkManager::accessChunks(ChunkEvent events[], const File &f, int numChunk
     int numSuccess = 0;
     bool allsuccess = false;
 
-    pthread_t wt[numChunks];
     ProxyIO::RequestMeta meta[numChunks];
 
     // retry others if number of chunks get in last iteration is less than required, and there is more chunks to try
@@ -1519,8 +2139,8 @@ bool ChunkManager::accessChunks(ChunkEvent events[], const File &f, int numChunk
                 meta[i].network = &(bmStripe->network->at(i));
             }
 
-            // send the requests via threads
-            pthread_create(&wt[i], NULL, ProxyIO::sendChunkRequestToAgent, &meta[i]);
+            // send the requests without waiting for the replies
+            ProxyIO::submitChunkRequest(&meta[i]);
         }
 
         // the event chunks are init (no need to init upon retry)
@@ -1531,7 +2151,7 @@ bool ChunkManager::accessChunks(ChunkEvent events[], const File &f, int numChunk
         bool sentNoError[numChunks];
         for (int i = numSuccess; i < numChunks; i++) {
             void *ptr;
-            pthread_join(wt[i], &ptr);
+            ptr = ProxyIO::waitChunkRequest(&meta[i]);
             sentNoError[i] = ptr == 0;
             
             if (benchmark && bmStripe->agentProcess && bmStripe->agentProcess->size() > (size_t) i) {
@@ -1552,8 +2172,8 @@ bool ChunkManager::accessChunks(ChunkEvent events[], const File &f, int numChunk
                 switch (meta[i].request->opcode) {
                 case Opcode::GET_CHUNK_REQ:
                     if (Config::getInstance().verifyChunkChecksum()) {
-                        meta[i].reply->chunks[0].copyMD5(chunkList[(useIdx? chunkIndices[i] : i)]);
-                        checksumPassed = meta[i].reply->chunks[0].verifyMD5();
+                        meta[i].reply->chunks[0].copyChecksum(chunkList[(useIdx? chunkIndices[i] : i)]);
+                        checksumPassed = meta[i].reply->chunks[0].verifyChecksum();
                     }
                     chunkSizeMatches = chunkList[useIdx? chunkIndices[i] : i].size ==  meta[i].reply->chunks[0].size;
                     break;
@@ -1676,7 +2296,6 @@ bool ChunkManager::accessChunks(ChunkEvent events[], const File &f, int numChunk
 }
 
 bool ChunkManager::accessGroupedChunks(ChunkEvent events[], int containerIds[], int numChunks, int chunkGroups[], int numChunkGroups, unsigned char  namespaceId, boost::uuids::uuid fuuid, std::string matrix, int chunkIdOffset) {
-    pthread_t wt[numChunkGroups];
     ProxyIO::RequestMeta meta[numChunkGroups];
     DLOG(INFO) << "Get grouped chunks from " << numChunkGroups << " groups of " << numChunks << " chunks";
 
@@ -1717,8 +2336,8 @@ bool ChunkManager::accessGroupedChunks(ChunkEvent events[], int containerIds[],
         meta[i].io = _io;
         meta[i].request = &events[i];
         meta[i].reply = &events[i + numChunkGroups];
-        // send the requests via threads
-        pthread_create(&wt[i], NULL, ProxyIO::sendChunkRequestToAgent, &meta[i]);
+        // send the requests without waiting for the replies
+        ProxyIO::submitChunkRequest(&meta[i]);
     }
 
     // check the reply
@@ -1726,7 +2345,7 @@ bool ChunkManager::accessGroupedChunks(ChunkEvent events[], int containerIds[],
 
     for (int i = 0; i < numChunkGroups; i++) {
         void *ptr;
-        pthread_join(wt[i], &ptr);
+        ptr = ProxyIO::waitChunkRequest(&meta[i]);
         if (ptr != 0 || meta[i].reply->opcode != ENC_CHUNK_REP_SUCCESS) {
             LOG(ERROR) << "Failed to operate on chunk (" << ENC_CHUNK_REQ << ") due to internal failure, container id = " << meta[i].containerId << ", return opcode =" << meta[i].reply->opcode;
             allsuccess = false;
@@ -1749,6 +2368,66 @@ bool ChunkManager::accessGroupedChunks(ChunkEvent events[], int containerIds[],
     return allsuccess;
 }
 
+bool ChunkManager::accessChunkRanges(ChunkEvent events[], const File &f, int numChunks, int *chunkIndices, const int ranges[]) {
+    ProxyIO::RequestMeta meta[numChunks];
+    DLOG(INFO) << "Get ranges of " << numChunks << " chunks";
+
+    // generate a read chunk range event for each chunk
+    for (int i = 0; i < numChunks; i++) {
+        int idx = chunkIndices[i];
+        events[i].id = _eventCount.fetch_add(1);
+        events[i].opcode = Opcode::GET_CHUNK_RANGE_REQ;
+        events[i].numChunks = 1;
+        try {
+            events[i].chunks = new Chunk[1];
+            events[i].containerIds = new int[1];
+            events[i].codingMeta.codingState = new unsigned char [sizeof(int) * 2];
+        } catch (std::bad_alloc &e) {
+            LOG(ERROR) << "Failed to allocate memory for event chunks";
+            return false;
+        }
+        events[i].chunks[0] = f.chunks[idx];
+        events[i].chunks[0].freeData = false;
+        events[i].containerIds[0] = f.containerIds[idx];
+        // the range is carried as coding state
+        events[i].codingMeta.codingStateSize = sizeof(int) * 2;
+        memcpy(events[i].codingMeta.codingState, &ranges[i * 2], sizeof(int) * 2);
+
+        meta[i].containerId = f.containerIds[idx];
+        meta[i].io = _io;
+        meta[i].request = &events[i];
+        meta[i].reply = &events[i + numChunks];
+        // send the requests without waiting for the replies
+        ProxyIO::submitChunkRequest(&meta[i]);
+    }
+
+    // check the reply
+    bool allsuccess = true;
+
+    for (int i = 0; i < numChunks; i++) {
+        void *ptr;
+        ptr = ProxyIO::waitChunkRequest(&meta[i]);
+        if (ptr != 0 || meta[i].reply->opcode != GET_CHUNK_RANGE_REP_SUCCESS || meta[i].reply->numChunks != 1 || meta[i].reply->chunks[0].size != ranges[i * 2 + 1]) {
+            LOG(ERROR) << "Failed to operate on chunk (" << GET_CHUNK_RANGE_REQ << ") due to internal failure, container id = " << meta[i].containerId << ", return opcode =" << meta[i].reply->opcode;
+            allsuccess = false;
+            continue;
+        }
+        LOG(INFO)   << "Get reply for chunk ("
+                    << (unsigned int) meta[i].reply->chunks[0].getNamespaceId()
+                    << ", "
+                    << meta[i].reply->chunks[0].getFileUUID()
+                    << ", "
+                    << (int) meta[i].reply->chunks[0].getChunkId()
+                    << ") range at offset "
+                    << ranges[i * 2]
+                    << " of size "
+                    << meta[i].reply->chunks[0].size
+        ;
+    }
+
+    return allsuccess;
+}
+
 bool ChunkManager::isValidCoding(int coding) {
     return coding >= 0 && coding < CodingScheme::UNKNOWN_CODE;
 }
@@ -1777,6 +2456,16 @@ int ChunkManager::getCodingScheme(std::string className) {
     return CodingScheme::UNKNOWN_CODE;
 }
 
+int ChunkManager::getChecksumType(std::string className) {
+    try {
+        StorageClass* sc = _storageClasses.at(className);
+        return sc->getChecksumType();
+    } catch (std::out_of_range &e) {
+        DLOG(INFO) << "Storage class [" << className << "] not found";
+    }
+    return ChecksumType::CHECKSUM_MD5;
+}
+
 Coding* ChunkManager::getCodingInstance(int codingScheme, int n, int k) {
     Coding *code = NULL;
     if (!isValidCoding(codingScheme)) {
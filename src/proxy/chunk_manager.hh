@@ -4,9 +4,15 @@
 #define __CHUNK_MANAGER_HH__
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <map>
+#include <thread>
+#include <vector>
 
+#include <boost/timer/timer.hpp>
 #include <zmq.hpp>
 
 #include "bg_chunk_handler.hh"
@@ -17,10 +23,50 @@
 #include "../ds/file.hh"
 #include "../ds/storage_class.hh"
 
+#define HEDGED_READ_LATENCY_HISTORY_SIZE (256)
+#define HEDGED_READ_MIN_LATENCY_SAMPLES  (16)
+
+struct HedgedChunkRequests;
+
 class ChunkManager {
 public:
     ChunkManager(std::map<int, std::string> *containerToAgentMap, ProxyIO *io, BgChunkHandler *handler, MetaStore *metastore = nullptr);
     ~ChunkManager();
+
+    /**
+     * Chunk requests of a file stripe submitted for write
+     **/
+    struct StripeWrite {
+        File *file;                                 /**< file containing the stripe */
+        std::vector<int> spareContainers;           /**< spare containers for writing chunks */
+        bool isOverwrite;                           /**< whether the file stripe is overwritten */
+        unsigned char *codebuf;                     /**< buffer for code chunks */
+        ProxyIO::RequestMeta *meta;                 /**< chunk requests */
+        ChunkEvent *events;                         /**< chunk events of the requests and the replies */
+        int numReqs;                                /**< number of chunk requests */
+        int numFgReqs;                              /**< number of foreground chunk requests */
+        int numBgReqs;                              /**< number of background chunk requests */
+        boost::timer::cpu_timer timer;              /**< time since the requests are issued */
+
+        StripeWrite() {
+            file = 0;
+            isOverwrite = false;
+            codebuf = 0;
+            meta = 0;
+            events = 0;
+            numReqs = numFgReqs = numBgReqs = 0;
+        }
+
+        ~StripeWrite() {
+            // wait for and drop the requests if the write is never completed
+            free(codebuf);
+            delete [] meta;
+            delete [] events;
+        }
+
+        StripeWrite(const StripeWrite&) = delete;
+        StripeWrite &operator=(const StripeWrite&) = delete;
+    };
     
     /**
      * Write a stripe in the file to storage backend
@@ -37,7 +83,59 @@ public:
     bool writeFileStripe(File &file, int spareContainers[], int numSpare, bool alignDataBuf = true, bool isOverwrite = false, bool withEncode = true);
 
     /**
-     * Encode a file
+     * Encode a stripe in the file and issue its chunk requests without waiting for the replies
+     *
+     * The file and its data must remain valid until ChunkManager::completeFileStripe() returns
+     *
+     * @param[in,out] file          file containing the stripe to write
+     * @param[in] spareContainers   spare containers for writing chunks
+     * @param[in] numSpare          number of spare containers for writing chunks
+     * @param[out] write            chunk requests issued, to pass to ChunkManager::completeFileStripe()
+     * @param[in] alignDataBuf      whether data buffer needs internal alignment, caller should adjust it manually to the size returned by ChunkManager::getDataStripeSize() before disabling this
+     * @param[in] isOverwrite       whether the file stripes are overwritten
+     * @param[in] withEncode        whether to encode the file(stripe)
+     *
+     * @return whether the chunk requests are issued
+     **/
+    bool submitFileStripe(File &file, int spareContainers[], int numSpare, StripeWrite &write, bool alignDataBuf = true, bool isOverwrite = false, bool withEncode = true);
+
+    /**
+     * Wait for the chunk requests of a stripe issued by ChunkManager::submitFileStripe(), and revert (or delete) the stripe on failure
+     *
+     * @param[in,out] write         chunk requests issued
+     *
+     * @return whether the file stripe is successfully written
+     **/
+    bool completeFileStripe(StripeWrite &write);
+
+    /**
+     * Tell whether stripes of a file can be overwritten in place by applying the data changes to the affected data chunks and the code chunks
+     *
+     * @param[in] file              file with coding metadata
+     *
+     * @return whether in-place stripe updates are supported
+     **/
+    bool canUpdateFileStripe(const File &file);
+
+    /**
+     * Overwrite part of the data in a stripe in place, by applying the changes of the affected data chunks and the code chunks to the stored ones
+     *
+     * The changes are applied only to stored chunks matching the checksums in the file metadata, so the update can be safely retried.
+     * Updating a stripe with the old data returned reverts the update.
+     *
+     * @param[in,out] file          file with the chunk metadata and container ids of all stripes; checksums and versions of the updated chunks are refreshed on success, and chunks which cannot be reverted on failure are marked as corrupted
+     * @param[in] stripeId          id of the stripe to overwrite
+     * @param[in] offset            offset of the new data in the stripe
+     * @param[in] length            length of the new data
+     * @param[in] data              new data
+     * @param[out] oldData          buffer of the given length for the data overwritten, NULL if not needed
+     *
+     * @return whether the stripe is updated; the stored chunks, including those updated without a reply, are reverted on failure
+     **/
+    bool updateFileStripe(File &file, int stripeId, unsigned long int offset, unsigned long int length, const unsigned char *data, unsigned char *oldData = NULL);
+
+    /**
+     * Encode a file, and compute the checksums of the chunks along
      * 
      * @param[in,out] file          file(stripe) to write
      * @param[in] spareContainers   spare containers for writing chunks
@@ -50,6 +148,50 @@ public:
     bool encodeFile(File &file, int spareContainers[], int numSpare, bool alignDataBuf = true, unsigned char *codebuf = 0);
 
 
+    /**
+     * Chunk requests of a file stripe submitted for read
+     **/
+    struct StripeRead {
+        File *file;                                 /**< file containing the stripe */
+        bool *chunkIndicator;                       /**< chunk liveness */
+        DecodingPlan plan;                          /**< decoding plan on the chunks requested */
+        int numChunks;                              /**< number of chunks to decode from */
+        std::vector<int> chunkIndices;              /**< indices of the chunks to request, in the order of preference */
+        bool hedged;                                /**< whether extra chunks are requested on slow reads */
+        HedgedChunkRequests *reqs;                  /**< chunk requests */
+        ChunkManager *manager;                      /**< chunk manager which releases the requests */
+
+        StripeRead();
+        ~StripeRead();
+
+        StripeRead(const StripeRead&) = delete;
+        StripeRead &operator=(const StripeRead&) = delete;
+    };
+
+    /**
+     * Issue the chunk requests for reading a stripe in the file without waiting for the replies
+     *
+     * The file and the chunk indicator must remain valid until ChunkManager::completeFileStripeRead() returns
+     *
+     * @param[in] file              file containing the stripe to read
+     * @param[in] chunkIndicator    list of indicators for chunk liveness (true means alive, false means failed), its size is equal to the number of chunks in the file
+     * @param[out] read             chunk requests issued, to pass to ChunkManager::completeFileStripeRead()
+     *
+     * @return whether the chunk requests are issued
+     **/
+    bool submitFileStripeRead(File &file, bool chunkIndicator[], StripeRead &read);
+
+    /**
+     * Wait for the chunk requests of a stripe issued by ChunkManager::submitFileStripeRead(), and decode the stripe
+     *
+     * Falls back to ChunkManager::readFileStripe() if not enough chunks are returned
+     *
+     * @param[in,out] read          chunk requests issued
+     *
+     * @return whether the file stripe is successfully read
+     **/
+    bool completeFileStripeRead(StripeRead &read);
+
     /**
      * Read a stripe in the file from storage backend  (sequential proxy)
      *
@@ -275,6 +417,125 @@ public:
 
 private:
 
+    /**
+     * Hedged read settings, and the recent chunk read latencies, of a storage class
+     **/
+    struct HedgedReadPolicy {
+        int numExtraChunks;                         /**< number of extra chunks to request on slow reads, 0 if disabled */
+        int delay;                                  /**< time to wait before requesting extra chunks (in milliseconds), 0 to follow the latency percentile */
+        int percentile;                             /**< percentile of recent chunk read latencies to wait before requesting extra chunks */
+        std::mutex lock;                            /**< lock on the latency history */
+        std::vector<long> latencies;                /**< recent chunk read latencies (in microseconds) */
+        size_t nextLatency;                         /**< index of the oldest latency to replace */
+
+        HedgedReadPolicy(int numExtraChunks, int delay, int percentile) :
+                numExtraChunks(numExtraChunks), delay(delay), percentile(percentile), nextLatency(0) {
+        }
+
+        /**
+         * Record the latency of a chunk read
+         *
+         * @param[in] latency           latency in microseconds
+         **/
+        void addLatency(long latency);
+
+        /**
+         * Get the time to wait before requesting extra chunks
+         *
+         * @return time to wait in microseconds, -1 if not enough latencies are recorded
+         **/
+        long getDelay();
+    };
+
+    /**
+     * Find the hedged read policy of the storage class of a file
+     *
+     * @param[in] file              file to read
+     *
+     * @return the policy if hedged reads are enabled for the file, NULL otherwise
+     **/
+    HedgedReadPolicy *getHedgedReadPolicy(const File &file);
+
+    /**
+     * Get chunks stored in containers, and request extra chunks if the replies are slow
+     *
+     * Chunks are first requested in the order of the chunk indices, and one more chunk is requested whenever a request fails.
+     * Once the delay of the policy passes, extra chunks are requested. The first chunks which arrive are returned, and late replies are ignored.
+     *
+     * @param[in,out] events        list of chunk events for holding the requests and replies of the chunks returned, its size is a double of the number of chunks
+     * @param[in] file              file that contains the list of container ids and chunks
+     * @param[in] numChunks         number of chunks to get
+     * @param[in,out] chunkIndices  list of indices of chunks to get, in the order of preference; on success, the first numChunks indices are set to those of the chunks returned, in ascending order
+     * @param[in] chunkIndicesSize  size of the chunk indices provided
+     * @param[in] policy            hedged read policy
+     *
+     * @return whether enough chunks are returned
+     **/
+    bool accessChunksHedged(ChunkEvent events[], const File &f, int numChunks, int *chunkIndices, int chunkIndicesSize, HedgedReadPolicy *policy);
+
+    /**
+     * Issue the requests of the first chunks of a hedged read, see ChunkManager::accessChunksHedged()
+     *
+     * @param[in] file              file that contains the list of container ids and chunks
+     * @param[in] numChunks         number of chunks to get
+     * @param[in] chunkIndices      list of indices of chunks to get, in the order of preference
+     * @param[in] chunkIndicesSize  size of the chunk indices provided
+     *
+     * @return the chunk requests issued, to pass to ChunkManager::completeChunksHedged()
+     **/
+    HedgedChunkRequests *submitChunksHedged(const File &f, int numChunks, const int *chunkIndices, int chunkIndicesSize);
+
+    /**
+     * Issue the request of the next chunk in a hedged read
+     *
+     * @param[in,out] reqs          chunk requests of the read
+     * @param[in] file              file that contains the list of container ids and chunks
+     * @param[in] chunkIndices      list of indices of chunks to get, in the order of preference
+     **/
+    void issueHedgedChunkRequest(HedgedChunkRequests *reqs, const File &f, const int *chunkIndices);
+
+    /**
+     * Wait for the chunks issued by ChunkManager::submitChunksHedged(), request more chunks on failures and slow replies, and release the requests, see ChunkManager::accessChunksHedged()
+     *
+     * @param[in] reqs              chunk requests issued
+     * @param[in,out] events        list of chunk events for holding the requests and replies of the chunks returned, its size is a double of the number of chunks
+     * @param[in] file              file that contains the list of container ids and chunks
+     * @param[in] numChunks         number of chunks to get
+     * @param[in,out] chunkIndices  list of indices of chunks to get, as passed to ChunkManager::submitChunksHedged()
+     * @param[in] chunkIndicesSize  size of the chunk indices provided
+     * @param[in] policy            hedged read policy, NULL to only request more chunks on failures
+     *
+     * @return whether enough chunks are returned
+     **/
+    bool completeChunksHedged(HedgedChunkRequests *reqs, ChunkEvent events[], const File &f, int numChunks, int *chunkIndices, int chunkIndicesSize, HedgedReadPolicy *policy);
+
+    /**
+     * Release chunk requests, or hand them over to the reaper if some are still in flight
+     *
+     * @param[in] reqs              chunk requests to release
+     **/
+    void releaseChunkRequests(HedgedChunkRequests *reqs);
+
+    /**
+     * Release the chunk requests handed over once their late replies arrive (or time out), until stopped
+     **/
+    void reapChunkRequests();
+
+    /**
+     * Apply changes to chunks of a file in place, each only to the stored chunk matching the expected checksum
+     *
+     * @param[in] file              file with the chunk metadata and container ids
+     * @param[in] numChunks         number of chunks to update
+     * @param[in] chunkIndices      indices of the chunks to update in the file
+     * @param[in] deltas            changes to XOR to the stored chunks, each of the size of the chunk
+     * @param[in] expected          expected stored chunks, with the checksums before the changes are applied
+     * @param[out] updated          updated chunks, with the checksums and versions after the changes are applied
+     * @param[in,out] done          whether each chunk is updated; chunks already updated are skipped
+     *
+     * @return whether all chunks not skipped are updated
+     **/
+    bool updateChunksInPlace(const File &file, int numChunks, const int chunkIndices[], unsigned char *const deltas[], const Chunk expected[], Chunk updated[], bool done[]);
+
     /**
      * Operate on the alive chunks of a file in the storage backend
      *
@@ -322,6 +583,19 @@ private:
      **/
     bool accessGroupedChunks(ChunkEvent events[], int containerIds[], int numChunks, int chunkGroups[], int numChunkGroups, unsigned char  namepsaceId, boost::uuids::uuid fuuid, std::string matrix, int chunkIdOffset);
 
+    /**
+     * Get byte ranges of chunks stored in containers
+     *
+     * @param[in,out] events        list of chunk events for sending chunk requests and holding the response, its size is a double of the number of chunks
+     * @param[in] file              file that contains the list of container ids and chunks
+     * @param[in] numChunks         number of chunks to access
+     * @param[in] chunkIndices      list of indices of the chunks to access, its size is equal to the number of chunks to access
+     * @param[in] ranges            (offset, length) of the range to get in each chunk, its size is a double of the number of chunks to access
+     *
+     * @return whether the access to all chunks are successful
+     **/
+    bool accessChunkRanges(ChunkEvent events[], const File &f, int numChunks, int *chunkIndices, const int ranges[]);
+
     /**
      * Modify a file in storage backend
      *
@@ -353,6 +627,15 @@ private:
      **/
     int getCodingScheme(std::string className);
 
+    /**
+     * Obtain the chunk checksum type by class name search
+     *
+     * @param[in] className name of the storage class
+     *
+     * @return checksum type if class exists, ChecksumType::CHECKSUM_MD5 otherwise
+     **/
+    int getChecksumType(std::string className);
+
     /**
      * Get the max stripe size, using coding intance
      *
@@ -415,12 +698,19 @@ private:
     std::atomic<int> _eventCount;                              /**< evnet id counter */
 
     std::map<std::string, StorageClass*> _storageClasses;      /**< storage classes mapping */
+    std::map<std::string, HedgedReadPolicy*> _hedgedReadPolicies; /**< hedged read policies of storage classes */
     std::map<std::string, Coding*> _codings;                   /**< coding instances mapping */
     std::mutex _codingsLock;                                   /**< coding instance mapping lock */
     ProxyIO *_io;                                              /**< IO module */
     BgChunkHandler *_bgChunkHandler;                           /**< background chunk handler */
     MetaStore*_metastore;                                      /**< metastore */
 
+    std::mutex _reaperLock;                                    /**< lock on the chunk requests to release */
+    std::condition_variable _hasLateRequests;                  /**< signal for chunk requests to release or stop */
+    std::deque<HedgedChunkRequests*> _lateRequests;            /**< chunk requests with late replies to wait for before release */
+    bool _stopReaper;                                          /**< whether to stop the reaper */
+    std::thread _reaper;                                       /**< thread releasing chunk requests with late replies */
+
     std::map<int, std::string> *_containerToAgentMap;          /**< map of containers [container id]->agent socket*/
 
     
@@ -227,7 +227,9 @@ int ProxyCoordinator::findSpareContainers(const int *containerIds, int numContai
     int n = codingMeta.n;
     int k = codingMeta.k;
     int f = codingMeta.f;
-    int l = f > 0 ? (n - k) / f : n; // max. number of containers chosen per agent, floor of (n-k)/f 
+    // number of chunk failures tolerated in any pattern, only g+1 for LRC
+    int t = codingMeta.coding == CodingScheme::LRC? LRC_NUM_GLOBAL_PARITIES + 1 : n - k;
+    int l = f > 0 ? t / f : n; // max. number of containers chosen per agent, floor of t/f 
     int r = 0; // min. number of containers chosen per agent
 
     //DLOG(INFO) << "Check for " << numSpare << " with " << numContainers << " at hand, n = " << n << ", k = " << k << ", f = " << f << " l = " << l;
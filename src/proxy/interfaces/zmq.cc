@@ -7,6 +7,9 @@
 #include <string.h>
 #include <unistd.h>    // close()
 
+#include <algorithm>
+#include <deque>
+
 #include "zmq.hh"
 #include "../../common/io.hh"
 #include "../../common/config.hh"
@@ -29,6 +32,8 @@ ProxyZMQIntegration::ProxyZMQIntegration(Proxy *proxy) {
     pthread_barrier_init(&_stopRunning, NULL, 2);
     _isRunning = false;
     _releaseProxy = proxy == 0;
+    _nextWriteSessionId = 1;
+    _nextReadSessionId = 1;
 }
 
 ProxyZMQIntegration::ProxyZMQIntegration(ProxyCoordinator *coordinator, std::map<int, std::string> *map, BgChunkHandler::TaskQueue *queue) {
@@ -41,12 +46,16 @@ ProxyZMQIntegration::ProxyZMQIntegration(ProxyCoordinator *coordinator, std::map
     pthread_barrier_init(&_stopRunning, NULL, 2);
     _isRunning = false;
     _releaseProxy = true;
+    _nextWriteSessionId = 1;
+    _nextReadSessionId = 1;
 }
 
 ProxyZMQIntegration::~ProxyZMQIntegration() {
     stop();
     delete _frontend;
     delete _backend;
+    // remove the data of unfinished uploads
+    abortIdleWriteSessions(/* all */ true);
     if (_releaseProxy)
         delete _proxy;
 }
@@ -87,12 +96,12 @@ void *ProxyZMQIntegration::run(void *arg) {
     self->_frontend->bind(proxyAddr);
 
     // dispatch requests
-    self->_backend = new zmq::socket_t(self->_cxt, ZMQ_DEALER);
+    self->_backend = new zmq::socket_t(self->_cxt, ZMQ_ROUTER);
     self->_backend->bind(_workerAddr);
 
     // start processing requests
     try {
-        zmq::proxy(*self->_frontend, *self->_backend, NULL);
+        dispatchRequests(*self->_frontend, *self->_backend);
     } catch (std::exception &e) {
         LOG(WARNING) << "Proxy reuqeest dispatcher ended, " << e.what();
     }
@@ -105,14 +114,86 @@ void *ProxyZMQIntegration::run(void *arg) {
     return NULL;
 }
 
+void ProxyZMQIntegration::dispatchRequests(zmq::socket_t &frontend, zmq::socket_t &backend) {
+    std::deque<zmq::message_t> idleWorkers;
+    zmq::message_t msg;
+
+    auto forward = [&msg](zmq::socket_t &from, zmq::socket_t &to) {
+        bool more = true;
+        while (more) {
+            msg.rebuild();
+            from.recv(&msg);
+            more = msg.more();
+            to.send(msg, more? ZMQ_SNDMORE : 0);
+        }
+    };
+
+    while (true) {
+        zmq::pollitem_t items[] = {
+            { (void *) backend, 0, ZMQ_POLLIN, 0 },
+            { (void *) frontend, 0, ZMQ_POLLIN, 0 }
+        };
+        // only take new requests when some worker is idle, and leave the others queued at the frontend
+        zmq::poll(items, idleWorkers.empty()? 1 : 2, -1);
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            // worker identity and the empty delimiter
+            zmq::message_t worker;
+            backend.recv(&worker);
+            msg.rebuild();
+            backend.recv(&msg);
+            // either a reply to forward (with the client envelope in front), or the first ready signal of the worker
+            msg.rebuild();
+            backend.recv(&msg);
+            if (msg.more()) {
+                frontend.send(msg, ZMQ_SNDMORE);
+                forward(backend, frontend);
+            }
+            idleWorkers.emplace_back(std::move(worker));
+        }
+
+        if (!idleWorkers.empty() && (items[1].revents & ZMQ_POLLIN)) {
+            backend.send(idleWorkers.front(), ZMQ_SNDMORE);
+            idleWorkers.pop_front();
+            backend.send("", 0, ZMQ_SNDMORE);
+            forward(frontend, backend);
+        }
+    }
+}
+
+bool ProxyZMQIntegration::getEnvelope(zmq::socket_t &socket, std::vector<zmq::message_t> &envelope) {
+    envelope.clear();
+    while (true) {
+        zmq::message_t msg;
+        socket.recv(&msg);
+        // the empty delimiter, followed by the request
+        if (msg.size() == 0 && msg.more())
+            return true;
+        // no delimiter before the end of message, keep only the client identity to route the failure reply back
+        if (!msg.more()) {
+            envelope.resize(std::min(envelope.size(), (size_t) 1));
+            return false;
+        }
+        envelope.emplace_back(std::move(msg));
+    }
+}
+
+void ProxyZMQIntegration::sendEnvelope(zmq::socket_t &socket, std::vector<zmq::message_t> &envelope) {
+    for (auto &msg : envelope)
+        socket.send(msg, ZMQ_SNDMORE);
+    socket.send("", 0, ZMQ_SNDMORE);
+}
+
 void *ProxyZMQIntegration::handleRequests(void *arg) {
     ProxyZMQIntegration *self = (ProxyZMQIntegration*) arg;
 
     unsigned long int traffic = 0;
     
-    zmq::socket_t socket(self->_cxt, ZMQ_REP);
+    zmq::socket_t socket(self->_cxt, ZMQ_REQ);
     try {
         socket.connect(_workerAddr);
+        // tell the dispatcher that this worker is ready for requests
+        socket.send("READY", 5, 0);
     } catch (zmq::error_t &e) {
         LOG(ERROR) << "Failed to connect to request queue: " << e.what();
         return NULL;
@@ -125,15 +206,42 @@ void *ProxyZMQIntegration::handleRequests(void *arg) {
         Reply rep;
         File myfile;
         bool success = false, okay = true;
+        std::vector<zmq::message_t> envelope;
 
         try  {
-            if (getRequest(socket, req) != 0)
-                continue;
+            if (!getEnvelope(socket, envelope)) {
+                LOG(WARNING) << "Failed to find the envelope delimiter of request";
+                req.opcode = ClientOpcode::UNKNOWN_CLIENT_OP;
+            } else if (getRequest(socket, req) != 0) {
+                // skip the rest of the malformed request, and reply with a failure
+                zmq::message_t msg;
+                while (socket.getsockopt<int>(ZMQ_RCVMORE))
+                    socket.recv(&msg);
+                LOG(WARNING) << "Failed to parse request, opcode = " << req.opcode;
+                req.opcode = ClientOpcode::UNKNOWN_CLIENT_OP;
+            }
         } catch (zmq::error_t &e) {
-            LOG_IF(ERROR, self->_isRunning) << "Failed to get request message: " << e.what();
-            break;
+            if (!self->_isRunning || e.num() == ETERM) {
+                LOG_IF(ERROR, self->_isRunning) << "Failed to get request message: " << e.what();
+                break;
+            }
+            // keep the worker for the next request, and reply with a failure to the current one
+            LOG(WARNING) << "Failed to parse request, " << e.what();
+            try {
+                zmq::message_t msg;
+                while (socket.getsockopt<int>(ZMQ_RCVMORE))
+                    socket.recv(&msg);
+            } catch (zmq::error_t &se) {
+                LOG(ERROR) << "Failed to skip the rest of request, " << se.what();
+                break;
+            }
+            req.opcode = ClientOpcode::UNKNOWN_CLIENT_OP;
         }
 
+        // clean up the write and read sessions left behind by clients
+        self->abortIdleWriteSessions();
+        self->closeIdleReadSessions();
+
         switch(req.opcode) {
         case ClientOpcode::WRITE_FILE_REQ:
             DLOG(INFO) << "Get a write file request";
@@ -445,6 +553,157 @@ void *ProxyZMQIntegration::handleRequests(void *arg) {
         case GET_PROXY_STATUS_REQ:
             proxy->getProxyStatus(rep.proxyStatus);
             rep.opcode = ClientOpcode::GET_PROXY_STATUS_REP_SUCCESS;
+            break;
+
+        // write sessions are shared among workers, and always run on the proxy of the interface (instead of the one of any worker)
+        case OPEN_WRITE_SESSION_REQ:
+            {
+                DLOG(INFO) << "Get an open write session request";
+                // name
+                myfile.nameLength = req.file.name.size();
+                myfile.name = (char *) malloc (myfile.nameLength + 1);
+                memcpy(myfile.name, req.file.name.c_str(), myfile.nameLength);
+                myfile.name[myfile.nameLength] = 0;
+                // namespace id
+                myfile.namespaceId = req.file.namespaceId;
+                // storage class
+                myfile.storageClass = req.file.storageClass;
+
+                Proxy::WriteSession *session = self->_proxy->openWriteSession(myfile);
+                if (session != NULL)
+                    rep.sessionId = self->addWriteSession(session);
+                rep.opcode = session != NULL? ClientOpcode::OPEN_WRITE_SESSION_REP_SUCCESS : ClientOpcode::OPEN_WRITE_SESSION_REP_FAIL;
+            }
+            break;
+
+        case WRITE_SESSION_DATA_REQ:
+            {
+                Proxy::WriteSession *session = self->takeWriteSession(req.sessionId);
+                if (session != NULL) {
+                    success = self->_proxy->writeSessionData(session, req.file.data, req.file.size);
+                    rep.file.size = self->_proxy->getWriteSessionSize(session);
+                    self->returnWriteSession(req.sessionId, session);
+                    traffic += req.file.size;
+                } else {
+                    LOG(WARNING) << "Failed to find write session " << req.sessionId << " for data";
+                }
+                free(req.file.data);
+                req.file.data = 0;
+                rep.opcode = success? ClientOpcode::WRITE_SESSION_DATA_REP_SUCCESS : ClientOpcode::WRITE_SESSION_DATA_REP_FAIL;
+            }
+            break;
+
+        case COMMIT_WRITE_SESSION_REQ:
+            {
+                Proxy::WriteSession *session = self->takeWriteSession(req.sessionId);
+                if (session != NULL) {
+                    // the session is released on commit
+                    success = self->_proxy->commitWriteSession(session, myfile);
+                    rep.file.size = myfile.size;
+                } else {
+                    LOG(WARNING) << "Failed to find write session " << req.sessionId << " for commit";
+                }
+                rep.opcode = success? ClientOpcode::COMMIT_WRITE_SESSION_REP_SUCCESS : ClientOpcode::COMMIT_WRITE_SESSION_REP_FAIL;
+            }
+            break;
+
+        case ABORT_WRITE_SESSION_REQ:
+            {
+                Proxy::WriteSession *session = self->takeWriteSession(req.sessionId);
+                if (session != NULL) {
+                    self->_proxy->abortWriteSession(session);
+                    success = true;
+                }
+                rep.opcode = success? ClientOpcode::ABORT_WRITE_SESSION_REP_SUCCESS : ClientOpcode::ABORT_WRITE_SESSION_REP_FAIL;
+            }
+            break;
+
+        // read sessions only keep the read position, and run on the proxy of the interface such that the read-ahead follows the session across workers
+        case OPEN_READ_SESSION_REQ:
+            {
+                DLOG(INFO) << "Get an open read session request";
+                // name
+                myfile.nameLength = req.file.name.size();
+                myfile.name = (char *) malloc (myfile.nameLength + 1);
+                memcpy(myfile.name, req.file.name.c_str(), myfile.nameLength);
+                myfile.name[myfile.nameLength] = 0;
+                // namespace id
+                myfile.namespaceId = req.file.namespaceId;
+
+                ReadSession session;
+                // pin the session to the current file version
+                session.size = self->_proxy->getFileSize(myfile, /* copy metadata */ true);
+                if (session.size != INVALID_FILE_LENGTH) {
+                    session.stripeSize = self->_proxy->getExpectedReadSize(myfile);
+                    okay = session.stripeSize != INVALID_FILE_OFFSET && (session.stripeSize > 0 || session.size == 0);
+                } else {
+                    okay = false;
+                }
+                if (okay) {
+                    session.name = req.file.name;
+                    session.namespaceId = myfile.namespaceId;
+                    session.version = myfile.version;
+                    session.changeCount = myfile.changeCount;
+                    session.offset = 0;
+                    rep.sessionId = self->addReadSession(session);
+                    rep.file.size = session.size;
+                    rep.stripeSize = session.stripeSize;
+                } else {
+                    LOG(WARNING) << "Failed to open read session on file " << req.file.name;
+                }
+                rep.opcode = okay? ClientOpcode::OPEN_READ_SESSION_REP_SUCCESS : ClientOpcode::OPEN_READ_SESSION_REP_FAIL;
+            }
+            break;
+
+        case READ_SESSION_DATA_REQ:
+            {
+                ReadSession session;
+                if (self->takeReadSession(req.sessionId, session)) {
+                    rep.file.offset = session.offset;
+                    rep.file.size = 0;
+                    rep.stripeSize = session.stripeSize;
+                    if (session.offset >= session.size) {
+                        // end of file
+                        success = true;
+                    } else {
+                        // read (at most) as many stripes as the client asks for, bounded by the read window
+                        unsigned long int numStripes = std::min(req.numStripes, (unsigned int) Config::getInstance().getProxyReadWindow());
+                        myfile.nameLength = session.name.size();
+                        myfile.name = (char *) malloc (myfile.nameLength + 1);
+                        memcpy(myfile.name, session.name.c_str(), myfile.nameLength);
+                        myfile.name[myfile.nameLength] = 0;
+                        myfile.namespaceId = session.namespaceId;
+                        myfile.version = session.version;
+                        myfile.offset = session.offset;
+                        myfile.length = numStripes * session.stripeSize;
+                        success = self->_proxy->readPartialFile(myfile) && myfile.size > 0;
+                        // the version may be modified in place since the session is opened
+                        if (success && myfile.changeCount != session.changeCount) {
+                            LOG(WARNING) << "File " << session.name << " is modified since read session " << req.sessionId << " is opened";
+                            success = false;
+                        }
+                        if (success) {
+                            rep.file.size = std::min(myfile.size, session.size - session.offset);
+                            rep.file.data = myfile.data;
+                            session.offset += rep.file.size;
+                            traffic += rep.file.size;
+                        }
+                    }
+                    self->returnReadSession(req.sessionId, session);
+                } else {
+                    LOG(WARNING) << "Failed to find read session " << req.sessionId << " for data";
+                }
+                rep.opcode = success? ClientOpcode::READ_SESSION_DATA_REP_SUCCESS : ClientOpcode::READ_SESSION_DATA_REP_FAIL;
+            }
+            break;
+
+        case CLOSE_READ_SESSION_REQ:
+            {
+                ReadSession session;
+                success = self->takeReadSession(req.sessionId, session);
+                rep.opcode = success? ClientOpcode::CLOSE_READ_SESSION_REP_SUCCESS : ClientOpcode::CLOSE_READ_SESSION_REP_FAIL;
+            }
+            break;
 
         default:
             // unknown request ..
@@ -452,7 +711,8 @@ void *ProxyZMQIntegration::handleRequests(void *arg) {
         }
 
         try {
-            // send reply
+            // send reply, back to the client (and the request) identified by the envelope
+            sendEnvelope(socket, envelope);
             sendReply(socket, rep);
             DLOG(INFO) << "Reply to client, op = " << rep.opcode;
         } catch (zmq::error_t &e) {
@@ -470,6 +730,87 @@ void *ProxyZMQIntegration::handleRequests(void *arg) {
     return NULL;
 }
 
+unsigned long int ProxyZMQIntegration::addWriteSession(Proxy::WriteSession *session) {
+    std::lock_guard<std::mutex> lk(_writeSessionsLock);
+    unsigned long int id = _nextWriteSessionId++;
+    _writeSessions[id] = { session, time(NULL) };
+    return id;
+}
+
+Proxy::WriteSession *ProxyZMQIntegration::takeWriteSession(unsigned long int id) {
+    std::lock_guard<std::mutex> lk(_writeSessionsLock);
+    auto it = _writeSessions.find(id);
+    if (it == _writeSessions.end())
+        return NULL;
+    Proxy::WriteSession *session = it->second.session;
+    _writeSessions.erase(it);
+    return session;
+}
+
+void ProxyZMQIntegration::returnWriteSession(unsigned long int id, Proxy::WriteSession *session) {
+    std::lock_guard<std::mutex> lk(_writeSessionsLock);
+    _writeSessions[id] = { session, time(NULL) };
+}
+
+void ProxyZMQIntegration::abortIdleWriteSessions(bool all) {
+    std::vector<Proxy::WriteSession*> idle;
+    time_t deadline = time(NULL) - Config::getInstance().getProxyZmqWriteSessionTimeout();
+
+    // take the idle sessions out first, and abort them without holding the lock
+    _writeSessionsLock.lock();
+    for (auto it = _writeSessions.begin(); it != _writeSessions.end();) {
+        if (all || it->second.lastActive < deadline) {
+            LOG(WARNING) << "Abort idle write session " << it->first;
+            idle.push_back(it->second.session);
+            it = _writeSessions.erase(it);
+        } else {
+            it++;
+        }
+    }
+    _writeSessionsLock.unlock();
+
+    for (auto session : idle)
+        _proxy->abortWriteSession(session);
+}
+
+unsigned long int ProxyZMQIntegration::addReadSession(const ReadSession &session) {
+    std::lock_guard<std::mutex> lk(_readSessionsLock);
+    unsigned long int id = _nextReadSessionId++;
+    _readSessions[id] = session;
+    _readSessions[id].lastActive = time(NULL);
+    return id;
+}
+
+bool ProxyZMQIntegration::takeReadSession(unsigned long int id, ReadSession &session) {
+    std::lock_guard<std::mutex> lk(_readSessionsLock);
+    auto it = _readSessions.find(id);
+    if (it == _readSessions.end())
+        return false;
+    session = it->second;
+    _readSessions.erase(it);
+    return true;
+}
+
+void ProxyZMQIntegration::returnReadSession(unsigned long int id, ReadSession &session) {
+    std::lock_guard<std::mutex> lk(_readSessionsLock);
+    session.lastActive = time(NULL);
+    _readSessions[id] = session;
+}
+
+void ProxyZMQIntegration::closeIdleReadSessions() {
+    time_t deadline = time(NULL) - Config::getInstance().getProxyZmqReadSessionTimeout();
+
+    std::lock_guard<std::mutex> lk(_readSessionsLock);
+    for (auto it = _readSessions.begin(); it != _readSessions.end();) {
+        if (it->second.lastActive < deadline) {
+            LOG(WARNING) << "Close idle read session " << it->first;
+            it = _readSessions.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
 int ProxyZMQIntegration::getRequest(zmq::socket_t &socket, Request &req) {
     zmq::message_t msg;
 
@@ -481,6 +822,7 @@ int ProxyZMQIntegration::getRequest(zmq::socket_t &socket, Request &req) {
 
     // get op code
     getNextMsg();
+    if (msg.size() < sizeof(req.opcode)) return 1;
     req.opcode = *((int *) msg.data());
     DLOG(INFO) << "Opcode = " << req.opcode;
 
@@ -488,13 +830,65 @@ int ProxyZMQIntegration::getRequest(zmq::socket_t &socket, Request &req) {
         return 0;
 
     // get namespace id
+    if (!msg.more()) return 1;
     getNextMsg();
+    if (msg.size() < sizeof(req.file.namespaceId)) return 1;
     req.file.namespaceId = *((unsigned char *) msg.data());
     DLOG(INFO) << "Namespace Id = " << (int) req.file.namespaceId;
 
     if (hasNamespaceIdOnly(req.opcode))
         return 0;
 
+    if (hasSessionId(req.opcode)) {
+        // get session id
+        if (!msg.more()) return 1;
+        getNextMsg();
+        if (msg.size() != sizeof(req.sessionId)) return 1;
+        req.sessionId = *((unsigned long int *) msg.data());
+        DLOG(INFO) << "Session id = " << req.sessionId;
+        if (req.opcode == READ_SESSION_DATA_REQ) {
+            // get the max. number of stripes to read
+            if (!msg.more()) return 1;
+            getNextMsg();
+            if (msg.size() != sizeof(req.numStripes)) return 1;
+            req.numStripes = *((unsigned int *) msg.data());
+            DLOG(INFO) << "Num. of stripes = " << req.numStripes;
+            if (req.numStripes == 0) {
+                LOG(WARNING) << "Reject a request to read no stripes in read session " << req.sessionId;
+                return 1;
+            }
+            return 0;
+        }
+        if (req.opcode != WRITE_SESSION_DATA_REQ)
+            return 0;
+        // get data length
+        if (!msg.more()) return 1;
+        getNextMsg();
+        if (msg.size() != sizeof(req.file.size)) return 1;
+        req.file.size = *((unsigned long int *) msg.data());
+        DLOG(INFO) << "Size = " << req.file.size;
+        // get data, which is bounded by the max. segment size instead of the file size
+        if (req.file.size > Config::getInstance().getProxyZmqMaxSegmentSize()) {
+            LOG(WARNING) << "Reject data of size " << req.file.size << " above the max. segment size " << Config::getInstance().getProxyZmqMaxSegmentSize() << " in write session " << req.sessionId;
+            return 1;
+        }
+        unsigned long int rb = 0;
+        req.file.data = (unsigned char*) malloc (req.file.size + 1);
+        if (req.file.data == NULL) {
+            LOG(ERROR) << "Failed to allocate memory for data of size " << req.file.size << " in write session " << req.sessionId;
+            return 1;
+        }
+        while(rb < req.file.size) {
+            if (!msg.more()) return 1;
+            getNextMsg();
+            if (rb + msg.size() > req.file.size) return 1;
+            memcpy(req.file.data + rb, msg.data(), msg.size());
+            rb += msg.size();
+        }
+        DLOG(INFO) << "Data (" << rb << ")";
+        return 0;
+    }
+
     if (req.opcode == GET_APPEND_SIZE_REQ) {
         if (!msg.more()) return 1;
         getNextMsg();
@@ -511,8 +905,19 @@ int ProxyZMQIntegration::getRequest(zmq::socket_t &socket, Request &req) {
     req.file.name = std::string((char *) msg.data(), msg.size());
     DLOG(INFO) << "Name = " << req.file.name;
 
-    if (req.opcode == GET_READ_SIZE_REQ || req.opcode == GET_FILE_LIST_REQ)
+    if (req.opcode == GET_READ_SIZE_REQ || req.opcode == GET_FILE_LIST_REQ || req.opcode == OPEN_READ_SESSION_REQ)
         return 0;
+
+    if (req.opcode == OPEN_WRITE_SESSION_REQ) {
+        // get file storage class
+        if (!msg.more()) return 1;
+        getNextMsg();
+        req.file.storageClass = std::string((char *) msg.data(), msg.size());
+        DLOG(INFO) << "Storage class = " << req.file.storageClass;
+        if (req.file.storageClass.empty())
+            req.file.storageClass = Config::getInstance().getDefaultStorageClass();
+        return 0;
+    }
     
     if (hasFileSize(req.opcode)) {
         // get file size
@@ -693,6 +1098,56 @@ bool ProxyZMQIntegration::sendReply(zmq::socket_t &socket, Reply &rep) {
             LOG(ERROR) << "Failed to send append size on reply";
             return false;
         }
+    } else if (rep.opcode == OPEN_WRITE_SESSION_REP_SUCCESS) {
+        msgLength = sizeof(rep.sessionId);
+        if (socket.send(&rep.sessionId, msgLength, 0) != msgLength) {
+            LOG(ERROR) << "Failed to send write session id on reply";
+            return false;
+        }
+    } else if (rep.opcode == WRITE_SESSION_DATA_REP_SUCCESS || rep.opcode == COMMIT_WRITE_SESSION_REP_SUCCESS) {
+        msgLength = sizeof(rep.file.size);
+        if (socket.send(&rep.file.size, msgLength, 0) != msgLength) {
+            LOG(ERROR) << "Failed to send write session size on reply";
+            return false;
+        }
+    } else if (rep.opcode == OPEN_READ_SESSION_REP_SUCCESS) {
+        msgLength = sizeof(rep.sessionId);
+        if (socket.send(&rep.sessionId, msgLength, ZMQ_SNDMORE) != msgLength) {
+            LOG(ERROR) << "Failed to send read session id on reply";
+            return false;
+        }
+        msgLength = sizeof(rep.file.size);
+        if (socket.send(&rep.file.size, msgLength, ZMQ_SNDMORE) != msgLength) {
+            LOG(ERROR) << "Failed to send file size on reply";
+            return false;
+        }
+        msgLength = sizeof(rep.stripeSize);
+        if (socket.send(&rep.stripeSize, msgLength, 0) != msgLength) {
+            LOG(ERROR) << "Failed to send stripe size on reply";
+            return false;
+        }
+        DLOG(INFO) << "read session " << rep.sessionId << " file size = " << rep.file.size << " stripe size = " << rep.stripeSize;
+    } else if (rep.opcode == READ_SESSION_DATA_REP_SUCCESS) {
+        msgLength = sizeof(rep.file.offset);
+        if (socket.send(&rep.file.offset, msgLength, ZMQ_SNDMORE) != msgLength) {
+            LOG(ERROR) << "Failed to send file offset on reply";
+            return false;
+        }
+        // data size, zero at the end of file
+        msgLength = sizeof(rep.file.size);
+        if (socket.send(&rep.file.size, msgLength, rep.file.size > 0? ZMQ_SNDMORE : 0) != msgLength) {
+            LOG(ERROR) << "Failed to send data size on reply";
+            return false;
+        }
+        DLOG(INFO) << "read session data offset = " << rep.file.offset << " size = " << rep.file.size;
+        // one frame per stripe
+        for (unsigned long int sent = 0; sent < rep.file.size; sent += msgLength) {
+            msgLength = std::min(rep.stripeSize, rep.file.size - sent);
+            if (socket.send(rep.file.data + sent, msgLength, sent + msgLength < rep.file.size? ZMQ_SNDMORE : 0) != msgLength) {
+                LOG(ERROR) << "Failed to send stripe data at offset " << rep.file.offset + sent << " on reply";
+                return false;
+            }
+        }
     } else if (rep.opcode == APPEND_FILE_REP_SUCCESS || rep.opcode == OVERWRITE_FILE_REP_SUCCESS) {
         msgLength = sizeof(rep.file.size);
         if (socket.send(&rep.file.size, msgLength, 0) != msgLength) {
@@ -5,6 +5,11 @@
 
 #include <pthread.h>
 
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <zmq.hpp>
 
 #include "../../common/zmq_int_define.hh"
@@ -41,8 +46,120 @@ private:
     pthread_barrier_t _stopRunning;                        /**< barrier when the interface stops running */
     bool _isRunning;                                       /**< whether the interface is running */
 
+    struct WriteSessionEntry {
+        Proxy::WriteSession *session;                      /**< write session */
+        time_t lastActive;                                 /**< time of the last request on the session */
+    };
+
+    std::mutex _writeSessionsLock;                         /**< lock on the write sessions */
+    std::map<unsigned long int, WriteSessionEntry> _writeSessions; /**< write sessions not in use by any worker, by session id */
+    unsigned long int _nextWriteSessionId;                 /**< id of the next write session */
+
+    struct ReadSession {
+        std::string name;                                  /**< file name */
+        unsigned char namespaceId;                         /**< file namespace id */
+        int version;                                       /**< file version opened, which all reads of the session are pinned to */
+        unsigned long int changeCount;                     /**< number of modifications to the file version opened, reads fail once the version is modified */
+        unsigned long int size;                            /**< file size */
+        unsigned long int stripeSize;                      /**< size of data in each stripe, i.e., the alignment of reads */
+        unsigned long int offset;                          /**< offset of the next read */
+        time_t lastActive;                                 /**< time of the last request on the session */
+    };
+
+    std::mutex _readSessionsLock;                          /**< lock on the read sessions */
+    std::map<unsigned long int, ReadSession> _readSessions; /**< read sessions not in use by any worker, by session id */
+    unsigned long int _nextReadSessionId;                  /**< id of the next read session */
+
     bool stop();
 
+    /**
+     * Keep a write session opened for a client
+     *
+     * @param[in] session   write session opened
+     * @return id of the write session
+     **/
+    unsigned long int addWriteSession(Proxy::WriteSession *session);
+
+    /**
+     * Take a write session for handling a request, such that no other worker can use it until it is returned
+     *
+     * @param[in] id        id of the write session
+     * @return the write session, NULL if not found (or in use)
+     **/
+    Proxy::WriteSession *takeWriteSession(unsigned long int id);
+
+    /**
+     * Return a write session taken by ProxyZMQIntegration::takeWriteSession()
+     *
+     * @param[in] id        id of the write session
+     * @param[in] session   write session
+     **/
+    void returnWriteSession(unsigned long int id, Proxy::WriteSession *session);
+
+    /**
+     * Abort the write sessions idle for longer than the configured timeout
+     *
+     * @param[in] all       whether to abort all write sessions regardless of the idle time
+     **/
+    void abortIdleWriteSessions(bool all = false);
+
+    /**
+     * Keep a read session opened for a client
+     *
+     * @param[in] session   read session opened
+     * @return id of the read session
+     **/
+    unsigned long int addReadSession(const ReadSession &session);
+
+    /**
+     * Take a read session for handling a request, such that no other worker can use it until it is returned
+     *
+     * @param[in] id        id of the read session
+     * @param[out] session  read session
+     * @return whether the read session is found (and not in use)
+     **/
+    bool takeReadSession(unsigned long int id, ReadSession &session);
+
+    /**
+     * Return a read session taken by ProxyZMQIntegration::takeReadSession()
+     *
+     * @param[in] id        id of the read session
+     * @param[in] session   read session
+     **/
+    void returnReadSession(unsigned long int id, ReadSession &session);
+
+    /**
+     * Close the read sessions idle for longer than the configured timeout
+     **/
+    void closeIdleReadSessions();
+
+    /**
+     * Dispatch client requests to idle workers only, and replies back to clients
+     *
+     * Clients may keep many requests in flight over one connection (e.g., over a DEALER socket), so a request is never queued behind a busy worker
+     *
+     * @param[in] frontend  socket accepting client requests
+     * @param[in] backend   socket connected to workers
+     **/
+    static void dispatchRequests(zmq::socket_t &frontend, zmq::socket_t &backend);
+
+    /**
+     * Receive the routing envelope of a request, i.e., the frames before the empty delimiter, which identifies the client and the request (if tagged by the client)
+     *
+     * @param[in] socket    socket connected to the dispatcher
+     * @param[out] envelope frames of the routing envelope
+     * @return whether the empty delimiter is found before the end of message; if not, the envelope only keeps the client identity
+     **/
+    static bool getEnvelope(zmq::socket_t &socket, std::vector<zmq::message_t> &envelope);
+
+    /**
+     * Send the routing envelope of a request, followed by the empty delimiter, before the reply
+     *
+     * @param[in] socket    socket connected to the dispatcher
+     * @param[in] envelope  frames of the routing envelope
+     **/
+    static void sendEnvelope(zmq::socket_t &socket, std::vector<zmq::message_t> &envelope);
+
     /**
      * Worker procedure for handling requests
      *
@@ -127,6 +244,23 @@ private:
         );
     }
 
+    /**
+     * Tell whether the (write or read) session id is expected after the namespace id in the request
+     *
+     * @param[in] op         client operation code
+     * @return whether the write session id is expected
+     **/
+    static bool hasSessionId(int op) {
+        return (
+            op == ClientOpcode::WRITE_SESSION_DATA_REQ ||
+            op == ClientOpcode::COMMIT_WRITE_SESSION_REQ ||
+            op == ClientOpcode::ABORT_WRITE_SESSION_REQ ||
+            op == ClientOpcode::READ_SESSION_DATA_REQ ||
+            op == ClientOpcode::CLOSE_READ_SESSION_REQ ||
+            false
+        );
+    }
+
     /**
      * Tell whether the file offset is expected in the request
      *
@@ -162,6 +296,11 @@ private:
             op != GET_PROXY_STATUS_REP_SUCCESS &&
             op != GET_BG_TASK_PRG_REP_SUCCESS &&
             op != GET_REPAIR_STATS_REP_SUCCESS &&
+            op != OPEN_WRITE_SESSION_REP_SUCCESS &&
+            op != WRITE_SESSION_DATA_REP_SUCCESS &&
+            op != COMMIT_WRITE_SESSION_REP_SUCCESS &&
+            op != OPEN_READ_SESSION_REP_SUCCESS &&
+            op != READ_SESSION_DATA_REP_SUCCESS &&
             true
         ;
     }
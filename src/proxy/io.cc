@@ -1,26 +1,84 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+#include <set>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include <glog/logging.h>
 
 #include "io.hh"
 #include "../common/config.hh"
 #include "../common/util.hh"
 
-ProxyIO::ProxyIO(std::map<int, std::string> *containerToAgentMap) {
+ProxyIO::ProxyIO(std::map<int, std::string> *containerToAgentMap, int numIOThreads, int batchSize) {
     _cxt = zmq::context_t(Config::getInstance().getProxyNumZmqThread());
     _containerToAgentMap = containerToAgentMap;
+    _running = true;
+    _numConnections = Config::getInstance().getProxyNumChunkIOConnections();
+    _maxInflightPerConnection = Config::getInstance().getProxyChunkIODepth();
+    _maxBatchSize = batchSize < 0? Config::getInstance().getProxyChunkIOBatchSize() : std::max(batchSize, 1);
+    _nextWireId = 0;
+
+    // event-driven chunk I/O threads
+    if (numIOThreads < 0)
+        numIOThreads = Config::getInstance().getProxyNumChunkIOThreads();
+    for (int i = 0; i < numIOThreads; i++) {
+        Dispatcher *d = new Dispatcher();
+        d->io = this;
+        d->stopped = false;
+        d->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (d->eventFd == -1) {
+            LOG(ERROR) << "Failed to create event fd for chunk I/O thread " << i << ", " << strerror(errno);
+            delete d;
+            break;
+        }
+        if (pthread_create(&d->thread, NULL, runDispatcher, d) != 0) {
+            LOG(ERROR) << "Failed to create chunk I/O thread " << i;
+            close(d->eventFd);
+            delete d;
+            break;
+        }
+        _dispatchers.push_back(d);
+    }
+    LOG_IF(WARNING, numIOThreads > 0 && _dispatchers.empty()) << "Fall back to one thread per chunk request";
 }
 
 ProxyIO::~ProxyIO() {
     LOG(WARNING) << "Terminating Proxy IO";
-    for (auto it : _containerToSocketMap) {
-        it.second->close();
-        delete it.second;
+    // stop the chunk I/O threads, pending requests are failed on exit
+    _running = false;
+    for (auto d : _dispatchers) {
+        uint64_t signal = 1;
+        if (write(d->eventFd, &signal, sizeof(signal)) != sizeof(signal))
+            LOG(WARNING) << "Failed to notify chunk I/O thread to stop, " << strerror(errno);
+        pthread_join(d->thread, NULL);
+        close(d->eventFd);
+        delete d;
+    }
+    _dispatchers.clear();
+    for (int i = 0; i < PROXY_IO_NUM_SOCKET_POOL_SHARDS; i++) {
+        for (auto &agent : _socketPool[i].idle) {
+            for (auto socket : agent.second) {
+                socket->close();
+                delete socket;
+            }
+        }
+        _socketPool[i].idle.clear();
     }
     _cxt.close();
     LOG(WARNING) << "Terminated Proxy IO";
 }
 
+int ProxyIO::getNumIOThreads() const {
+    return _dispatchers.size();
+}
+
+int ProxyIO::getBatchSize() const {
+    return _dispatchers.empty()? 1 : _maxBatchSize;
+}
+
 void *ProxyIO::sendChunkRequestToAgent(void *arg) {
     RequestMeta &meta = *((RequestMeta*) arg);
 
@@ -42,21 +100,15 @@ void *ProxyIO::sendChunkRequestToAgent(void *arg) {
         meta.network->markStart();
     }
 
-    if (Config::getInstance().reuseDataConn()) {
-        meta.io->_lock.lock();
-        try {
-            ioMeta.socket = meta.io->_containerToSocketMap.at(meta.containerId);
-        } catch (std::exception &e) {
-            ioMeta.socket = new zmq::socket_t(meta.io->_cxt, ZMQ_REQ);
-            meta.io->_containerToSocketMap.insert(std::pair<int, zmq::socket_t*>(meta.containerId, ioMeta.socket));
-            Util::setSocketOptions(ioMeta.socket, PROXY_TO_AGENT);
-            int timeout = Config::getInstance().getFailureTimeout();
-            ioMeta.socket->setsockopt(ZMQ_SNDTIMEO, timeout);
-            ioMeta.socket->setsockopt(ZMQ_RCVTIMEO, timeout);
-            ioMeta.socket->setsockopt(ZMQ_LINGER, timeout);
-            ioMeta.socket->connect(ioMeta.address);
-        }
-        meta.io->_lock.unlock();
+    bool reuse = Config::getInstance().reuseDataConn();
+    if (reuse) {
+        ioMeta.socket = meta.io->acquireSocket(ioMeta.address);
+        if (ioMeta.socket == NULL) {
+            if (meta.network != NULL) {
+                meta.network->markEnd();
+            }
+            return (void *) -1;
+        }
     } else {
         ioMeta.cxt = &meta.io->_cxt;
     }
@@ -64,11 +116,630 @@ void *ProxyIO::sendChunkRequestToAgent(void *arg) {
     void *retVal = IO::sendChunkRequestToAgent((void*) &ioMeta);
     // return IO::sendChunkRequestToAgent((void*) &ioMeta);
 
+    // a REQ socket is out of the send-receive cycle after failures, so only reuse it after success
+    if (reuse) {
+        meta.io->releaseSocket(ioMeta.address, ioMeta.socket, retVal == NULL);
+    }
+
     // TAGPT (end): network
     if (meta.network != NULL) {
         meta.network->markEnd();
     }
-    
-    pthread_exit(retVal);
+
+    return retVal;
+}
+
+void ProxyIO::submitChunkRequest(RequestMeta *meta) {
+    ProxyIO *io = meta->io;
+
+    // one thread per request
+    if (io->_dispatchers.empty()) {
+        meta->result = std::async(std::launch::async, [meta]() {
+            void *ret = sendChunkRequestToAgent((void *) meta);
+            if (meta->notifier != NULL)
+                meta->notifier->notify(meta);
+            return ret;
+        });
+        return;
+    }
+
+    PendingRequest *req = new PendingRequest();
+    req->meta = meta;
+    meta->result = req->promise.get_future();
+
+    try {
+        req->address = io->_containerToAgentMap->at(meta->containerId);
+    } catch (std::exception &e) {
+        LOG(ERROR) << "Failed to find agent addresss, container id = " << meta->containerId;
+        completeRequest(req, (void *) -1);
+        return;
+    }
+
+    // TAGPT (start): network
+    if (meta->network != NULL) {
+        meta->network->markStart();
+    }
+
+    // spread the requests over the threads by event id
+    Dispatcher *d = io->_dispatchers.at(meta->request->id % io->_dispatchers.size());
+    d->lock.lock();
+    if (d->stopped) {
+        d->lock.unlock();
+        LOG(ERROR) << "Failed to submit chunk request to agent, container id = " << meta->containerId << ", Proxy IO is terminating";
+        completeRequest(req, (void *) -1);
+        return;
+    }
+    d->submitted.push_back(req);
+    d->lock.unlock();
+
+    // wake up the event loop
+    uint64_t signal = 1;
+    if (write(d->eventFd, &signal, sizeof(signal)) != sizeof(signal))
+        LOG(WARNING) << "Failed to notify chunk I/O thread on new request, " << strerror(errno);
+}
+
+void *ProxyIO::waitChunkRequest(RequestMeta *meta) {
+    if (!meta->result.valid()) {
+        LOG(ERROR) << "Failed to wait for a chunk request which is not submitted, container id = " << meta->containerId;
+        return (void *) -1;
+    }
+    return meta->result.get();
 }
 
+void *ProxyIO::runDispatcher(void *arg) {
+    Dispatcher *d = (Dispatcher *) arg;
+    ProxyIO *io = d->io;
+
+    std::vector<zmq::pollitem_t> items;
+    std::vector<zmq::socket_t*> polled;
+    std::deque<PendingRequest*> submitted;
+
+    while (io->_running) {
+        // watch for new requests, and replies on sockets with requests in flight
+        items.clear();
+        polled.clear();
+        items.push_back({ NULL, d->eventFd, ZMQ_POLLIN, 0 });
+        long timeout = -1;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        auto updateTimeout = [&timeout, &now](const std::chrono::steady_clock::time_point &deadline) {
+            long left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+            if (left < 0)
+                left = 0;
+            if (timeout == -1 || left < timeout)
+                timeout = left;
+        };
+        for (auto &s : d->inflight) {
+            if (s.second.empty())
+                continue;
+            items.push_back({ (void *) *s.first, 0, ZMQ_POLLIN, 0 });
+            polled.push_back(s.first);
+            // wake up no later than the nearest deadline
+            for (auto &r : s.second)
+                updateTimeout(r.second->deadline);
+        }
+        for (auto &a : d->agents) {
+            if (a.second.waiting.empty())
+                continue;
+            updateTimeout(a.second.waiting.front()->deadline);
+            // wake up to reconnect the failed connections for the waiting requests
+            for (size_t i = 0; i < a.second.sockets.size(); i++) {
+                if (a.second.sockets.at(i) == 0)
+                    updateTimeout(a.second.retryAt.at(i));
+            }
+        }
+
+        try {
+            zmq::poll(items.data(), items.size(), timeout);
+        } catch (zmq::error_t &e) {
+            if (e.num() == ETERM)
+                break;
+            LOG(WARNING) << "Failed to poll for chunk requests and replies, " << e.what();
+            continue;
+        }
+
+        // send new requests
+        if (items[0].revents & ZMQ_POLLIN) {
+            uint64_t count = 0;
+            if (read(d->eventFd, &count, sizeof(count)) != sizeof(count) && errno != EAGAIN)
+                LOG(WARNING) << "Failed to clear chunk I/O thread notification, " << strerror(errno);
+            d->lock.lock();
+            submitted.swap(d->submitted);
+            d->lock.unlock();
+            for (auto req : submitted)
+                dispatchRequest(d, req);
+            submitted.clear();
+        }
+
+        // dispatch replies
+        for (size_t i = 0; i < polled.size(); i++) {
+            if (items[i + 1].revents & ZMQ_POLLIN)
+                collectReplies(d, polled.at(i));
+        }
+
+        // notify the requesters once ZeroMQ releases the chunk data sent
+        for (auto it = d->releasing.begin(); it != d->releasing.end(); ) {
+            PendingRequest *req = *it;
+            if (!req->tracker.done()) {
+                it++;
+                continue;
+            }
+            completeRequest(req, req->result);
+            it = d->releasing.erase(it);
+        }
+
+        // fail requests without a reply in time
+        now = std::chrono::steady_clock::now();
+        std::set<zmq::socket_t*> stalled;
+        for (auto &s : d->inflight) {
+            for (auto it = s.second.begin(); it != s.second.end(); ) {
+                PendingRequest *req = it->second;
+                if (req->deadline > now) {
+                    it++;
+                    continue;
+                }
+                LOG(ERROR) << "Failed to get a chunk event reply over socket at " << req->address << " before timeout, event id = " << it->first;
+                req->agent->numInflight.at(req->connection)--;
+                // chunk data still queued on the connection is only released when the connection closes
+                if (!req->tracker.done())
+                    stalled.insert(s.first);
+                completeSentRequest(d, req, (void *) -2);
+                it = s.second.erase(it);
+            }
+        }
+        for (auto &a : d->agents) {
+            for (size_t i = 0; i < a.second.sockets.size() && !stalled.empty(); i++) {
+                if (stalled.erase(a.second.sockets.at(i)) > 0)
+                    resetConnection(d, &a.second, i, a.first);
+            }
+        }
+        for (auto &a : d->agents) {
+            std::deque<PendingRequest*> &waiting = a.second.waiting;
+            while (!waiting.empty() && waiting.front()->deadline <= now) {
+                LOG(ERROR) << "Failed to send chunk event to " << a.first << " before timeout, none of the " << a.second.sockets.size() << " connections is connected with free slots";
+                completeRequest(waiting.front(), (void *) -2);
+                waiting.pop_front();
+            }
+            sendWaitingRequests(d, &a.second);
+        }
+    }
+
+    // stop accepting requests and fail the pending ones
+    d->lock.lock();
+    d->stopped = true;
+    submitted.swap(d->submitted);
+    d->lock.unlock();
+    for (auto req : submitted)
+        completeRequest(req, (void *) -1);
+    for (auto &s : d->inflight) {
+        for (auto &r : s.second)
+            completeSentRequest(d, r.second, (void *) -1);
+    }
+    d->inflight.clear();
+    for (auto &a : d->agents) {
+        for (auto req : a.second.waiting)
+            completeRequest(req, (void *) -1);
+        for (auto socket : a.second.sockets) {
+            if (socket == 0)
+                continue;
+            socket->close();
+            delete socket;
+        }
+    }
+    d->agents.clear();
+    // chunk data queued on the closed sockets is dropped and released
+    for (auto req : d->releasing) {
+        req->tracker.wait();
+        completeRequest(req, req->result);
+    }
+    d->releasing.clear();
+
+    return NULL;
+}
+
+bool ProxyIO::dispatchRequest(Dispatcher *d, PendingRequest *req) {
+    ProxyIO *io = d->io;
+
+    req->deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(Config::getInstance().getFailureTimeout());
+    req->tracker.notifyFd = d->eventFd;
+
+    // connect to the agent on first request, and leave the failed connections to reconnect later
+    auto ait = d->agents.find(req->address);
+    if (ait == d->agents.end()) {
+        AgentConnections &agent = d->agents[req->address];
+        agent.address = req->address;
+        agent.sockets.resize(io->_numConnections, 0);
+        agent.numInflight.resize(io->_numConnections, 0);
+        agent.retryAt.resize(io->_numConnections, std::chrono::steady_clock::time_point::min());
+        agent.numRetries.resize(io->_numConnections, 0);
+        ait = d->agents.find(req->address);
+    }
+    req->agent = &ait->second;
+    reconnectAgent(d, req->agent);
+
+    // fail fast instead of waiting for the retries if the agent cannot be connected at all
+    if (std::count(req->agent->sockets.begin(), req->agent->sockets.end(), (zmq::socket_t *) 0) == (long) req->agent->sockets.size()) {
+        LOG(ERROR) << "Failed to send chunk event to " << req->address << ", no connection to the agent";
+        completeRequest(req, (void *) -1);
+        return false;
+    }
+
+    // keep the order of requests to the agent, and queue all newly submitted requests for batching before sending any
+    if (!req->agent->waiting.empty() || io->_maxBatchSize > 1) {
+        req->agent->waiting.push_back(req);
+        return true;
+    }
+
+    int connection = findFreeConnection(req->agent, io->_maxInflightPerConnection);
+    if (connection == -1) {
+        DLOG(INFO) << "Queue chunk event to " << req->address << ", event id = " << req->meta->request->id << ", all connections are full";
+        req->agent->waiting.push_back(req);
+        return true;
+    }
+
+    return sendRequest(d, req, connection);
+}
+
+bool ProxyIO::sendRequest(Dispatcher *d, PendingRequest *req, int connection) {
+    RequestMeta *meta = req->meta;
+    AgentConnections *agent = req->agent;
+    std::string address = req->address;
+    zmq::socket_t *socket = agent->sockets.at(connection);
+    bool partial = false;
+
+    // send the waiting requests of the same operation along, if any
+    if (d->io->_maxBatchSize > 1)
+        batchRequests(req, d->io->_maxBatchSize);
+    const ChunkEvent &request = req->batch != NULL? *req->batch : *meta->request;
+
+    // match the reply by an id of our own, since the callers (e.g., chunk managers sharing the ProxyIO) number their events independently
+    req->wireId = d->io->_nextWireId.fetch_add(1);
+
+    try {
+        std::map<unsigned int, PendingRequest*> &inflight = d->inflight[socket];
+        if (inflight.count(req->wireId) > 0) {
+            LOG(ERROR) << "Failed to send chunk event to " << req->address << ", event id = " << req->wireId << " is already in flight";
+            completeRequest(req, (void *) -1);
+            return false;
+        }
+
+        if ((socket->getsockopt<int>(ZMQ_EVENTS) & ZMQ_POLLOUT) == 0) {
+            LOG(ERROR) << "Failed to send chunk event over socket at " << req->address << ", too many pending requests";
+            completeRequest(req, (void *) -1);
+            return false;
+        }
+
+        // empty delimiter as sent by a REQ socket, followed by the chunk event
+        zmq::message_t delimiter;
+        if (!socket->send(delimiter, ZMQ_SNDMORE)) {
+            LOG(ERROR) << "Failed to send chunk event over socket at " << req->address;
+            completeRequest(req, (void *) -1);
+            return false;
+        }
+        partial = true;
+        if (IO::sendChunkEventMessage(*socket, request, &req->tracker, &req->wireId) == 0) {
+            LOG(ERROR) << "Failed to send chunk event over socket at " << req->address;
+            completeSentRequest(d, req, (void *) -1);
+            // drop the incomplete message
+            resetConnection(d, agent, connection, address);
+            return false;
+        }
+
+        req->connection = connection;
+        req->agent->numInflight.at(connection)++;
+        inflight.insert(std::make_pair(req->wireId, req));
+    } catch (zmq::error_t &e) {
+        LOG(ERROR) << "Failed to connect agent to send the chunk request opcode = " << request.opcode << ", " << e.what();
+        if (partial) {
+            completeSentRequest(d, req, (void *) -1);
+            resetConnection(d, agent, connection, address);
+        } else {
+            completeRequest(req, (void *) -1);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+static bool isBatchable(const ChunkEvent *request, unsigned short opcode) {
+    return request->opcode == opcode
+            && (opcode == Opcode::PUT_CHUNK_REQ || opcode == Opcode::GET_CHUNK_REQ)
+            && request->numChunks == 1
+            && request->chunks != NULL
+            && request->containerIds != NULL;
+}
+
+void ProxyIO::batchRequests(PendingRequest *req, int maxBatchSize) {
+    const ChunkEvent *first = req->meta->request;
+    std::deque<PendingRequest*> &waiting = req->agent->waiting;
+
+    if (req->batch != NULL || !isBatchable(first, first->opcode))
+        return;
+
+    // take the consecutive requests of the same operation to keep the order of requests to the agent
+    while (!waiting.empty() && req->batched.size() + 1 < (size_t) maxBatchSize && isBatchable(waiting.front()->meta->request, first->opcode)) {
+        req->batched.push_back(waiting.front());
+        waiting.pop_front();
+    }
+    if (req->batched.empty())
+        return;
+
+    // the batched request refers to the chunk data of the requests without copying
+    int numChunks = req->batched.size() + 1;
+    ChunkEvent *batch = new ChunkEvent();
+    batch->id = first->id;
+    batch->opcode = first->opcode == Opcode::PUT_CHUNK_REQ? Opcode::PUT_CHUNK_BATCH_REQ : Opcode::GET_CHUNK_BATCH_REQ;
+    batch->numChunks = numChunks;
+    batch->containerIds = new int[numChunks];
+    batch->chunks = new Chunk[numChunks];
+    batch->p2a = first->p2a;
+    for (int i = 0; i < numChunks; i++) {
+        const ChunkEvent *request = i == 0? first : req->batched.at(i - 1)->meta->request;
+        batch->containerIds[i] = request->containerIds[0];
+        batch->chunks[i] = request->chunks[0];
+        batch->chunks[i].freeData = false;
+    }
+    req->batch = batch;
+
+    DLOG(INFO) << "Batch " << numChunks << " chunk requests to " << req->address << ", event id = " << batch->id;
+}
+
+bool ProxyIO::splitBatchReply(PendingRequest *req, ChunkEvent &reply) {
+    bool isPut = req->batch->opcode == Opcode::PUT_CHUNK_BATCH_REQ;
+    int numChunks = req->batch->numChunks;
+
+    if (reply.opcode != (isPut? Opcode::PUT_CHUNK_BATCH_REP : Opcode::GET_CHUNK_BATCH_REP) || reply.numChunks != numChunks || reply.chunkStatus == NULL) {
+        LOG(ERROR) << "Failed to match the batched chunk event reply from " << req->address << ", opcode = " << reply.opcode << ", number of chunks = " << reply.numChunks << " (expect " << numChunks << ")";
+        return false;
+    }
+
+    for (int i = 0; i < numChunks; i++) {
+        RequestMeta *meta = i == 0? req->meta : req->batched.at(i - 1)->meta;
+        ChunkEvent *out = meta->reply;
+        bool success = reply.chunkStatus[i];
+        out->id = meta->request->id;
+        if (isPut)
+            out->opcode = success? Opcode::PUT_CHUNK_REP_SUCCESS : Opcode::PUT_CHUNK_REP_FAIL;
+        else
+            out->opcode = success? Opcode::GET_CHUNK_REP_SUCCESS : Opcode::GET_CHUNK_REP_FAIL;
+        out->p2a = reply.p2a;
+        out->agentProcess = reply.agentProcess;
+        out->a2p = reply.a2p;
+        // failure replies carry no chunk
+        if (!success)
+            continue;
+        out->numChunks = 1;
+        out->containerIds = new int[1];
+        out->containerIds[0] = reply.containerIds[i];
+        out->chunks = new Chunk[1];
+        out->chunks[0].move(reply.chunks[i]);
+    }
+
+    return true;
+}
+
+void ProxyIO::sendWaitingRequests(Dispatcher *d, AgentConnections *agent) {
+    if (!agent->waiting.empty())
+        reconnectAgent(d, agent);
+    while (!agent->waiting.empty()) {
+        int connection = findFreeConnection(agent, d->io->_maxInflightPerConnection);
+        if (connection == -1)
+            break;
+        PendingRequest *req = agent->waiting.front();
+        agent->waiting.pop_front();
+        sendRequest(d, req, connection);
+    }
+}
+
+int ProxyIO::findFreeConnection(const AgentConnections *agent, int maxInflight) {
+    int connection = -1;
+    for (size_t i = 0; i < agent->sockets.size(); i++) {
+        // skip connections which failed to reconnect (and wait for a retry)
+        if (agent->sockets.at(i) == 0)
+            continue;
+        if (maxInflight > 0 && agent->numInflight.at(i) >= maxInflight)
+            continue;
+        if (connection == -1 || agent->numInflight.at(i) < agent->numInflight.at(connection))
+            connection = i;
+    }
+    return connection;
+}
+
+void ProxyIO::reconnectAgent(Dispatcher *d, AgentConnections *agent) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < agent->sockets.size(); i++) {
+        if (agent->sockets.at(i) != 0)
+            continue;
+        if (agent->retryAt.at(i) > now)
+            continue;
+        agent->sockets.at(i) = d->io->connectAgent(agent->address);
+        if (agent->sockets.at(i) != 0) {
+            agent->numRetries.at(i) = 0;
+            continue;
+        }
+        // double the wait on every consecutive failure, up to a limit
+        int shift = std::min(agent->numRetries.at(i)++, 16);
+        long backoff = std::min((long) PROXY_IO_RECONNECT_MIN_BACKOFF_MS << shift, (long) PROXY_IO_RECONNECT_MAX_BACKOFF_MS);
+        agent->retryAt.at(i) = now + std::chrono::milliseconds(backoff);
+        LOG(WARNING) << "Failed to reconnect connection " << i << " to agent at " << agent->address << ", retry in " << backoff << "ms";
+    }
+}
+
+void ProxyIO::collectReplies(Dispatcher *d, zmq::socket_t *socket) {
+    std::map<unsigned int, PendingRequest*> &inflight = d->inflight[socket];
+    AgentConnections *agent = 0;
+
+    try {
+        while (socket->getsockopt<int>(ZMQ_EVENTS) & ZMQ_POLLIN) {
+            zmq::message_t delimiter;
+            ChunkEvent reply;
+            unsigned long received = 0;
+
+            if (!socket->recv(&delimiter))
+                break;
+            if (delimiter.more())
+                received = IO::getChunkEventMessage(*socket, reply);
+            // drop the remains of a malformed reply
+            while (socket->getsockopt<int>(ZMQ_RCVMORE)) {
+                zmq::message_t remains;
+                socket->recv(&remains);
+            }
+            if (!delimiter.more()) {
+                LOG(WARNING) << "Drop an empty chunk event reply over socket";
+                continue;
+            }
+
+            auto it = inflight.find(reply.id);
+            if (it == inflight.end()) {
+                LOG(WARNING) << "Drop the chunk event reply with no pending request (possibly timed out), event id = " << reply.id;
+                continue;
+            }
+            PendingRequest *req = it->second;
+            inflight.erase(it);
+            agent = req->agent;
+            agent->numInflight.at(req->connection)--;
+
+            if (received == 0) {
+                LOG(ERROR) << "Failed to get a chunk event reply over socket at " << req->address;
+                completeSentRequest(d, req, (void *) -2);
+                continue;
+            }
+
+            if (req->batch != NULL) {
+                // hand over the reply of each chunk (and its buffers) to its requester
+                if (!splitBatchReply(req, reply)) {
+                    completeSentRequest(d, req, (void *) -2);
+                    continue;
+                }
+            } else {
+                // hand over the reply (and its buffers) to the requester, with the id of its request
+                *req->meta->reply = reply;
+                req->meta->reply->id = req->meta->request->id;
+                reply.reset();
+                reply.codingMeta.reset();
+            }
+            completeSentRequest(d, req, NULL);
+        }
+    } catch (zmq::error_t &e) {
+        LOG(ERROR) << "Failed to get chunk event replies over socket, " << e.what();
+    }
+
+    // use the freed slots for requests waiting on the agent
+    if (agent != 0)
+        sendWaitingRequests(d, agent);
+}
+
+void ProxyIO::completeRequest(PendingRequest *req, void *ret) {
+    // requests sent along in a batched request share its result
+    for (auto member : req->batched)
+        completeRequest(member, ret);
+    delete req->batch;
+    // TAGPT (end): network
+    if (req->meta->network != NULL) {
+        req->meta->network->markEnd();
+    }
+    // notify before setting the result, after which the request may be gone
+    if (req->meta->notifier != NULL) {
+        req->meta->notifier->notify(req->meta);
+    }
+    req->promise.set_value(ret);
+    delete req;
+}
+
+void ProxyIO::completeSentRequest(Dispatcher *d, PendingRequest *req, void *ret) {
+    // the requester may free the chunk data once notified
+    if (!req->tracker.done()) {
+        req->result = ret;
+        d->releasing.push_back(req);
+        return;
+    }
+    completeRequest(req, ret);
+}
+
+void ProxyIO::resetConnection(Dispatcher *d, AgentConnections *agent, int connection, const std::string &address) {
+    zmq::socket_t *socket = agent->sockets.at(connection);
+
+    LOG(WARNING) << "Reset connection " << connection << " to agent at " << address;
+
+    // replies to the requests in flight can no longer be received
+    auto it = d->inflight.find(socket);
+    if (it != d->inflight.end()) {
+        for (auto &r : it->second)
+            completeSentRequest(d, r.second, (void *) -2);
+        d->inflight.erase(it);
+    }
+    agent->numInflight.at(connection) = 0;
+
+    socket->close();
+    delete socket;
+    agent->sockets.at(connection) = 0;
+    agent->retryAt.at(connection) = std::chrono::steady_clock::time_point::min();
+    reconnectAgent(d, agent);
+}
+
+zmq::socket_t *ProxyIO::connectAgent(const std::string &address) {
+    zmq::socket_t *socket = 0;
+    try {
+        socket = new zmq::socket_t(_cxt, ZMQ_DEALER);
+        Util::setSocketOptions(socket, PROXY_TO_AGENT);
+        // never block the event loop, and drop queued messages on close
+        socket->setsockopt(ZMQ_SNDTIMEO, 0);
+        socket->setsockopt(ZMQ_LINGER, 0);
+        socket->connect(address);
+    } catch (zmq::error_t &e) {
+        LOG(ERROR) << "Failed to connect agent at " << address << ", " << e.what();
+        if (socket != 0) {
+            socket->close();
+            delete socket;
+        }
+        return NULL;
+    }
+    return socket;
+}
+
+zmq::socket_t *ProxyIO::acquireSocket(const std::string &address) {
+    SocketPoolShard &shard = _socketPool[std::hash<std::string>()(address) % PROXY_IO_NUM_SOCKET_POOL_SHARDS];
+
+    // take an idle socket
+    shard.lock.lock();
+    auto it = shard.idle.find(address);
+    if (it != shard.idle.end() && !it->second.empty()) {
+        zmq::socket_t *socket = it->second.back();
+        it->second.pop_back();
+        shard.lock.unlock();
+        return socket;
+    }
+    shard.lock.unlock();
+
+    // or connect a new one
+    zmq::socket_t *socket = 0;
+    try {
+        socket = new zmq::socket_t(_cxt, ZMQ_REQ);
+        Util::setSocketOptions(socket, PROXY_TO_AGENT);
+        int timeout = Config::getInstance().getFailureTimeout();
+        socket->setsockopt(ZMQ_SNDTIMEO, timeout);
+        socket->setsockopt(ZMQ_RCVTIMEO, timeout);
+        socket->setsockopt(ZMQ_LINGER, timeout);
+        socket->connect(address);
+    } catch (zmq::error_t &e) {
+        LOG(ERROR) << "Failed to connect agent at " << address << ", " << e.what();
+        if (socket != 0) {
+            socket->close();
+            delete socket;
+        }
+        return NULL;
+    }
+    return socket;
+}
+
+void ProxyIO::releaseSocket(const std::string &address, zmq::socket_t *socket, bool reuse) {
+    if (!reuse) {
+        socket->close();
+        delete socket;
+        return;
+    }
+    SocketPoolShard &shard = _socketPool[std::hash<std::string>()(address) % PROXY_IO_NUM_SOCKET_POOL_SHARDS];
+    std::lock_guard<std::mutex> lk (shard.lock);
+    shard.idle[address].push_back(socket);
+}
@@ -3,32 +3,56 @@
 #ifndef __PROXY_IO_HH__
 #define __PROXY_IO_HH__
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <string>
 #include <map>
 #include <mutex>
+#include <vector>
 
 #include <zmq.hpp>
 
 #include "../common/io.hh"
 #include "../ds/chunk_event.hh"
 
+#define PROXY_IO_NUM_SOCKET_POOL_SHARDS (16)
+#define PROXY_IO_RECONNECT_MIN_BACKOFF_MS (100)
+#define PROXY_IO_RECONNECT_MAX_BACKOFF_MS (10000)
+
 class ProxyIO {
 public:
-    ProxyIO(std::map<int, std::string> *containerToAgentMap);
+    /**
+     * Constructor
+     *
+     * @param containerToAgentMap    container id to agent address mapping
+     * @param numIOThreads           number of event-driven threads for chunk requests, 0 to use one thread per request, -1 to follow the configuration
+     * @param batchSize              max. number of chunks of queued requests to send in one request by the event-driven threads, 1 to disable batching, -1 to follow the configuration
+     **/
+    ProxyIO(std::map<int, std::string> *containerToAgentMap, int numIOThreads = -1, int batchSize = -1);
     ~ProxyIO();
 
+    struct CompletionNotifier;
+
     struct RequestMeta {
         int containerId;
         ProxyIO *io;
         ChunkEvent *request;
         ChunkEvent *reply;
         TagPt *network;
+        std::future<void *> result;     /**< result of a submitted request */
+        CompletionNotifier *notifier;   /**< optional notification on completion of a submitted request */
 
         RequestMeta() {
             reset();
         }
 
         ~RequestMeta() {
+            // never leave a submitted request behind
+            if (result.valid())
+                result.wait();
             reset();
         }
 
@@ -38,9 +62,47 @@ public:
             request = 0;
             reply = 0;
             network = 0;
+            notifier = 0;
         }
     } ;
 
+    /**
+     * Notification on the completion of any request in a group of submitted requests
+     *
+     * A request is notified right before its result is set, so the notifier must remain valid until the results of all requests in the group are ready
+     **/
+    struct CompletionNotifier {
+        std::mutex lock;                        /**< lock on the completed requests */
+        std::condition_variable cv;             /**< condition for new completed requests */
+        std::deque<RequestMeta*> completed;     /**< completed requests not yet taken */
+
+        /**
+         * Notify the completion of a request
+         *
+         * @param meta   request completed
+         **/
+        void notify(RequestMeta *meta) {
+            std::lock_guard<std::mutex> lk(lock);
+            completed.push_back(meta);
+            cv.notify_one();
+        }
+
+        /**
+         * Take a completed request, in the order of completion
+         *
+         * @param deadline   time to give up waiting
+         * @return the completed request, NULL if no request completes before the deadline
+         **/
+        RequestMeta *wait(std::chrono::steady_clock::time_point deadline) {
+            std::unique_lock<std::mutex> lk(lock);
+            if (!cv.wait_until(lk, deadline, [this] { return !completed.empty(); }))
+                return NULL;
+            RequestMeta *meta = completed.front();
+            completed.pop_front();
+            return meta;
+        }
+    };
+
     /**
      * Send a chunk event request to agent (and get the reply)
      *
@@ -49,10 +111,218 @@ public:
      **/
     static void *sendChunkRequestToAgent(void *arg);
 
+    /**
+     * Submit a chunk event request to agent without waiting for the reply
+     *
+     * @param meta   pointer to a ProxyIO::RequestMeta structure, which must remain valid until waitChunkRequest() returns
+     **/
+    static void submitChunkRequest(RequestMeta *meta);
+
+    /**
+     * Wait for the reply of a submitted chunk event request
+     *
+     * @param meta   pointer to a ProxyIO::RequestMeta structure submitted via submitChunkRequest()
+     * @return whether the operation is successful, NULL if sucessful, non-NULL otherwise
+     **/
+    static void *waitChunkRequest(RequestMeta *meta);
+
+    /**
+     * Get the number of event-driven threads for chunk requests
+     *
+     * @return number of threads, 0 if one thread is spawned per request
+     **/
+    int getNumIOThreads() const;
+
+    /**
+     * Get the max. number of chunks of queued requests to send in one request
+     *
+     * @return max. number of chunks, 1 if batching is disabled
+     **/
+    int getBatchSize() const;
+
 private:
+    struct AgentConnections;
+
+    struct PendingRequest {
+        RequestMeta *meta;                                      /**< request metadata */
+        unsigned int wireId;                                    /**< event id sent to the agent, unique among requests of the ProxyIO */
+        std::string address;                                    /**< agent address */
+        std::promise<void *> promise;                           /**< result of the request */
+        std::chrono::steady_clock::time_point deadline;         /**< time to give up waiting for the reply */
+        AgentConnections *agent;                                /**< connections to the agent */
+        int connection;                                         /**< index of the connection which the request is sent over */
+        IO::ZeroCopyTracker tracker;                            /**< chunk data sent without copying */
+        void *result;                                           /**< result of a completed request waiting for its chunk data to be released */
+        std::vector<PendingRequest*> batched;                   /**< other requests sent along in the batched request, completed together with this request */
+        ChunkEvent *batch;                                      /**< batched request sent on behalf of this and the other requests, NULL if sent alone */
+    };
+
+    struct AgentConnections {
+        std::string address;                                    /**< agent address */
+        std::vector<zmq::socket_t*> sockets;                    /**< connections to the agent, NULL if failed to connect */
+        std::vector<int> numInflight;                           /**< number of requests in flight over each connection */
+        std::vector<std::chrono::steady_clock::time_point> retryAt; /**< earliest time to reconnect each failed connection */
+        std::vector<int> numRetries;                            /**< number of consecutive failures to reconnect each connection */
+        std::deque<PendingRequest*> waiting;                    /**< requests waiting for a connection with free slots */
+    };
+
+    struct Dispatcher {
+        ProxyIO *io;                                            /**< parent */
+        pthread_t thread;                                       /**< event loop thread */
+        int eventFd;                                            /**< fd to wake up the event loop */
+        bool stopped;                                           /**< whether the event loop has stopped accepting requests */
+        std::mutex lock;                                        /**< lock on the submission queue */
+        std::deque<PendingRequest*> submitted;                  /**< submitted requests not yet sent */
+        std::map<std::string, AgentConnections> agents;         /**< agent address to connections mapping */
+        std::map<zmq::socket_t*, std::map<unsigned int, PendingRequest*> > inflight; /**< requests sent over each socket, keyed by the event id sent */
+        std::vector<PendingRequest*> releasing;                 /**< completed requests with chunk data not yet released by ZeroMQ */
+    };
+
+    struct SocketPoolShard {
+        std::mutex lock;                                        /**< lock on the shard */
+        std::map<std::string, std::vector<zmq::socket_t*> > idle; /**< agent address to idle sockets mapping */
+    };
+
+    /**
+     * Event loop for sending requests and dispatching replies
+     *
+     * @param arg    pointer to a ProxyIO::Dispatcher structure
+     * @return NULL
+     **/
+    static void *runDispatcher(void *arg);
+
+    /**
+     * Send a submitted request to its agent, or queue it if all connections to the agent are full
+     *
+     * @param d      dispatcher which owns the sockets
+     * @param req    request to send
+     * @return whether the request is sent or queued
+     **/
+    static bool dispatchRequest(Dispatcher *d, PendingRequest *req);
+
+    /**
+     * Send a request over a connection to its agent
+     *
+     * @param d          dispatcher which owns the sockets
+     * @param req        request to send
+     * @param connection index of the connection in the agent connections
+     * @return whether the request is sent
+     **/
+    static bool sendRequest(Dispatcher *d, PendingRequest *req, int connection);
+
+    /**
+     * Merge the put or get chunk requests waiting at the front of the agent queue into one batched request with the given request
+     *
+     * @param req    request to send, which holds the merged requests and the batched request on return
+     * @param maxBatchSize max. number of chunks in the batched request
+     **/
+    static void batchRequests(PendingRequest *req, int maxBatchSize);
+
+    /**
+     * Hand over the status and chunk of each request in a batched reply to its requester
+     *
+     * @param req    request which the batched request is sent on behalf of
+     * @param reply  batched reply, with the chunks moved out on return
+     * @return whether the reply matches the batched request
+     **/
+    static bool splitBatchReply(PendingRequest *req, ChunkEvent &reply);
+
+    /**
+     * Send the waiting requests of an agent over connections with free slots
+     *
+     * @param d      dispatcher which owns the sockets
+     * @param agent  connections to the agent
+     **/
+    static void sendWaitingRequests(Dispatcher *d, AgentConnections *agent);
+
+    /**
+     * Find the least loaded connection to an agent with free slots
+     *
+     * @param agent       connections to the agent
+     * @param maxInflight max. number of requests in flight per connection, 0 for no limit
+     * @return index of the connection, -1 if all connections are full
+     **/
+    static int findFreeConnection(const AgentConnections *agent, int maxInflight);
+
+    /**
+     * Reconnect the failed connections to an agent which are due for a retry, and back off the retries of those which fail again
+     *
+     * @param d      dispatcher which owns the sockets
+     * @param agent  connections to the agent
+     **/
+    static void reconnectAgent(Dispatcher *d, AgentConnections *agent);
+
+    /**
+     * Receive all available replies on a socket and complete the matching requests
+     *
+     * @param d      dispatcher which owns the socket
+     * @param socket socket with replies to receive
+     **/
+    static void collectReplies(Dispatcher *d, zmq::socket_t *socket);
+
+    /**
+     * Complete a request and notify the waiting caller
+     *
+     * @param req    request to complete
+     * @param ret    result of the request, NULL if sucessful, non-NULL otherwise
+     **/
+    static void completeRequest(PendingRequest *req, void *ret);
+
+    /**
+     * Complete a sent request once ZeroMQ releases its chunk data, which the caller may free right after the notification
+     *
+     * @param d      dispatcher which owns the sockets
+     * @param req    request to complete
+     * @param ret    result of the request, NULL if sucessful, non-NULL otherwise
+     **/
+    static void completeSentRequest(Dispatcher *d, PendingRequest *req, void *ret);
+
+    /**
+     * Replace a connection to an agent with a new one, and fail the requests in flight over the old one
+     *
+     * The chunk data queued on the old connection is dropped (and released) on close. If the new connection fails, it is retried on later requests to the agent
+     *
+     * @param d          dispatcher which owns the sockets
+     * @param agent      connections to the agent
+     * @param connection index of the connection in the agent connections
+     * @param address    agent address
+     **/
+    static void resetConnection(Dispatcher *d, AgentConnections *agent, int connection, const std::string &address);
+
+    /**
+     * Connect a DEALER socket to an agent for the event-driven dispatchers
+     *
+     * @param address agent address
+     * @return the socket, NULL if failed
+     **/
+    zmq::socket_t *connectAgent(const std::string &address);
+
+    /**
+     * Take an idle REQ socket connected to an agent, or create one if there is none
+     *
+     * @param address agent address
+     * @return the socket
+     **/
+    zmq::socket_t *acquireSocket(const std::string &address);
+
+    /**
+     * Return a REQ socket for reuse, or close it if it cannot be reused
+     *
+     * @param address agent address
+     * @param socket  the socket
+     * @param reuse   whether the socket can be reused, i.e., the last request completed normally
+     **/
+    void releaseSocket(const std::string &address, zmq::socket_t *socket, bool reuse);
+
     std::map<int, std::string> *_containerToAgentMap;           /**< container id to agent address mapping */
-    std::map<int, zmq::socket_t*> _containerToSocketMap;        /**< container id to socket mapping */
-    std::mutex _lock;
+    SocketPoolShard _socketPool[PROXY_IO_NUM_SOCKET_POOL_SHARDS]; /**< idle REQ sockets for reuse, sharded by agent address */
+
+    std::vector<Dispatcher*> _dispatchers;                      /**< event-driven dispatchers for chunk requests */
+    std::atomic<bool> _running;                                 /**< whether the dispatchers should keep running */
+    int _numConnections;                                        /**< number of connections to each agent per dispatcher */
+    int _maxInflightPerConnection;                              /**< max. number of requests in flight per connection, 0 for no limit */
+    int _maxBatchSize;                                          /**< max. number of chunks in a batched request, 1 to disable batching */
+    std::atomic<unsigned int> _nextWireId;                      /**< event id to send with the next request, as ids of requests from different callers may collide */
 
     zmq::context_t _cxt;                                        /**< zeromq context */
 
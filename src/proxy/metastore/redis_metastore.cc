@@ -248,6 +248,7 @@ bool RedisMetaStore::putMeta(const File &f) {
             " sg_size %b sg_sc %s sg_cs %b sg_n %b sg_k %b sg_f %b sg_maxCS %b sg_mtime %b"
             " dm %d"
             " numUB %b numDB %b"
+            " chg %b"
         , filename, (size_t) nameLength
 
         , f.name, (size_t) f.nameLength
@@ -286,12 +287,17 @@ bool RedisMetaStore::putMeta(const File &f) {
 
         , &numUniqueBlocks, (size_t) sizeof(size_t)
         , &numDuplicateBlocks, (size_t) sizeof(size_t)
+
+        , &f.changeCount, (size_t) sizeof(f.changeCount)
     );
 
     // container ids
     char cname[MAX_KEY_SIZE];
+    unsigned char checksum[CHUNK_CHECKSUM_FIELD_LEN];
     for (int i = 0; i < f.numChunks; i++) {
         genChunkKeyPrefix(f.chunks[i].getChunkId(), cname);
+        // the checksum type follows the checksum, except for md5 as in old records
+        int checksumLength = f.chunks[i].packChecksum(checksum);
         redisAppendCommand(
             _cxt
             , "HMSET %b %s-cid %b %s-size %b %s-md5 %b %s-bad %d"
@@ -301,7 +307,7 @@ bool RedisMetaStore::putMeta(const File &f) {
             , cname
             , &f.chunks[i].size, (size_t) sizeof(int)
             , cname
-            , f.chunks[i].md5, MD5_DIGEST_LENGTH
+            , checksum, (size_t) checksumLength
             , cname
             , (f.chunksCorrupted? f.chunksCorrupted[i] : 0)
         );
@@ -421,7 +427,7 @@ bool RedisMetaStore::getMeta(File &f, int getBlocks) {
         " codingStateS codingState ver ctime atime"
         " mtime tctime md5 sg_size sg_sc"
         " sg_cs sg_n sg_k sg_f sg_maxCS"
-        " sg_mtime dm numUB numDB"
+        " sg_mtime dm numUB numDB chg"
         , filename, (size_t) nameLength
     );
 
@@ -533,6 +539,8 @@ bool RedisMetaStore::getMeta(File &f, int getBlocks) {
     // blocks under deduplication
     check_and_copy_or_set_field(&numUniqueBlocks, 27, sizeof(size_t), 0);
     check_and_copy_or_set_field(&numDuplicateBlocks, 28, sizeof(size_t), 0);
+    // modifications of the version
+    check_and_copy_or_set_field(&f.changeCount, 29, sizeof(f.changeCount), 0);
 
     freeReplyObject(r);
     r = 0;
@@ -578,7 +586,8 @@ bool RedisMetaStore::getMeta(File &f, int getBlocks) {
 
         check_and_copy_field(&f.containerIds[i], 0, sizeof(int));
         check_and_copy_field(&f.chunks[i].size, 1, sizeof(int));
-        check_and_copy_or_set_field(f.chunks[i].md5, 2, MD5_DIGEST_LENGTH, 0);
+        if (r->elements <= 2 || r->element[2]->type != REDIS_REPLY_STRING || !f.chunks[i].unpackChecksum((unsigned char *) r->element[2]->str, r->element[2]->len))
+            f.chunks[i].resetChecksum();
         f.chunksCorrupted[i] = r->elements <= 3? false : (bool) atoi(r->element[3]->str);
         f.chunks[i].setId(f.namespaceId, f.uuid, i);
         f.chunks[i].data = 0;
@@ -1958,6 +1967,8 @@ bool RedisMetaStore::addChunkToJournal(const File &file, const Chunk &chunk, int
     if (skipAdding) return true;
 
     // second, set the latest record
+    unsigned char checksum[CHUNK_CHECKSUM_FIELD_LEN];
+    int checksumLength = chunk.packChecksum(checksum);
     std::string script = 
          "local e2 = redis.call('HMSET', KEYS[1], ARGV[1], ARGV[2], ARGV[3], ARGV[4], ARGV[5], ARGV[6], ARGV[7], ARGV[8]); \
          if e2['ok'] == 'OK' then \
@@ -1974,7 +1985,7 @@ bool RedisMetaStore::addChunkToJournal(const File &file, const Chunk &chunk, int
         , cname, containerId
         , &chunk.size, sizeof(int)
         , cname, containerId
-        , chunk.md5, (size_t) MD5_DIGEST_LENGTH
+        , checksum, (size_t) checksumLength
         , cname, containerId
         , opType
         , cname, containerId
@@ -2117,7 +2128,7 @@ void RedisMetaStore::getFileJournal(const FileInfo &file, std::vector<std::tuple
             if (listIndexIt != chunk2listIndex.end()) {
                 auto &record = records.at(listIndexIt->second);
                 if (type.compare("md5") == 0) {
-                    memcpy(std::get<0>(record).md5, r->element[i]->str, MD5_DIGEST_LENGTH);
+                    std::get<0>(record).unpackChecksum((unsigned char *) r->element[i]->str, r->element[i]->len);
                 } else if (type.compare("size") == 0) {
                     memcpy(&std::get<0>(record).size, r->element[i]->str, sizeof(int));
                 } else if (type.compare("status") == 0) { // whether the record is pre-operation
@@ -74,6 +74,7 @@ Proxy::Proxy(ProxyCoordinator *coordinator, std::map<int, std::string> *map, BgC
 
     // auto file recovery
     _ongoingRepairCnt = 0;
+    _readAheadClock = 0;
     if (enableAutoRepair)
         pthread_create(&_rt, NULL, Proxy::backgroundRepair, this);
 
@@ -114,6 +115,11 @@ Proxy::~Proxy() {
 
     LOG(WARNING) << "Terminating Proxy ...";
 
+    // wait for and drop the stripes read ahead
+    for (auto it = _readAheadStreams.begin(); it != _readAheadStreams.end(); it++)
+        delete it->second;
+    _readAheadStreams.clear();
+
     // release chunk manager and chunk-related handler
     delete _chunkManager;
     if (Config::getInstance().autoFileRecovery())
@@ -519,7 +525,7 @@ bool Proxy::batchedChunkScan(const FileInfo *list, const int numFiles, const int
 
 int Proxy::checkCorruptedChunks(bool *chunksCorrupted, int numChunks, bool *chunkIndicator) {
     int numCorruptedChunks = 0;
-    for (int i = 0; i < numChunks; i++) {
+    for (int i = 0; chunksCorrupted != NULL && i < numChunks; i++) {
         // chunk already failed, not marking as corrupted
         if (!chunkIndicator[i])
             continue;
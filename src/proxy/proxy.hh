@@ -4,6 +4,7 @@
 #define __PROXY_HH__
 
 #include <atomic>
+#include <mutex>
 #include <string>
 #include <map>
 #include <vector>
@@ -23,6 +24,7 @@
 #include "immutable/immutable_manager.hh"
 #include "interfaces/immutable_management_apis.hh"
 
+#define PROXY_MAX_READ_AHEAD_STREAMS (64)
 
 class Proxy {
 public:
@@ -44,6 +46,56 @@ public:
      **/
     virtual bool writeFile(File &f);
 
+    struct WriteSession;
+
+    /**
+     * Open a session to write a file with data arriving in segments, without buffering the whole file
+     *
+     * The file remains locked until the session is committed or aborted
+     *
+     * @param[in] f file to write, containing the name, namespace id, and storage class
+     *
+     * @return the session, NULL if failed
+     **/
+    virtual WriteSession *openWriteSession(File &f);
+
+    /**
+     * Append data to the file of a write session, where each stripe is encoded and written to backend as soon as its data is complete
+     *
+     * @param[in] session   session opened by Proxy::openWriteSession()
+     * @param[in] data      data to append
+     * @param[in] length    length of the data
+     *
+     * @return whether the data is accepted; the session can only be aborted after a failure
+     **/
+    virtual bool writeSessionData(WriteSession *session, const unsigned char *data, unsigned long int length);
+
+    /**
+     * Write the remaining data and the metadata of the file of a write session, and release the session
+     *
+     * @param[in] session   session opened by Proxy::openWriteSession()
+     * @param[out] f        file written, with the size and md5 checksum set upon success
+     *
+     * @return whether the file is written; the session is released in either case
+     **/
+    virtual bool commitWriteSession(WriteSession *session, File &f);
+
+    /**
+     * Remove the data written in a write session, and release the session
+     *
+     * @param[in] session   session opened by Proxy::openWriteSession()
+     **/
+    virtual void abortWriteSession(WriteSession *session);
+
+    /**
+     * Get the number of bytes accepted by a write session
+     *
+     * @param[in] session   session opened by Proxy::openWriteSession()
+     *
+     * @return number of bytes accepted
+     **/
+    unsigned long int getWriteSessionSize(const WriteSession *session) const;
+
     /**
      * Overwrite part of an existing file in the backend data store
      * @see getExpectedAppendSize()
@@ -314,6 +366,68 @@ protected:
         }
     };
 
+    // read
+    /**
+     * A stripe read issued by Proxy::startStripeRead()
+     **/
+    struct StripeRead {
+        int stripeId;                           /**< stripe id in file */
+        File file;                              /**< stripe metadata (owned copy), and data decoded */
+        bool *chunkIndicator;                   /**< chunk liveness */
+        bool inPlace;                           /**< whether the stripe is decoded directly into the destination buffer */
+        bool submitted;                         /**< whether the chunk requests are issued */
+        ChunkManager::StripeRead chunks;        /**< chunk requests in flight, which decode into the stripe data only on completion */
+
+        StripeRead() {
+            stripeId = -1;
+            chunkIndicator = 0;
+            inPlace = false;
+            submitted = false;
+        }
+
+        ~StripeRead() {
+            // the destination buffer belongs to the reader
+            if (inPlace)
+                file.data = 0;
+            delete [] chunkIndicator;
+        }
+
+        StripeRead(const StripeRead&) = delete;
+        StripeRead &operator=(const StripeRead&) = delete;
+    };
+
+    /**
+     * Stripes read ahead for a sequential stream of ranged reads on a file
+     **/
+    struct ReadAheadStream {
+        int version;                            /**< file version read */
+        time_t mtime;                           /**< file modification time read */
+        unsigned long int changeCount;          /**< number of modifications to the file version read */
+        unsigned long int nextOffset;           /**< offset expected for the next sequential read */
+        int numStripes;                         /**< number of stripes to read ahead */
+        unsigned long int lastUse;              /**< logical time of the last read, for eviction */
+        std::map<int, StripeRead*> stripes;     /**< stripes read ahead, by stripe id */
+
+        ReadAheadStream() {
+            version = -1;
+            mtime = 0;
+            changeCount = 0;
+            nextOffset = INVALID_FILE_OFFSET;
+            numStripes = 0;
+            lastUse = 0;
+        }
+
+        ~ReadAheadStream() {
+            dropStripes();
+        }
+
+        void dropStripes() {
+            for (auto it = stripes.begin(); it != stripes.end(); it++)
+                delete it->second;
+            stripes.clear();
+        }
+    };
+
     /*************************************/
     /* [Internal] File Operation Helpers */
     /*************************************/
@@ -331,9 +445,84 @@ protected:
      **/
     bool writeFileStripes(File &f, File &wf, int spareContainers[], int numSelected );
 
+    /**
+     * Encode the stripe buffered in a write session and issue its chunk requests, and wait for the oldest stripes in flight beyond the pipeline depth
+     *
+     * @param[in,out] session            write session with a non-empty stripe buffered
+     *
+     * @return whether the stripe and the stripes waited are written successfully
+     **/
+    bool submitSessionStripe(WriteSession *session);
+
+    /**
+     * Wait for the oldest stripe in flight of a write session, and keep its chunk metadata in the session
+     *
+     * @param[in,out] session            write session with stripes in flight
+     *
+     * @return whether the stripe is written successfully
+     **/
+    bool completeSessionStripe(WriteSession *session);
+
+    /**
+     * Wait for the stripes in flight of a write session, remove the stripes written, unlock the file, and release the session
+     *
+     * @param[in] session                write session to release
+     **/
+    void discardWriteSession(WriteSession *session);
+
     bool copyFileStripeMeta(File &dst, File &src, int stripeId, const char *op);
     void unsetCopyFileStripeMeta(File &copy);
 
+    /**
+     * Issue the read of a file stripe without waiting for it to complete
+     *
+     * @param[in] rf                     file containing the stripe to read, the stripe metadata is copied
+     * @param[in] stripeId               id of the stripe to read
+     * @param[in] dst                    destination buffer of the stripe data, NULL to read into a buffer of the stripe read
+     * @param[in] bmStripeId             stripe id for benchmark, -1 to exclude the read from benchmark
+     *
+     * @return the stripe read, NULL if failed to issue the read
+     **/
+    StripeRead *startStripeRead(File &rf, int stripeId, unsigned char *dst, int bmStripeId);
+
+    /**
+     * Wait for a stripe read to complete, and copy the data to the destination buffer if not read directly into it
+     *
+     * @param[in] read                   stripe read issued by Proxy::startStripeRead()
+     * @param[in] dst                    destination buffer of the stripe data
+     * @param[in,out] bytesRead          number of bytes read, incremented by the stripe size on success
+     *
+     * @return whether the stripe is successfully read
+     **/
+    bool finishStripeRead(StripeRead *read, unsigned char *dst, unsigned long int &bytesRead);
+
+    /**
+     * Take the read-ahead stream of a file for a ranged read, and adapt the number of stripes to read ahead to the read pattern
+     *
+     * @param[in] f                      file to read, with the range to read
+     * @param[in] rf                     file metadata
+     *
+     * @return the read-ahead stream, NULL if read-ahead is disabled
+     **/
+    ReadAheadStream *acquireReadAheadStream(const File &f, const File &rf);
+
+    /**
+     * Return a read-ahead stream taken by Proxy::acquireReadAheadStream() after reading ahead the stripes following a ranged read
+     *
+     * @param[in] f                      file read
+     * @param[in] rf                     file metadata
+     * @param[in] stream                 read-ahead stream
+     * @param[in] nextStripe             id of the stripe following the range read
+     **/
+    void releaseReadAheadStream(const File &f, File &rf, ReadAheadStream *stream, int nextStripe);
+
+    /**
+     * Drop the stripes read ahead for a file
+     *
+     * @param[in] f                      file modified or deleted
+     **/
+    void dropReadAheadStream(const File &f);
+
     /**
      * Modify file via overwrite / append
      *
@@ -344,6 +533,19 @@ protected:
      **/
     bool modifyFile(File &f, bool isAppend);
 
+    /**
+     * Overwrite a small range of data within a stripe in place, by rewriting only the affected data chunks and updating the code chunks with the data changes
+     *
+     * @param[in,out] of     file to overwrite, with its metadata obtained; chunk metadata is updated on success
+     * @param[in] offset     offset of the range in the file
+     * @param[in] length     length of the range
+     * @param[in] data       new data of the range
+     * @param[out] oldData   buffer of the range length for the data overwritten, NULL if not needed; overwriting the range with it reverts the overwrite
+     *
+     * @return whether the range is overwritten in place; the caller should fall back to rewriting the stripes otherwise
+     **/
+    bool overwriteFileInPlace(File &of, unsigned long int offset, unsigned long int length, const unsigned char *data, unsigned char *oldData = NULL);
+
     virtual unsigned long int getExpectedAppendSize(int codingScheme, int n, int k, int maxChunkSize);
 
     // file locking
@@ -460,6 +662,11 @@ protected:
     bool _releaseDedupModule;                                     /**< whether to release deduplication module */
     std::atomic<int> _ongoingRepairCnt;                           /**< number of on-going repair task */
 
+    // read-ahead
+    std::mutex _readAheadLock;                                    /**< lock on the read-ahead streams */
+    std::map<std::string, ReadAheadStream*> _readAheadStreams;    /**< read-ahead streams not in use, by namespace id and file name */
+    unsigned long int _readAheadClock;                            /**< logical time of read-ahead stream use */
+
     // staging
     bool _stagingEnabled;                                         /**< staging enabled */
     Staging *_staging;                                            /**< staging module */
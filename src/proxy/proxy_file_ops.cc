@@ -1,5 +1,9 @@
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+#include <deque>
+#include <sys/resource.h> // getrusage()
+
 #include "proxy.hh"
 
 #include "../common/config.hh"
@@ -23,6 +27,9 @@ bool Proxy::writeFile(File &f) {
     if (f.storageClass.empty())
         f.storageClass = Config::getInstance().getDefaultStorageClass();
 
+    // stripes read ahead for the old file are outdated
+    dropReadAheadStream(f);
+
     // check for immutability
     if (_immutableManager->isImmutable(f) || _immutableManager->isOnModificationHold(f) || _immutableManager->isOnAccessHold(f)) {
         LOG(ERROR) << "Failed to proceed with a write operations on file " << wf.name << " due to immutable policies";
@@ -57,6 +64,8 @@ bool Proxy::writeFile(File &f) {
     time_t now = time(NULL);
     if (_metastore->getMeta(of)) {
         wf.setTimeStamps(of.ctime, now, now);
+        // tell reads of the old file (which may have the same version and modification time) from the new one
+        wf.changeCount = of.changeCount + 1;
         // delete old file chunks only when (i) system is configured to overwrite file data, and (ii) there is no chunk reference, i.e., either deduplication is disabled or the old file has no unique chunk
         deleteOldFile = Config::getInstance().overwriteFiles();
         DLOG(INFO) << "Increment version of file " << f.name << " from " << of.version << " to " << wf.version;
@@ -149,6 +158,9 @@ bool Proxy::writeFile(File &f) {
     }
     putMeta.stop();
 
+    // drop the stripes read ahead for the old file by reads during the write
+    dropReadAheadStream(f);
+
     commitfp.start();
     // commit all fingerprints
     size_t numCommits = wf.commitIds.size();
@@ -204,6 +216,462 @@ bool Proxy::writeFile(File &f) {
     return true;
 }
 
+struct Proxy::WriteSession {
+    struct StripeInFlight {
+        File swf;                                   /**< stripe to write */
+        unsigned char *stripebuf;                   /**< buffer holding the stripe data */
+        ChunkManager::StripeWrite write;            /**< chunk requests of the stripe */
+    };
+
+    File wf;                                        /**< file to write */
+    File of;                                        /**< existing version of the file */
+    bool deleteOldFile;                             /**< whether to delete the chunks of the existing version after commit */
+    int *spareContainers;                           /**< containers selected for the stripe to write */
+    int numSelected;                                /**< number of containers selected */
+    int numChunksPerStripe;                         /**< number of chunks per stripe */
+    unsigned long int maxDataStripeSize;            /**< max. size of data per stripe */
+    unsigned long int stripebufSize;                /**< size of a stripe buffer, including space for coding-specific data */
+    unsigned char *stripebuf;                       /**< buffer of the stripe to fill */
+    unsigned long int numBuffered;                  /**< number of bytes in the stripe buffer */
+    unsigned long int size;                         /**< number of bytes accepted */
+    int numStripes;                                 /**< number of stripes submitted */
+    bool failed;                                    /**< whether any stripe failed to write */
+    std::deque<StripeInFlight*> inflight;           /**< stripes in flight, in the order of submission */
+    std::vector<unsigned char*> idleStripebufs;     /**< stripe buffers not in use */
+    std::vector<int> containerIds;                  /**< container ids of the chunks of the stripes written */
+    std::deque<Chunk> chunks;                       /**< metadata of the chunks of the stripes written */
+    std::vector<std::vector<unsigned char> > codingStates; /**< coding state of each stripe written */
+    bool hasCodingParameters;                       /**< whether the coding parameters of the file are taken from a stripe written */
+    MD5Calculator md5;                              /**< checksum of the data accepted */
+    TagPt overallT;                                 /**< time since the session is opened */
+    boost::timer::cpu_timer sinceOpen;              /**< time since the session is opened */
+    boost::timer::cpu_timer dataWrite;              /**< time spent on writing stripes */
+    double firstStripeStored;                       /**< time (in ms) from open until the chunks of the first stripe are stored, -1 if none yet */
+
+    WriteSession() {
+        deleteOldFile = false;
+        spareContainers = 0;
+        numSelected = 0;
+        numChunksPerStripe = 0;
+        maxDataStripeSize = 0;
+        stripebufSize = 0;
+        stripebuf = 0;
+        numBuffered = 0;
+        size = 0;
+        numStripes = 0;
+        failed = false;
+        hasCodingParameters = false;
+        firstStripeStored = -1;
+        overallT.markStart();
+        dataWrite.stop();
+    }
+
+    ~WriteSession() {
+        free(stripebuf);
+        for (auto buf : idleStripebufs)
+            free(buf);
+        delete [] spareContainers;
+    }
+};
+
+Proxy::WriteSession *Proxy::openWriteSession(File &f) {
+    if (f.namespaceId == INVALID_NAMESPACE_ID)
+        f.namespaceId = DEFAULT_NAMESPACE_ID;
+    if (f.storageClass.empty())
+        f.storageClass = Config::getInstance().getDefaultStorageClass();
+
+    // the size is unknown until commit
+    f.size = 0;
+    f.offset = 0;
+    f.length = 0;
+
+    // stripes read ahead for the old file are outdated
+    dropReadAheadStream(f);
+
+    // check for immutability
+    if (_immutableManager->isImmutable(f) || _immutableManager->isOnModificationHold(f) || _immutableManager->isOnAccessHold(f)) {
+        LOG(ERROR) << "Failed to proceed with a write operations on file " << f.name << " due to immutable policies";
+        return NULL;
+    }
+
+    WriteSession *session = new WriteSession();
+    File &wf = session->wf;
+    File &of = session->of;
+
+    if (prepareWrite(f, wf, session->spareContainers, session->numSelected, /* needsFindSpareContainers */ false) == false) {
+        delete session;
+        return NULL;
+    }
+    wf.storageClass = f.storageClass;
+
+    // size the stripe buffers and spare containers by the storage class, instead of the (unknown) file size
+    CodingMeta &cmeta = wf.codingMeta;
+    int numContainers = _chunkManager->getNumRequiredContainers(cmeta.coding, cmeta.n, cmeta.k);
+    int numChunksPerContainer = _chunkManager->getNumChunksPerContainer(cmeta.coding, cmeta.n, cmeta.k);
+    session->maxDataStripeSize = _chunkManager->getMaxDataSizePerStripe(cmeta.coding, cmeta.n, cmeta.k, cmeta.maxChunkSize);
+    if (numContainers <= 0 || numChunksPerContainer <= 0 || session->maxDataStripeSize == INVALID_FILE_OFFSET || session->maxDataStripeSize == 0) {
+        LOG(ERROR) << "Failed to find the stripe size of file " << f.name << " for " << cmeta.print();
+        delete session;
+        return NULL;
+    }
+    delete [] session->spareContainers;
+    session->spareContainers = new int[numContainers];
+    session->numChunksPerStripe = numContainers * numChunksPerContainer;
+    session->stripebufSize = _chunkManager->getDataStripeSize(cmeta.coding, cmeta.n, cmeta.k, session->maxDataStripeSize);
+    session->stripebuf = (unsigned char *) calloc (session->stripebufSize, 1);
+    if (session->stripebuf == NULL) {
+        LOG(ERROR) << "Failed to allocate a stripe buffer for file " << f.name;
+        delete session;
+        return NULL;
+    }
+
+    // lock file for write
+    if (lockFile(wf) == false) {
+        LOG(ERROR) << "Failed to lock file " << wf.name << " before write";
+        delete session;
+        return NULL;
+    }
+
+    // increment version number, and update timestamps
+    of.copyName(wf);
+    time_t now = time(NULL);
+    if (_metastore->getMeta(of)) {
+        wf.setTimeStamps(of.ctime, now, now);
+        // tell reads of the old file (which may have the same version and modification time) from the new one
+        wf.changeCount = of.changeCount + 1;
+        session->deleteOldFile = Config::getInstance().overwriteFiles();
+    } else {
+        wf.setTimeStamps(now, now, now);
+    }
+    wf.version = of.version + 1;
+
+    DLOG(INFO) << "Open write session on file " << wf.name << " with version " << wf.version << ", stripe size = " << session->maxDataStripeSize;
+
+    return session;
+}
+
+bool Proxy::writeSessionData(WriteSession *session, const unsigned char *data, unsigned long int length) {
+    if (session == NULL || session->failed)
+        return false;
+
+    // fill the stripe buffer, and write the stripe once it is full
+    while (length > 0) {
+        unsigned long int copyLength = std::min(length, session->maxDataStripeSize - session->numBuffered);
+        memcpy(session->stripebuf + session->numBuffered, data, copyLength);
+        session->md5.appendData(data, copyLength);
+        session->numBuffered += copyLength;
+        session->size += copyLength;
+        data += copyLength;
+        length -= copyLength;
+        if (session->numBuffered == session->maxDataStripeSize && !submitSessionStripe(session)) {
+            session->failed = true;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Proxy::commitWriteSession(WriteSession *session, File &f) {
+    if (session == NULL)
+        return false;
+
+    boost::timer::cpu_timer putMeta;
+    putMeta.stop();
+
+    File &wf = session->wf;
+    File &of = session->of;
+
+    // write the last stripe and wait for all stripes in flight
+    if (!session->failed && session->numBuffered > 0 && !submitSessionStripe(session)) {
+        session->failed = true;
+    }
+    while (!session->inflight.empty()) {
+        session->failed = !completeSessionStripe(session) || session->failed;
+    }
+    if (session->failed) {
+        LOG(ERROR) << "Failed to write file " << wf.name << " in write session";
+        discardWriteSession(session);
+        return false;
+    }
+
+    // collect the chunk metadata of all stripes
+    wf.offset = 0;
+    wf.size = session->size;
+    wf.length = session->size;
+    wf.numStripes = session->numStripes;
+    wf.numChunks = session->containerIds.size();
+    if (!wf.initChunksAndContainerIds()) {
+        LOG(ERROR) << "Failed to allocate the chunk metadata of file " << wf.name;
+        discardWriteSession(session);
+        return false;
+    }
+    for (int i = 0; i < wf.numChunks; i++) {
+        wf.containerIds[i] = session->containerIds.at(i);
+        wf.chunks[i].copyMeta(session->chunks.at(i));
+    }
+    // coding state of all stripes, in slots of the same size
+    size_t stripeCodingStateSize = 0;
+    for (auto &state : session->codingStates)
+        stripeCodingStateSize = std::max(stripeCodingStateSize, state.size());
+    if (stripeCodingStateSize > 0) {
+        wf.codingMeta.codingStateSize = stripeCodingStateSize * session->numStripes;
+        wf.codingMeta.codingState = new unsigned char [wf.codingMeta.codingStateSize];
+        memset(wf.codingMeta.codingState, 0, wf.codingMeta.codingStateSize);
+        for (size_t i = 0; i < session->codingStates.size(); i++) {
+            std::vector<unsigned char> &state = session->codingStates.at(i);
+            if (!state.empty())
+                memcpy(wf.codingMeta.codingState + i * stripeCodingStateSize, state.data(), state.size());
+        }
+    }
+
+    // md5 checksum
+    unsigned int md5len = MD5_DIGEST_LENGTH;
+    session->md5.finalize(wf.md5, md5len);
+
+    putMeta.resume();
+    // update metadata
+    if (_metastore->putMeta(wf) == false) {
+        LOG(ERROR) << "Failed to update file metadata of file " << wf.name;
+        putMeta.stop();
+        discardWriteSession(session);
+        return false;
+    }
+    putMeta.stop();
+
+    // drop the stripes read ahead for the old file by reads during the write session
+    dropReadAheadStream(wf);
+
+    // commit all fingerprints
+    size_t numCommits = wf.commitIds.size();
+    for (size_t i = 0; i < numCommits; i++) {
+        _dedup->commit(wf.commitIds.at(i));
+    }
+
+    // remove the old data from backend
+    if (session->deleteOldFile && of.numChunks > 0) {
+        bool chunkIndices[of.numChunks];
+        _coordinator->checkContainerLiveness(of.containerIds, of.numChunks, chunkIndices);
+        if (_chunkManager->deleteFile(of, chunkIndices) == false) {
+            LOG(WARNING) << "Failed to delete file " << wf.name << " from backend";
+        }
+    }
+
+    unlockFile(wf);
+
+    // return the size and checksum of the file written
+    f.size = wf.size;
+    f.length = wf.size;
+    f.uuid = wf.uuid;
+    memcpy(f.md5, wf.md5, MD5_DIGEST_LENGTH);
+
+    session->overallT.markEnd();
+
+    // peak memory usage of the proxy, which includes the stripes buffered and in flight rather than the whole file
+    struct rusage usage;
+    double peakRSS = getrusage(RUSAGE_SELF, &usage) == 0? usage.ru_maxrss * 1.0 / (1 << 10) : -1;
+
+    // record the operation
+    boost::timer::cpu_times duration = session->dataWrite.elapsed();
+    std::map<std::string, double> stats = genStatsMap(duration, putMeta.elapsed(), wf.size);
+    stats["first stripe stored (ms)"] = session->firstStripeStored;
+    stats["peak RSS (MB)"] = peakRSS;
+    _statsSaver.saveStatsRecord(stats, "write session (cloud)", std::string(wf.name, wf.nameLength), session->overallT.getStart().sec(), session->overallT.getEnd().sec());
+
+    LOG(INFO) << "Write file " << wf.name << " in session, " << (wf.size * 1.0 / (1 << 20)) << "MB in " << session->numStripes << " stripes"
+            << ", (first-stripe-stored) = " << session->firstStripeStored << " ms"
+            << ", (data-write) = " << duration.wall * 1.0 / 1e6 << " ms"
+            << ", (session) = " << session->sinceOpen.elapsed().wall * 1.0 / 1e6 << " ms"
+            << ", (peak-rss) = " << peakRSS << " MB";
+
+    delete session;
+
+    return true;
+}
+
+void Proxy::abortWriteSession(WriteSession *session) {
+    if (session == NULL)
+        return;
+
+    LOG(WARNING) << "Abort write session on file " << session->wf.name << " after " << session->size << " bytes";
+
+    discardWriteSession(session);
+}
+
+unsigned long int Proxy::getWriteSessionSize(const WriteSession *session) const {
+    return session == NULL? 0 : session->size;
+}
+
+bool Proxy::submitSessionStripe(WriteSession *session) {
+    File &wf = session->wf;
+
+    WriteSession::StripeInFlight *stripe = new WriteSession::StripeInFlight();
+    File &swf = stripe->swf;
+    swf.copyVersionControlInfo(wf);
+    swf.reqId = wf.reqId;
+    swf.blockId = wf.blockId;
+    swf.stripeId = session->numStripes;
+
+    // the stripe is appended to the data written so far
+    wf.offset = session->numStripes * session->maxDataStripeSize;
+    wf.length = session->numBuffered;
+    wf.size = wf.offset + wf.length;
+
+    if (prepareWrite(wf, swf, session->spareContainers, session->numSelected, /* needsFindSpareContainers */ true) == false) {
+        delete stripe;
+        return false;
+    }
+
+    // hand over the stripe buffer to the stripe
+    stripe->stripebuf = session->stripebuf;
+    session->stripebuf = 0;
+    swf.data = stripe->stripebuf;
+
+    auto releaseStripe = [&]() {
+        swf.data = 0;
+        session->idleStripebufs.push_back(stripe->stripebuf);
+        delete stripe;
+    };
+
+    // scan for duplicate blocks
+    std::string commitId;
+    if (!dedupStripe(swf, wf.uniqueBlocks, wf.duplicateBlocks, commitId)) {
+        releaseStripe();
+        return false;
+    }
+    // add commit id to file, so it is aborted together with the others on error
+    wf.commitIds.push_back(commitId);
+
+    // zero the padding after the (deduplicated) stripe data
+    if (swf.length < session->stripebufSize)
+        memset(swf.data + swf.length, 0, session->stripebufSize - swf.length);
+
+    // encode the stripe and issue its chunk requests, unless all data is duplicated
+    bool emptyStripe = swf.length == 0;
+    session->dataWrite.resume();
+    bool submitted = emptyStripe || _chunkManager->submitFileStripe(swf, session->spareContainers, session->numSelected, stripe->write, /* alignDataBuf */ false, /* isOverwrite */ false);
+    session->dataWrite.stop();
+    if (!submitted) {
+        LOG(ERROR) << "Failed to write stripe " << swf.stripeId << " of file " << wf.name << " to backend";
+        releaseStripe();
+        return false;
+    }
+
+    session->inflight.push_back(stripe);
+    session->numStripes++;
+
+    // take a buffer for the next stripe
+    if (!session->idleStripebufs.empty()) {
+        session->stripebuf = session->idleStripebufs.back();
+        session->idleStripebufs.pop_back();
+    } else {
+        session->stripebuf = (unsigned char *) calloc (session->stripebufSize, 1);
+    }
+    session->numBuffered = 0;
+
+    // bound the number of stripes in flight
+    bool okay = session->stripebuf != NULL;
+    size_t pipelineDepth = Config::getInstance().getProxyWritePipelineDepth();
+    while (okay && session->inflight.size() >= pipelineDepth) {
+        okay = completeSessionStripe(session);
+    }
+
+    return okay;
+}
+
+bool Proxy::completeSessionStripe(WriteSession *session) {
+    WriteSession::StripeInFlight *stripe = session->inflight.front();
+    session->inflight.pop_front();
+    File &swf = stripe->swf;
+    File &wf = session->wf;
+
+    bool emptyStripe = swf.length == 0;
+
+    session->dataWrite.resume();
+    bool written = emptyStripe || _chunkManager->completeFileStripe(stripe->write);
+    session->dataWrite.stop();
+
+    if (written) {
+        if (session->firstStripeStored < 0)
+            session->firstStripeStored = session->sinceOpen.elapsed().wall * 1.0 / 1e6;
+
+        // keep the container ids, chunk metadata, and coding state of the stripe, in the order of stripes
+        int numChunksPerStripe = session->numChunksPerStripe;
+        if (!emptyStripe && swf.numChunks != numChunksPerStripe) {
+            LOG(WARNING) << "Expected num of chunks in stripe: " << numChunksPerStripe << ", but actually got " << swf.numChunks;
+        }
+        for (int nc = 0; nc < numChunksPerStripe; nc++) {
+            session->chunks.emplace_back();
+            Chunk &chunk = session->chunks.back();
+            if (!emptyStripe) {
+                session->containerIds.push_back(swf.containerIds[nc]);
+                chunk.copyMeta(swf.chunks[nc]);
+            } else {
+                session->containerIds.push_back(UNUSED_CONTAINER_ID);
+                chunk.size = 0;
+                chunk.resetChecksum();
+            }
+            chunk.setChunkId(swf.stripeId * numChunksPerStripe + nc);
+        }
+        // copy coding meta from stripe (holder) to file
+        if (!emptyStripe && !session->hasCodingParameters) {
+            wf.codingMeta.n = swf.codingMeta.n;
+            wf.codingMeta.k = swf.codingMeta.k;
+            session->hasCodingParameters = true;
+        }
+        session->codingStates.emplace_back();
+        if (!emptyStripe && swf.codingMeta.codingStateSize > 0) {
+            session->codingStates.back().assign(swf.codingMeta.codingState, swf.codingMeta.codingState + swf.codingMeta.codingStateSize);
+        }
+    } else {
+        LOG(ERROR) << "Failed to write stripe " << swf.stripeId << " of file " << wf.name << " to backend";
+    }
+
+    // clean up
+    swf.data = 0;
+    session->idleStripebufs.push_back(stripe->stripebuf);
+    delete stripe;
+
+    return written;
+}
+
+void Proxy::discardWriteSession(WriteSession *session) {
+    File &wf = session->wf;
+
+    // wait for all stripes in flight, where a failed stripe is already cleaned up on its own
+    while (!session->inflight.empty()) {
+        completeSessionStripe(session);
+    }
+
+    // remove the chunks of the stripes written
+    int numChunks = session->containerIds.size();
+    if (numChunks > 0) {
+        wf.numChunks = numChunks;
+        if (wf.initChunksAndContainerIds()) {
+            bool *deleteIndicator = new bool[numChunks];
+            for (int i = 0; i < numChunks; i++) {
+                wf.containerIds[i] = session->containerIds.at(i);
+                wf.chunks[i].copyMeta(session->chunks.at(i));
+                deleteIndicator[i] = wf.containerIds[i] != INVALID_CONTAINER_ID && wf.containerIds[i] != UNUSED_CONTAINER_ID;
+            }
+            if (!_chunkManager->deleteFile(wf, deleteIndicator)) {
+                LOG(WARNING) << "Failed to remove the stripes written in the write session of file " << wf.name;
+            }
+            delete [] deleteIndicator;
+        }
+    }
+
+    // abort all fingerprints
+    size_t numCommits = wf.commitIds.size();
+    for (size_t i = 0; i < numCommits; i++) {
+        _dedup->abort(wf.commitIds.at(i));
+    }
+
+    unlockFile(wf);
+
+    delete session;
+}
+
 bool Proxy::overwriteFile(File &f) {
     return modifyFile(f, /* isAppend */ false);
 }
@@ -226,6 +694,9 @@ bool Proxy::modifyFile(File &f, bool isAppend) {
     if (f.namespaceId == INVALID_NAMESPACE_ID)
         f.namespaceId = DEFAULT_NAMESPACE_ID;
 
+    // stripes read ahead for the file are outdated
+    dropReadAheadStream(f);
+
     // check for immutability
     if (_immutableManager->isImmutable(f) || _immutableManager->isOnModificationHold(f) || _immutableManager->isOnAccessHold(f)) {
         LOG(ERROR) << "Failed to proceed with a write operations on file " << f.name << " due to immutable policies";
@@ -317,6 +788,44 @@ bool Proxy::modifyFile(File &f, bool isAppend) {
             okay = false;
         }
     }
+    // overwrite a small range in place, without reading and rewriting the whole stripe
+    unsigned char *oldData = NULL;
+    if (
+        okay && !isAppend && !isVersioned
+        && of.uuid == expectedUUID
+        && of.storageClass == f.storageClass
+        && f.offset + f.length <= of.size
+        && (oldData = (unsigned char *) malloc (f.length)) != NULL
+        && overwriteFileInPlace(of, f.offset, f.length, f.data, oldData)
+    ) {
+        readOldData.stop();
+        putMeta.start();
+        time_t now = time(NULL);
+        of.setTimeStamps(of.ctime, now, now);
+        // the version and (second-granular) modification time may stay the same
+        of.changeCount++;
+        bool metaUpdated = _metastore->putMeta(of);
+        putMeta.stop();
+        if (!metaUpdated) {
+            LOG(ERROR) << "Failed to update file metadata of file " << f.name << ", going to revert the in-place overwrite now";
+            of.changeCount--;
+            if (!overwriteFileInPlace(of, f.offset, f.length, oldData)) {
+                LOG(ERROR) << "Failed to revert the in-place overwrite of file " << f.name;
+            }
+        }
+        // drop the stripes read ahead by reads during the overwrite
+        dropReadAheadStream(f);
+        free(oldData);
+        unlockFile(of);
+        f.size = f.offset + f.length;
+        of.name = 0;
+        LOG(INFO) << "Overwrite file " << f.name << " in place"
+                << ", (get-meta) = " << (getMeta.elapsed().wall * 1.0 / 1e6) << " ms"
+                << ", (update-data) = " << (readOldData.elapsed().wall * 1.0 / 1e6) << " ms"
+                << ", (put-meta) = " << (putMeta.elapsed().wall * 1.0 / 1e6) << " ms";
+        return metaUpdated;
+    }
+    free(oldData);
     if (!isAppend) {
         // overwrite should start from the beginning of a stripe in the file 
         if (of.size < f.offset) {
@@ -465,6 +974,7 @@ bool Proxy::modifyFile(File &f, bool isAppend) {
     // update last access time and last modified time
     time_t now = time(NULL);
     wf.setTimeStamps(wf.ctime, now, now);
+    wf.changeCount++;
     processMeta.stop();
 
     putMeta.start();
@@ -489,6 +999,9 @@ bool Proxy::modifyFile(File &f, bool isAppend) {
     }
     putMeta.stop();
 
+    // drop the stripes read ahead for the old data by reads during the modification
+    dropReadAheadStream(f);
+
     commitfp.start();
     size_t numCommits = wf.commitIds.size();
     for (size_t i = 0; i < numCommits; i++) {
@@ -531,6 +1044,45 @@ bool Proxy::modifyFile(File &f, bool isAppend) {
     return true;
 }
 
+bool Proxy::overwriteFileInPlace(File &of, unsigned long int offset, unsigned long int length, const unsigned char *data, unsigned char *oldData) {
+    if (of.numStripes <= 0 || length == 0 || !_chunkManager->canUpdateFileStripe(of)) {
+        return false;
+    }
+
+    unsigned long int maxDataStripeSize = _chunkManager->getMaxDataSizePerStripe(of.codingMeta.coding, of.codingMeta.n, of.codingMeta.k, of.codingMeta.maxChunkSize);
+    if (maxDataStripeSize == INVALID_FILE_OFFSET || maxDataStripeSize == 0) {
+        return false;
+    }
+
+    // only update within one stripe, so a failed update can be reverted as a whole
+    int stripeId = offset / maxDataStripeSize;
+    if ((offset + length - 1) / maxDataStripeSize != (unsigned long int) stripeId || stripeId >= of.numStripes) {
+        return false;
+    }
+
+    // in-place update writes the affected data chunks and all code chunks, which pays off only if not all data chunks are affected
+    int numChunksPerStripe = of.numChunks / of.numStripes;
+    unsigned long int chunkSize = of.chunks[stripeId * numChunksPerStripe].size;
+    unsigned long int stripeOffset = offset - stripeId * maxDataStripeSize;
+    if (chunkSize == 0 || (stripeOffset + length - 1) / chunkSize - stripeOffset / chunkSize + 1 >= (unsigned long int) of.codingMeta.k) {
+        return false;
+    }
+
+    if (_chunkManager->updateFileStripe(of, stripeId, stripeOffset, length, data, oldData)) {
+        return true;
+    }
+
+    // keep the chunks which cannot be reverted away from reads, and have them repaired
+    bool hasCorrupted = false;
+    for (int i = 0; of.chunksCorrupted && i < numChunksPerStripe; i++)
+        hasCorrupted |= of.chunksCorrupted[stripeId * numChunksPerStripe + i];
+    if (hasCorrupted && (!_metastore->putMeta(of) || !_metastore->markFileAsNeedsRepair(of))) {
+        LOG(ERROR) << "Failed to mark the chunks of stripe " << stripeId << " of file " << of.name << " left inconsistent by the in-place overwrite for repair";
+    }
+
+    return false;
+}
+
 bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSelected) {
     int numContainers = _chunkManager->getNumRequiredContainers(wf.codingMeta.coding, wf.codingMeta.n, wf.codingMeta.k);
     int numChunksPerContainer = _chunkManager->getNumChunksPerContainer(wf.codingMeta.coding, wf.codingMeta.n, wf.codingMeta.k);
@@ -543,7 +1095,6 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
         return false;
     }
 
-    unsigned char *stripebuf = 0;
     int numStripes = f.size / maxDataStripeSize;
     numStripes += (f.size % maxDataStripeSize == 0)? 0 : 1;
     int numChunksPerStripe = numContainers * numChunksPerContainer;
@@ -559,20 +1110,103 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
     dataWriteTime.stop();
     postWriteProcessTime.stop();
 
-    // write the data stripe-by-stripe
+    // write the data stripe-by-stripe, where the encoding of a stripe overlaps with the chunk transfer of the previous ones
     int startIdx = f.offset / maxDataStripeSize;
     int endIdx = (f.offset + f.length + maxDataStripeSize - 1) / maxDataStripeSize;
+    size_t pipelineDepth = Config::getInstance().getProxyWritePipelineDepth();
+
+    DLOG(INFO) << "Write stripe " << startIdx << " to " << endIdx << " of file " << wf.name << ", up to " << pipelineDepth << " stripes in flight";
+
+    struct StripeInFlight {
+        bool isAppend;                      /**< whether the stripe is appended */
+        File swf;                           /**< stripe to write */
+        unsigned char *stripebuf;           /**< buffer holding the stripe data, if any */
+        BMWriteStripe *bmStripe;            /**< benchmark of the stripe, if any */
+        ChunkManager::StripeWrite write;    /**< chunk requests of the stripe */
+    };
+    std::deque<StripeInFlight*> inflight;
+    std::vector<unsigned char*> idleStripebufs;
+    std::vector<bool> writtenStripes(endIdx, false);
+    bool okay = true;
 
-    DLOG(INFO) << "Write stripe " << startIdx << " to " << endIdx << " of file " << wf.name;
+    // wait for the oldest stripe in flight, and copy its container ids and chunk information to the file
+    auto completeStripe = [&]() {
+        StripeInFlight *stripe = inflight.front();
+        inflight.pop_front();
+        File &swf = stripe->swf;
+        int i = swf.stripeId;
+        bool emptyStripe = swf.length == 0;
 
-    std::string filename = std::string(wf.name, wf.nameLength);
+        dataWriteTime.resume();
+        bool written = emptyStripe || _chunkManager->completeFileStripe(stripe->write);
+        dataWriteTime.stop();
 
-    for (int i = startIdx; i < endIdx; i++) {
+        if (written) {
+            postWriteProcessTime.resume();
+            // process metadata
+            if (!emptyStripe && swf.numChunks != numChunksPerStripe) {
+                LOG(WARNING) << "Expected num of chunks in stripe: " << numChunksPerStripe << ", but actually got " << swf.numChunks;
+            }
+
+            // copy container ids and chunk information from stripe (holder) to file
+            if (!emptyStripe) {
+                memcpy(wf.containerIds + i * numChunksPerStripe, swf.containerIds, numChunksPerStripe * sizeof(int));
+            } else {
+                for (int cidx = 0; cidx < numChunksPerStripe; cidx++) {
+                    wf.containerIds[i * numChunksPerStripe + cidx] = UNUSED_CONTAINER_ID;
+                }
+            }
+            for (int nc = 0; nc < numChunksPerStripe; nc++) {
+                if (!emptyStripe) {
+                    wf.chunks[i * numChunksPerStripe + nc].copyMeta(swf.chunks[nc]);
+                } else {
+                    wf.chunks[i * numChunksPerStripe + nc].size = 0;
+                    wf.chunks[i * numChunksPerStripe + nc].resetChecksum();
+                }
+                wf.chunks[i * numChunksPerStripe + nc].setChunkId(i * numChunksPerStripe + nc);
+            }
+
+            // copy coding meta from stripe (holder) to file
+            if (i == startIdx) {
+                wf.codingMeta.n = swf.codingMeta.n;
+                wf.codingMeta.k = swf.codingMeta.k;
+                wf.codingMeta.codingStateSize = swf.codingMeta.codingStateSize * numStripes;
+                if (wf.codingMeta.codingStateSize > 0)
+                    wf.codingMeta.codingState = new unsigned char [wf.codingMeta.codingStateSize];
+            }
+            if (wf.codingMeta.codingStateSize > 0) {
+                memcpy(wf.codingMeta.codingState + i * swf.codingMeta.codingStateSize, swf.codingMeta.codingState, swf.codingMeta.codingStateSize);
+            }
+            writtenStripes[i] = !emptyStripe;
+            postWriteProcessTime.stop();
+        } else {
+            LOG(ERROR) << "Failed to write file " << f.name << " to backend";
+        }
+
+        // TAGPT (end): process stripe
+        if (stripe->bmStripe) {
+            stripe->bmStripe->overallTime.markEnd();
+        }
+
+        // clean up
+        swf.data = 0;
+        if (stripe->stripebuf)
+            idleStripebufs.push_back(stripe->stripebuf);
+        delete stripe;
+
+        return written;
+    };
+
+    for (int i = startIdx; i < endIdx && okay; i++) {
         bool isAppend = i >= f.numStripes;
 
         prepareWriteTime.resume();
 
-        File swf; // stripe to write
+        StripeInFlight *stripe = new StripeInFlight();
+        stripe->isAppend = isAppend;
+        stripe->stripebuf = 0;
+        stripe->bmStripe = NULL;
+        File &swf = stripe->swf; // stripe to write
         swf.copyVersionControlInfo(wf);
 
         wf.offset = i * maxDataStripeSize;
@@ -591,28 +1225,12 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
             }
         }
 
-#define CLEAN_UP_PREVIOUS_STRIPES(__END_IDX__) do { \
-    if (i > startIdx) { \
-        memmove(wf.containerIds, wf.containerIds + startIdx * numChunksPerStripe, (__END_IDX__ - startIdx) * numChunksPerStripe); \
-        for (int j = startIdx * numChunksPerStripe; j < __END_IDX__ * numChunksPerStripe; j++) { \
-            wf.chunks[j - startIdx * numChunksPerStripe] = wf.chunks[j]; \
-            wf.chunks[j].freeData = false; \
-        } \
-        wf.numChunks = numChunksPerStripe * (__END_IDX__ - startIdx); \
-        bool chunkIndicator[wf.numChunks] = { true }; \
-        if (isAppend) { \
-            _chunkManager->deleteFile(wf, chunkIndicator); \
-        } else { \
-            _chunkManager->revertFile(wf, chunkIndicator); \
-        } \
-    } \
-} while (0)
-
         if (prepareWrite(wf, swf, spareContainers, numSelected, isAppend) == false) {
             swf.data = 0;
-            // clean up previous data
-            if (i > startIdx) CLEAN_UP_PREVIOUS_STRIPES((i-1));
-            return false;
+            delete stripe;
+            prepareWriteTime.stop();
+            okay = false;
+            break;
         }
 
         // make a shadow copy of data for file processing
@@ -628,18 +1246,23 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
             // TAGPT (start): process stripe
             bmStripe->overallTime.markStart();
             bmStripe->preparation.markStart();
+            stripe->bmStripe = bmStripe;
         }
 
         // use buffer if the data buffer will be modified (e.g., appending coding specific info), or the stripe needs padding
         bool useBuffer = _chunkManager->willModifyDataBuffer(f.storageClass) || swf.length != maxDataStripeSize;
         if (useBuffer) {
-            // adjust the buffer size for last stripe with unaligned size
-            if (stripebuf == 0)
-                stripebuf = (unsigned char *) calloc (_chunkManager->getDataStripeSize(wf.codingMeta.coding, wf.codingMeta.n, wf.codingMeta.k, maxDataStripeSize), 1);
+            // each stripe in flight has its own buffer, sized for the last stripe with unaligned size
+            if (!idleStripebufs.empty()) {
+                stripe->stripebuf = idleStripebufs.back();
+                idleStripebufs.pop_back();
+            } else {
+                stripe->stripebuf = (unsigned char *) calloc (_chunkManager->getDataStripeSize(wf.codingMeta.coding, wf.codingMeta.n, wf.codingMeta.k, maxDataStripeSize), 1);
+            }
             // copy data to temp buffer
-            memcpy(stripebuf, swf.data + swf.offset, swf.length);
+            memcpy(stripe->stripebuf, swf.data + swf.offset, swf.length);
             // point to the temp buffer instead of shadowing the original data buffer
-            swf.data = stripebuf;
+            swf.data = stripe->stripebuf;
         } else {
             // directly advance to the start of the current data stripe
             swf.data += swf.offset;
@@ -647,12 +1270,23 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
 
         prepareWriteTime.stop();
 
+        // TAGPT (end): preparation
+        if (benchmark) {
+            bmStripe->preparation.markEnd();
+        }
+
         dedupScanTime.resume();
         // scan for duplicate blocks
         std::map<BlockLocation::InObjectLocation, std::pair<Fingerprint, int> > stripeFps;
         std::string commitId;
         if (!dedupStripe(swf, wf.uniqueBlocks, wf.duplicateBlocks, commitId)) {
-            return false;
+            dedupScanTime.stop();
+            swf.data = 0;
+            if (stripe->stripebuf)
+                idleStripebufs.push_back(stripe->stripebuf);
+            delete stripe;
+            okay = false;
+            break;
         }
         dedupScanTime.stop();
 
@@ -667,63 +1301,34 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
 
         dataWriteTime.resume();
         // TODO journaling / copy-on-write for overwrite to avoid file corruption due to unexpected termination
-        // write the stripe (as part of the file)
-        if (!emptyStripe && _chunkManager->writeFileStripe(swf, spareContainers, numSelected, /* alignDataBuf */ false, /* isOverwrite */ !isAppend) == false) {
+        // encode the stripe and issue its chunk requests (as part of the file)
+        if (!emptyStripe && _chunkManager->submitFileStripe(swf, spareContainers, numSelected, stripe->write, /* alignDataBuf */ false, /* isOverwrite */ !isAppend) == false) {
             LOG(ERROR) << "Failed to write file " << f.name << " to backend";
+            dataWriteTime.stop();
             swf.data = 0;
-            // clean up previous data
-            CLEAN_UP_PREVIOUS_STRIPES(i);
-            free(stripebuf);
-            return false;
+            if (stripe->stripebuf)
+                idleStripebufs.push_back(stripe->stripebuf);
+            delete stripe;
+            okay = false;
+            break;
         }
         dataWriteTime.stop();
 
-        postWriteProcessTime.resume();
-        // process metadata
-        if (!emptyStripe && swf.numChunks != numChunksPerStripe) {
-            LOG(WARNING) << "Expected num of chunks in stripe: " << numChunksPerStripe << ", but actually got " << swf.numChunks;
+        // bound the number of stripes in flight
+        inflight.push_back(stripe);
+        while (okay && inflight.size() >= pipelineDepth) {
+            okay = completeStripe();
         }
+    }
 
-        // copy container ids and chunk information from stripe (holder) to file
-        if (!emptyStripe) {
-            memcpy(wf.containerIds + i * numChunksPerStripe, swf.containerIds, numChunksPerStripe * sizeof(int));
-        } else {
-            for (int cidx = 0; cidx < numChunksPerStripe; cidx++) {
-                wf.containerIds[i * numChunksPerStripe + cidx] = UNUSED_CONTAINER_ID;
-            }
-        }
-        for (int nc = 0; nc < numChunksPerStripe; nc++) {
-            if (!emptyStripe) {
-                wf.chunks[i * numChunksPerStripe + nc].copyMeta(swf.chunks[nc]);
-            } else {
-                wf.chunks[i * numChunksPerStripe + nc].size = 0;
-                wf.chunks[i * numChunksPerStripe + nc].resetMD5();
-            }
-            wf.chunks[i * numChunksPerStripe + nc].setChunkId(i * numChunksPerStripe + nc);
-        }
-
-        // copy coding meta from stripe (holder) to file
-        if (i == startIdx) {
-            wf.codingMeta.n = swf.codingMeta.n;
-            wf.codingMeta.k = swf.codingMeta.k;
-            wf.codingMeta.codingStateSize = swf.codingMeta.codingStateSize * numStripes;
-            if (wf.codingMeta.codingStateSize > 0)
-                wf.codingMeta.codingState = new unsigned char [wf.codingMeta.codingStateSize];
-        }
-        if (wf.codingMeta.codingStateSize > 0) {
-            memcpy(wf.codingMeta.codingState + i * swf.codingMeta.codingStateSize, swf.codingMeta.codingState, swf.codingMeta.codingStateSize);
-        }
-        postWriteProcessTime.stop();
-
-        // clean up
-        swf.data = 0;
-
-        // TAGPT (end): process stripe
-        if (benchmark) {
-            bmStripe->overallTime.markEnd();
-        }
+    // wait for all remaining stripes, even after failure, before cleaning up
+    while (!inflight.empty()) {
+        okay = completeStripe() && okay;
     }
 
+    for (auto stripebuf : idleStripebufs)
+        free(stripebuf);
+
     LOG(INFO) << " Write file " << f.name 
             << ", (dedup-scan) = " << (dedupScanTime.elapsed().wall * 1.0 / 1e6) << " ms"
             << ", (dedup-post-process) = " << (dedupPostProcessTime.elapsed().wall * 1.0 / 1e6) << " ms"
@@ -732,11 +1337,35 @@ bool Proxy::writeFileStripes(File &f, File &wf, int spareContainers[], int numSe
             << ", (post-write-process) = " << (postWriteProcessTime.elapsed().wall * 1.0 / 1e6) << " ms"
     ;
 
-    wf.numStripes = numStripes;
+    if (!okay) {
+        // clean up the stripes written, a failed stripe is already cleaned up on its own
+        // overwritten chunks are reverted, and appended chunks are deleted
+        bool *revertIndicator = new bool[wf.numChunks];
+        bool *deleteIndicator = new bool[wf.numChunks];
+        bool needsRevert = false, needsDelete = false;
+        for (int j = 0; j < wf.numChunks; j++) {
+            int stripeIdx = j / numChunksPerStripe;
+            bool written = stripeIdx < endIdx && writtenStripes[stripeIdx]
+                    && wf.containerIds[j] != INVALID_CONTAINER_ID && wf.containerIds[j] != UNUSED_CONTAINER_ID;
+            bool isAppend = stripeIdx >= f.numStripes;
+            revertIndicator[j] = written && !isAppend;
+            deleteIndicator[j] = written && isAppend;
+            needsRevert |= revertIndicator[j];
+            needsDelete |= deleteIndicator[j];
+        }
+        if (needsRevert) {
+            _chunkManager->revertFile(wf, revertIndicator);
+        }
+        if (needsDelete) {
+            _chunkManager->deleteFile(wf, deleteIndicator);
+        }
+        delete [] revertIndicator;
+        delete [] deleteIndicator;
+        return false;
+    }
 
-    free(stripebuf);
+    wf.numStripes = numStripes;
 
-#undef CLEAN_UP_PREVIOUS_STRIPES
     return true;
 }
 
@@ -916,6 +1545,8 @@ bool Proxy::readFile(File &f, bool isPartial) {
     }
     LOG(INFO) << "Read file " << f.name << ", metadata found ";
     getMeta.stop();
+    // pass the number of modifications to the version read
+    f.changeCount = rf.changeCount;
 
     // record the last access time
     rf.atime = time(NULL);
@@ -1056,6 +1687,7 @@ bool Proxy::readFile(File &f, bool isPartial) {
         int stripeId = ef->offset / maxDataSizePerStripe;
         bool chunkIndices[numChunksPerStripe];
         _coordinator->checkContainerLiveness(ef->containerIds + stripeId * numChunksPerStripe, numChunksPerStripe, chunkIndices);
+        checkCorruptedChunks(ef->chunksCorrupted? ef->chunksCorrupted + stripeId * numChunksPerStripe : NULL, numChunksPerStripe, chunkIndices);
 
         File erf;
         if (copyFileStripeMeta(erf, *ef, stripeId, "read") == false) {
@@ -1108,97 +1740,85 @@ bool Proxy::readFile(File &f, bool isPartial) {
     rf.data += f.offset;
 
     // read the unique data in the range
-    bool chunkIndices[numChunksPerStripe];
     // adjust such that rf.data always points to the (virtual) start of file
     rf.data -= f.offset;
-    // decode stripe by stripe
+    // read stripes in parallel, and complete them in order
     bool okay = true;
     int startStripe = isPartial? f.offset / maxDataStripeSize : 0;
     int endStripe = isPartial && f.offset + f.length <= rf.size? (f.offset + f.length) / maxDataStripeSize : rf.numStripes;
-    int currStripeId = 0;
-    unsigned char *tmpBuffer = 0;
-    unsigned long int bufferSize = 0;
-
-    for (int i = startStripe; i < endStripe; i++, currStripeId++) {
-        File srf;
-
-        // copy the stripe metadata
-        if (copyFileStripeMeta(srf, rf, i, "read") == false) {
-            if (preallocated) { rf.data = 0; }
-            clean_external_filemeta();
-            return false;
+    size_t readWindow = Config::getInstance().getProxyReadWindow();
+    std::deque<StripeRead*> inflight;
+
+    // stripes read ahead by previous sequential ranged reads
+    rf.blockId = f.blockId;
+    ReadAheadStream *stream = isPartial? acquireReadAheadStream(f, rf) : NULL;
+
+    // wait for the earliest stripe read in flight
+    auto completeStripe = [&]() {
+        StripeRead *read = inflight.front();
+        inflight.pop_front();
+        if (!finishStripeRead(read, rf.data + read->stripeId * maxDataStripeSize, bytesRead)) {
+            LOG(ERROR) << "Failed to read file " << f.name << " from backend (stripe " << read->stripeId << ")";
+            okay = false;
         }
-        srf.blockId = f.blockId;
-        srf.stripeId = currStripeId;
+        delete read;
+    };
 
-        // mark the offset and length
-        srf.offset = 0;
-        srf.length = srf.size;
+    for (int i = startStripe, currStripeId = 0; i < endStripe && okay; i++, currStripeId++) {
         // skip empty (i.e., fully deduplicated) stripes
-        if (srf.chunks[0].size == 0) {
-            if (preallocated) { rf.data = 0; }
-            unsetCopyFileStripeMeta(srf);
+        if (rf.chunks[i * numChunksPerStripe].size == 0)
             continue;
+
+        // keep at most a window of stripes in flight
+        while (okay && inflight.size() >= readWindow)
+            completeStripe();
+        if (!okay)
+            break;
+
+        // take the stripe if read ahead, or read it (into the data buffer directly if aligned)
+        StripeRead *read = 0;
+        if (stream && stream->stripes.count(i) > 0) {
+            read = stream->stripes.at(i);
+            stream->stripes.erase(i);
+        } else {
+            read = startStripeRead(rf, i, rf.data + i * maxDataStripeSize, currStripeId);
         }
-        // check for alive containers
-        _coordinator->checkContainerLiveness(srf.containerIds, srf.numChunks, chunkIndices);
-        // read the data from stripe
-        unsigned long int actualDataStripeSize = _chunkManager->getDataStripeSize(cmeta.coding, cmeta.n, cmeta.k, srf.size);
-        bool unalignedStripe = i + 1 == rf.numStripes && (rf.size % maxDataStripeSize != 0); // last stripe may be unaligned
-        bool useTempBuffer = unalignedStripe || actualDataStripeSize > maxDataStripeSize;
-        if (useTempBuffer) {
-            // allocate buffer on first use, or when the size is not sufficiently large
-            if (tmpBuffer == 0 || bufferSize < actualDataStripeSize || bufferSize < maxDataStripeSize) {
-                free(tmpBuffer);
-                bufferSize = std::max(actualDataStripeSize, maxDataStripeSize);
-                DLOG(INFO) << bufferSize;
-                tmpBuffer = static_cast<unsigned char *>(calloc (bufferSize, 1));
-                if (tmpBuffer == 0) {
-                    LOG(ERROR) << "Out of memory for reading stripes for file " << f.name;
-                    unlockFile(rf);
-                    clean_external_filemeta();
-                    unsetCopyFileStripeMeta(srf);
-                    return false;
-                }
-            }
-            // zero out the zone to use
-            memset(tmpBuffer, 0, actualDataStripeSize);
-            // assigned it to the stripe
-            srf.data = tmpBuffer;
-        } else { // aligned stripes
-            srf.data = rf.data + i * maxDataStripeSize;
-        }
-        if (_chunkManager->readFileStripe(srf, chunkIndices) == false) {
+        if (read == 0) {
             LOG(ERROR) << "Failed to read file " << f.name << " from backend (stripe " << i << ")";
             okay = false;
+            break;
         }
-        if (useTempBuffer) { // copy data back to the original file data buffer
-            // directly copy all data read
-            memcpy(rf.data + i * maxDataStripeSize, srf.data, srf.size);
-            bytesRead += srf.size;
-            // if buffer is replaced by lower level functions, free the new buffer and reset to tmp buffer pointer to avoid double free
-            if (srf.data != tmpBuffer) {
-                tmpBuffer = 0;
-                bufferSize = 0;
-                free(srf.data);
-            }
+        inflight.push_back(read);
+    }
+
+    // wait for the remaining stripes, and drop them once any read fails
+    while (!inflight.empty()) {
+        if (okay) {
+            completeStripe();
         } else {
-            bytesRead += srf.size;
-	}
-        // unset the data reference to the original file data buffer or the temp buffer
-        srf.data = 0;
-        // clean up (avoid double free)
-        unsetCopyFileStripeMeta(srf);
-        // skip once read failed
-        if (!okay) {
-            if (preallocated) {
-                rf.data = 0;
-            } else {
-                rf.data += f.offset;
-            }
-            clean_external_filemeta();
-            return false;
+            delete inflight.front();
+            inflight.pop_front();
+        }
+    }
+
+    if (stream) {
+        if (okay) {
+            releaseReadAheadStream(f, rf, stream, endStripe);
+        } else {
+            delete stream;
+        }
+        stream = 0;
+    }
+
+    // skip once read failed
+    if (!okay) {
+        if (preallocated) {
+            rf.data = 0;
+        } else {
+            rf.data += f.offset;
         }
+        clean_external_filemeta();
+        return false;
     }
     // make it back to the actual data buffer starting address
     rf.data += f.offset;
@@ -1233,8 +1853,6 @@ bool Proxy::readFile(File &f, bool isPartial) {
     }
 
     cleanup.start();
-    free(tmpBuffer);
-
     clean_external_filemeta();
     cleanup.stop();
 
@@ -1425,6 +2043,9 @@ bool Proxy::deleteFile(const File &f) {
 
     File df;
 
+    // stripes read ahead for the file are outdated
+    dropReadAheadStream(f);
+
     bool isVersioned = !Config::getInstance().overwriteFiles();
 
     boost::timer::cpu_times metaDuration, duration;
@@ -1542,6 +2163,10 @@ bool Proxy::renameFile(File &sf, File &df) {
     if (df.namespaceId == INVALID_NAMESPACE_ID)
         df.namespaceId = sf.namespaceId;
 
+    // stripes read ahead for the files are outdated
+    dropReadAheadStream(sf);
+    dropReadAheadStream(df);
+
     // check for immutability
     if (_immutableManager->isImmutable(sf) || _immutableManager->isOnModificationHold(sf) || _immutableManager->isOnAccessHold(sf)) {
         LOG(ERROR) << "Failed to proceed with a rename operations on file " << sf.name << " due to immutable policies";
@@ -1874,6 +2499,8 @@ bool Proxy::repairFile(const File &f, bool isBg) {
         // check the chunk availability
         bool chunkIndicator[srf.numChunks];
         int numFailed = _coordinator->checkContainerLiveness(srf.containerIds, srf.numChunks, chunkIndicator);
+        // rebuild the corrupted chunks as well
+        numFailed += checkCorruptedChunks(srf.chunksCorrupted, srf.numChunks, chunkIndicator);
 
         // skip if no repair is needed
         if (numFailed == 0) {
@@ -2084,7 +2711,8 @@ bool Proxy::copyFileStripeMeta(File &dst, File &src, int stripeId, const char *o
     dst.chunks = src.chunks + stripeId * numChunksPerStripe; 
     dst.containerIds = src.containerIds + stripeId * numChunksPerStripe;
     dst.chunksCorrupted = src.chunksCorrupted + stripeId * numChunksPerStripe;
-    // stripe coding metadata
+    // stripe storage class and coding metadata
+    dst.storageClass = src.storageClass;
     dst.codingMeta = src.codingMeta;
     dst.codingMeta.codingStateSize /= src.numStripes;
     dst.codingMeta.codingState += stripeId * dst.codingMeta.codingStateSize;
@@ -2123,6 +2751,178 @@ void Proxy::unsetCopyFileStripeMeta(File &copy) {
     copy.codingMeta.codingState = 0;
 }
 
+Proxy::StripeRead *Proxy::startStripeRead(File &rf, int stripeId, unsigned char *dst, int bmStripeId) {
+    File shadow;
+    if (copyFileStripeMeta(shadow, rf, stripeId, "read") == false)
+        return NULL;
+
+    StripeRead *read = new StripeRead();
+    read->stripeId = stripeId;
+
+    // keep a copy of the stripe metadata, which the read may outlive
+    File &srf = read->file;
+    srf.copyNameAndSize(shadow);
+    srf.version = shadow.version;
+    srf.storageClass = shadow.storageClass;
+    srf.copyChunkInfo(shadow);
+    srf.codingMeta.copyMeta(shadow.codingMeta);
+    unsetCopyFileStripeMeta(shadow);
+    srf.offset = 0;
+    srf.length = srf.size;
+    srf.blockId = rf.blockId;
+    srf.stripeId = bmStripeId;
+    if (bmStripeId == -1)
+        srf.reqId = -1;
+
+    // check for alive containers
+    read->chunkIndicator = new bool[srf.numChunks];
+    _coordinator->checkContainerLiveness(srf.containerIds, srf.numChunks, read->chunkIndicator);
+    // avoid reading corrupted chunks
+    checkCorruptedChunks(srf.chunksCorrupted, srf.numChunks, read->chunkIndicator);
+
+    // decode aligned stripes directly into the destination buffer, and others into a buffer of its own
+    CodingMeta &cmeta = srf.codingMeta;
+    unsigned long int maxDataStripeSize = _chunkManager->getMaxDataSizePerStripe(cmeta.coding, cmeta.n, cmeta.k, cmeta.maxChunkSize, /* full chunk size */ true);
+    unsigned long int actualDataStripeSize = _chunkManager->getDataStripeSize(cmeta.coding, cmeta.n, cmeta.k, srf.size);
+    read->inPlace = dst != NULL && srf.size == maxDataStripeSize && actualDataStripeSize <= maxDataStripeSize;
+    if (read->inPlace) {
+        srf.data = dst;
+    } else {
+        srf.data = static_cast<unsigned char *>(calloc (std::max(actualDataStripeSize, maxDataStripeSize), 1));
+        if (srf.data == 0) {
+            LOG(ERROR) << "Out of memory for reading stripe " << stripeId << " of file " << rf.name;
+            delete read;
+            return NULL;
+        }
+    }
+
+    // issue the chunk requests through the chunk I/O dispatchers, and leave the decoding to the completion
+    read->submitted = _chunkManager->submitFileStripeRead(read->file, read->chunkIndicator, read->chunks);
+
+    return read;
+}
+
+bool Proxy::finishStripeRead(StripeRead *read, unsigned char *dst, unsigned long int &bytesRead) {
+    if (!read->submitted || !_chunkManager->completeFileStripeRead(read->chunks))
+        return false;
+
+    // copy data back to the destination buffer
+    if (!read->inPlace)
+        memcpy(dst, read->file.data, read->file.size);
+    bytesRead += read->file.size;
+
+    return true;
+}
+
+static std::string genReadAheadStreamKey(const File &f) {
+    unsigned char namespaceId = f.namespaceId == INVALID_NAMESPACE_ID? DEFAULT_NAMESPACE_ID : f.namespaceId;
+    return std::to_string(namespaceId).append("_").append(f.name, f.nameLength);
+}
+
+Proxy::ReadAheadStream *Proxy::acquireReadAheadStream(const File &f, const File &rf) {
+    int maxReadAhead = Config::getInstance().getProxyMaxReadAhead();
+    if (maxReadAhead <= 0)
+        return NULL;
+
+    std::string key = genReadAheadStreamKey(f);
+    ReadAheadStream *stream = 0;
+
+    // take the stream out, or start a new one if there is none (or it is in use by another read)
+    std::unique_lock<std::mutex> lk(_readAheadLock);
+    auto it = _readAheadStreams.find(key);
+    if (it != _readAheadStreams.end()) {
+        stream = it->second;
+        _readAheadStreams.erase(it);
+    }
+    lk.unlock();
+    if (stream == 0)
+        stream = new ReadAheadStream();
+
+    // drop the stripes read ahead for another version of the file, or before the version is modified
+    if (stream->version != rf.version || stream->mtime != rf.mtime || stream->changeCount != rf.changeCount) {
+        stream->dropStripes();
+        stream->nextOffset = INVALID_FILE_OFFSET;
+    }
+
+    // read ahead more on each sequential read, and stop reading ahead otherwise
+    if (f.offset == stream->nextOffset) {
+        stream->numStripes = std::min(std::max(stream->numStripes * 2, 1), maxReadAhead);
+    } else {
+        stream->numStripes = 0;
+        stream->dropStripes();
+    }
+
+    stream->version = rf.version;
+    stream->mtime = rf.mtime;
+    stream->changeCount = rf.changeCount;
+    stream->nextOffset = f.offset + f.length;
+
+    return stream;
+}
+
+void Proxy::releaseReadAheadStream(const File &f, File &rf, ReadAheadStream *stream, int nextStripe) {
+    // drop the stripes read ahead but skipped
+    while (!stream->stripes.empty() && stream->stripes.begin()->first < nextStripe) {
+        delete stream->stripes.begin()->second;
+        stream->stripes.erase(stream->stripes.begin());
+    }
+
+    // read ahead the stripes following the range read
+    int numChunksPerStripe = rf.numChunks / rf.numStripes;
+    int endStripe = std::min(nextStripe + stream->numStripes, rf.numStripes);
+    for (int i = nextStripe; i < endStripe; i++) {
+        if (stream->stripes.count(i) > 0 || rf.chunks[i * numChunksPerStripe].size == 0)
+            continue;
+        StripeRead *read = startStripeRead(rf, i, /* own buffer */ NULL, /* no benchmark */ -1);
+        if (read == 0)
+            break;
+        stream->stripes.insert(std::make_pair(i, read));
+    }
+
+    std::string key = genReadAheadStreamKey(f);
+    std::vector<ReadAheadStream*> evicted;
+
+    std::unique_lock<std::mutex> lk(_readAheadLock);
+    stream->lastUse = _readAheadClock++;
+    // replace any stream started by another read on the file in the meantime
+    auto it = _readAheadStreams.find(key);
+    if (it != _readAheadStreams.end()) {
+        evicted.push_back(it->second);
+        it->second = stream;
+    } else {
+        _readAheadStreams.insert(std::make_pair(key, stream));
+    }
+    // evict the least recently used stream if there are too many
+    if (_readAheadStreams.size() > PROXY_MAX_READ_AHEAD_STREAMS) {
+        auto lru = _readAheadStreams.begin();
+        for (auto sit = _readAheadStreams.begin(); sit != _readAheadStreams.end(); sit++) {
+            if (sit->second->lastUse < lru->second->lastUse)
+                lru = sit;
+        }
+        evicted.push_back(lru->second);
+        _readAheadStreams.erase(lru);
+    }
+    lk.unlock();
+
+    // wait for the reads in flight outside the lock
+    for (size_t i = 0; i < evicted.size(); i++)
+        delete evicted.at(i);
+}
+
+void Proxy::dropReadAheadStream(const File &f) {
+    ReadAheadStream *stream = 0;
+
+    std::unique_lock<std::mutex> lk(_readAheadLock);
+    auto it = _readAheadStreams.find(genReadAheadStreamKey(f));
+    if (it != _readAheadStreams.end()) {
+        stream = it->second;
+        _readAheadStreams.erase(it);
+    }
+    lk.unlock();
+
+    delete stream;
+}
+
 bool Proxy::lockFile(const File &f) {
     int retryIntv = Config::getInstance().getRetryInterval();
     int numRetry = Config::getInstance().getNumRetry();
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <pthread.h> // pthread_*()
+#include <stdio.h> // printf()
+#include <stdlib.h> // atoi(), atol(), rand()
+#include <string.h> // strcmp()
+#include <boost/timer/timer.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+extern "C" {
+#include <oss_c_sdk/aos_http_io.h>
+}
+#include <zmq.hpp>
+#include <glog/logging.h>
+#include <aws/core/Aws.h>
+
+#include "../../agent/agent.hh"
+#include "../../common/config.hh"
+#include "../../common/coding/decoding_table_cache.hh"
+#include "../../common/define.hh"
+#include "../../common/io.hh"
+#include "../../ds/chunk_event.hh"
+
+/**
+ * Agent benchmark
+ *
+ * Run an Agent on localhost (without registering to Proxy), put chunks to the first NUM_CHUNKS containers in
+ * agent.ini, and repeat the partial encoding requests and the repair requests using CAR on them, with the same
+ * coefficients in every request as in the repair of a stripe. Report the throughput of each type of request and the
+ * hits on the coding table cache. The repaired chunk is stored in the container after the input chunks, so agent.ini
+ * should have at least NUM_CHUNKS + 1 containers.
+ *
+ * Usage: ./agent_bench [number of requests] [chunk size in bytes]
+ **/
+
+#define NUM_CHUNKS (2)
+#define BENCH_DEFAULT_NUM_REQUESTS (100)
+#define BENCH_DEFAULT_CHUNK_SIZE   (4 << 10)
+
+void usage(char *prg) {
+    fprintf(stderr, "%s [number of requests] [chunk size in bytes]\n", prg);
+    exit(1);
+}
+
+/**
+ * Send a request to the agent for a number of rounds and report the throughput
+ *
+ * @param[in] requester     socket connected to the agent
+ * @param[in,out] request   request to send, with the event id changed on every round
+ * @param[in] expectedOp    expected opcode of the replies
+ * @param[in] numRounds     number of rounds
+ * @param[in] bytesPerOp    bytes of chunk data processed by the agent per request
+ * @param[in] name          name of the request for printing
+ *
+ * @return whether all requests succeed
+ **/
+static bool benchRequest(zmq::socket_t &requester, ChunkEvent &request, Opcode expectedOp, int numRounds, unsigned long int bytesPerOp, const char *name) {
+    DecodingTableCache &cache = DecodingTableCache::getInstance();
+    unsigned long int hits = cache.getNumHits(), misses = cache.getNumMisses();
+    unsigned int baseId = request.id;
+
+    boost::timer::cpu_timer mytimer;
+    for (int i = 0; i < numRounds; i++) {
+        ChunkEvent reply;
+        request.id = baseId + i;
+        IO::sendChunkEventMessage(requester, request);
+        IO::getChunkEventMessage(requester, reply);
+        if (reply.id != request.id || reply.opcode != expectedOp) {
+            fprintf(stderr, "> [%s] Unexpected reply (id = %u, opcode = %d) in round %d\n", name, reply.id, reply.opcode, i);
+            return false;
+        }
+    }
+    double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+
+    printf("> [%s] %d requests in %.3lfs, %.1lf requests/s, %.3lf MB/s, coding table cache hits = %lu misses = %lu\n"
+        , name
+        , numRounds
+        , elapsed
+        , numRounds / elapsed
+        , bytesPerOp * numRounds / elapsed / (1 << 20)
+        , cache.getNumHits() - hits
+        , cache.getNumMisses() - misses
+    );
+    return true;
+}
+
+static void *runAgent(void *arg) {
+    Agent *agent = (Agent*) arg;
+
+    agent->run(/* register to proxy */ false);
+
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        usage(argv[0]);
+    }
+
+    int numRequests = argc > 1? atoi(argv[1]) : BENCH_DEFAULT_NUM_REQUESTS;
+    long int chunkSize = argc > 2? atol(argv[2]) : BENCH_DEFAULT_CHUNK_SIZE;
+    if (numRequests <= 0 || chunkSize <= 0)
+        usage(argv[0]);
+
+    Config &config = Config::getInstance();
+    config.setConfigPath();
+
+    // init aws sdk
+    Aws::SDKOptions options;
+    Aws::InitAPI(options);
+    // init aliyun sdk
+    if (aos_http_io_initialize(NULL, 0) != AOSE_OK) {
+        LOG(ERROR) << "Failed to init Aliyun OSS interface";
+        return 1;
+    }
+
+    FLAGS_logtostderr = true;
+    FLAGS_minloglevel = google::ERROR;
+    google::InitGoogleLogging(argv[0]);
+
+    srand(12345);
+
+    printf("Start Agent Benchmark\n");
+    printf("=====================\n");
+    printf("%d requests, %d chunks per request, chunk size = %ldB\n", numRequests, NUM_CHUNKS, chunkSize);
+
+    // run agent in background
+    Agent *agent = new Agent();
+    pthread_t at;
+    pthread_create(&at, NULL, runAgent, agent);
+
+    std::string agentIP = config.getAgentIP();
+    unsigned short port = config.getAgentPort();
+
+    zmq::socket_t requester(agent->_cxt, ZMQ_REQ);
+
+    sleep(1);
+
+    requester.connect(IO::genAddr(agentIP, port));
+    if (!requester.connected()) {
+        fprintf(stderr, "Failed to connect agent\n");
+        return 1;
+    }
+
+    ChunkEvent put, stored, repair, reply;
+    bool okay = true;
+
+    // put the input chunks
+    boost::uuids::basic_random_generator<boost::mt19937> gen;
+    boost::uuids::uuid fileuuid = gen();
+    unsigned char namespaceId = 1;
+
+    put.id = 1;
+    put.opcode = Opcode::PUT_CHUNK_REQ;
+    put.numChunks = NUM_CHUNKS;
+    put.chunks = new Chunk[put.numChunks];
+    put.containerIds = new int[put.numChunks];
+    for (int i = 0; i < put.numChunks; i++) {
+        put.chunks[i].setId(namespaceId, fileuuid, i);
+        put.chunks[i].size = chunkSize;
+        put.chunks[i].data = (unsigned char*) malloc (chunkSize);
+        put.chunks[i].fileVersion = 0;
+        put.chunks[i].freeData = true;
+        put.containerIds[i] = config.getContainerId(i + 1);
+        for (long int j = 0; j < chunkSize; j++)
+            put.chunks[i].data[j] = rand() % 256;
+        put.chunks[i].computeChecksum();
+    }
+    IO::sendChunkEventMessage(requester, put);
+    IO::getChunkEventMessage(requester, stored);
+    if (stored.id != put.id || stored.opcode != Opcode::PUT_CHUNK_REP_SUCCESS || stored.numChunks != NUM_CHUNKS) {
+        fprintf(stderr, "> [Put chunk] Unexpected reply (id = %u, opcode = %d)\n", stored.id, stored.opcode);
+        okay = false;
+    }
+
+    // encode the stored chunks into one partial chunk
+    if (okay) {
+        stored.id = 1000000;
+        stored.opcode = Opcode::ENC_CHUNK_REQ;
+        stored.codingMeta.codingStateSize = NUM_CHUNKS;
+        stored.codingMeta.codingState = (unsigned char *) malloc (NUM_CHUNKS);
+        for (int i = 0; i < NUM_CHUNKS; i++)
+            stored.codingMeta.codingState[i] = 1;
+        okay = benchRequest(requester, stored, Opcode::ENC_CHUNK_REP_SUCCESS, numRequests, NUM_CHUNKS * chunkSize, "Encode chunk");
+    }
+
+    // repair a chunk from the stored chunks using CAR
+    repair.id = 2000000;
+    repair.opcode = Opcode::RPR_CHUNK_REQ;
+    // repair target
+    repair.numChunks = 1;
+    repair.containerIds = new int[1];
+    repair.containerIds[0] = config.getContainerId(NUM_CHUNKS + 1);
+    repair.chunks = new Chunk[1];
+    repair.chunks[0].setId(namespaceId, fileuuid, NUM_CHUNKS);
+    repair.chunks[0].size = 0;
+    repair.chunks[0].data = 0;
+    repair.chunks[0].fileVersion = 0;
+    // how to repair
+    repair.codingMeta.coding = CodingScheme::RS;
+    repair.codingMeta.codingStateSize = NUM_CHUNKS;
+    repair.codingMeta.codingState = (unsigned char *) malloc (NUM_CHUNKS);
+    repair.numChunkGroups = NUM_CHUNKS;
+    repair.numInputChunks = NUM_CHUNKS;
+    repair.chunkGroupMap = (int *) malloc (sizeof(int) * (NUM_CHUNKS + repair.numChunkGroups));
+    repair.containerGroupMap = (int *) malloc (sizeof(int) * (NUM_CHUNKS + repair.numChunkGroups));
+    for (int i = 0; i < repair.numChunkGroups; i++) {
+        repair.codingMeta.codingState[i] = 1;
+        repair.chunkGroupMap[i * 2] = 1;
+        repair.chunkGroupMap[i * 2 + 1] = i;
+        repair.containerGroupMap[i] = config.getContainerId(i + 1);
+        repair.agents.append(IO::genAddr(agentIP, port));
+        repair.agents.append(";");
+    }
+    repair.repairUsingCAR = true;
+    if (okay)
+        okay = benchRequest(requester, repair, Opcode::RPR_CHUNK_REP_SUCCESS, numRequests, NUM_CHUNKS * chunkSize, "Repair chunk, CAR");
+
+    agent->printStats();
+
+    // remove the input chunks and the repaired chunk
+    stored.id = 3000000;
+    stored.opcode = Opcode::DEL_CHUNK_REQ;
+    IO::sendChunkEventMessage(requester, stored);
+    IO::getChunkEventMessage(requester, reply);
+    repair.id = 3000001;
+    repair.opcode = Opcode::DEL_CHUNK_REQ;
+    IO::sendChunkEventMessage(requester, repair);
+    IO::getChunkEventMessage(requester, reply);
+
+    requester.close();
+
+    delete agent;
+    pthread_join(at, NULL);
+
+    aos_http_io_deinitialize();
+    Aws::ShutdownAPI(options);
+
+    printf("End of Agent Benchmark\n");
+    printf("=====================\n");
+
+    return okay? 0 : 1;
+}
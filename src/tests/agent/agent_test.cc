@@ -107,7 +107,7 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    ChunkEvent event, event2, event3, event4, event5, event6, event7, event8, event9, event10, event11, event12, event13;
+    ChunkEvent event, event2, event3, event4, event5, event6, event7, event8, event9, event10, event11, event12, event13, event14, event15, event16, event17, event18;
 
     agent->printStats();
 
@@ -133,7 +133,7 @@ int main(int argc, char **argv) {
         event.chunks[i].freeData = true;
         event.containerIds[i] = config.getContainerId(i + 1);
         memset(event.chunks[i].data, 'a', event.chunks[i].size); 
-        event.chunks[i].computeMD5();
+        event.chunks[i].computeChecksum();
     }
     IO::sendChunkEventMessage(requester, event);
     IO::getChunkEventMessage(requester, event2);
@@ -367,7 +367,7 @@ int main(int argc, char **argv) {
     event10.id = 485398;
     event10.opcode = Opcode::PUT_CHUNK_REQ;
     memset(event10.chunks[1].data, 0, event10.chunks[1].size);
-    event10.chunks[1].computeMD5();
+    event10.chunks[1].computeChecksum();
     IO::sendChunkEventMessage(requester, event10);
     IO::getChunkEventMessage(requester, event11);
 
@@ -409,8 +409,215 @@ int main(int argc, char **argv) {
 
     printf("> Pass verify chunk test (corrupted chunks)\n");
 
+    // ---------------------------
+    // 10. update chunks in place
+    // ---------------------------
+    event14.id = 3948571;
+    event14.opcode = Opcode::UPD_CHUNK_REQ;
+    event14.numChunks = NUM_CHUNKS;
+    // the changes, followed by the stored chunks expected
+    event14.chunks = new Chunk[event14.numChunks * 2];
+    event14.containerIds = new int[event14.numChunks];
+    for (int i = 0; i < event14.numChunks; i++) {
+        event14.chunks[i].copyMeta(event2.chunks[i]);
+        event14.chunks[i].allocateData(CHUNK_SIZE);
+        // flip the lowest bit of the first half of chunk data
+        memset(event14.chunks[i].data, 1, CHUNK_SIZE / 2);
+        memset(event14.chunks[i].data + CHUNK_SIZE / 2, 0, CHUNK_SIZE - CHUNK_SIZE / 2);
+        event14.chunks[i].computeChecksum();
+        event14.containerIds[i] = event2.containerIds[i];
+        // chunk 0 was filled with 'a', and chunk 1 was zeroed
+        Chunk &stored = event14.chunks[NUM_CHUNKS + i];
+        stored.copyMeta(event2.chunks[i]);
+        stored.allocateData(CHUNK_SIZE);
+        memset(stored.data, i == 0? 'a' : 0, CHUNK_SIZE);
+        stored.computeChecksum();
+    }
+    IO::sendChunkEventMessage(requester, event14);
+    IO::getChunkEventMessage(requester, event15);
+
+    if (event14.id != event15.id) {
+        printf("> [Update chunk] Event id mismatched\n");
+        return 1;
+    }
+    if (event15.opcode != Opcode::UPD_CHUNK_REP_SUCCESS) {
+        printf("> [Update chunk] Unexpected opcode, expect %d but got %d\n", Opcode::UPD_CHUNK_REP_SUCCESS, event15.opcode);
+        return 1;
+    }
+    if (event15.numChunks != NUM_CHUNKS) {
+        printf("> [Update chunk] Incorrect number of chunks, expect %d but got %d\n", NUM_CHUNKS, event15.numChunks);
+        return 1;
+    }
+
+    // retry the update, which should not apply the changes again
+    {
+        ChunkEvent retry;
+        IO::sendChunkEventMessage(requester, event14);
+        IO::getChunkEventMessage(requester, retry);
+        if (retry.opcode != Opcode::UPD_CHUNK_REP_SUCCESS || retry.numChunks != NUM_CHUNKS) {
+            printf("> [Update chunk] Unexpected opcode on retry, expect %d but got %d\n", Opcode::UPD_CHUNK_REP_SUCCESS, retry.opcode);
+            return 1;
+        }
+        for (int i = 0; i < NUM_CHUNKS; i++) {
+            if (!retry.chunks[i].matchChecksum(event15.chunks[i])) {
+                printf("> [Update chunk] Changes applied again to chunk %d on retry\n", i);
+                return 1;
+            }
+        }
+    }
+
+    // read the updated chunks back, chunk 0 was filled with 'a', and chunk 1 was zeroed
+    event15.id = 3948572;
+    event15.opcode = Opcode::GET_CHUNK_REQ;
+    IO::sendChunkEventMessage(requester, event15);
+    IO::getChunkEventMessage(requester, event16);
+
+    if (event16.opcode != Opcode::GET_CHUNK_REP_SUCCESS || event16.numChunks != NUM_CHUNKS) {
+        printf("> [Update chunk] Failed to get updated chunks, opcode = %d\n", event16.opcode);
+        return 1;
+    }
+    for (int i = 0; i < NUM_CHUNKS; i++) {
+        unsigned char original = i == 0? 'a' : 0;
+        Chunk expected;
+        expected.allocateData(CHUNK_SIZE);
+        memset(expected.data, original ^ 1, CHUNK_SIZE / 2);
+        memset(expected.data + CHUNK_SIZE / 2, original, CHUNK_SIZE - CHUNK_SIZE / 2);
+        expected.computeChecksum();
+        if (event16.chunks[i].size != CHUNK_SIZE || memcmp(event16.chunks[i].data, expected.data, CHUNK_SIZE) != 0) {
+            printf("> [Update chunk] Incorrect content of updated chunk %d\n", i);
+            return 1;
+        }
+        if (!event15.chunks[i].matchChecksum(expected)) {
+            printf("> [Update chunk] Incorrect checksum of updated chunk %d in reply\n", i);
+            return 1;
+        }
+    }
+
+    agent->printStats();
+
+    printf("> Pass update chunk test\n");
+
+    // revert an update applied at the agent with its reply lost, as the proxy does for a failed stripe update:
+    // send the update again to learn the checksums after the changes, then apply the changes again with those checksums expected
+    {
+        // the chunks as updated above, and the changes flipping the first quarter of them
+        Chunk before[NUM_CHUNKS];
+        ChunkEvent update, reply, settle, revert;
+        update.id = 3948581;
+        update.opcode = Opcode::UPD_CHUNK_REQ;
+        update.numChunks = NUM_CHUNKS;
+        update.chunks = new Chunk[NUM_CHUNKS * 2];
+        update.containerIds = new int[NUM_CHUNKS];
+        for (int i = 0; i < NUM_CHUNKS; i++) {
+            before[i].copyMeta(event16.chunks[i]);
+            before[i].allocateData(CHUNK_SIZE);
+            memcpy(before[i].data, event16.chunks[i].data, CHUNK_SIZE);
+            before[i].computeChecksum();
+            update.chunks[i].copyMeta(event2.chunks[i]);
+            update.chunks[i].allocateData(CHUNK_SIZE);
+            memset(update.chunks[i].data, 2, CHUNK_SIZE / 4);
+            memset(update.chunks[i].data + CHUNK_SIZE / 4, 0, CHUNK_SIZE - CHUNK_SIZE / 4);
+            update.chunks[i].computeChecksum();
+            update.chunks[NUM_CHUNKS + i].copyMeta(event2.chunks[i]);
+            update.chunks[NUM_CHUNKS + i].copyChecksum(before[i]);
+            update.containerIds[i] = event2.containerIds[i];
+        }
+
+        // the update is applied, but its reply never reaches the proxy
+        IO::sendChunkEventMessage(requester, update);
+        IO::getChunkEventMessage(requester, reply);
+
+        IO::sendChunkEventMessage(requester, update);
+        IO::getChunkEventMessage(requester, settle);
+        if (settle.opcode != Opcode::UPD_CHUNK_REP_SUCCESS || settle.numChunks != NUM_CHUNKS) {
+            printf("> [Revert update without reply] Unexpected opcode on resending the update, expect %d but got %d\n", Opcode::UPD_CHUNK_REP_SUCCESS, settle.opcode);
+            return 1;
+        }
+
+        // revert twice, where the second one finds the chunks already reverted
+        for (int round = 0; round < 2; round++) {
+            for (int i = 0; i < NUM_CHUNKS; i++)
+                update.chunks[NUM_CHUNKS + i].copyChecksum(settle.chunks[i]);
+            update.id = 3948582 + round;
+            IO::sendChunkEventMessage(requester, update);
+            IO::getChunkEventMessage(requester, revert);
+            if (revert.opcode != Opcode::UPD_CHUNK_REP_SUCCESS || revert.numChunks != NUM_CHUNKS) {
+                printf("> [Revert update without reply] Unexpected opcode on revert round %d, expect %d but got %d\n", round, Opcode::UPD_CHUNK_REP_SUCCESS, revert.opcode);
+                return 1;
+            }
+            for (int i = 0; i < NUM_CHUNKS; i++) {
+                if (!revert.chunks[i].matchChecksum(before[i])) {
+                    printf("> [Revert update without reply] Incorrect checksum of reverted chunk %d on round %d\n", i, round);
+                    return 1;
+                }
+            }
+        }
+
+        // read the reverted chunks back
+        event15.id = 3948584;
+        event15.opcode = Opcode::GET_CHUNK_REQ;
+        IO::sendChunkEventMessage(requester, event15);
+        IO::getChunkEventMessage(requester, event16);
+        if (event16.opcode != Opcode::GET_CHUNK_REP_SUCCESS || event16.numChunks != NUM_CHUNKS) {
+            printf("> [Revert update without reply] Failed to get reverted chunks, opcode = %d\n", event16.opcode);
+            return 1;
+        }
+        for (int i = 0; i < NUM_CHUNKS; i++) {
+            if (event16.chunks[i].size != CHUNK_SIZE || memcmp(event16.chunks[i].data, before[i].data, CHUNK_SIZE) != 0) {
+                printf("> [Revert update without reply] Incorrect content of reverted chunk %d\n", i);
+                return 1;
+            }
+        }
+    }
+
+    printf("> Pass revert update without reply test\n");
+
+    // ---------------------------
+    // 11. get ranges of chunks
+    // ---------------------------
+    event17.id = 3948573;
+    event17.opcode = Opcode::GET_CHUNK_RANGE_REQ;
+    event17.numChunks = NUM_CHUNKS;
+    event17.chunks = new Chunk[event17.numChunks];
+    event17.containerIds = new int[event17.numChunks];
+    // get the second half of each chunk
+    event17.codingMeta.codingStateSize = sizeof(int) * 2 * NUM_CHUNKS;
+    event17.codingMeta.codingState = new unsigned char [event17.codingMeta.codingStateSize];
+    for (int i = 0; i < event17.numChunks; i++) {
+        int range[2] = { CHUNK_SIZE / 2, CHUNK_SIZE - CHUNK_SIZE / 2 };
+        event17.chunks[i].copyMeta(event2.chunks[i]);
+        event17.containerIds[i] = event2.containerIds[i];
+        memcpy(event17.codingMeta.codingState + sizeof(int) * 2 * i, range, sizeof(int) * 2);
+    }
+    IO::sendChunkEventMessage(requester, event17);
+    IO::getChunkEventMessage(requester, event18);
+
+    if (event17.id != event18.id) {
+        printf("> [Get chunk range] Event id mismatched\n");
+        return 1;
+    }
+    if (event18.opcode != Opcode::GET_CHUNK_RANGE_REP_SUCCESS || event18.numChunks != NUM_CHUNKS) {
+        printf("> [Get chunk range] Unexpected opcode, expect %d but got %d\n", Opcode::GET_CHUNK_RANGE_REP_SUCCESS, event18.opcode);
+        return 1;
+    }
+    for (int i = 0; i < NUM_CHUNKS; i++) {
+        // the second half of the updated chunks is not changed
+        unsigned char original = i == 0? 'a' : 0;
+        Chunk expected;
+        expected.allocateData(CHUNK_SIZE - CHUNK_SIZE / 2);
+        memset(expected.data, original, CHUNK_SIZE - CHUNK_SIZE / 2);
+        if (event18.chunks[i].size != CHUNK_SIZE - CHUNK_SIZE / 2 || memcmp(event18.chunks[i].data, expected.data, expected.size) != 0) {
+            printf("> [Get chunk range] Incorrect content of the range of chunk %d\n", i);
+            return 1;
+        }
+    }
+
+    agent->printStats();
+
+    printf("> Pass get chunk range test\n");
+
     // ------------------
-    // 10. delete chunks
+    // 12. delete chunks
     // ------------------
     event2.id = 8494859;
     event2.opcode = Opcode::DEL_CHUNK_REQ;
@@ -431,7 +638,7 @@ int main(int argc, char **argv) {
     printf("> Pass delete chunk test\n");
 
     // -----------------
-    // 11. check chunks
+    // 13. check chunks
     // -----------------
     event2.id = 2734294;
     event2.opcode = Opcode::CHK_CHUNK_REQ;
@@ -452,7 +659,7 @@ int main(int argc, char **argv) {
     printf("> Pass check chunk test (non-existing chunks)\n");
 
     // ------------------
-    // 12. verify chunks
+    // 14. verify chunks
     // ------------------
     event2.id = 2845958;
     event2.opcode = Opcode::VRF_CHUNK_REQ;
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __BENCH_UTIL_HH__
+#define __BENCH_UTIL_HH__
+
+#include <string.h> // memcpy(), memset()
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <boost/timer/timer.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include "../../ds/chunk.hh"
+
+/**
+ * Helpers shared by the Agent and container benchmarks
+ **/
+
+/**
+ * Set up a chunk with the file id derived from an index, so the chunks need not be kept in memory
+ *
+ * @param[out] chunk chunk to set up
+ * @param index index to derive the file id from
+ * @param data chunk data (not owned by the chunk)
+ * @param size size of the chunk data
+ * @param checksum chunk with the checksum to copy
+ * @param chunkId chunk id within the file
+ **/
+inline void setChunk(Chunk &chunk, int index, unsigned char *data, length_t size, const Chunk &checksum, int chunkId = 0) {
+    boost::uuids::uuid fuuid;
+    memset(fuuid.data, 0, fuuid.size());
+    memcpy(fuuid.data, &index, sizeof(index));
+    chunk.setId(1, fuuid, chunkId);
+    chunk.fileVersion = 0;
+    chunk.size = size;
+    chunk.data = data;
+    chunk.freeData = false;
+    chunk.copyChecksum(checksum);
+}
+
+/**
+ * Set up the chunks of a file, with the file id derived from an index and the chunk ids from 0 to numChunks - 1
+ *
+ * @param[out] chunks chunks to set up
+ * @param numChunks number of chunks
+ * @param index index to derive the file id from
+ * @param data chunk data shared by all chunks (not owned by the chunks)
+ * @param size size of the chunk data
+ * @param checksum chunk with the checksum to copy
+ **/
+inline void setChunks(Chunk chunks[], int numChunks, int index, unsigned char *data, length_t size, const Chunk &checksum) {
+    for (int i = 0; i < numChunks; i++)
+        setChunk(chunks[i], index, data, size, checksum, i);
+}
+
+/**
+ * Run an operation on a range of indices with multiple threads, each taking the indices in turn
+ *
+ * @param start first index
+ * @param end index after the last one
+ * @param numThreads number of threads
+ * @param op operation taking an index, which returns whether it succeeds
+ *
+ * @return elapsed time in seconds, or a negative value if any operation fails
+ **/
+template <typename Op>
+double runConcurrently(int start, int end, int numThreads, Op op) {
+    std::atomic<int> next(start);
+    std::atomic<bool> okay(true);
+    std::vector<std::thread> threads;
+
+    boost::timer::cpu_timer mytimer;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&]() {
+            for (int i = next++; i < end && okay; i = next++) {
+                if (!op(i))
+                    okay = false;
+            }
+        });
+    }
+    for (auto &th : threads)
+        th.join();
+    double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+
+    return okay? elapsed : -1;
+}
+
+#endif // define __BENCH_UTIL_HH__
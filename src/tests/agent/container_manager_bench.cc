@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h> // atoi(), atol(), rand()
+#include <string.h> // memcmp(), strcmp()
+
+#include <string>
+#include <vector>
+
+#include <boost/timer/timer.hpp>
+
+#include <glog/logging.h>
+
+#include "../../common/config.hh"
+#include "../../ds/chunk.hh"
+#include "../../agent/container_manager.hh"
+#include "bench_util.hh"
+
+/**
+ * Container manager benchmark
+ *
+ * Send put, get, and delete requests to the container manager, each with one chunk in each of the first m containers
+ * configured in agent.ini, for m from 1 to the number of containers, and report the latency and throughput of the
+ * requests. With the chunks of a request handled by the workers of the containers in parallel (container_io_workers
+ * > 0), the latency stays close to that of requests with one chunk, so the throughput scales with the number of
+ * containers on different disks. The speedup is the throughput relative to that with one container per request.
+ * Chunks read back are compared with those written.
+ *
+ * Usage: ./container_manager_bench [number of requests] [chunk size in bytes]
+ **/
+
+#define BENCH_DEFAULT_NUM_REQUESTS (256)
+#define BENCH_DEFAULT_CHUNK_SIZE   (1 << 20)
+
+void usage(char *prg) {
+    fprintf(stderr, "%s [number of requests] [chunk size in bytes]\n", prg);
+    exit(1);
+}
+
+void printResult(const char *op, double elapsed, int numRequests, int numContainers, length_t chunkSize, double baseRate) {
+    double rate = numRequests * numContainers * 1.0 * chunkSize / (1 << 20) / elapsed;
+    printf("  %-6s latency: %8.3lf ms  throughput: %9.2lf MB/s  speedup: %5.2lf\n"
+        , op
+        , elapsed * 1e3 / numRequests
+        , rate
+        , baseRate > 0? rate / baseRate : 1.0
+    );
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        usage(argv[0]);
+    }
+
+    Config &config = Config::getInstance();
+    config.setConfigPath();
+
+    FLAGS_logtostderr = true;
+    FLAGS_minloglevel = google::ERROR;
+    google::InitGoogleLogging(argv[0]);
+
+    srand(12345);
+
+    int numRequests = argc > 1? atoi(argv[1]) : BENCH_DEFAULT_NUM_REQUESTS;
+    long int chunkSize = argc > 2? atol(argv[2]) : BENCH_DEFAULT_CHUNK_SIZE;
+    if (numRequests <= 0 || chunkSize <= 0)
+        usage(argv[0]);
+
+    ContainerManager cm;
+    int numContainers = cm.getNumContainers();
+    int containerIds[MAX_NUM_CONTAINERS];
+    cm.getContainerIds(containerIds);
+
+    unsigned char *data = (unsigned char *) malloc(chunkSize);
+    if (data == NULL) {
+        fprintf(stderr, "Failed to allocate memory for chunk data\n");
+        return 1;
+    }
+    for (long int i = 0; i < chunkSize; i++)
+        data[i] = rand() % 256;
+
+    // all chunks have the same data and checksum
+    Chunk checksum;
+    checksum.data = data;
+    checksum.size = chunkSize;
+    checksum.freeData = false;
+    checksum.computeChecksum();
+
+    printf("Start Container Manager Benchmark\n");
+    printf("=================================\n");
+    printf("%d containers, %d requests, chunk size = %ldB, container I/O workers = %d, sync on put = %s\n", numContainers, numRequests, chunkSize, config.getAgentContainerIOWorkers(), config.getAgentFlushOnClose()? "true" : "false");
+
+    bool okay = true;
+    double basePutRate = 0, baseGetRate = 0;
+    for (int m = 1; m <= numContainers && okay; m++) {
+        std::vector<Chunk> chunks(m);
+        printf("%d chunk(s) per request, one in each container\n", m);
+
+        // put
+        boost::timer::cpu_timer mytimer;
+        for (int r = 0; r < numRequests && okay; r++) {
+            setChunks(chunks.data(), m, r, data, chunkSize, checksum);
+            okay = cm.putChunks(containerIds, chunks.data(), m, /* trust checksum */ true);
+        }
+        double elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        if (!okay) {
+            fprintf(stderr, "Failed to put chunks\n");
+            break;
+        }
+        printResult("put", elapsed, numRequests, m, chunkSize, basePutRate);
+        if (m == 1)
+            basePutRate = numRequests * 1.0 * chunkSize / (1 << 20) / elapsed;
+
+        // get
+        mytimer.start();
+        for (int r = 0; r < numRequests && okay; r++) {
+            setChunks(chunks.data(), m, r, NULL, 0, checksum);
+            for (int i = 0; i < m; i++)
+                chunks.at(i).freeData = true;
+            okay = cm.getChunks(containerIds, chunks.data(), m);
+            for (int i = 0; i < m && okay; i++) {
+                if (chunks.at(i).size != chunkSize || memcmp(chunks.at(i).data, data, chunkSize) != 0) {
+                    fprintf(stderr, "Chunk %d of request %d read back mismatches the one written\n", i, r);
+                    okay = false;
+                }
+            }
+            for (int i = 0; i < m; i++)
+                chunks.at(i).release();
+        }
+        elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        if (!okay) {
+            fprintf(stderr, "Failed to get chunks\n");
+            break;
+        }
+        printResult("get", elapsed, numRequests, m, chunkSize, baseGetRate);
+        if (m == 1)
+            baseGetRate = numRequests * 1.0 * chunkSize / (1 << 20) / elapsed;
+
+        // delete
+        mytimer.start();
+        for (int r = 0; r < numRequests; r++) {
+            setChunks(chunks.data(), m, r, NULL, 0, checksum);
+            cm.deleteChunks(containerIds, chunks.data(), m);
+        }
+        elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        printf("  %-6s latency: %8.3lf ms\n", "delete", elapsed * 1e3 / numRequests);
+    }
+
+    free(data);
+
+    printf("End of Container Manager Benchmark\n");
+    printf("=================================\n");
+
+    return okay? 0 : 1;
+}
@@ -1,8 +1,12 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <stdio.h>
+#include <stdlib.h> // mkdtemp()
 #include <string.h>
+#include <unistd.h> // unlink()
+#include <sys/stat.h> // mkdir()
 #include <linux/limits.h>
+#include <boost/filesystem.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -31,6 +35,8 @@ extern "C" {
  * 8. Move chunks within containers
  * 9. Delete chunks in containers
  * 10. Check chunks existence
+ * 11. Put, revert, move and delete chunks in a segment container, and check the chunks after reopening the
+ *     container, with and without its checkpoint, and after compacting the segments holding the deletions
  *
  * Expect all operations to finish successfully
  *
@@ -41,6 +47,138 @@ extern "C" {
 #define NUM_CONTAINER Config::getInstance().getNumContainers()
 #define NUM_CHUNK (6)
 #define CHUNK_SIZE (1024)
+#define SEGMENT_TEST_CHUNK_SIZE (4096)
+
+/**
+ * Put, revert, move and delete chunks in a segment container, and check the chunks after reopening the container
+ *
+ * The container is reopened with its checkpoint, and without it, i.e., with the index rebuilt from the segments.
+ * Segments are set to hold three chunks each, so the segments holding the deletions can be compacted while the
+ * segment holding the deleted chunk stays.
+ *
+ * @return whether all checks pass
+ **/
+bool testSegmentContainer() {
+    const int chunkSize = SEGMENT_TEST_CHUNK_SIZE;
+    const unsigned char namespaceId = 1;
+
+    char dir[PATH_MAX] = "/tmp/segment_container_test_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        printf("Failed to create directory for segment container test\n");
+        return false;
+    }
+    std::string checkpointPath = std::string(dir) + "/index";
+
+    SegmentOptions options;
+    options.segmentSize = chunkSize * 4;
+    options.compactionThreshold = 50;
+
+    boost::uuids::basic_random_generator<boost::mt19937> gen;
+    boost::uuids::uuid fuuid = gen();
+
+    // fill chunk i with byte c
+    auto setChunk = [&](Chunk &chunk, int i, char c) {
+        chunk.setId(namespaceId, fuuid, i);
+        chunk.size = chunkSize;
+        chunk.data = (unsigned char *) malloc(chunkSize);
+        memset(chunk.data, c, chunkSize);
+        chunk.computeChecksum();
+    };
+    auto putChunk = [&](Container *sc, int i, char c) {
+        Chunk chunk;
+        setChunk(chunk, i, c);
+        bool success = sc->putChunk(chunk);
+        if (!success)
+            printf("Failed to put chunk %d to segment container\n", i);
+        return success;
+    };
+    auto deleteChunk = [&](Container *sc, int i) {
+        Chunk chunk;
+        chunk.setId(namespaceId, fuuid, i);
+        bool success = sc->deleteChunk(chunk);
+        if (!success)
+            printf("Failed to delete chunk %d in segment container\n", i);
+        return success;
+    };
+    // check whether chunk i is filled with byte c, or does not exist if c is 0
+    auto checkChunk = [&](Container *sc, int i, char c) {
+        Chunk chunk;
+        chunk.setId(namespaceId, fuuid, i);
+        bool found = sc->getChunk(chunk, /* skipVerification */ true);
+        bool matched = found == (c != 0);
+        for (int j = 0; found && matched && j < chunkSize; j++)
+            matched = chunk.size == chunkSize && chunk.data[j] == c;
+        if (!matched)
+            printf("Chunk %d in segment container mismatches, expect %s\n", i, c? std::string(1, c).c_str() : "none");
+        return matched;
+    };
+
+    bool okay = true;
+    SegmentContainer *sc = new SegmentContainer(0, dir, /* capacity */ 1UL << 30, options);
+
+    // chunk 0: put and revert an overwrite; chunk 1: deleted; chunk 2: moved to chunk 3; chunk 4: kept
+    okay = okay && putChunk(sc, 0, 'A') && putChunk(sc, 1, 'B') && putChunk(sc, 2, 'C') && putChunk(sc, 4, 'E');
+    if (okay) {
+        Chunk overwrite;
+        setChunk(overwrite, 0, 'a');
+        okay = sc->putChunk(overwrite) && checkChunk(sc, 0, 'a') && sc->revertChunk(overwrite);
+        if (!okay)
+            printf("Failed to overwrite and revert chunk 0 in segment container\n");
+    }
+    okay = okay && deleteChunk(sc, 1);
+    if (okay) {
+        Chunk src, dst;
+        src.setId(namespaceId, fuuid, 2);
+        dst.setId(namespaceId, fuuid, 3);
+        okay = sc->moveChunk(src, dst);
+        if (!okay)
+            printf("Failed to move chunk 2 to chunk 3 in segment container\n");
+    }
+    auto checkChunks = [&](Container *sc) {
+        return checkChunk(sc, 0, 'A') && checkChunk(sc, 1, 0) && checkChunk(sc, 2, 0) && checkChunk(sc, 3, 'C') && checkChunk(sc, 4, 'E');
+    };
+    okay = okay && checkChunks(sc);
+    if (okay)
+        printf("> Put, revert, move and delete chunks in segment container\n");
+
+    // reopen with the checkpoint, and without it
+    delete sc;
+    sc = new SegmentContainer(0, dir, /* capacity */ 1UL << 30, options);
+    okay = okay && checkChunks(sc);
+    delete sc;
+    unlink(checkpointPath.c_str());
+    sc = new SegmentContainer(0, dir, /* capacity */ 1UL << 30, options);
+    okay = okay && checkChunks(sc);
+    if (okay)
+        printf("> Reopen segment container with and without checkpoint\n");
+
+    // fill the first segment with chunks 5 to 7, and delete chunk 5 in the next segment after chunk 8
+    delete sc;
+    boost::filesystem::remove_all(dir);
+    mkdir(dir, 0755);
+    sc = new SegmentContainer(0, dir, /* capacity */ 1UL << 30, options);
+    for (int i = 5; i < 9 && okay; i++)
+        okay = putChunk(sc, i, 'a' + i);
+    okay = okay && deleteChunk(sc, 5);
+    // leave the segments after it with little live data, and compact them
+    for (int i = 9; i < 16 && okay; i++)
+        okay = putChunk(sc, i, 'a' + i) && deleteChunk(sc, i);
+    if (okay && sc->compact() <= 0) {
+        printf("Failed to compact segments in segment container\n");
+        okay = false;
+    }
+    delete sc;
+    unlink(checkpointPath.c_str());
+    sc = new SegmentContainer(0, dir, /* capacity */ 1UL << 30, options);
+    okay = okay && checkChunk(sc, 5, 0) && checkChunk(sc, 6, 'g') && checkChunk(sc, 7, 'h') && checkChunk(sc, 8, 'i') && checkChunk(sc, 9, 0);
+    if (okay)
+        printf("> Reopen segment container without checkpoint after compaction\n");
+
+    delete sc;
+    boost::filesystem::remove_all(dir);
+
+    return okay;
+}
 
 int main(int argc, char **argv) {
     Config &config = Config::getInstance();
@@ -95,6 +233,9 @@ int main(int argc, char **argv) {
         case ContainerType::FS_CONTAINER:
             c[i] = new FsContainer(i, cstr.c_str(), capacity);
             break;
+        case ContainerType::SEGMENT_CONTAINER:
+            c[i] = new SegmentContainer(i, cstr.c_str(), capacity);
+            break;
         case ContainerType::AWS_CONTAINER:
             c[i] = new AwsContainer(cid, cstr, region, keyId, key, capacity, "", proxyIP, proxyPort);
             break;
@@ -136,7 +277,7 @@ int main(int argc, char **argv) {
         chunks[i].size = chunkSize;
         chunks[i].data = (unsigned char *) malloc (chunkSize * sizeof(unsigned char));
         memset(chunks[i].data, 'a'+i, chunkSize);
-        chunks[i].computeMD5();
+        chunks[i].computeChecksum();
         if (c[i % NUM_CONTAINER]->putChunk(chunks[i]) == false) {
             printf("Failed to put chunk\n");
             okay = false;
@@ -155,7 +296,7 @@ int main(int argc, char **argv) {
             chunks[i + NUM_CHUNK].size = chunkSize;
             chunks[i + NUM_CHUNK].data = (unsigned char *) malloc (chunkSize * sizeof(unsigned char));
             memset(chunks[i + NUM_CHUNK].data, 'b'+i, chunkSize);
-            chunks[i + NUM_CHUNK].computeMD5();
+            chunks[i + NUM_CHUNK].computeChecksum();
             if (c[i % NUM_CONTAINER]->putChunk(chunks[i + NUM_CHUNK]) == false) {
                 printf("Failed to put chunk %d/%d for revert test\n", i + NUM_CHUNK, NUM_CHUNK);
                 okay = false;
@@ -165,7 +306,7 @@ int main(int argc, char **argv) {
         // get chunks
         for (int i = 0; i < NUM_CHUNK && okay; i++) {
             chunks[i + NUM_CHUNK * 2].setId(namespaceId, fileuuid[i / NUM_CONTAINER], i % NUM_CONTAINER);
-            memcpy(chunks[i + NUM_CHUNK * 2].md5, chunks[i + NUM_CHUNK].md5, MD5_DIGEST_LENGTH);
+            chunks[i + NUM_CHUNK * 2].copyChecksum(chunks[i + NUM_CHUNK]);
             if (c[i % NUM_CONTAINER]->getChunk(chunks[i + NUM_CHUNK * 2]) == false) {
                 printf("Failed to get chunk for revert test\n");
                 okay = false;
@@ -206,8 +347,8 @@ int main(int argc, char **argv) {
     // get chunks
     for (int i = 0; i < NUM_CHUNK && okay; i++) {
         chunks[i + NUM_CHUNK].setId(namespaceId, fileuuid[i / NUM_CONTAINER], i % NUM_CONTAINER);
-        // copy the md5 checksum for verification
-        memcpy(chunks[i + NUM_CHUNK].md5, chunks[i].md5, MD5_DIGEST_LENGTH);
+        // copy the checksum for verification
+        chunks[i + NUM_CHUNK].copyChecksum(chunks[i]);
         if (c[i % NUM_CONTAINER]->getChunk(chunks[i + NUM_CHUNK]) == false) {
             printf("Failed to get chunk\n");
             okay = false;
@@ -257,8 +398,8 @@ int main(int argc, char **argv) {
             okay = false;
             break;
         }
-        // copy the md5 checksum for verification
-        memcpy(chunks[i + NUM_CHUNK * 2].md5, chunks[i + NUM_CHUNK].md5, MD5_DIGEST_LENGTH);
+        // copy the checksum for verification
+        chunks[i + NUM_CHUNK * 2].copyChecksum(chunks[i + NUM_CHUNK]);
         if (c[i % NUM_CONTAINER]->getChunk(chunks[i + NUM_CHUNK * 2]) == false || memcmp(chunks[i].data, chunks[i + NUM_CHUNK * 2].data, chunkSize) != 0) {
             printf("Chunk content mismatch\n");
             okay = false;
@@ -298,8 +439,8 @@ int main(int argc, char **argv) {
             okay = false;
             break;
         }
-        // copy the md5 checksum for verification
-        memcpy(chunks[i + NUM_CHUNK * 3].md5, chunks[i].md5, MD5_DIGEST_LENGTH);
+        // copy the checksum for verification
+        chunks[i + NUM_CHUNK * 3].copyChecksum(chunks[i]);
         if (c[i % NUM_CONTAINER]->getChunk(chunks[i + NUM_CHUNK * 3]) == false || memcmp(chunks[i].data, chunks[i + NUM_CHUNK * 3].data, chunkSize) != 0) {
             printf("Chunk content mismatch\n");
             okay = false;
@@ -336,6 +477,9 @@ int main(int argc, char **argv) {
         printf("> Check chunk %s no longer exists\n", chunks[i + NUM_CHUNK].getChunkName().c_str());
     }
 
+    // check segment container recovery
+    okay = okay && testSegmentContainer();
+
     // release resources 
     for (int i = 0; i < NUM_CONTAINER; i++) {
         delete c[i];
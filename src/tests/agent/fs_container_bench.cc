@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h> // atoi(), atol(), rand()
+#include <string.h> // memcmp(), strcmp()
+
+#include <string>
+#include <vector>
+
+#include <boost/timer/timer.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <glog/logging.h>
+
+#include "../../common/config.hh"
+#include "../../ds/chunk.hh"
+#include "../../agent/container/fs.hh"
+#include "bench_util.hh"
+
+/**
+ * FS container benchmark
+ *
+ * Put, get, and delete chunks in a container on local file system concurrently, using POSIX I/O, io_uring, and
+ * io_uring with direct I/O, each with and without group commit, and report the MB/s and IOPS of put and get for
+ * each chunk size. Chunks read back are compared with those written. Data is synced on put if flush_on_close is
+ * set in agent.ini, which group commit applies to.
+ *
+ * Usage: ./fs_container_bench [directory] [number of chunks] [number of threads] [chunk size in bytes ...]
+ **/
+
+#define BENCH_DEFAULT_DIR "/tmp/fs_container_bench"
+#define BENCH_DEFAULT_NUM_CHUNKS (256)
+#define BENCH_DEFAULT_NUM_THREADS (4)
+
+static const length_t defaultChunkSizes[] = { 4 << 10, 64 << 10, 1 << 20, 4 << 20 };
+
+/**
+ * I/O engine setting to benchmark
+ **/
+struct EngineSetting {
+    int engine;          /**< I/O engine, see FsIOEngine */
+    bool directIO;       /**< whether to bypass the page cache */
+    bool groupCommit;    /**< whether to sync the writes in groups */
+};
+
+static const EngineSetting engineSettings[] = {
+    { FsIOEngine::FS_IO_POSIX, false, false },
+    { FsIOEngine::FS_IO_POSIX, false, true },
+    { FsIOEngine::FS_IO_URING, false, false },
+    { FsIOEngine::FS_IO_URING, false, true },
+    { FsIOEngine::FS_IO_URING, true, false },
+    { FsIOEngine::FS_IO_URING, true, true }
+};
+
+void usage(char *prg) {
+    fprintf(stderr, "%s [directory] [number of chunks] [number of threads] [chunk size in bytes ...]\n", prg);
+    exit(1);
+}
+
+/**
+ * Benchmark put and get of chunks of a size in a container
+ *
+ * @return whether all operations succeed
+ **/
+bool benchContainer(FsContainer &container, const EngineSetting &setting, length_t chunkSize, int numChunks, int numThreads) {
+    // the engine in use, after falling back to POSIX I/O if io_uring is not available
+    int engine = container.getIOEngine();
+    bool directIO = engine == FsIOEngine::FS_IO_URING && setting.directIO;
+    unsigned long int numCommits = 0, numWrites = 0, numCommitsBefore = 0, numWritesBefore = 0;
+    bool groupCommit = container.getGroupCommitStats(numCommitsBefore, numWritesBefore);
+
+    unsigned char *data = (unsigned char *) malloc(chunkSize);
+    if (data == NULL) {
+        fprintf(stderr, "Failed to allocate memory for chunk data\n");
+        return false;
+    }
+    for (length_t i = 0; i < chunkSize; i++)
+        data[i] = rand() % 256;
+
+    // chunks referencing the same data
+    std::vector<Chunk> chunks(numChunks);
+    boost::uuids::random_generator gen;
+    for (int i = 0; i < numChunks; i++) {
+        chunks.at(i).setId(1, gen(), 0);
+        chunks.at(i).fileVersion = 0;
+        chunks.at(i).size = chunkSize;
+        chunks.at(i).data = data;
+        chunks.at(i).freeData = false;
+        chunks.at(i).computeChecksum();
+    }
+
+    // put, with the checksums trusted to skip reading the chunks back
+    double putTime = runConcurrently(0, numChunks, numThreads, [&](int i) {
+        return container.putChunk(chunks.at(i), /* trust checksum */ true);
+    });
+
+    // get, with the data compared instead of verifying the checksums
+    double getTime = putTime < 0? -1 : runConcurrently(0, numChunks, numThreads, [&](int i) {
+        Chunk readChunk;
+        readChunk.copyMeta(chunks.at(i));
+        readChunk.data = NULL;
+        readChunk.size = 0;
+        readChunk.freeData = true;
+        bool okay = container.getChunk(readChunk, /* skip verification */ true);
+        if (okay && (readChunk.size != (int) chunkSize || memcmp(readChunk.data, data, chunkSize) != 0)) {
+            fprintf(stderr, "Chunk %d read back mismatches the one written\n", i);
+            okay = false;
+        }
+        return okay;
+    });
+
+    container.getGroupCommitStats(numCommits, numWrites);
+    for (int i = 0; i < numChunks; i++)
+        container.deleteChunk(chunks.at(i));
+    chunks.clear();
+    free(data);
+
+    if (putTime < 0 || getTime < 0) {
+        fprintf(stderr, "Failed to %s chunks of %u bytes using %s%s\n", putTime < 0? "put" : "get", chunkSize, FsIOEngineName[engine], directIO? " (direct)" : "");
+        return false;
+    }
+
+    double totalMB = chunkSize * 1.0 * numChunks / (1 << 20);
+    printf("  %-8s %-8s %-12s chunk=%8uB put: %9.2lf MB/s %9.0lf IOPS  get: %9.2lf MB/s %9.0lf IOPS"
+        , FsIOEngineName[engine]
+        , directIO? "direct" : "buffered"
+        , groupCommit? "group-commit" : "-"
+        , chunkSize
+        , totalMB / putTime
+        , numChunks / putTime
+        , totalMB / getTime
+        , numChunks / getTime
+    );
+    if (groupCommit && numCommits > numCommitsBefore)
+        printf("  (%.1lf writes/commit)", (numWrites - numWritesBefore) * 1.0 / (numCommits - numCommitsBefore));
+    printf("\n");
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        usage(argv[0]);
+    }
+
+    Config &config = Config::getInstance();
+    config.setConfigPath();
+
+    FLAGS_logtostderr = true;
+    FLAGS_minloglevel = google::ERROR;
+    google::InitGoogleLogging(argv[0]);
+
+    srand(12345);
+
+    std::string dir = argc > 1? argv[1] : BENCH_DEFAULT_DIR;
+    int numChunks = argc > 2? atoi(argv[2]) : BENCH_DEFAULT_NUM_CHUNKS;
+    int numThreads = argc > 3? atoi(argv[3]) : BENCH_DEFAULT_NUM_THREADS;
+    if (numChunks <= 0 || numThreads <= 0)
+        usage(argv[0]);
+
+    std::vector<length_t> chunkSizes;
+    for (int i = 4; i < argc; i++) {
+        long int size = atol(argv[i]);
+        if (size <= 0) {
+            fprintf(stderr, "Invalid chunk size %s\n", argv[i]);
+            usage(argv[0]);
+        }
+        chunkSizes.push_back(size);
+    }
+    if (chunkSizes.empty())
+        chunkSizes.assign(defaultChunkSizes, defaultChunkSizes + sizeof(defaultChunkSizes) / sizeof(length_t));
+
+    printf("Start FS Container Benchmark\n");
+    printf("============================\n");
+    printf("Directory = %s, %d chunks, %d threads, sync on put = %s\n", dir.c_str(), numChunks, numThreads, config.getAgentFlushOnClose()? "true" : "false");
+
+    bool okay = true;
+    for (size_t e = 0; e < sizeof(engineSettings) / sizeof(EngineSetting) && okay; e++) {
+        const EngineSetting &setting = engineSettings[e];
+        FsIOOptions options;
+        options.engine = setting.engine;
+        options.queueDepth = config.getAgentFsIOQueueDepth();
+        options.directIO = setting.directIO;
+        options.groupCommit = setting.groupCommit;
+        options.groupCommitWindow = config.getAgentFsGroupCommitWindow();
+        options.groupCommitBatchSize = config.getAgentFsGroupCommitBatchSize();
+        FsContainer container(0, dir.c_str(), /* capacity */ 1UL << 40, options);
+        for (size_t s = 0; s < chunkSizes.size() && okay; s++)
+            okay = benchContainer(container, setting, chunkSizes.at(s), numChunks, numThreads);
+    }
+
+    printf("End of FS Container Benchmark\n");
+    printf("============================\n");
+
+    return okay? 0 : 1;
+}
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h> // atoi(), atol(), rand()
+#include <string.h> // memcmp(), strcmp()
+#include <sys/stat.h> // mkdir()
+#include <unistd.h> // unlink()
+
+#include <string>
+
+#include <boost/timer/timer.hpp>
+
+#include <glog/logging.h>
+
+#include "../../common/config.hh"
+#include "../../ds/chunk.hh"
+#include "../../agent/container/fs.hh"
+#include "../../agent/container/segment.hh"
+#include "bench_util.hh"
+
+/**
+ * Segment container benchmark
+ *
+ * Put, get, and delete many small chunks in a segment container and in an FS container, and report the rate of
+ * each operation, the time to update the usage, and the time to reopen the container (i.e., to load the index of a
+ * segment container, or the usage of an FS container). For an FS container, the time to reopen without the usage
+ * saved, which scans the directory, is also reported. Chunks read back and the usage are compared with those written. For the segment container, half of the chunks are deleted before compaction, and the space
+ * reclaimed is reported. Settings, e.g., flush_on_close and the segment size, are taken from agent.ini.
+ *
+ * Usage: ./segment_container_bench [directory] [number of chunks] [number of threads] [chunk size in bytes]
+ **/
+
+#define BENCH_DEFAULT_DIR "/tmp/segment_container_bench"
+#define BENCH_DEFAULT_NUM_CHUNKS (100000)
+#define BENCH_DEFAULT_NUM_THREADS (4)
+#define BENCH_DEFAULT_CHUNK_SIZE (4096)
+
+void usage(char *prg) {
+    fprintf(stderr, "%s [directory] [number of chunks] [number of threads] [chunk size in bytes]\n", prg);
+    exit(1);
+}
+
+/**
+ * Open a container of a type
+ **/
+Container *openContainer(int type, const std::string &dir) {
+    if (type == ContainerType::SEGMENT_CONTAINER)
+        return new SegmentContainer(0, dir.c_str(), /* capacity */ 1UL << 50);
+    return new FsContainer(0, dir.c_str(), /* capacity */ 1UL << 50);
+}
+
+void printRate(const char *op, double elapsed, int numOps) {
+    printf("  %-22s %9.3lfs %12.0lf ops/s\n", op, elapsed, numOps / elapsed);
+}
+
+bool checkUsage(Container *c, unsigned long int expected) {
+    unsigned long int usage = c->getUsage();
+    if (usage != expected)
+        fprintf(stderr, "Usage (%luB) mismatches the size of chunks written (%luB)\n", usage, expected);
+    return usage == expected;
+}
+
+/**
+ * Benchmark a container of a type
+ *
+ * @return whether all operations succeed
+ **/
+bool benchContainer(int type, const std::string &dir, int numChunks, int numThreads, length_t chunkSize) {
+    const char *typeName = type == ContainerType::SEGMENT_CONTAINER? "Segment" : "FS";
+    unsigned char *data = (unsigned char *) malloc(chunkSize);
+    if (data == NULL) {
+        fprintf(stderr, "Failed to allocate memory for chunk data\n");
+        return false;
+    }
+    for (length_t i = 0; i < chunkSize; i++)
+        data[i] = rand() % 256;
+
+    // all chunks have the same data and checksum
+    Chunk checksum;
+    checksum.data = data;
+    checksum.size = chunkSize;
+    checksum.freeData = false;
+    checksum.computeChecksum();
+
+    auto put = [&](Container *c, int i) {
+        Chunk chunk;
+        setChunk(chunk, i, data, chunkSize, checksum);
+        return c->putChunk(chunk, /* trust checksum */ true);
+    };
+    auto get = [&](Container *c, int i) {
+        Chunk chunk, readChunk;
+        setChunk(chunk, i, data, chunkSize, checksum);
+        readChunk.copyMeta(chunk);
+        readChunk.data = NULL;
+        readChunk.size = 0;
+        readChunk.freeData = true;
+        bool okay = c->getChunk(readChunk, /* skip verification */ true);
+        if (okay && (readChunk.size != (int) chunkSize || memcmp(readChunk.data, data, chunkSize) != 0)) {
+            fprintf(stderr, "Chunk %d read back mismatches the one written\n", i);
+            okay = false;
+        }
+        return okay;
+    };
+    auto del = [&](Container *c, int i) {
+        Chunk chunk;
+        setChunk(chunk, i, data, chunkSize, checksum);
+        return c->deleteChunk(chunk);
+    };
+
+    printf("%s container, %d chunks of %u bytes, %d threads\n", typeName, numChunks, chunkSize, numThreads);
+
+    bool okay = true;
+    double elapsed = 0;
+    Container *c = openContainer(type, dir);
+
+    // put and get
+    elapsed = runConcurrently(0, numChunks, numThreads, [&](int i) { return put(c, i); });
+    okay = elapsed >= 0;
+    if (okay)
+        printRate("put", elapsed, numChunks);
+    elapsed = okay? runConcurrently(0, numChunks, numThreads, [&](int i) { return get(c, i); }) : -1;
+    okay = elapsed >= 0;
+    if (okay)
+        printRate("get", elapsed, numChunks);
+
+    // usage update
+    if (okay) {
+        boost::timer::cpu_timer mytimer;
+        unsigned long int usage = c->getUsage(/* update now */ true);
+        printf("  %-22s %9.3lfs (usage = %luB)\n", "usage update", mytimer.elapsed().wall * 1.0 / 1e9, usage);
+        okay = checkUsage(c, (unsigned long int) numChunks * chunkSize);
+    }
+
+    // reopen and check that the chunks are all there
+    if (okay) {
+        delete c;
+        boost::timer::cpu_timer mytimer;
+        c = openContainer(type, dir);
+        printf("  %-22s %9.3lfs\n", "reopen", mytimer.elapsed().wall * 1.0 / 1e9);
+        okay = checkUsage(c, (unsigned long int) numChunks * chunkSize);
+    }
+
+    // reopen an FS container without the usage saved, as after a crash, so the usage is from a scan of the directory
+    if (okay && type == ContainerType::FS_CONTAINER) {
+        delete c;
+        unlink((dir + "/" + FS_USAGE_STATE_FILE).c_str());
+        boost::timer::cpu_timer mytimer;
+        c = openContainer(type, dir);
+        printf("  %-22s %9.3lfs\n", "reopen (scan)", mytimer.elapsed().wall * 1.0 / 1e9);
+        okay = checkUsage(c, (unsigned long int) numChunks * chunkSize);
+    }
+
+    if (okay) {
+        elapsed = runConcurrently(0, numChunks, numThreads, [&](int i) { return get(c, i); });
+        okay = elapsed >= 0;
+        if (okay)
+            printRate("get after reopen", elapsed, numChunks);
+    }
+
+    // delete half of the chunks, and compact the segments with the dead chunks
+    if (okay) {
+        elapsed = runConcurrently(0, numChunks / 2, numThreads, [&](int i) { return del(c, i); });
+        okay = elapsed >= 0;
+        if (okay)
+            printRate("delete", elapsed, numChunks / 2);
+        okay = okay && checkUsage(c, (unsigned long int) (numChunks - numChunks / 2) * chunkSize);
+    }
+    SegmentContainer *sc = dynamic_cast<SegmentContainer *>(c);
+    if (okay && sc) {
+        unsigned long int numSegments = 0, totalSize = 0, liveSize = 0;
+        sc->getSegmentStats(numSegments, totalSize, liveSize);
+        printf("  %-22s %lu segments, %luB in total, %luB live\n", "before compaction", numSegments, totalSize, liveSize);
+        boost::timer::cpu_timer mytimer;
+        int numCompacted = sc->compact();
+        elapsed = mytimer.elapsed().wall * 1.0 / 1e9;
+        sc->getSegmentStats(numSegments, totalSize, liveSize);
+        printf("  %-22s %9.3lfs (%d segments removed) %lu segments, %luB in total, %luB live\n", "compaction", elapsed, numCompacted, numSegments, totalSize, liveSize);
+        elapsed = runConcurrently(numChunks / 2, numChunks, numThreads, [&](int i) { return get(c, i); });
+        okay = elapsed >= 0;
+        if (okay)
+            printRate("get after compaction", elapsed, numChunks - numChunks / 2);
+    }
+
+    // clean up
+    runConcurrently(0, numChunks, numThreads, [&](int i) { return del(c, i); });
+    delete c;
+    free(data);
+
+    if (!okay)
+        fprintf(stderr, "Failed to benchmark %s container\n", typeName);
+
+    return okay;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        usage(argv[0]);
+    }
+
+    Config &config = Config::getInstance();
+    config.setConfigPath();
+
+    FLAGS_logtostderr = true;
+    FLAGS_minloglevel = google::ERROR;
+    google::InitGoogleLogging(argv[0]);
+
+    srand(12345);
+
+    std::string dir = argc > 1? argv[1] : BENCH_DEFAULT_DIR;
+    int numChunks = argc > 2? atoi(argv[2]) : BENCH_DEFAULT_NUM_CHUNKS;
+    int numThreads = argc > 3? atoi(argv[3]) : BENCH_DEFAULT_NUM_THREADS;
+    long int chunkSize = argc > 4? atol(argv[4]) : BENCH_DEFAULT_CHUNK_SIZE;
+    if (numChunks <= 0 || numThreads <= 0 || chunkSize <= 0)
+        usage(argv[0]);
+
+    mkdir(dir.c_str(), 0755);
+
+    printf("Start Segment Container Benchmark\n");
+    printf("=================================\n");
+    printf("Directory = %s, sync on put = %s, segment size = %luB\n", dir.c_str(), config.getAgentFlushOnClose()? "true" : "false", config.getAgentSegmentSize());
+
+    bool okay = benchContainer(ContainerType::SEGMENT_CONTAINER, dir + "/segment", numChunks, numThreads, chunkSize)
+        && benchContainer(ContainerType::FS_CONTAINER, dir + "/fs", numChunks, numThreads, chunkSize);
+
+    printf("End of Segment Container Benchmark\n");
+    printf("=================================\n");
+
+    return okay? 0 : 1;
+}
@@ -9,6 +9,7 @@
 #include <sys/mman.h>  // mmap()
 #include <sys/time.h>  // struct timeval, gettimeofday()
 #include <errno.h>
+#include <limits.h>    // ULONG_MAX
 
 #include <glib.h>
 #include <glib/gprintf.h>
@@ -35,6 +36,11 @@
 #define TEST_NUM_SPLIT_PER_GROUP   (2)
 #define HUMAN_BYTE_STRING_LEN      (128)
 #define TEST_NAMESPACE_ID          (-1)
+#define TEST_SEGMENT_LENGTH        (((unsigned long int) 1 << 20) + 4097)
+#define TEST_STREAM_NUM_STRIPES    (2)
+#define TEST_ASYNC_DEPTH           (8)
+#define TEST_ASYNC_NUM_FILES       (32)
+#define TEST_ASYNC_FILE_LENGTH     ((unsigned long int) 64 << 10)
 
 unsigned char data[TEST_FILE_LENGTH];
 int cached = 0;
@@ -502,6 +508,272 @@ int copy_test(char *sname, char *dname) {
     return 0;
 }
 
+double elapsed_ms(const struct timeval start, const struct timeval end) {
+    return (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_usec - start.tv_usec) / 1e3;
+}
+
+int stream_write_test(char *name) {
+    request_t req;
+    struct timeval start, first, end;
+    unsigned long int session_id = 0, sent = 0, accepted = 0;
+
+    gettimeofday(&start, NULL);
+
+    // open a write session
+    set_open_write_session_request(&req, name, TEST_FILE_CODING, TEST_NAMESPACE_ID);
+    if (send_request(&conn, &req) == ULONG_MAX) {
+        printf("> Failed to open write session!\n");
+        request_t_release(&req);
+        return -1;
+    }
+    session_id = req.session_id;
+    request_t_release(&req);
+
+    // send the file in segments not aligned to the stripes
+    for (sent = 0; sent < TEST_FILE_LENGTH; sent = accepted) {
+        unsigned long int length = TEST_FILE_LENGTH - sent < TEST_SEGMENT_LENGTH? TEST_FILE_LENGTH - sent : TEST_SEGMENT_LENGTH;
+        set_write_session_data_request(&req, session_id, data + sent, length);
+        accepted = send_request(&conn, &req);
+        request_t_release(&req);
+        if (accepted != sent + length) {
+            printf("> Failed to write data at offset %lu in write session, accepted = %lu!\n", sent, accepted);
+            set_abort_write_session_request(&req, session_id);
+            send_request(&conn, &req);
+            request_t_release(&req);
+            return -1;
+        }
+        if (sent == 0)
+            gettimeofday(&first, NULL);
+    }
+
+    // commit the write session
+    set_commit_write_session_request(&req, session_id);
+    if (send_request(&conn, &req) != TEST_FILE_LENGTH) {
+        printf("> Failed to commit write session, file size = %lu!\n", req.file.size);
+        request_t_release(&req);
+        return -1;
+    }
+    request_t_release(&req);
+
+    gettimeofday(&end, NULL);
+
+    // the time until the first stripe is stored at agents, and the peak memory usage, are in the proxy statistics
+    printf("> Complete test on streaming write, first segment accepted in %.3lf ms, file written in %.3lf ms (%.2lf MB/s).\n",
+            elapsed_ms(start, first),
+            elapsed_ms(start, end),
+            (TEST_FILE_LENGTH * 1.0 / (1 << 20)) / (elapsed_ms(start, end) / 1e3)
+    );
+
+    return 0;
+}
+
+int stream_write_abort_test(char *name) {
+    request_t req;
+    unsigned long int session_id = 0;
+
+    // open a write session and send some data
+    set_open_write_session_request(&req, name, TEST_FILE_CODING, TEST_NAMESPACE_ID);
+    if (send_request(&conn, &req) == ULONG_MAX) {
+        printf("> Failed to open write session!\n");
+        request_t_release(&req);
+        return -1;
+    }
+    session_id = req.session_id;
+    request_t_release(&req);
+
+    set_write_session_data_request(&req, session_id, data, TEST_SEGMENT_LENGTH * 4);
+    if (send_request(&conn, &req) != TEST_SEGMENT_LENGTH * 4) {
+        printf("> Failed to write data in write session!\n");
+        request_t_release(&req);
+        return -1;
+    }
+    request_t_release(&req);
+
+    // abort the session
+    set_abort_write_session_request(&req, session_id);
+    if (send_request(&conn, &req) == ULONG_MAX) {
+        printf("> Failed to abort write session!\n");
+        request_t_release(&req);
+        return -1;
+    }
+    request_t_release(&req);
+
+    // the session is gone after abort
+    set_commit_write_session_request(&req, session_id);
+    if (send_request(&conn, &req) != ULONG_MAX) {
+        printf("> Committed an aborted write session!\n");
+        request_t_release(&req);
+        return -1;
+    }
+    request_t_release(&req);
+
+    // the file is not written
+    set_buffered_file_read_request(&req, name, TEST_NAMESPACE_ID);
+    if (send_request(&conn, &req) != ULONG_MAX) {
+        printf("> Found the file of an aborted write session!\n");
+        free(req.file.data);
+        request_t_release(&req);
+        return -1;
+    }
+    request_t_release(&req);
+
+    printf("> Complete test on aborting streaming write.\n");
+    return 0;
+}
+
+typedef struct {
+    unsigned long int next_offset;     /**< offset of the next stripe expected */
+    unsigned long int stop_offset;     /**< offset to stop the read at */
+    struct timeval first;              /**< time when the first stripe arrives */
+} stream_read_state_t;
+
+int check_stream_read_data(const unsigned char *buf, unsigned long int offset, unsigned long int length, void *arg) {
+    stream_read_state_t *state = (stream_read_state_t *) arg;
+    if (offset == 0)
+        gettimeofday(&state->first, NULL);
+    if (offset != state->next_offset || offset + length > TEST_FILE_LENGTH || memcmp(data + offset, buf, length) != 0) {
+        printf("> Unexpected data at offset %lu (expected %lu) of length %lu in stream read\n", offset, state->next_offset, length);
+        return -1;
+    }
+    state->next_offset += length;
+    return state->next_offset >= state->stop_offset;
+}
+
+int stream_read_test(char *name) {
+    stream_read_state_t state;
+    struct timeval start, end;
+
+    // read the whole file as a stream of stripes
+    state.next_offset = 0;
+    state.stop_offset = ULONG_MAX;
+    gettimeofday(&start, NULL);
+    if (read_file_stream(&conn, name, TEST_NAMESPACE_ID, TEST_STREAM_NUM_STRIPES, check_stream_read_data, &state) != TEST_FILE_LENGTH || state.next_offset != TEST_FILE_LENGTH) {
+        printf("> Failed to read file in a stream, %lu bytes checked!\n", state.next_offset);
+        return -1;
+    }
+    gettimeofday(&end, NULL);
+
+    printf("> Complete test on streaming read, first stripe received in %.3lf ms, file read in %.3lf ms (%.2lf MB/s).\n",
+            elapsed_ms(start, state.first),
+            elapsed_ms(start, end),
+            (TEST_FILE_LENGTH * 1.0 / (1 << 20)) / (elapsed_ms(start, end) / 1e3)
+    );
+
+    // stop the read early from the callback
+    state.next_offset = 0;
+    state.stop_offset = 1;
+    if (read_file_stream(&conn, name, TEST_NAMESPACE_ID, TEST_STREAM_NUM_STRIPES, check_stream_read_data, &state) != ULONG_MAX || state.next_offset >= TEST_FILE_LENGTH) {
+        printf("> Failed to stop the stream read, %lu bytes checked!\n", state.next_offset);
+        return -1;
+    }
+
+    printf("> Complete test on stopping streaming read.\n");
+    return 0;
+}
+
+void count_async_completion(unsigned long int tag, request_t *req, unsigned long int result, void *arg) {
+    int *num_succeeded = (int *) arg;
+    if (result != ULONG_MAX)
+        (*num_succeeded)++;
+    else
+        printf("> Failed async request %lu on file %s\n", tag, req->file.filename.name);
+}
+
+// complete all requests in flight, and return the number of requests completed (-1 if failed)
+int wait_async_requests(ncloud_async_conn_t *aconn, request_completion_t *completions) {
+    int num_completed = 0;
+    while (aconn->num_inflight > 0) {
+        int ret = poll_requests(aconn, -1, completions? completions + num_completed : NULL, TEST_ASYNC_DEPTH);
+        if (ret < 0)
+            return -1;
+        num_completed += ret;
+    }
+    return num_completed;
+}
+
+int async_test(const char *ip, unsigned short port) {
+    ncloud_async_conn_t aconn;
+    request_t reqs[TEST_ASYNC_NUM_FILES];
+    request_completion_t completions[TEST_ASYNC_NUM_FILES];
+    char names[TEST_ASYNC_NUM_FILES][64];
+    int num_succeeded = 0, ret = 0;
+
+    if (ncloud_async_conn_t_init(ip, port, &aconn, TEST_ASYNC_DEPTH) != 0) {
+        printf("> Failed to connect for async requests!\n");
+        return -1;
+    }
+
+    // write files with callbacks, with at most TEST_ASYNC_DEPTH requests in flight
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES && ret == 0; i++) {
+        snprintf(names[i], 64, "%s.async.%d", TEST_FILE_NAME, i);
+        set_buffered_file_write_request(&reqs[i], names[i], TEST_ASYNC_FILE_LENGTH, data + i * TEST_ASYNC_FILE_LENGTH, TEST_FILE_CODING, TEST_NAMESPACE_ID);
+        if (aconn.num_inflight == TEST_ASYNC_DEPTH && poll_requests(&aconn, -1, NULL, 1) < 0)
+            ret = -1;
+        else if (submit_request(&aconn, &reqs[i], i, count_async_completion, &num_succeeded) != 0)
+            ret = -1;
+    }
+    if (ret == -1 || wait_async_requests(&aconn, NULL) < 0 || num_succeeded != TEST_ASYNC_NUM_FILES) {
+        printf("> Failed to write files with async requests, %d succeeded!\n", num_succeeded);
+        ncloud_async_conn_t_release(&aconn);
+        return -1;
+    }
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES; i++)
+        request_t_release(&reqs[i]);
+
+    // read the files back, and check the completions on poll
+    int num_completed = 0;
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES && ret == 0; i++) {
+        set_buffered_file_read_request(&reqs[i], names[i], TEST_NAMESPACE_ID);
+        if (aconn.num_inflight == TEST_ASYNC_DEPTH) {
+            int n = poll_requests(&aconn, -1, completions + num_completed, 1);
+            ret = n < 0? -1 : 0;
+            num_completed += n;
+        }
+        if (ret == 0 && submit_request(&aconn, &reqs[i], i, NULL, NULL) != 0)
+            ret = -1;
+    }
+    int n = ret == 0? wait_async_requests(&aconn, completions + num_completed) : -1;
+    if (n < 0 || num_completed + n != TEST_ASYNC_NUM_FILES) {
+        printf("> Failed to read files with async requests!\n");
+        ncloud_async_conn_t_release(&aconn);
+        return -1;
+    }
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES; i++) {
+        request_t *req = completions[i].request;
+        unsigned long int tag = completions[i].tag;
+        if (completions[i].result == ULONG_MAX || req != &reqs[tag] || req->file.size != TEST_ASYNC_FILE_LENGTH || memcmp(data + tag * TEST_ASYNC_FILE_LENGTH, req->file.data, TEST_ASYNC_FILE_LENGTH) != 0) {
+            printf("> Failed to read file %s back with async requests, file is corrupted!\n", names[tag]);
+            ret = -1;
+        }
+    }
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES; i++) {
+        free(reqs[i].file.data);
+        request_t_release(&reqs[i]);
+    }
+
+    // delete the files all at once
+    num_succeeded = 0;
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES; i += TEST_ASYNC_DEPTH) {
+        for (int j = i; j < i + TEST_ASYNC_DEPTH && j < TEST_ASYNC_NUM_FILES; j++) {
+            set_delete_file_request(&reqs[j], names[j], TEST_NAMESPACE_ID);
+            submit_request(&aconn, &reqs[j], j, count_async_completion, &num_succeeded);
+        }
+        wait_async_requests(&aconn, NULL);
+    }
+    if (num_succeeded != TEST_ASYNC_NUM_FILES) {
+        printf("> Failed to delete files with async requests, %d succeeded!\n", num_succeeded);
+        ret = -1;
+    }
+    for (int i = 0; i < TEST_ASYNC_NUM_FILES; i++)
+        request_t_release(&reqs[i]);
+
+    ncloud_async_conn_t_release(&aconn);
+
+    if (ret == 0)
+        printf("> Complete test on async requests.\n");
+    return ret;
+}
+
 int main() {
     // init file
     for (int i = 0; i < TEST_FILE_LENGTH; i++)
@@ -633,7 +905,42 @@ int main() {
         ncloud_conn_t_release(&conn);
         return -1;
     }
+    // write a file in a write session
+    if (stream_write_test(TEST_FILE_NAME_3) == -1) {
+        fprintf(stderr, "Streaming write test FAILED!\n");
+        ncloud_conn_t_release(&conn);
+        return -1;
+    }
+    // read the file written in a write session
+    if (read_test(TEST_FILE_NAME_3) == -1) {
+        fprintf(stderr, "Read test (streamed file) FAILED!\n");
+        ncloud_conn_t_release(&conn);
+        return -1;
+    }
+    // read the file in a read session
+    if (stream_read_test(TEST_FILE_NAME_3) == -1) {
+        fprintf(stderr, "Streaming read test FAILED!\n");
+        ncloud_conn_t_release(&conn);
+        return -1;
+    }
+    // pipeline requests over one connection
+    if (async_test(ip, port) == -1) {
+        fprintf(stderr, "Async request test FAILED!\n");
+        ncloud_conn_t_release(&conn);
+        return -1;
+    }
+    // abort a write session
+    if (stream_write_abort_test(TEST_FILE_NAME) == -1) {
+        fprintf(stderr, "Streaming write abort test FAILED!\n");
+        ncloud_conn_t_release(&conn);
+        return -1;
+    }
     // delete all files created
+    if (delete_test(TEST_FILE_NAME_3) == -1) {
+        fprintf(stderr, "Delete test (streamed file) FAILED!\n");
+        ncloud_conn_t_release(&conn);
+        return -1;
+    }
     if (delete_test(TEST_RENAME_FILE_NAME) == -1) {
         fprintf(stderr, "Delete test (renamed file) FAILED!\n");
         ncloud_conn_t_release(&conn);
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <pthread.h> // pthread_*()
+#include <stdio.h> // printf()
+#include <stdlib.h> // atoi()
+#include <string.h> // memset()
+#include <boost/timer/timer.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <glog/logging.h>
+#include <zmq.hpp>
+
+#include "../../common/define.hh"
+#include "../../common/io.hh"
+#include "../../ds/chunk_event.hh"
+
+/**
+ * Chunk message benchmark
+ *
+ * Benchmark flow
+ * For each chunk size from 1MiB to 64MiB, and for copying and zero-copy chunk data,
+ * 1. Send put chunk requests with one chunk each from a sender thread
+ * 2. Receive the requests in a receiver thread
+ *    - Expect the chunk size and content received to match
+ * Printing of the throughput in GB/s, and in GB/s per core (of CPU time spent by both threads)
+ *
+ * Usage: ./chunk_message_bench [number of messages per chunk size] [socket address]
+ **/
+
+#define DEFAULT_NUM_MSGS     (64)
+#define DEFAULT_ADDRESS      "inproc://chunk_message_bench"
+#define MIN_CHUNK_SIZE       (1 << 20)
+#define MAX_CHUNK_SIZE       (64 << 20)
+#define NUM_BUFFERS          (4)
+
+struct ReceiverArg {
+    zmq::socket_t *socket;
+    int numMsgs;
+    int chunkSize;
+    bool zeroCopy;
+    bool okay;
+};
+
+/**
+ * Receive put chunk requests, and copy the chunk data out of the message buffers unless using zero-copy
+ *
+ * @param arg pointer to a ReceiverArg structure, with okay set to whether all requests are received intact on return
+ * @return NULL
+ **/
+static void *runReceiver(void *arg) {
+    ReceiverArg &receiver = *((ReceiverArg *) arg);
+    bool okay = true;
+
+    for (int i = 0; i < receiver.numMsgs; i++) {
+        ChunkEvent event;
+        if (IO::getChunkEventMessage(*receiver.socket, event) == 0 || event.numChunks != 1) {
+            printf("> Failed to receive message %d\n", i);
+            okay = false;
+            continue;
+        }
+        Chunk chunk;
+        if (receiver.zeroCopy) {
+            chunk.move(event.chunks[0]);
+        } else if (!chunk.copy(event.chunks[0])) {
+            printf("> Failed to allocate memory for chunk data of message %d\n", i);
+            okay = false;
+            continue;
+        }
+        unsigned char mark = i % NUM_BUFFERS;
+        if (chunk.size != receiver.chunkSize || chunk.data[0] != mark || chunk.data[chunk.size - 1] != mark) {
+            printf("> Chunk data of message %d mismatched\n", i);
+            okay = false;
+        }
+    }
+
+    receiver.okay = okay;
+    return NULL;
+}
+
+/**
+ * Send put chunk requests from the calling thread to a receiver thread
+ *
+ * @return whether all requests are received intact
+ **/
+static bool runMessages(zmq::socket_t &sender, zmq::socket_t &receiver, unsigned char **buffers, int numMsgs, int chunkSize, bool zeroCopy, double &throughput, double &throughputPerCore) {
+    boost::uuids::basic_random_generator<boost::mt19937> gen;
+    boost::uuids::uuid fileuuid = gen();
+    IO::ZeroCopyTracker tracker;
+    ReceiverArg arg = { &receiver, numMsgs, chunkSize, zeroCopy, false };
+    pthread_t rt;
+
+    // mark the buffers, which remain unchanged until all messages are received
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+        buffers[i][0] = (unsigned char) i;
+        buffers[i][chunkSize - 1] = (unsigned char) i;
+    }
+
+    boost::timer::cpu_timer mytimer;
+
+    pthread_create(&rt, NULL, runReceiver, &arg);
+
+    for (int i = 0; i < numMsgs; i++) {
+        ChunkEvent event;
+        event.id = i;
+        event.opcode = Opcode::PUT_CHUNK_REQ;
+        event.numChunks = 1;
+        event.chunks = new Chunk[1];
+        event.containerIds = new int[1];
+        event.containerIds[0] = 0;
+        event.chunks[0].setId(1, fileuuid, i);
+        event.chunks[0].size = chunkSize;
+        event.chunks[0].data = buffers[i % NUM_BUFFERS];
+        event.chunks[0].freeData = false;
+        if (IO::sendChunkEventMessage(sender, event, zeroCopy? &tracker : NULL) == 0) {
+            printf("> Failed to send message %d\n", i);
+            break;
+        }
+    }
+
+    pthread_join(rt, NULL);
+    // the buffers are reused by the next round
+    tracker.wait();
+
+    boost::timer::cpu_times duration = mytimer.elapsed();
+    double bytes = 1.0 * numMsgs * chunkSize;
+    throughput = bytes / duration.wall;
+    // CPU time below the timer resolution is not measurable
+    throughputPerCore = duration.user + duration.system > 0? bytes / (duration.user + duration.system) : -1;
+
+    return arg.okay;
+}
+
+int main(int argc, char **argv) {
+    int numMsgs = argc > 1? atoi(argv[1]) : DEFAULT_NUM_MSGS;
+    std::string address = argc > 2? argv[2] : DEFAULT_ADDRESS;
+    if (numMsgs <= 0) {
+        printf("Usage: %s [number of messages per chunk size] [socket address]\n", argv[0]);
+        return 1;
+    }
+
+    FLAGS_logtostderr = true;
+    FLAGS_minloglevel = 1;
+    google::InitGoogleLogging(argv[0]);
+
+    printf("Start Chunk Message Benchmark\n");
+    printf("========================\n");
+    printf("> %d messages per chunk size over %s\n", numMsgs, address.c_str());
+
+    zmq::context_t cxt(1);
+    zmq::socket_t receiver(cxt, ZMQ_PAIR);
+    zmq::socket_t sender(cxt, ZMQ_PAIR);
+    try {
+        // never hang on lost messages
+        receiver.setsockopt(ZMQ_RCVTIMEO, 10000);
+        receiver.bind(address);
+        sender.connect(address);
+    } catch (zmq::error_t &e) {
+        printf("Failed to set up sockets at %s, %s\n", address.c_str(), e.what());
+        return 1;
+    }
+
+    // messages take turns to send the buffers, which zero-copy sends may share
+    unsigned char *buffers[NUM_BUFFERS];
+    for (int i = 0; i < NUM_BUFFERS; i++) {
+        buffers[i] = (unsigned char *) malloc (MAX_CHUNK_SIZE);
+        if (buffers[i] == NULL) {
+            printf("Failed to allocate memory for chunk data\n");
+            return 1;
+        }
+        memset(buffers[i], 'a', MAX_CHUNK_SIZE);
+    }
+
+    bool okay = true;
+    for (int chunkSize = MIN_CHUNK_SIZE; chunkSize <= MAX_CHUNK_SIZE && okay; chunkSize <<= 1) {
+        for (int zeroCopy = 0; zeroCopy < 2 && okay; zeroCopy++) {
+            double throughput = 0, throughputPerCore = 0;
+            const char *mode = zeroCopy? "zero-copy" : "copy";
+            if (!runMessages(sender, receiver, buffers, numMsgs, chunkSize, zeroCopy, throughput, throughputPerCore)) {
+                printf("> [%2dMiB] Failed (%s)\n", chunkSize >> 20, mode);
+                okay = false;
+                break;
+            }
+            if (throughputPerCore < 0)
+                printf("> [%2dMiB] %6.2lf GB/s, CPU time not measurable (%s)\n", chunkSize >> 20, throughput, mode);
+            else
+                printf("> [%2dMiB] %6.2lf GB/s, %6.2lf GB/s per core (%s)\n", chunkSize >> 20, throughput, throughputPerCore, mode);
+        }
+    }
+
+    for (int i = 0; i < NUM_BUFFERS; i++)
+        free(buffers[i]);
+
+    sender.close();
+    receiver.close();
+    cxt.close();
+
+    printf("End of Chunk Message Benchmark\n");
+    printf("========================\n");
+
+    return okay? 0 : 1;
+}
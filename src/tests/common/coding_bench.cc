@@ -0,0 +1,716 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h> // fprintf()
+#include <stdlib.h> // exit(), rand(), malloc()
+#include <string.h> // memset()
+
+#include <algorithm> // std::min(), std::max()
+#include <atomic>
+#include <new>     // std::bad_alloc
+#include <string>
+#include <thread>  // std::thread::hardware_concurrency()
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <boost/timer/timer.hpp>
+
+#include "../../common/config.hh"
+
+#include "../../common/coding/coding.hh"
+#include "../../common/coding/coding_util.hh"
+#include "../../common/coding/decoding_plan.hh"
+#include "../../common/coding/all.hh"
+#include "../../common/coding/coding_generator.hh"
+#include "../../common/coding/decoding_table_cache.hh"
+#include "../../common/coding/parallel_coding.hh"
+
+#define BENCH_MIN_TIME (0.2)           // min. time (in seconds) to repeat each operation
+#define BENCH_MIN_ITERATIONS (3)       // min. number of times to repeat each operation
+#define BENCH_NUM_CODES (4)            // number of (n, k) pairs to sweep
+#define BENCH_DEGRADED_READ_CHUNK_SIZE (4 << 10)  // small chunks for degraded reads, where setting up the decoding tables matters
+#define BENCH_PARALLEL_CODING_CHUNK_SIZE ((16 << 20) + 1000)  // large chunks, with a partial last slice, for parallel coding
+#define BENCH_PARALLEL_CODING_MAX_THREADS (16)  // max. number of coding threads to sweep
+#define BENCH_NUM_PARALLEL_CODES (2)   // number of (n, k) pairs to sweep for parallel coding
+#define BENCH_FUSED_CHECKSUM_CHUNK_SIZE (4 << 20)  // chunk size for encoding with and without fused checksums
+#define BENCH_CHECKSUM_MIN_SIZE (4 << 10)   // smallest chunk size for checksums
+#define BENCH_CHECKSUM_MAX_SIZE (16 << 20)  // largest chunk size for checksums
+
+static const coding_param_t codingParams[BENCH_NUM_CODES][2] = { { 6, 4 }, { 9, 6 }, { 12, 8 }, { 16, 12 } };
+static const coding_param_t parallelCodingParams[BENCH_NUM_PARALLEL_CODES][2] = { { 9, 6 }, { 12, 8 } };
+static const length_t defaultChunkSizes[] = { 4 << 10, 64 << 10, 1 << 20, 4 << 20 };
+
+// count the calls to the memory allocation functions, which are wrapped at link time (--wrap), and operator new
+static std::atomic<unsigned long int> numAllocs(0);
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+int __real_posix_memalign(void **ptr, size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    numAllocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+    numAllocs++;
+    return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    numAllocs++;
+    return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t alignment, size_t size) {
+    numAllocs++;
+    return __real_posix_memalign(ptr, alignment, size);
+}
+}
+
+void *operator new(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept {
+    free(ptr);
+}
+
+void usage(char *prg) {
+    fprintf(stderr, "%s [output file, - for stdout] [chunk size in bytes ...]\n", prg);
+    exit(1);
+}
+
+/**
+ * Result of benchmarking an operation
+ **/
+struct BenchResult {
+    std::string op;                  /**< operation */
+    std::string coding;              /**< coding scheme */
+    std::string checksum;            /**< checksum type */
+    coding_param_t n;                /**< coding parameter n */
+    coding_param_t k;                /**< coding parameter k */
+    length_t chunkSize;              /**< chunk size */
+    int erasures;                    /**< number of failed chunks */
+    int threads;                     /**< number of coding threads */
+    unsigned long int bytesPerOp;    /**< bytes of chunk data processed per operation */
+    unsigned long int iterations;    /**< number of times the operation is repeated */
+    double nsPerOp;                  /**< average time per operation in nanoseconds */
+    double cpuNsPerOp;               /**< average CPU time (user and system, over all threads) per operation in nanoseconds */
+    double allocsPerOp;              /**< average number of memory allocations per operation */
+
+    double getThroughput() const {
+        return bytesPerOp / nsPerOp;
+    }
+};
+
+/**
+ * Repeat an operation (after a warm-up run) for at least BENCH_MIN_TIME seconds and BENCH_MIN_ITERATIONS times
+ *
+ * @param[in,out] result    result with the operation described, to fill in the measurements
+ * @param[in] op            operation to benchmark
+ *
+ * @return whether all runs of the operation succeed
+ **/
+template <typename Op>
+bool bench(BenchResult &result, Op op) {
+    if (!op())
+        return false;
+
+    boost::timer::cpu_timer mytimer;
+    unsigned long int allocs = numAllocs;
+    unsigned long int iterations = 0;
+    double elapsed = 0;
+    boost::timer::cpu_times duration;
+
+    mytimer.start();
+    do {
+        if (!op())
+            return false;
+        iterations++;
+        duration = mytimer.elapsed();
+        elapsed = duration.wall * 1.0 / 1e9;
+    } while (elapsed < BENCH_MIN_TIME || iterations < BENCH_MIN_ITERATIONS);
+
+    result.threads = ParallelCoding::getInstance().getNumThreads();
+    result.iterations = iterations;
+    result.nsPerOp = elapsed * 1e9 / iterations;
+    result.cpuNsPerOp = (duration.user + duration.system) * 1.0 / iterations;
+    result.allocsPerOp = (numAllocs - allocs) * 1.0 / iterations;
+
+    fprintf(stderr, "  %-22s %-10s %-6s n=%2d k=%2d chunk=%8uB erasures=%d threads=%2d: %8.3lf GB/s %12.0lf ns/op %12.0lf cpu ns/op %6.2lf allocs/op\n"
+        , result.op.c_str()
+        , result.coding.c_str()
+        , result.checksum.c_str()
+        , result.n
+        , result.k
+        , result.chunkSize
+        , result.erasures
+        , result.threads
+        , result.getThroughput()
+        , result.nsPerOp
+        , result.cpuNsPerOp
+        , result.allocsPerOp
+    );
+
+    return true;
+}
+
+/**
+ * Benchmark RS encoding, decoding (without and with erasures), CAR repair, and partial encoding at agents for a (n, k) pair and chunk size
+ **/
+bool benchRS(coding_param_t n, coding_param_t k, length_t chunkSize, std::vector<BenchResult> &results) {
+    CodingOptions options;
+    options.setN(n);
+    options.setK(k);
+    Coding *code = CodingGenerator::genCoding(CodingScheme::RS, options);
+    options.setRepairUsingCAR();
+    Coding *carCode = CodingGenerator::genCoding(CodingScheme::RS, options);
+    if (code == NULL || carCode == NULL) {
+        fprintf(stderr, "Failed to init RS codes with n=%d k=%d\n", n, k);
+        delete code;
+        delete carCode;
+        return false;
+    }
+
+    length_t dataSize = chunkSize * k;
+    data_t *data = NULL, *output = NULL;
+    std::vector<Chunk> stripe;
+    bool okay = posix_memalign((void **) &data, 64, dataSize) == 0 && posix_memalign((void **) &output, 64, dataSize) == 0;
+    for (length_t i = 0; okay && i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    BenchResult result;
+    result.coding = CodingSchemeName[CodingScheme::RS];
+    result.n = n;
+    result.k = k;
+    result.chunkSize = chunkSize;
+
+    // encode, referencing the data chunks to the data buffer as the proxy does for foreground writes
+    result.op = "encode";
+    result.erasures = 0;
+    result.bytesPerOp = dataSize;
+    okay = okay && bench(result, [&]() {
+        return code->encode(data, dataSize, stripe, NULL, /* shadow data chunks */ true);
+    });
+    if (okay)
+        results.push_back(result);
+
+    // decode the data chunks (full decode) and after losing the first few data chunks (degraded decode), planning included as for a read
+    for (int e = 0; e <= n - k && okay; e++) {
+        std::vector<chunk_id_t> failedChunks;
+        for (int i = 0; i < e; i++)
+            failedChunks.push_back(i);
+        std::vector<Chunk> input(k);
+        for (int i = 0; i < k; i++) {
+            input.at(i).copyMeta(stripe.at(e + i));
+            input.at(i).data = stripe.at(e + i).data;
+            input.at(i).freeData = false;
+        }
+
+        result.op = e == 0? "decode" : "degraded_decode";
+        result.erasures = e;
+        result.bytesPerOp = dataSize;
+        okay = bench(result, [&]() {
+            DecodingPlan plan;
+            length_t decodedSize = 0;
+            return code->preDecode(failedChunks, plan, NULL)
+                    && code->decode(input, &output, decodedSize, plan, NULL)
+                    && decodedSize == dataSize;
+        });
+        if (okay)
+            results.push_back(result);
+    }
+
+    // combine the partially encoded chunks from n-k racks (i.e., carRepairFinalize()) to repair a chunk under CAR
+    DecodingPlan carPlan;
+    int numRacks = n - k;
+    std::vector<Chunk> partials(numRacks);
+    std::vector<chunk_id_t> repairTargets(1, 0);
+    okay = okay && carCode->preDecode(repairTargets, carPlan, NULL, /* is repair */ true);
+    for (int i = 0; i < numRacks && okay; i++) {
+        partials.at(i).setChunkId(k + i);
+        partials.at(i).data = stripe.at(k + i).data;
+        partials.at(i).size = chunkSize;
+        partials.at(i).freeData = false;
+    }
+    result.op = "car_repair";
+    result.erasures = 1;
+    result.bytesPerOp = (unsigned long int) chunkSize * numRacks;
+    okay = okay && bench(result, [&]() {
+        length_t decodedSize = 0;
+        return carCode->decode(partials, &output, decodedSize, carPlan, NULL, /* is repair */ true, repairTargets) && decodedSize == chunkSize;
+    });
+    if (okay)
+        results.push_back(result);
+
+    // encode the k data chunks into one partial chunk with a row of the repair matrix, i.e., the partial encoding at agents under CAR
+    data_t matrix[k];
+    data_t *datap[k], *outputp[1] = { output };
+    for (int i = 0; i < k; i++) {
+        matrix[i] = rand() % 255 + 1;
+        datap[i] = stripe.at(i).data;
+    }
+    result.op = "partial_encode";
+    result.erasures = 1;
+    result.bytesPerOp = dataSize;
+    okay = okay && bench(result, [&]() {
+        return CodingUtils::encode(datap, k, outputp, 1, chunkSize, matrix);
+    });
+    if (okay)
+        results.push_back(result);
+
+    stripe.clear();
+    free(data);
+    free(output);
+    delete code;
+    delete carCode;
+
+    return okay;
+}
+
+/**
+ * Benchmark degraded reads of small chunks after losing the first data chunk, without and with caching decoding tables, with the decoding plan made once
+ **/
+bool benchDegradedRead(coding_param_t n, coding_param_t k, std::vector<BenchResult> &results) {
+    DecodingTableCache &cache = DecodingTableCache::getInstance();
+    size_t capacity = cache.getCapacity();
+    CodingOptions options;
+    options.setN(n);
+    options.setK(k);
+    Coding *code = CodingGenerator::genCoding(CodingScheme::RS, options);
+    if (code == NULL) {
+        fprintf(stderr, "Failed to init RS code with n=%d k=%d\n", n, k);
+        return false;
+    }
+
+    length_t chunkSize = BENCH_DEGRADED_READ_CHUNK_SIZE;
+    length_t dataSize = chunkSize * k;
+    data_t *data = NULL, *output = NULL;
+    std::vector<Chunk> stripe, input;
+    std::vector<chunk_id_t> failedChunks(1, 0);
+    DecodingPlan plan;
+    bool okay = posix_memalign((void **) &data, 64, dataSize) == 0 && posix_memalign((void **) &output, 64, dataSize) == 0;
+    for (length_t i = 0; okay && i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    okay = okay && code->encode(data, dataSize, stripe, NULL) && code->preDecode(failedChunks, plan, NULL);
+    if (okay) {
+        std::vector<chunk_id_t> inputChunksInPlan = plan.getInputChunkIds();
+        input.resize(plan.getMinNumInputChunks());
+        for (size_t i = 0; i < input.size(); i++) {
+            input.at(i).copyMeta(stripe.at(inputChunksInPlan.at(i)));
+            input.at(i).data = stripe.at(inputChunksInPlan.at(i)).data;
+            input.at(i).freeData = false;
+        }
+    }
+
+    BenchResult result;
+    result.coding = CodingSchemeName[CodingScheme::RS];
+    result.n = n;
+    result.k = k;
+    result.chunkSize = chunkSize;
+    result.erasures = 1;
+    result.bytesPerOp = dataSize;
+
+    // decode without (0) and with (1) cached decoding tables
+    for (int cached = 0; cached < 2 && okay; cached++) {
+        cache.clear();
+        cache.setCapacity(cached? (capacity > 0? capacity : DECODING_TABLE_CACHE_DEFAULT_SIZE) : 0);
+        result.op = cached? "degraded_read_cached" : "degraded_read";
+        okay = bench(result, [&]() {
+            length_t decodedSize = 0;
+            return code->decode(input, &output, decodedSize, plan, NULL) && decodedSize == dataSize;
+        });
+        if (okay)
+            results.push_back(result);
+    }
+
+    cache.clear();
+    cache.setCapacity(capacity);
+    plan.release();
+    input.clear();
+    stripe.clear();
+    free(data);
+    free(output);
+    delete code;
+
+    return okay;
+}
+
+/**
+ * Copy the sub-chunks of a chunk needed as an input in a decoding plan
+ *
+ * @return the size of input chunk copied
+ **/
+length_t copyInputChunk(Chunk &input, const Chunk &src, const DecodingPlan &plan, size_t idx) {
+    num_t first = 0, num = 0;
+    length_t subChunkSize = src.size / plan.getNumSubChunks();
+    plan.getInputSubChunks(idx, first, num);
+    input.allocateData(num * subChunkSize);
+    input.setChunkId(src.getChunkId());
+    memcpy(input.data, src.data + first * subChunkSize, num * subChunkSize);
+    return num * subChunkSize;
+}
+
+/**
+ * Benchmark repairing each chunk of a stripe as the only failed chunk, with the decoding plans made once, and report the number of chunks read per repair
+ **/
+bool benchRepair(int scheme, coding_param_t n, coding_param_t k, length_t chunkSize, std::vector<BenchResult> &results) {
+    CodingOptions options;
+    options.setN(n);
+    options.setK(k);
+    Coding *code = CodingGenerator::genCoding(scheme, options);
+    if (code == NULL) {
+        fprintf(stderr, "Failed to init %s code with n=%d k=%d\n", CodingSchemeName[scheme], n, k);
+        return false;
+    }
+
+    length_t dataSize = chunkSize * k;
+    data_t *data = NULL, *output = NULL;
+    std::vector<Chunk> stripe;
+    bool okay = posix_memalign((void **) &data, 64, dataSize) == 0 && posix_memalign((void **) &output, 64, dataSize) == 0;
+    for (length_t i = 0; okay && i < dataSize; i++)
+        data[i] = rand() % 256;
+    okay = okay && code->encode(data, dataSize, stripe, NULL);
+
+    // the (sub-)chunks read for repairing each chunk
+    std::vector<DecodingPlan> plans(n);
+    std::vector<std::vector<Chunk> > inputs(n);
+    std::vector<std::vector<chunk_id_t> > failedChunks(n);
+    unsigned long int bytesRead = 0;
+    for (chunk_id_t f = 0; f < n && okay; f++) {
+        failedChunks.at(f).push_back(f);
+        okay = code->preDecode(failedChunks.at(f), plans.at(f), NULL, /* is repair */ true);
+        if (!okay)
+            break;
+        std::vector<chunk_id_t> inputChunksInPlan = plans.at(f).getInputChunkIds();
+        inputs.at(f).resize(plans.at(f).getMinNumInputChunks());
+        for (size_t i = 0; i < inputs.at(f).size(); i++)
+            bytesRead += copyInputChunk(inputs.at(f).at(i), stripe.at(inputChunksInPlan.at(i)), plans.at(f), i);
+    }
+
+    BenchResult result;
+    result.op = "repair";
+    result.coding = CodingSchemeName[scheme];
+    result.n = n;
+    result.k = k;
+    result.chunkSize = chunkSize;
+    result.erasures = 1;
+    result.bytesPerOp = bytesRead;
+    okay = okay && bench(result, [&]() {
+        bool repaired = true;
+        for (chunk_id_t f = 0; f < n && repaired; f++) {
+            length_t decodedSize = 0;
+            repaired = code->decode(inputs.at(f), &output, decodedSize, plans.at(f), NULL, /* is repair */ true, failedChunks.at(f)) && decodedSize == chunkSize;
+        }
+        return repaired;
+    });
+    if (okay) {
+        results.push_back(result);
+        fprintf(stderr, "  %-22s %-10s reads %.2lf chunks per failed chunk\n", "", result.coding.c_str(), bytesRead * 1.0 / chunkSize / n);
+    }
+
+    plans.clear();
+    inputs.clear();
+    stripe.clear();
+    free(data);
+    free(output);
+    delete code;
+
+    return okay;
+}
+
+/**
+ * Benchmark RS encoding and decoding (after losing the first n-k chunks) of large chunks using different numbers of coding threads, with the decoding plan made once
+ **/
+bool benchParallelCoding(coding_param_t n, coding_param_t k, std::vector<BenchResult> &results) {
+    ParallelCoding &pc = ParallelCoding::getInstance();
+    int numThreads = pc.getNumThreads();
+    int maxThreads = std::min(std::max((int) std::thread::hardware_concurrency(), 4), BENCH_PARALLEL_CODING_MAX_THREADS);
+    CodingOptions options;
+    options.setN(n);
+    options.setK(k);
+    Coding *code = CodingGenerator::genCoding(CodingScheme::RS, options);
+    if (code == NULL) {
+        fprintf(stderr, "Failed to init RS code with n=%d k=%d\n", n, k);
+        return false;
+    }
+
+    length_t chunkSize = BENCH_PARALLEL_CODING_CHUNK_SIZE;
+    length_t dataSize = chunkSize * k;
+    data_t *data = NULL, *output = NULL;
+    std::vector<Chunk> stripe, input;
+    std::vector<chunk_id_t> failedChunks;
+    DecodingPlan plan;
+    bool okay = posix_memalign((void **) &data, 64, dataSize) == 0 && posix_memalign((void **) &output, 64, dataSize) == 0;
+    for (length_t i = 0; okay && i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    for (chunk_id_t i = 0; i < n - k; i++)
+        failedChunks.push_back(i);
+    okay = okay && code->encode(data, dataSize, stripe, NULL) && code->preDecode(failedChunks, plan, NULL);
+    if (okay) {
+        std::vector<chunk_id_t> inputChunksInPlan = plan.getInputChunkIds();
+        input.resize(plan.getMinNumInputChunks());
+        for (size_t i = 0; i < input.size(); i++) {
+            input.at(i).copyMeta(stripe.at(inputChunksInPlan.at(i)));
+            input.at(i).data = stripe.at(inputChunksInPlan.at(i)).data;
+            input.at(i).freeData = false;
+        }
+    }
+
+    BenchResult result;
+    result.coding = CodingSchemeName[CodingScheme::RS];
+    result.n = n;
+    result.k = k;
+    result.chunkSize = chunkSize;
+    result.bytesPerOp = dataSize;
+
+    std::vector<Chunk> encoded;
+    for (int t = 1; t <= maxThreads && okay; t *= 2) {
+        pc.setNumThreads(t);
+
+        result.op = "encode";
+        result.erasures = 0;
+        okay = bench(result, [&]() {
+            return code->encode(data, dataSize, encoded, NULL, /* shadow data chunks */ true);
+        });
+        if (okay)
+            results.push_back(result);
+
+        result.op = "degraded_decode";
+        result.erasures = n - k;
+        okay = okay && bench(result, [&]() {
+            length_t decodedSize = 0;
+            return code->decode(input, &output, decodedSize, plan, NULL) && decodedSize == dataSize;
+        });
+        if (okay)
+            results.push_back(result);
+    }
+
+    pc.setNumThreads(numThreads);
+    plan.release();
+    input.clear();
+    encoded.clear();
+    stripe.clear();
+    free(data);
+    free(output);
+    delete code;
+
+    return okay;
+}
+
+/**
+ * Benchmark encoding and checksumming the chunks in separate passes against in one fused pass, with 1 and the max. number of coding threads
+ **/
+bool benchFusedChecksum(int scheme, coding_param_t n, coding_param_t k, int checksumType, std::vector<BenchResult> &results) {
+    ParallelCoding &pc = ParallelCoding::getInstance();
+    int numThreads = pc.getNumThreads();
+    int maxThreads = std::min(std::max((int) std::thread::hardware_concurrency(), 2), BENCH_PARALLEL_CODING_MAX_THREADS);
+    CodingOptions options;
+    options.setN(n);
+    options.setK(k);
+    Coding *code = CodingGenerator::genCoding(scheme, options);
+    if (code == NULL) {
+        fprintf(stderr, "Failed to init %s code with n=%d k=%d\n", CodingSchemeName[scheme], n, k);
+        return false;
+    }
+
+    length_t dataSize = BENCH_FUSED_CHECKSUM_CHUNK_SIZE * k;
+    data_t *data = NULL;
+    std::vector<Chunk> stripe;
+    bool okay = posix_memalign((void **) &data, 64, dataSize) == 0;
+    for (length_t i = 0; okay && i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    BenchResult result;
+    result.coding = CodingSchemeName[scheme];
+    result.checksum = ChecksumTypeName[checksumType];
+    result.n = n;
+    result.k = k;
+    result.chunkSize = code->getChunkSize(dataSize);
+    result.erasures = 0;
+    result.bytesPerOp = dataSize;
+
+    for (int t = 1; t <= maxThreads && okay; t = t == 1? maxThreads : t + 1) {
+        pc.setNumThreads(t);
+
+        // encode and then checksum (0), and encode with checksums (1)
+        for (int fused = 0; fused < 2 && okay; fused++) {
+            result.op = fused? "fused_encode_checksum" : "encode_then_checksum";
+            okay = bench(result, [&]() {
+                bool encoded = code->encode(data, dataSize, stripe, NULL, /* shadow data chunks */ true, /* compute checksums */ fused, checksumType);
+                for (coding_param_t i = 0; i < n && encoded && !fused; i++) {
+                    stripe.at(i).checksumType = checksumType;
+                    encoded = stripe.at(i).computeChecksum();
+                }
+                return encoded;
+            });
+            if (okay)
+                results.push_back(result);
+        }
+    }
+
+    pc.setNumThreads(numThreads);
+    stripe.clear();
+    free(data);
+    delete code;
+
+    return okay;
+}
+
+/**
+ * Benchmark computing the checksum of a chunk for each checksum type across chunk sizes
+ **/
+bool benchChecksum(std::vector<BenchResult> &results) {
+    data_t *data = NULL;
+    bool okay = posix_memalign((void **) &data, 64, BENCH_CHECKSUM_MAX_SIZE) == 0;
+    for (length_t i = 0; okay && i < BENCH_CHECKSUM_MAX_SIZE; i++)
+        data[i] = rand() % 256;
+
+    BenchResult result;
+    result.op = "checksum";
+    result.n = 0;
+    result.k = 0;
+    result.erasures = 0;
+
+    for (length_t size = BENCH_CHECKSUM_MIN_SIZE; size <= BENCH_CHECKSUM_MAX_SIZE && okay; size *= 4) {
+        for (int t = 0; t < ChecksumType::UNKNOWN_CHECKSUM && okay; t++) {
+            result.checksum = ChecksumTypeName[t];
+            result.chunkSize = size;
+            result.bytesPerOp = size;
+            okay = bench(result, [&]() {
+                unsigned char digest[CHUNK_CHECKSUM_MAX_LEN];
+                unsigned int length = CHUNK_CHECKSUM_MAX_LEN;
+                ChecksumCalculator *cal = ChecksumCalculatorGenerator::genCalculator(t);
+                bool computed = cal != NULL && cal->appendData(data, size) && cal->finalize(digest, length);
+                delete cal;
+                return computed;
+            });
+            if (okay)
+                results.push_back(result);
+        }
+    }
+
+    free(data);
+
+    return okay;
+}
+
+/**
+ * Write the results in JSON
+ **/
+void writeJSON(FILE *out, const std::vector<BenchResult> &results) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"coding_bench\",\n");
+    fprintf(out, "  \"coding_threads\": %d,\n", ParallelCoding::getInstance().getNumThreads());
+    fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results.at(i);
+        fprintf(out, "    { \"op\": \"%s\", \"coding\": \"%s\", \"checksum\": \"%s\", \"n\": %d, \"k\": %d, \"chunk_size\": %u, \"erasures\": %d, \"threads\": %d, \"bytes_per_op\": %lu, \"iterations\": %lu, \"ns_per_op\": %.1lf, \"cpu_ns_per_op\": %.1lf, \"gb_per_s\": %.4lf, \"allocs_per_op\": %.2lf }%s\n"
+            , r.op.c_str()
+            , r.coding.c_str()
+            , r.checksum.c_str()
+            , r.n
+            , r.k
+            , r.chunkSize
+            , r.erasures
+            , r.threads
+            , r.bytesPerOp
+            , r.iterations
+            , r.nsPerOp
+            , r.cpuNsPerOp
+            , r.getThroughput()
+            , r.allocsPerOp
+            , i + 1 < results.size()? "," : ""
+        );
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        usage(argv[0]);
+    }
+
+    Config &config = Config::getInstance();
+    config.setConfigPath();
+
+    FLAGS_logtostderr = true;
+    FLAGS_minloglevel = google::ERROR;
+    google::InitGoogleLogging(argv[0]);
+
+    srand(12345);
+
+    std::vector<length_t> chunkSizes;
+    for (int i = 2; i < argc; i++) {
+        long int size = atol(argv[i]);
+        if (size <= 0) {
+            fprintf(stderr, "Invalid chunk size %s\n", argv[i]);
+            usage(argv[0]);
+        }
+        chunkSizes.push_back(size);
+    }
+    if (chunkSizes.empty())
+        chunkSizes.assign(defaultChunkSizes, defaultChunkSizes + sizeof(defaultChunkSizes) / sizeof(length_t));
+
+    FILE *out = stdout;
+    if (argc > 1 && strcmp(argv[1], "-") != 0) {
+        out = fopen(argv[1], "w");
+        if (out == NULL) {
+            fprintf(stderr, "Failed to open %s for output\n", argv[1]);
+            exit(1);
+        }
+    }
+
+    std::vector<BenchResult> results;
+    bool okay = true;
+    for (int c = 0; c < BENCH_NUM_CODES && okay; c++) {
+        for (size_t s = 0; s < chunkSizes.size() && okay; s++) {
+            okay = benchRS(codingParams[c][0], codingParams[c][1], chunkSizes.at(s), results);
+        }
+    }
+    for (int c = 0; c < BENCH_NUM_CODES && okay; c++)
+        okay = benchDegradedRead(codingParams[c][0], codingParams[c][1], results);
+    // single-failure repair of LRC (with at least one local group) and Hitchhiker codes against RS
+    for (int c = 0; c < BENCH_NUM_CODES && okay; c++) {
+        coding_param_t n = codingParams[c][0], k = codingParams[c][1];
+        for (size_t s = 0; s < chunkSizes.size() && okay; s++) {
+            okay = benchRepair(CodingScheme::RS, n, k, chunkSizes.at(s), results);
+            if (okay && n - k > LRC_NUM_GLOBAL_PARITIES)
+                okay = benchRepair(CodingScheme::LRC, n, k, chunkSizes.at(s), results);
+            okay = okay && benchRepair(CodingScheme::HITCHHIKER, n, k, chunkSizes.at(s), results);
+        }
+    }
+
+    for (int c = 0; c < BENCH_NUM_PARALLEL_CODES && okay; c++)
+        okay = benchParallelCoding(parallelCodingParams[c][0], parallelCodingParams[c][1], results);
+
+    // encoding with checksums, with 2 global parities (and local groups) for LRC, i.e., n=12, k=8 for all schemes
+    for (int c = 0; c < CodingScheme::UNKNOWN_CODE && okay; c++) {
+        for (int t = 0; t < ChecksumType::UNKNOWN_CHECKSUM && okay; t++)
+            okay = benchFusedChecksum(c, 12, 8, t, results);
+    }
+
+    okay = okay && benchChecksum(results);
+
+    if (!okay)
+        fprintf(stderr, "Failed to benchmark coding operations\n");
+
+    writeJSON(out, results);
+    if (out != stdout)
+        fclose(out);
+
+    return okay? 0 : 1;
+}
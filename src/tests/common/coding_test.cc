@@ -4,6 +4,9 @@
 #include <stdlib.h> // exit(), rand()
 #include <string.h> // strcmp(), memset()
 
+#include <algorithm> // std::min(), std::max()
+#include <thread>    // std::thread::hardware_concurrency()
+
 #include <glog/logging.h>
 
 #include <boost/timer/timer.hpp>
@@ -16,9 +19,18 @@
 #include "../../common/coding/decoding_plan.hh"
 #include "../../common/coding/all.hh"
 #include "../../common/coding/coding_generator.hh"
+#include "../../common/coding/decoding_table_cache.hh"
+#include "../../common/coding/parallel_coding.hh"
 
 #define N (12)
 #define ROUNDS (3)  // rounds for repair single failure, esp. for non-exact repairing of F-MSR
+#define DEGRADED_READ_CHUNK_SIZE (4096)  // small chunks for checking degraded reads
+#define DEGRADED_READ_ROUNDS (100)       // number of degraded reads to check the decoding table cache with
+#define DELTA_UPDATE_CHUNK_SIZE (4096)   // chunk size for checking delta updates of code chunks
+#define FAILURE_TEST_CHUNK_SIZE (4096)   // chunk size for checking LRC and Hitchhiker codes under all failure patterns
+#define PARALLEL_CODING_CHUNK_SIZE ((16 << 20) + 1000)  // large chunks, with a partial last slice, for checking parallel coding
+#define PARALLEL_CODING_MAX_THREADS (16)         // max. number of threads to check
+#define FUSED_CHECKSUM_CHUNK_SIZE (4 << 20)      // chunk size for checking encoding with and without fused checksums
 
 #define HASH_SIZE CODING_HASH_SIZE
 
@@ -198,6 +210,31 @@ bool codingTest(CodingOptions options, coding_param_t r, const char *codename, C
     duration = mytimer.elapsed();
     printf(" Encoding speed = %.3lf MB/s\n", (fsize * 1.0 / (1 << 20))  / (duration.wall * 1.0 / 1e9));
 
+    // encode with data chunks referencing the data buffer, and compare the chunks
+    if (code->isSystematic()) {
+        std::vector<Chunk> shadowStripe;
+        data_t *shadowCodingState = NULL;
+        mytimer.start();
+        if (code->encode(fdata, fsize, shadowStripe, &shadowCodingState, /* shadowDataChunks */ true) == false) {
+            printf("  Failed to encode data with shadow data chunks\n");
+            okay = false;
+            goto CODE_TEST_EXIT;
+        }
+        duration = mytimer.elapsed();
+        printf(" Encoding speed (shadow data chunks) = %.3lf MB/s\n", (fsize * 1.0 / (1 << 20))  / (duration.wall * 1.0 / 1e9));
+        delete [] shadowCodingState;
+        for (num_t i = 0; i < stripe.size() && okay; i++) {
+            Chunk &chunk = shadowStripe.at(i);
+            bool isShadow = i < numDataChunks && (i + 1) * chunkSize <= fsize;
+            if (chunk.size != stripe.at(i).size || memcmp(chunk.data, stripe.at(i).data, chunkSize) != 0 || chunk.freeData == isShadow || (isShadow && chunk.data != fdata + i * chunkSize)) {
+                printf("  Incorrect chunk %u encoded with shadow data chunks\n", i);
+                okay = false;
+            }
+        }
+        if (!okay)
+            goto CODE_TEST_EXIT;
+    }
+
     // --------------- //
     //  test decoding  //
     // --------------- //
@@ -547,6 +584,539 @@ CODE_TEST_EXIT:
     return okay;
 }
 
+/**
+ * Check degraded reads of small chunks decoded with and without caching decoding tables, and the hits on the cache
+ **/
+bool degradedReadTest(coding_param_t n, coding_param_t k, Coding *code) {
+    DecodingTableCache &cache = DecodingTableCache::getInstance();
+    size_t capacity = cache.getCapacity();
+    length_t chunkSize = DEGRADED_READ_CHUNK_SIZE;
+    length_t dataSize = chunkSize * k;
+    length_t decodedSize = 0;
+    data_t *data = NULL, *decodeOutput = NULL;
+    std::vector<Chunk> stripe;
+    std::vector<Chunk> decodeInput;
+    std::vector<chunk_id_t> failedChunks, inputChunksInPlan;
+    DecodingPlan plan;
+    bool okay = true;
+
+    if (posix_memalign((void **) &data, 32, dataSize) != 0 || posix_memalign((void **) &decodeOutput, 32, dataSize) != 0) {
+        printf("  Failed to allocate memory for data\n");
+        free(data);
+        return false;
+    }
+    for (length_t i = 0; i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    if (!code->encode(data, dataSize, stripe, NULL)) {
+        printf("  Failed to encode data\n");
+        okay = false;
+        goto DEGRADED_READ_TEST_EXIT;
+    }
+
+    // the first data chunk is lost
+    failedChunks.push_back(0);
+    if (!code->preDecode(failedChunks, plan, NULL)) {
+        printf("  Failed to find a decoding plan!\n");
+        okay = false;
+        goto DEGRADED_READ_TEST_EXIT;
+    }
+    inputChunksInPlan = plan.getInputChunkIds();
+    decodeInput.resize(plan.getMinNumInputChunks());
+    for (num_t i = 0; i < decodeInput.size(); i++)
+        decodeInput.at(i).copy(stripe.at(inputChunksInPlan.at(i)));
+
+    // decode without (0) and with (1) cached decoding tables
+    for (int cached = 0; cached < 2 && okay; cached++) {
+        cache.clear();
+        cache.setCapacity(cached? (capacity > 0? capacity : DECODING_TABLE_CACHE_DEFAULT_SIZE) : 0);
+        for (int round = 0; round < DEGRADED_READ_ROUNDS && okay; round++) {
+            okay = code->decode(decodeInput, &decodeOutput, decodedSize, plan, NULL);
+        }
+        if (!okay || decodedSize != dataSize || memcmp(data, decodeOutput, dataSize) != 0) {
+            printf("  Failed to decode data under degraded read (%s cache)\n", cached? "with" : "without");
+            okay = false;
+            break;
+        }
+        // all but the first decode should reuse the cached decoding table
+        if (cached && (cache.getNumHits() != DEGRADED_READ_ROUNDS - 1 || cache.getNumMisses() != 1)) {
+            printf("  Incorrect number of decoding table cache hits = %lu and misses = %lu, expect %d and 1\n", cache.getNumHits(), cache.getNumMisses(), DEGRADED_READ_ROUNDS - 1);
+            okay = false;
+        }
+    }
+
+    if (okay)
+        printf(" Degraded read (chunk size = %uB) with and without cached decoding tables passed\n", chunkSize);
+
+DEGRADED_READ_TEST_EXIT:
+
+    cache.clear();
+    cache.setCapacity(capacity);
+    plan.release();
+    decodeInput.clear();
+    stripe.clear();
+    free(decodeOutput);
+    free(data);
+
+    return okay;
+}
+
+/**
+ * Check the code chunks updated with the changes of data chunks against those re-encoded from the updated data
+ **/
+bool deltaUpdateTest(coding_param_t n, coding_param_t k, Coding *code) {
+    length_t chunkSize = DELTA_UPDATE_CHUNK_SIZE;
+    length_t dataSize = chunkSize * k;
+    std::vector<Chunk> stripe, updatedStripe, dataDeltas, codeDeltas;
+    bool okay = true;
+
+    if (!code->supportsDeltaUpdate())
+        return true;
+
+    data_t *data = (data_t *) malloc (dataSize);
+    if (data == NULL) {
+        printf("  Failed to allocate memory for data\n");
+        return false;
+    }
+    for (length_t i = 0; i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    if (!code->encode(data, dataSize, stripe, NULL)) {
+        printf("  Failed to encode data\n");
+        free(data);
+        return false;
+    }
+
+    // overwrite part of the first and the last data chunks
+    chunk_id_t changed[2] = { 0, (chunk_id_t) (k - 1) };
+    dataDeltas.resize(k > 1? 2 : 1);
+    for (size_t c = 0; c < dataDeltas.size(); c++) {
+        length_t start = changed[c] * chunkSize + rand() % (chunkSize / 2);
+        for (length_t i = start; i < start + chunkSize / 2; i++)
+            data[i] = rand() % 256;
+        Chunk &delta = dataDeltas.at(c);
+        delta.setChunkId(changed[c]);
+        delta.allocateData(chunkSize);
+        for (length_t i = 0; i < chunkSize; i++)
+            delta.data[i] = stripe.at(changed[c]).data[i] ^ data[changed[c] * chunkSize + i];
+    }
+
+    if (!code->encodeDelta(dataDeltas, codeDeltas) || codeDeltas.size() != (size_t) (n - k)) {
+        printf("  Failed to encode the changes of data chunks\n");
+        okay = false;
+    }
+    if (okay && !code->encode(data, dataSize, updatedStripe, NULL)) {
+        printf("  Failed to encode the updated data\n");
+        okay = false;
+    }
+    for (coding_param_t i = 0; okay && i < n - k; i++) {
+        Chunk &codeChunk = stripe.at(k + i);
+        for (length_t j = 0; j < chunkSize; j++)
+            codeChunk.data[j] ^= codeDeltas.at(i).data[j];
+        if (codeDeltas.at(i).getChunkId() != k + i || memcmp(codeChunk.data, updatedStripe.at(k + i).data, chunkSize) != 0) {
+            printf("  Incorrect code chunk %d updated with the changes of data chunks\n", k + i);
+            okay = false;
+        }
+    }
+
+    if (okay)
+        printf(" Delta update of code chunks passed\n");
+
+    free(data);
+
+    return okay;
+}
+
+/**
+ * Copy the sub-chunks of an input chunk needed in the decoding plan
+ *
+ * @return the size of input chunk copied
+ **/
+length_t copyInputChunk(Chunk &input, const Chunk &src, const DecodingPlan &plan, size_t idx) {
+    num_t first = 0, num = 0;
+    length_t subChunkSize = src.size / plan.getNumSubChunks();
+    plan.getInputSubChunks(idx, first, num);
+    input.allocateData(num * subChunkSize);
+    input.setChunkId(src.getChunkId());
+    memcpy(input.data, src.data + first * subChunkSize, num * subChunkSize);
+    return num * subChunkSize;
+}
+
+/**
+ * Decode and repair chunks from the minimal inputs in the plan of a failure pattern, and check against the stripe
+ **/
+bool failurePatternTest(Coding *code, std::vector<Chunk> &stripe, data_t *data, std::vector<chunk_id_t> &failedChunks) {
+    coding_param_t k = code->getK();
+    length_t chunkSize = stripe.at(0).size;
+    length_t decodedSize = 0;
+    data_t *output = NULL;
+    std::vector<Chunk> input;
+    std::vector<chunk_id_t> inputChunksInPlan;
+    DecodingPlan plan;
+    bool okay = true;
+
+    for (int isRepair = 0; isRepair < 2 && okay; isRepair++) {
+        if (!code->preDecode(failedChunks, plan, NULL, isRepair)) {
+            okay = false;
+            break;
+        }
+        inputChunksInPlan = plan.getInputChunkIds();
+        input.clear();
+        input.resize(plan.getMinNumInputChunks());
+        for (num_t i = 0; i < input.size(); i++)
+            copyInputChunk(input.at(i), stripe.at(inputChunksInPlan.at(i)), plan, i);
+        free(output);
+        output = NULL;
+        okay = code->decode(input, &output, decodedSize, plan, NULL, isRepair, isRepair? failedChunks : std::vector<chunk_id_t>());
+        if (okay && !isRepair) {
+            okay = decodedSize == chunkSize * k && memcmp(output, data, chunkSize * k) == 0;
+        }
+        for (num_t i = 0; okay && isRepair && i < failedChunks.size(); i++) {
+            okay = decodedSize == chunkSize * failedChunks.size() && memcmp(output + i * chunkSize, stripe.at(failedChunks.at(i)).data, chunkSize) == 0;
+        }
+    }
+
+    free(output);
+    input.clear();
+    plan.release();
+
+    return okay;
+}
+
+/**
+ * Test LRC against all patterns of up to g+1 failed chunks
+ **/
+bool lrcTest(coding_param_t n, coding_param_t k, Coding *code) {
+    LRCCode *lrc = dynamic_cast<LRCCode *>(code);
+    length_t chunkSize = FAILURE_TEST_CHUNK_SIZE;
+    length_t dataSize = chunkSize * k;
+    std::vector<Chunk> stripe;
+    std::vector<chunk_id_t> failedChunks;
+    num_t numPatterns = 0;
+    bool okay = true;
+
+    if (lrc == NULL) {
+        printf("  Not an LRC instance\n");
+        return false;
+    }
+
+    data_t *data = (data_t *) malloc (dataSize);
+    if (data == NULL) {
+        printf("  Failed to allocate memory for data\n");
+        return false;
+    }
+    for (length_t i = 0; i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    if (!code->encode(data, dataSize, stripe, NULL)) {
+        printf("  Failed to encode data\n");
+        free(data);
+        return false;
+    }
+
+    // each local parity is the xor of the data chunks in its group
+    for (num_t g = 0; g < lrc->getNumLocalGroups() && okay; g++) {
+        for (length_t j = 0; j < chunkSize && okay; j++) {
+            uint8_t x = 0;
+            for (coding_param_t i = 0; i < k; i++)
+                x ^= lrc->getLocalGroup(i) == (int) g? stripe.at(i).data[j] : 0;
+            okay = x == stripe.at(k + g).data[j];
+        }
+        if (!okay)
+            printf("  Incorrect local parity of group %u\n", g);
+    }
+
+    // any g+1 failed chunks are recoverable
+    for (uint32_t mask = 1; mask < (1u << n) && okay; mask++) {
+        if (__builtin_popcount(mask) > LRC_NUM_GLOBAL_PARITIES + 1)
+            continue;
+        failedChunks.clear();
+        for (chunk_id_t i = 0; i < n; i++) {
+            if (mask & (1u << i))
+                failedChunks.push_back(i);
+        }
+        okay = failurePatternTest(code, stripe, data, failedChunks);
+        if (!okay)
+            printf("  Failed to decode or repair with chunks (mask = %x) failed\n", mask);
+        numPatterns++;
+    }
+    if (okay)
+        printf(" Decode and repair under %u patterns of up to %d failed chunks passed\n", numPatterns, LRC_NUM_GLOBAL_PARITIES + 1);
+
+    free(data);
+    stripe.clear();
+
+    return okay;
+}
+
+/**
+ * Test Hitchhiker codes against RS codes on the first sub-chunks, and against all patterns of up to n-k failed chunks
+ **/
+bool hitchhikerTest(coding_param_t n, coding_param_t k, Coding *code) {
+    HitchhikerCode *hitchhiker = dynamic_cast<HitchhikerCode *>(code);
+    CodingOptions options;
+    options.setN(n);
+    options.setK(k);
+    Coding *rs = CodingGenerator::genCoding(CodingScheme::RS, options);
+    length_t chunkSize = FAILURE_TEST_CHUNK_SIZE;
+    length_t subChunkSize = chunkSize / HITCHHIKER_NUM_SUB_CHUNKS;
+    length_t dataSize = chunkSize * k;
+    std::vector<Chunk> stripe, rsStripe;
+    std::vector<chunk_id_t> failedChunks;
+    num_t numPatterns = 0;
+    bool okay = true;
+
+    if (hitchhiker == NULL || rs == NULL) {
+        printf("  Not a Hitchhiker instance, or failed to create the RS instance\n");
+        delete rs;
+        return false;
+    }
+
+    data_t *data = (data_t *) malloc (dataSize);
+    data_t *subData = (data_t *) malloc (subChunkSize * k);
+    if (data == NULL || subData == NULL) {
+        printf("  Failed to allocate memory for data\n");
+        free(data);
+        free(subData);
+        delete rs;
+        return false;
+    }
+    for (length_t i = 0; i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    okay = code->encode(data, dataSize, stripe, NULL) && stripe.at(0).size == (int) chunkSize;
+    if (!okay)
+        printf("  Failed to encode data\n");
+
+    // the first sub-chunks of all chunks, and the second sub-chunks of parity 0, are RS-encoded as is
+    for (int s = 0; s < HITCHHIKER_NUM_SUB_CHUNKS && okay; s++) {
+        for (coding_param_t i = 0; i < k; i++)
+            memcpy(subData + i * subChunkSize, data + i * chunkSize + s * subChunkSize, subChunkSize);
+        okay = rs->encode(subData, subChunkSize * k, rsStripe, NULL);
+        for (coding_param_t i = k; okay && i < (s == 0? n : k + 1); i++)
+            okay = memcmp(rsStripe.at(i).data, stripe.at(i).data + s * subChunkSize, subChunkSize) == 0;
+        if (!okay)
+            printf("  Incorrect sub-chunk %d of code chunks\n", s);
+    }
+
+    // any n-k failed chunks are recoverable, as long as the RS codes (on the second sub-chunks) can recover them,
+    // since the RS matrix is not guaranteed to be MDS for all patterns when n-k > 4
+    num_t numSkipped = 0;
+    for (uint32_t mask = 1; mask < (1u << n) && okay; mask++) {
+        if (__builtin_popcount(mask) > n - k)
+            continue;
+        failedChunks.clear();
+        for (chunk_id_t i = 0; i < n; i++) {
+            if (mask & (1u << i))
+                failedChunks.push_back(i);
+        }
+        if (!failurePatternTest(rs, rsStripe, subData, failedChunks)) {
+            numSkipped++;
+            continue;
+        }
+        okay = failurePatternTest(code, stripe, data, failedChunks);
+        if (!okay)
+            printf("  Failed to decode or repair with chunks (mask = %x) failed\n", mask);
+        numPatterns++;
+    }
+    if (okay)
+        printf(" Decode and repair under %u patterns of up to %d failed chunks passed (%u patterns not recoverable by RS skipped)\n", numPatterns, n - k, numSkipped);
+
+    free(data);
+    free(subData);
+    stripe.clear();
+    rsStripe.clear();
+    delete rs;
+
+    return okay;
+}
+
+/**
+ * Check the encoding and decoding of large chunks using different numbers of coding threads
+ **/
+bool parallelCodingTest(coding_param_t n, coding_param_t k, Coding *code) {
+    ParallelCoding &pc = ParallelCoding::getInstance();
+    int numThreads = pc.getNumThreads();
+    int maxThreads = std::min(std::max((int) std::thread::hardware_concurrency(), 4), PARALLEL_CODING_MAX_THREADS);
+    length_t chunkSize = PARALLEL_CODING_CHUNK_SIZE;
+    length_t dataSize = chunkSize * k;
+    length_t decodedSize = 0;
+    data_t *data = NULL, *decodeOutput = NULL;
+    std::vector<Chunk> stripe, refCodeChunks;
+    std::vector<Chunk> decodeInput;
+    std::vector<chunk_id_t> failedChunks, inputChunksInPlan;
+    DecodingPlan plan;
+    bool okay = true;
+
+    if (posix_memalign((void **) &data, 64, dataSize) != 0 || posix_memalign((void **) &decodeOutput, 64, dataSize) != 0) {
+        printf("  Failed to allocate memory for data\n");
+        free(data);
+        return false;
+    }
+    for (length_t i = 0; i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    // the first n-k chunks are lost
+    for (chunk_id_t i = 0; i < n - k; i++)
+        failedChunks.push_back(i);
+    if (!code->preDecode(failedChunks, plan, NULL)) {
+        printf("  Failed to find a decoding plan!\n");
+        free(decodeOutput);
+        free(data);
+        return false;
+    }
+    inputChunksInPlan = plan.getInputChunkIds();
+
+    for (int t = 1; t <= maxThreads && okay; t *= 2) {
+        pc.setNumThreads(t);
+
+        okay = code->encode(data, dataSize, stripe, NULL, /* shadow data chunks */ true);
+        if (!okay) {
+            printf("  Failed to encode data with %d threads\n", t);
+            break;
+        }
+        // code chunks must not depend on the number of threads
+        if (refCodeChunks.empty()) {
+            refCodeChunks.resize(n - k);
+            for (coding_param_t i = k; i < n; i++)
+                refCodeChunks.at(i - k).copy(stripe.at(i));
+        }
+        for (coding_param_t i = k; i < n && okay; i++)
+            okay = memcmp(stripe.at(i).data, refCodeChunks.at(i - k).data, chunkSize) == 0;
+        if (!okay) {
+            printf("  Code chunks encoded with %d threads mismatch those encoded with 1 thread\n", t);
+            break;
+        }
+
+        decodeInput.clear();
+        decodeInput.resize(plan.getMinNumInputChunks());
+        for (num_t i = 0; i < decodeInput.size(); i++)
+            decodeInput.at(i).copy(stripe.at(inputChunksInPlan.at(i)));
+        memset(decodeOutput, 0, dataSize);
+        okay = code->decode(decodeInput, &decodeOutput, decodedSize, plan, NULL);
+        if (!okay || decodedSize != dataSize || memcmp(data, decodeOutput, dataSize) != 0) {
+            printf("  Failed to decode data with %d threads\n", t);
+            okay = false;
+        }
+    }
+
+    if (okay)
+        printf(" Parallel coding (chunk size = %uB) with up to %d threads passed\n", chunkSize, maxThreads);
+
+    pc.setNumThreads(numThreads);
+    plan.release();
+    decodeInput.clear();
+    refCodeChunks.clear();
+    stripe.clear();
+    free(decodeOutput);
+    free(data);
+
+    return okay;
+}
+
+/**
+ * Check the chunk checksums against known digests, and their serialization
+ **/
+bool checksumTest() {
+    // digests of "123456789" (check values of the algorithms)
+    const char *input = "123456789";
+    const char *expected[ChecksumType::UNKNOWN_CHECKSUM] = {
+        "25f9e794323b453885f5181f1b624d0b",  // MD5
+        "e3069283"                           // CRC32C
+    };
+    bool okay = true;
+
+    Chunk chunk;
+    chunk.allocateData(strlen(input));
+    memcpy(chunk.data, input, chunk.size);
+    for (int t = 0; t < ChecksumType::UNKNOWN_CHECKSUM && okay; t++) {
+        chunk.checksumType = t;
+        okay = chunk.computeChecksum();
+        ChecksumCalculator *cal = ChecksumCalculatorGenerator::genCalculator(t);
+        std::string digest = ChecksumCalculator::toHex(chunk.checksum, cal->getDigestSize());
+        delete cal;
+        if (!okay || digest != expected[t]) {
+            printf("  %s checksum mismatched (%s vs %s)\n", ChecksumTypeName[t], digest.c_str(), expected[t]);
+            okay = false;
+            break;
+        }
+        // the checksum type is carried along with the checksum, and old checksums without the type are MD5
+        unsigned char field[CHUNK_CHECKSUM_FIELD_LEN];
+        int length = chunk.packChecksum(field);
+        Chunk copy;
+        okay = copy.unpackChecksum(field, length) && copy.matchChecksum(chunk)
+                && copy.unpackChecksum(field, CHUNK_CHECKSUM_MAX_LEN) && copy.checksumType == ChecksumType::CHECKSUM_MD5;
+        if (!okay)
+            printf("  Failed to serialize %s checksum\n", ChecksumTypeName[t]);
+    }
+    chunk.release();
+
+    if (okay)
+        printf(" Digests and serialization of chunk checksums passed\n");
+
+    return okay;
+}
+
+/**
+ * Check the chunk checksums computed along with encoding against those computed in separate passes, with and without parallel coding
+ **/
+bool fusedChecksumTest(coding_param_t n, coding_param_t k, Coding *code, int checksumType) {
+    ParallelCoding &pc = ParallelCoding::getInstance();
+    int numThreads = pc.getNumThreads();
+    int maxThreads = std::min(std::max((int) std::thread::hardware_concurrency(), 2), PARALLEL_CODING_MAX_THREADS);
+    length_t chunkSize = code->getChunkSize(FUSED_CHECKSUM_CHUNK_SIZE * k);
+    length_t dataSize = FUSED_CHECKSUM_CHUNK_SIZE * k;
+    data_t *data = NULL;
+    std::vector<Chunk> stripe;
+    unsigned char digests[n][CHUNK_CHECKSUM_MAX_LEN];
+    bool okay = true;
+
+    if (posix_memalign((void **) &data, 64, dataSize) != 0) {
+        printf("  Failed to allocate memory for data\n");
+        return false;
+    }
+    for (length_t i = 0; i < dataSize; i++)
+        data[i] = rand() % 256;
+
+    for (int t = 1; t <= maxThreads && okay; t = t == 1? maxThreads : t + 1) {
+        pc.setNumThreads(t);
+
+        // encode and then checksum (0), and encode with checksums (1)
+        for (int fused = 0; fused < 2 && okay; fused++) {
+            okay = code->encode(data, dataSize, stripe, NULL, /* shadow data chunks */ true, /* compute checksums */ fused, checksumType);
+            for (coding_param_t i = 0; i < n && okay && !fused; i++) {
+                stripe.at(i).checksumType = checksumType;
+                okay = stripe.at(i).computeChecksum();
+            }
+            if (!okay) {
+                printf("  Failed to encode data %s checksums\n", fused? "with" : "before computing");
+                break;
+            }
+            // the checksums must match those of the chunk data, and the fused ones those computed separately with 1 thread
+            for (coding_param_t i = 0; i < n && okay; i++) {
+                if (stripe.at(i).size != (int) chunkSize || stripe.at(i).checksumType != checksumType || !stripe.at(i).verifyChecksum()) {
+                    printf("  Checksum of chunk %d mismatches its data (%s, threads = %d)\n", i, fused? "fused" : "separate", t);
+                    okay = false;
+                } else if (!fused && t == 1) {
+                    memcpy(digests[i], stripe.at(i).checksum, CHUNK_CHECKSUM_MAX_LEN);
+                } else if (fused && memcmp(digests[i], stripe.at(i).checksum, CHUNK_CHECKSUM_MAX_LEN) != 0) {
+                    printf("  Fused checksum of chunk %d mismatches the one computed separately (threads = %d)\n", i, t);
+                    okay = false;
+                }
+            }
+        }
+    }
+
+    if (okay)
+        printf(" Encode with %s checksums (chunk size = %uB) with 1 and %d threads passed\n", ChecksumTypeName[checksumType], chunkSize, maxThreads);
+
+    pc.setNumThreads(numThreads);
+    stripe.clear();
+    free(data);
+
+    return okay;
+}
+
 int main(int argc, char *argv[]) {
     if (argc < 3) {
         usage(argv[0]);
@@ -580,13 +1150,41 @@ int main(int argc, char *argv[]) {
     options.setN(1);
     options.setK(1);
     for (int c = 0; c < CodingScheme::UNKNOWN_CODE && pass; c++)
-        pass = parameterValidationTest(c, options, true);
+        pass = parameterValidationTest(c, options, c == CodingScheme::RS);
 
     printf("> (valid) n = 19, k = 17\n");
     options.setN(19);
     options.setK(17);
     for (int c = 0; c < CodingScheme::UNKNOWN_CODE && pass; c++)
-        pass = parameterValidationTest(c, options, true);
+        pass = parameterValidationTest(c, options, c != CodingScheme::LRC);
+
+    // LRC needs at least one local group besides the global parities, and no more local groups than data chunks
+    printf("> (LRC) n = 16, k = 12 (valid); n = 19, k = 16 (valid); n = 8, k = 2 (invalid)\n");
+    options.setN(16);
+    options.setK(12);
+    pass = pass && parameterValidationTest(CodingScheme::LRC, options, true);
+    options.setN(19);
+    options.setK(16);
+    pass = pass && parameterValidationTest(CodingScheme::LRC, options, true);
+    options.setN(8);
+    options.setK(2);
+    pass = pass && parameterValidationTest(CodingScheme::LRC, options, false);
+
+    // Hitchhiker codes need at least two parities, one of which carries no piggyback
+    printf("> (HITCHHIKER) n = 6, k = 4 (valid); n = 5, k = 4 (invalid)\n");
+    options.setN(6);
+    options.setK(4);
+    pass = pass && parameterValidationTest(CodingScheme::HITCHHIKER, options, true);
+    options.setN(5);
+    options.setK(4);
+    pass = pass && parameterValidationTest(CodingScheme::HITCHHIKER, options, false);
+
+    // checksum types
+    if (pass) {
+        printf("| Check chunk checksums\n");
+        pass = checksumTest();
+        printf("\n");
+    }
 
     if (!pass)
         exit(-1);
@@ -606,6 +1204,10 @@ int main(int argc, char *argv[]) {
             code = CodingGenerator::genCoding(CodingScheme::RS, options);
             for (int i = 2; i < argc && pass; i++)
                 pass = codingTest(options, r, "RS", code, argv[i]);
+            if (pass)
+                pass = degradedReadTest(n, k, code);
+            if (pass)
+                pass = deltaUpdateTest(n, k, code);
             delete code;
             printf("\n");
             
@@ -614,6 +1216,89 @@ int main(int argc, char *argv[]) {
         }
     }    
 
+    // parallel coding of large chunks
+    if (pass)
+        printf("| Check parallel coding (threshold = %uB)\n", ParallelCoding::getInstance().getThreshold());
+    for (coding_param_t n = 9; n <= N && pass; n += 3) {
+        coding_param_t k = n * 2 / 3;
+
+        options.setN(n);
+        options.setK(k);
+
+        printf("> RS, n=%d, k=%d\n", n, k);
+        code = CodingGenerator::genCoding(CodingScheme::RS, options);
+        pass = parallelCodingTest(n, k, code);
+        delete code;
+        printf("\n");
+    }
+
+    // encoding with checksums, with 2 global parities (and local groups) for LRC, i.e., n=12, k=8 for all schemes
+    if (pass)
+        printf("| Check fused encoding and checksums\n");
+    for (int c = 0; c < CodingScheme::UNKNOWN_CODE && pass; c++) {
+        coding_param_t n = N, k = N * 2 / 3;
+
+        options.setN(n);
+        options.setK(k);
+
+        printf("> %s, n=%d, k=%d\n", CodingSchemeName[c], n, k);
+        code = CodingGenerator::genCoding(c, options);
+        pass = code != NULL;
+        for (int t = 0; t < ChecksumType::UNKNOWN_CHECKSUM && pass; t++)
+            pass = fusedChecksumTest(n, k, code, t);
+        delete code;
+        printf("\n");
+    }
+
+    // l local groups and g global parities, i.e., n = k + l + g
+    for (coding_param_t n = LRC_NUM_GLOBAL_PARITIES + 2; n <= N && pass; n++) {
+        for (coding_param_t l = 1; l <= n - LRC_NUM_GLOBAL_PARITIES - l; l++) {
+            coding_param_t k = n - LRC_NUM_GLOBAL_PARITIES - l;
+
+            options.setN(n);
+            options.setK(k);
+
+            printf("> LRC, n=%d, k=%d, l=%d, g=%d\n", n, k, l, LRC_NUM_GLOBAL_PARITIES);
+            code = CodingGenerator::genCoding(CodingScheme::LRC, options);
+            pass = code != NULL;
+            if (pass)
+                pass = lrcTest(n, k, code);
+            if (pass)
+                pass = degradedReadTest(n, k, code);
+            if (pass)
+                pass = deltaUpdateTest(n, k, code);
+            delete code;
+            printf("\n");
+
+            if (!pass)
+                break;
+        }
+    }
+
+    // piggybacks on n-k-1 parities, i.e., n-k >= 2
+    // (degraded reads are not benchmarked, since each decode looks up the RS decoding tables for both sub-chunks)
+    for (coding_param_t n = 4; n <= N && pass; n++) {
+        for (coding_param_t m = 2; m < n - 1; m++) {
+            coding_param_t k = n - m;
+
+            options.setN(n);
+            options.setK(k);
+
+            printf("> HITCHHIKER, n=%d, k=%d\n", n, k);
+            code = CodingGenerator::genCoding(CodingScheme::HITCHHIKER, options);
+            pass = code != NULL;
+            if (pass)
+                pass = hitchhikerTest(n, k, code);
+            if (pass)
+                pass = deltaUpdateTest(n, k, code);
+            delete code;
+            printf("\n");
+
+            if (!pass)
+                break;
+        }
+    }
+
     if (!pass)
         printf("Test Failed!!!\n");
     else 
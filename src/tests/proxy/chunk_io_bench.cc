@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <pthread.h> // pthread_*()
+#include <stdio.h> // printf()
+#include <stdlib.h> // atoi()
+#include <boost/timer/timer.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+extern "C" {
+#include <oss_c_sdk/aos_http_io.h>
+}
+#include <glog/logging.h>
+#include <aws/core/Aws.h>
+
+#include "../../agent/agent.hh"
+#include "../../common/config.hh"
+#include "../../common/define.hh"
+#include "../../common/io.hh"
+#include "../../ds/chunk_event.hh"
+#include "../../proxy/io.hh"
+
+/**
+ * Chunk I/O benchmark
+ *
+ * Benchmark flow
+ * 1. Run agent on localhost (without registrating to proxy)
+ * 2. For one thread per request, the event-driven chunk I/O threads, and the event-driven chunk I/O threads with batched chunk requests,
+ *    a. Put chunks to containers in batches of concurrent requests from each client thread
+ *       - Expect successful put
+ *    b. Get the chunks in batches of concurrent requests from each client thread
+ *       - Expect successful get of the requested chunks of the same size, with each client thread numbering its events from 0 like the chunk managers sharing a ProxyIO
+ *    c. Delete the chunks in batches of concurrent requests from each client thread
+ *       - Expect successful delete
+ * Printing of the number of requests completed per second, and the throughput of put and get in MB/s, in each mode
+ *
+ * Usage: ./chunk_io_bench [number of requests] [number of concurrent requests] [chunk size] [number of client threads]
+ **/
+
+#define DEFAULT_NUM_REQS   (4096)
+#define DEFAULT_BATCH_SIZE (64)
+#define DEFAULT_CHUNK_SIZE (4096)
+#define DEFAULT_NUM_CLIENTS (2)
+#define DEFAULT_IO_BATCH_SIZE (8)
+
+struct ClientArg {
+    ProxyIO *io;
+    Opcode op;
+    Opcode expectedOp;
+    Chunk *chunks;
+    int numReqs;
+    int batchSize;
+    int numContainers;
+    bool okay;
+};
+
+static void *runAgent(void *arg) {
+    Agent *agent = (Agent*) arg;
+
+    agent->run(/* register to proxy */ false);
+
+    return NULL;
+}
+
+/**
+ * Issue chunk requests in batches, and wait for all replies of a batch before issuing the next batch
+ *
+ * @param arg pointer to a ClientArg structure, with okay set to whether all requests succeed on return
+ * @return NULL
+ **/
+static void *runClient(void *arg) {
+    Config &config = Config::getInstance();
+    ClientArg &client = *((ClientArg *) arg);
+    ProxyIO *io = client.io;
+    Opcode op = client.op, expectedOp = client.expectedOp;
+    Chunk *chunks = client.chunks;
+    int numReqs = client.numReqs, batchSize = client.batchSize, numContainers = client.numContainers;
+    ChunkEvent *events = new ChunkEvent[batchSize * 2];
+    ProxyIO::RequestMeta *meta = new ProxyIO::RequestMeta[batchSize];
+    // event ids of different clients collide
+    unsigned int eventId = 0;
+    bool okay = true;
+
+    for (int start = 0; start < numReqs && okay; start += batchSize) {
+        int num = std::min(batchSize, numReqs - start);
+        for (int i = 0; i < num; i++) {
+            events[i].release();
+            events[i + batchSize].release();
+            events[i].id = eventId++;
+            events[i].opcode = op;
+            events[i].numChunks = 1;
+            events[i].chunks = new Chunk[1];
+            events[i].chunks[0] = chunks[start + i];
+            events[i].chunks[0].freeData = false;
+            events[i].containerIds = new int[1];
+            events[i].containerIds[0] = config.getContainerId((start + i) % numContainers);
+
+            meta[i].containerId = events[i].containerIds[0];
+            meta[i].io = io;
+            meta[i].request = &events[i];
+            meta[i].reply = &events[i + batchSize];
+            ProxyIO::submitChunkRequest(&meta[i]);
+        }
+        for (int i = 0; i < num; i++) {
+            void *ptr = ProxyIO::waitChunkRequest(&meta[i]);
+            if (ptr != 0 || meta[i].reply->opcode != expectedOp) {
+                printf("> Request %d failed, error = %ld, opcode = %d\n", start + i, (long) ptr, meta[i].reply->opcode);
+                okay = false;
+            } else if (meta[i].reply->id != meta[i].request->id) {
+                printf("> Request %d failed, event id mismatched (%u vs %u)\n", start + i, meta[i].reply->id, meta[i].request->id);
+                okay = false;
+            } else if (op == Opcode::GET_CHUNK_REQ && (meta[i].reply->numChunks != 1 || meta[i].reply->chunks[0].getChunkId() != chunks[start + i].getChunkId() || meta[i].reply->chunks[0].size != chunks[start + i].size)) {
+                printf("> Request %d failed, chunk id or size mismatched\n", start + i);
+                okay = false;
+            }
+        }
+    }
+
+    delete [] meta;
+    delete [] events;
+
+    client.okay = okay;
+    return NULL;
+}
+
+/**
+ * Issue chunk requests from client threads, each on a separate range of chunks
+ *
+ * @return number of requests completed per second, negative if any request fails
+ **/
+static double runRequests(ProxyIO *io, Opcode op, Opcode expectedOp, Chunk *chunks, int numReqs, int batchSize, int numContainers, int numClients) {
+    pthread_t ct[numClients];
+    ClientArg args[numClients];
+    bool okay = true;
+
+    boost::timer::cpu_timer mytimer;
+
+    for (int i = 0, start = 0; i < numClients; i++) {
+        int num = numReqs / numClients + (i < numReqs % numClients? 1 : 0);
+        args[i] = { io, op, expectedOp, chunks + start, num, batchSize, numContainers, false };
+        start += num;
+        pthread_create(&ct[i], NULL, runClient, &args[i]);
+    }
+    for (int i = 0; i < numClients; i++) {
+        pthread_join(ct[i], NULL);
+        okay = okay && args[i].okay;
+    }
+
+    double duration = mytimer.elapsed().wall * 1.0 / 1e9;
+
+    return okay? numReqs / duration : -1;
+}
+
+int main(int argc, char **argv) {
+    Config &config = Config::getInstance();
+    config.setConfigPath();
+
+    int numReqs = argc > 1? atoi(argv[1]) : DEFAULT_NUM_REQS;
+    int batchSize = argc > 2? atoi(argv[2]) : DEFAULT_BATCH_SIZE;
+    int chunkSize = argc > 3? atoi(argv[3]) : DEFAULT_CHUNK_SIZE;
+    int numClients = argc > 4? atoi(argv[4]) : DEFAULT_NUM_CLIENTS;
+    if (numReqs <= 0 || batchSize <= 0 || chunkSize <= 0 || numClients <= 0) {
+        printf("Usage: %s [number of requests] [number of concurrent requests] [chunk size] [number of client threads]\n", argv[0]);
+        return 1;
+    }
+
+    // init aws sdk
+    Aws::SDKOptions options;
+    Aws::InitAPI(options);
+    // init aliyun sdk
+    if (aos_http_io_initialize(NULL, 0) != AOSE_OK) {
+        LOG(ERROR) << "Failed to init Aliyun OSS interface";
+        return 1;
+    }
+
+    printf("Start Chunk I/O Benchmark\n");
+    printf("====================\n");
+
+    if (!config.glogToConsole()) {
+        FLAGS_log_dir = config.getGlogDir().c_str();
+        printf("Output log to %s\n", config.getGlogDir().c_str());
+    } else {
+        FLAGS_logtostderr = true;
+        printf("Output log to console\n");
+    }
+    FLAGS_minloglevel = config.getLogLevel();
+    google::InitGoogleLogging(argv[0]);
+
+    // ---------------------------
+    // 1. run agent in background
+    // ---------------------------
+    Agent *agent = new Agent();
+    pthread_t at;
+    pthread_create(&at, NULL, runAgent, agent);
+
+    sleep(1);
+
+    // route requests of all containers to the local agent
+    std::map<int, std::string> containerToAgentMap;
+    std::string agentAddr = IO::genAddr(config.getAgentIP(), config.getAgentPort());
+    int numContainers = config.getNumContainers();
+    for (int i = 0; i < numContainers; i++)
+        containerToAgentMap.insert(std::make_pair(config.getContainerId(i), agentAddr));
+
+    // chunks to put and delete
+    boost::uuids::basic_random_generator<boost::mt19937> gen;
+    boost::uuids::uuid fileuuid = gen();
+    unsigned char namespaceId = 1;
+    unsigned char *data = (unsigned char*) malloc (chunkSize);
+    memset(data, 'a', chunkSize);
+    Chunk *chunks = new Chunk[numReqs];
+    for (int i = 0; i < numReqs; i++) {
+        chunks[i].setId(namespaceId, fileuuid, i);
+        chunks[i].size = chunkSize;
+        chunks[i].data = data;
+        chunks[i].fileVersion = 0;
+        chunks[i].freeData = false;
+        chunks[i].computeChecksum();
+    }
+
+    printf("> %d requests of %d bytes, %d client threads, %d concurrent requests per client, %d containers\n", numReqs, chunkSize, numClients, batchSize, numContainers);
+
+    // ---------------------------------------------------
+    // 2. put and delete chunks with each chunk I/O model
+    // ---------------------------------------------------
+    int numIOThreads[3] = { 0, std::max(config.getProxyNumChunkIOThreads(), 1), std::max(config.getProxyNumChunkIOThreads(), 1) };
+    int ioBatchSize[3] = { 1, 1, std::max(config.getProxyChunkIOBatchSize(), DEFAULT_IO_BATCH_SIZE) };
+    double mb = chunkSize * 1.0 / (1 << 20);
+    bool okay = true;
+    for (int m = 0; m < 3 && okay; m++) {
+        ProxyIO *io = new ProxyIO(&containerToAgentMap, numIOThreads[m], ioBatchSize[m]);
+        std::string mode = io->getNumIOThreads() == 0?
+                std::string("one thread per request") :
+                std::string("event-driven, ").append(std::to_string(io->getNumIOThreads())).append(" threads, ")
+                        .append(std::to_string(config.getProxyNumChunkIOConnections())).append(" connections per agent");
+        if (io->getBatchSize() > 1)
+            mode.append(", up to ").append(std::to_string(io->getBatchSize())).append(" chunks per batch");
+
+        double putRate = runRequests(io, Opcode::PUT_CHUNK_REQ, Opcode::PUT_CHUNK_REP_SUCCESS, chunks, numReqs, batchSize, numContainers, numClients);
+        if (putRate < 0) {
+            printf("> [Put Chunk] Failed (%s)\n", mode.c_str());
+            okay = false;
+        } else {
+            printf("> [Put Chunk] %.2lf requests/s, %.2lf MB/s (%s)\n", putRate, putRate * mb, mode.c_str());
+        }
+
+        double getRate = runRequests(io, Opcode::GET_CHUNK_REQ, Opcode::GET_CHUNK_REP_SUCCESS, chunks, numReqs, batchSize, numContainers, numClients);
+        if (getRate < 0) {
+            printf("> [Get Chunk] Failed (%s)\n", mode.c_str());
+            okay = false;
+        } else {
+            printf("> [Get Chunk] %.2lf requests/s, %.2lf MB/s (%s)\n", getRate, getRate * mb, mode.c_str());
+        }
+
+        double delRate = runRequests(io, Opcode::DEL_CHUNK_REQ, Opcode::DEL_CHUNK_REP_SUCCESS, chunks, numReqs, batchSize, numContainers, numClients);
+        if (delRate < 0) {
+            printf("> [Delete Chunk] Failed (%s)\n", mode.c_str());
+            okay = false;
+        } else {
+            printf("> [Delete Chunk] %.2lf requests/s (%s)\n", delRate, mode.c_str());
+        }
+
+        delete io;
+    }
+
+    agent->printStats();
+
+    // clean up at the end of all runs
+    delete [] chunks;
+    free(data);
+
+    delete agent;
+    pthread_join(at, NULL);
+
+    aos_http_io_deinitialize();
+    Aws::ShutdownAPI(options);
+
+    printf("End of Chunk I/O Benchmark\n");
+    printf("====================\n");
+
+    return okay? 0 : 1;
+}
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include <errno.h>
+#include <limits.h>    // ULONG_MAX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <getopt.h>
+
+#include "../client/c/zmq_interface.h"
+
+#define LOCAL_HOST                 "127.0.0.1"
+#define DEFAULT_PORT               (59001)
+#define DEFAULT_NUM_OPS            (1024)
+#define DEFAULT_OBJECT_SIZE        (4096)
+#define DEFAULT_MAX_DEPTH          (128)
+#define DEFAULT_STORAGE_CLASS      "STANDARD"
+#define TEST_NAMESPACE_ID          (-1)
+#define MAX_NAME_LENGTH            (128)
+
+enum LoadPhase {
+    WRITE = 0,
+    READ,
+    DELETE,
+
+    NUM_PHASES
+};
+
+const char *phase_names[] = {
+    "write",
+    "read",
+    "delete",
+};
+
+// test options
+const char *proxy_ip = LOCAL_HOST;
+unsigned short proxy_port = DEFAULT_PORT;
+int num_ops = DEFAULT_NUM_OPS;
+unsigned long int object_size = DEFAULT_OBJECT_SIZE;
+int max_depth = DEFAULT_MAX_DEPTH;
+char *storage_class = DEFAULT_STORAGE_CLASS;
+
+double elapsed_seconds(const struct timeval start, const struct timeval end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+// run one phase of operations with at most 'depth' requests in flight, and return the throughput in ops/s (-1 if failed)
+double run_phase(ncloud_async_conn_t *conn, int phase, int depth, unsigned char *data) {
+    request_t *reqs = (request_t *) malloc (sizeof(request_t) * depth);
+    char *names = (char *) malloc (MAX_NAME_LENGTH * depth);
+    int *free_slots = (int *) malloc (sizeof(int) * depth);
+    request_completion_t *completions = (request_completion_t *) malloc (sizeof(request_completion_t) * depth);
+    int num_free = 0, submitted = 0, completed = 0, failed = 0, okay = 1;
+    struct timeval start, end;
+
+    if (reqs == NULL || names == NULL || free_slots == NULL || completions == NULL) {
+        fprintf(stderr, "Failed to allocate memory for %d requests in flight\n", depth);
+        okay = 0;
+    }
+    for (int i = depth - 1; okay && i >= 0; i--)
+        free_slots[num_free++] = i;
+
+    gettimeofday(&start, NULL);
+    while (okay && completed < num_ops) {
+        // keep the pipeline full
+        while (submitted < num_ops && num_free > 0) {
+            int slot = free_slots[--num_free];
+            char *name = names + slot * MAX_NAME_LENGTH;
+            snprintf(name, MAX_NAME_LENGTH, "load_test_%d_%d", depth, submitted);
+            switch (phase) {
+            case WRITE:
+                set_buffered_file_write_request(&reqs[slot], name, object_size, data, storage_class, TEST_NAMESPACE_ID);
+                break;
+            case READ:
+                set_buffered_file_read_request(&reqs[slot], name, TEST_NAMESPACE_ID);
+                break;
+            case DELETE:
+            default:
+                set_delete_file_request(&reqs[slot], name, TEST_NAMESPACE_ID);
+                break;
+            }
+            if (submit_request(conn, &reqs[slot], slot, NULL, NULL) != 0) {
+                fprintf(stderr, "Failed to submit %s request %d at depth %d\n", phase_names[phase], submitted, depth);
+                okay = 0;
+                break;
+            }
+            submitted++;
+        }
+
+        // complete the requests with replies
+        int num_completed = poll_requests(conn, -1, completions, depth);
+        if (num_completed < 0) {
+            fprintf(stderr, "Failed to poll for replies at depth %d\n", depth);
+            okay = 0;
+            break;
+        }
+        for (int i = 0; i < num_completed; i++) {
+            request_t *req = completions[i].request;
+            if (completions[i].result == ULONG_MAX || (phase == READ && req->file.size != object_size))
+                failed++;
+            // the read buffer is allocated by the library on reply
+            if (phase == READ)
+                free(req->file.data);
+            request_t_release(req);
+            free_slots[num_free++] = completions[i].tag;
+        }
+        completed += num_completed;
+    }
+    gettimeofday(&end, NULL);
+
+    free(reqs);
+    free(names);
+    free(free_slots);
+    free(completions);
+
+    if (!okay)
+        return -1;
+    if (failed > 0)
+        fprintf(stderr, "%d out of %d %s requests failed at depth %d\n", failed, num_ops, phase_names[phase], depth);
+    return num_ops / elapsed_seconds(start, end);
+}
+
+void print_usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "Report the throughput (ops/s) of writing, reading and deleting objects with 1 to <max depth> requests in flight over one connection\n"
+            "\n"
+            "Options:\n"
+            "  -a<proxy ip>       Proxy IP (default: %s)\n"
+            "  -p<port>           Proxy port of the ZeroMQ interface (default: %d)\n"
+            "  -n<num ops>        number of operations per phase and depth (default: %d)\n"
+            "  -s<object size>    object size in bytes (default: %d)\n"
+            "  -d<max depth>      max. number of requests in flight, doubled from 1 (default: %d)\n"
+            "  -c<storage class>  storage class of objects (default: %s)\n"
+            "  -h                 print this help message\n"
+            , prog
+            , LOCAL_HOST
+            , DEFAULT_PORT
+            , DEFAULT_NUM_OPS
+            , DEFAULT_OBJECT_SIZE
+            , DEFAULT_MAX_DEPTH
+            , DEFAULT_STORAGE_CLASS
+    );
+}
+
+int main(int argc, char **argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "a:p:n:s:d:c:h")) != -1) {
+        switch(opt) {
+            case 'a':
+                proxy_ip = optarg;
+                break;
+            case 'p':
+                proxy_port = atoi(optarg);
+                break;
+            case 'n':
+                num_ops = atoi(optarg);
+                break;
+            case 's':
+                object_size = strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                max_depth = atoi(optarg);
+                break;
+            case 'c':
+                storage_class = optarg;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+
+    if (num_ops <= 0 || object_size == 0 || max_depth <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // object content
+    unsigned char *data = (unsigned char *) malloc (object_size);
+    if (data == NULL) {
+        fprintf(stderr, "Failed to allocate memory for object data of size %lu\n", object_size);
+        return 1;
+    }
+    for (unsigned long int i = 0; i < object_size; i++)
+        data[i] = i % 256;
+
+    ncloud_async_conn_t conn;
+    if (ncloud_async_conn_t_init(proxy_ip, proxy_port, &conn, max_depth) != 0) {
+        fprintf(stderr, "Failed to connect to proxy at %s:%hu\n", proxy_ip, proxy_port);
+        free(data);
+        return 1;
+    }
+
+    printf("%8s %14s %14s %14s\n", "depth", "write (ops/s)", "read (ops/s)", "delete (ops/s)");
+    int ret = 0;
+    for (int depth = 1; ret == 0; depth *= 2) {
+        // always end with the max. depth
+        if (depth > max_depth)
+            depth = max_depth;
+        double throughput[NUM_PHASES];
+        for (int phase = 0; phase < NUM_PHASES && ret == 0; phase++) {
+            throughput[phase] = run_phase(&conn, phase, depth, data);
+            ret = throughput[phase] < 0;
+        }
+        if (ret == 0)
+            printf("%8d %14.1lf %14.1lf %14.1lf\n", depth, throughput[WRITE], throughput[READ], throughput[DELETE]);
+        if (depth == max_depth)
+            break;
+    }
+
+    ncloud_async_conn_t_release(&conn);
+    free(data);
+
+    return ret;
+}
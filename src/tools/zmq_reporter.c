@@ -57,6 +57,7 @@ const char *storage_types[] = {
     "AWS",
     "Azure",
     "Generic_S3",    // 5
+    "Segment",
 
     "Unknown"
 };